@@ -28,6 +28,7 @@
 #include "../lib/oscilloscope.h"
 #include "../lib/picsimlab.h"
 #include "../lib/spareparts.h"
+#include "../lib/stepkernel.h"
 
 /* ids of inputs of input map*/
 enum {
@@ -536,23 +537,12 @@ void cboard_Arduino_Uno::Draw(CDraw* draw) {
 }
 
 void cboard_Arduino_Uno::Run_CPU(void) {
-    int i;
-    // int j;
     unsigned char pi;
     const picpin* pins;
-    unsigned int alm[100];
 
-    // int JUMPSTEPS = Window1.GetJUMPSTEPS ()*4.0; //number of steps skipped
+    const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS() * 4.0;  // number of steps skipped
     const int pinc = MGetPinCount();
     const long int NSTEP = 4.0 * PICSimLab.GetNSTEP();  // number of steps in 100ms
-    const float RNSTEP = 200.0 * pinc / NSTEP;
-
-    long long unsigned int cycle_start;
-    int twostep = 0;
-
-    // reset mean value
-
-    memset(alm, 0, pinc * sizeof(unsigned int));
 
     // read pic.pins to a local variable to speed up
 
@@ -561,55 +551,14 @@ void cboard_Arduino_Uno::Run_CPU(void) {
     if (use_spare)
         SpareParts.PreProcess();
 
-    // j = JUMPSTEPS; //step counter
-    pi = 0;
-    if (PICSimLab.GetMcuPwr())       // if powered
-        for (i = 0; i < NSTEP; i++)  // repeat for number of steps in 100ms
-        {
-            // verify if a breakpoint is reached if not run one instruction
-            if (avr_debug_type || (!mplabxd_testbp())) {
-                if (twostep) {
-                    twostep = 0;  // NOP
-                } else {
-                    cycle_start = avr->cycle;
-                    avr_run(avr);
-                    if ((avr->cycle - cycle_start) > 1) {
-                        twostep = 1;
-                    }
-                }
-            }
-
-            InstCounterInc();
-            UpdateHardware();
-
-            // avr->sleep_usec=0;
-            if (use_oscope)
-                Oscilloscope.SetSample();
-            if (use_spare)
-                SpareParts.Process();
-            ioupdated = 0;
-
-            // increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pinc)
-                pi = 0;
-            /*
-                if (j >= JUMPSTEPS)//if number of step is bigger than steps to skip
-                 {
-                  //set analog pin 2 (AN0) with value from scroll
-                  //pic_set_apin(2,((5.0*(scroll1->GetPosition()))/
-                  //  (scroll1->GetRange()-1)));
-
-                  j = -1; //reset counter
-                 }
-                j++; //counter increment
-             */
-        }
+    if (PICSimLab.GetMcuPwr())  // if powered
+        RunSteps(this, pins, pinc, NSTEP, JUMPSTEPS);
+    else
+        PinActivity.Clear();
 
     // calculate mean value
     for (pi = 0; pi < MGetPinCount(); pi++) {
-        cboard_Arduino_Uno::pins[pi].oavalue = (int)((alm[pi] * RNSTEP) + 55);
+        cboard_Arduino_Uno::pins[pi].oavalue = (int)((PinActivity.GetDuty(pi) * 200.0) + 55);
     }
 
     if (use_spare)
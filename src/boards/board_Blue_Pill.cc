@@ -399,22 +399,16 @@ void cboard_Blue_Pill::Draw(CDraw* draw) {
 
 void cboard_Blue_Pill::Run_CPU_ns(uint64_t time) {
     static unsigned char pi = 0;
-    static unsigned int alm[64];
     static const int pinc = MGetPinCount();
 
-    const float RNSTEP = 200.0 * pinc * inc_ns / TTIMEOUT;
-
     for (uint64_t c = 0; c < time; c += inc_ns) {
         if (ns_count < inc_ns) {
-            // reset pins mean value
-            memset(alm, 0, 64 * sizeof(unsigned int));
+            // start pins activity frame
+            PinActivity.Start(pins, pinc, GetInstCounter());
 
             // Spare parts window pre process
             if (use_spare)
                 SpareParts.PreProcess();
-
-            // j = JUMPSTEPS; //step counter
-            pi = 0;
         }
 
         if (PICSimLab.GetMcuPwr())  // if powered
@@ -435,11 +429,9 @@ void cboard_Blue_Pill::Run_CPU_ns(uint64_t time) {
             if (use_spare)
                 SpareParts.Process();
 
-            //  increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pinc)
-                pi = 0;
+            // record pins edges
+            if (ioupdated)
+                ScanPins();
             /*
                 if (j >= JUMPSTEPS)//if number of step is bigger than steps to skip
                  {
@@ -454,8 +446,12 @@ void cboard_Blue_Pill::Run_CPU_ns(uint64_t time) {
         if (ns_count >= TTIMEOUT) {
             ns_count -= TTIMEOUT;
             //  calculate mean value
+            if (PICSimLab.GetMcuPwr())
+                PinActivity.End(GetInstCounter());
+            else
+                PinActivity.Clear();
             for (pi = 0; pi < MGetPinCount(); pi++) {
-                pins[pi].oavalue = (int)((alm[pi] * RNSTEP) + 55);
+                pins[pi].oavalue = (int)((PinActivity.GetDuty(pi) * 200.0) + 55);
             }
             // Spare parts window pre post process
             if (use_spare)
@@ -28,6 +28,7 @@
 #include "../lib/oscilloscope.h"
 #include "../lib/picsimlab.h"
 #include "../lib/spareparts.h"
+#include "../lib/stepkernel.h"
 
 /* ids of inputs of input map*/
 enum {
@@ -422,63 +423,27 @@ void cboard_Breadboard::Draw(CDraw* draw) {
 }
 
 void cboard_Breadboard::Run_CPU(void) {
-    int i;
-    int j;
     unsigned char pi;
     const picpin* pins;
-    unsigned int alm[100];
 
     switch (ptype) {
         case _PIC: {
             const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS();  // number of steps skipped
             const long int NSTEP = PICSimLab.GetNSTEP();     // number of steps in 100ms
-            const float RNSTEP = 200.0 * pic.PINCOUNT / NSTEP;
-
-            // reset mean value
-            memset(alm, 0, 100 * sizeof(unsigned int));
 
             // read pic.pins to a local variable to speed up
             pins = MGetPinsValues();
             if (use_spare)
                 SpareParts.PreProcess();
 
-            j = JUMPSTEPS;  // step counter
-            pi = 0;
-            if (PICSimLab.GetMcuPwr())       // if powered
-                for (i = 0; i < NSTEP; i++)  // repeat for number of steps in 100ms
-                {
-                    if (j >= JUMPSTEPS)  // if number of step is bigger than steps to skip
-                    {
-                        pic_set_pin(&pic, pic.mclr, p_RST);
-                    }
-
-                    // verify if a breakpoint is reached if not run one instruction
-                    if (!mplabxd_testbp())
-                        pic_step(&pic);
-                    ioupdated = pic.ioupdated;
-                    InstCounterInc();
-
-                    if (use_oscope)
-                        Oscilloscope.SetSample();
-                    if (use_spare)
-                        SpareParts.Process();
-
-                    // increment mean value counter if pin is high
-                    alm[pi] += pins[pi].value;
-                    pi++;
-                    if (pi == pic.PINCOUNT)
-                        pi = 0;
+            if (PICSimLab.GetMcuPwr())  // if powered
+                RunSteps<bsim_picsim>(this, pins, pic.PINCOUNT, NSTEP, JUMPSTEPS);
+            else
+                PinActivity.Clear();
 
-                    if (j >= JUMPSTEPS)  // if number of step is bigger than steps to skip
-                    {
-                        j = -1;  // reset counter
-                    }
-                    j++;  // counter increment
-                    pic.ioupdated = 0;
-                }
             // calculate mean value
             for (pi = 0; pi < MGetPinCount(); pi++) {
-                bsim_picsim::pic.pins[pi].oavalue = (int)((alm[pi] * RNSTEP) + 55);
+                bsim_picsim::pic.pins[pi].oavalue = (int)((PinActivity.GetDuty(pi) * 200.0) + 55);
             }
             if (use_spare)
                 SpareParts.PostProcess();
@@ -486,17 +451,8 @@ void cboard_Breadboard::Run_CPU(void) {
         }
         case _AVR: {
             const int pinc = bsim_simavr::MGetPinCount();
-            // const int JUMPSTEPS = Window1.GetJUMPSTEPS ()*4.0; //number of steps
-            // skipped
-            const long int NSTEP = 4.0 * PICSimLab.GetNSTEP();  // number of steps in 100ms
-            const float RNSTEP = 200.0 * pinc / NSTEP;
-
-            long long unsigned int cycle_start;
-            int twostep = 0;
-
-            // reset mean value
-
-            memset(alm, 0, pinc * sizeof(unsigned int));
+            const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS() * 4.0;  // number of steps skipped
+            const long int NSTEP = 4.0 * PICSimLab.GetNSTEP();      // number of steps in 100ms
 
             // read pic.pins to a local variable to speed up
 
@@ -505,53 +461,14 @@ void cboard_Breadboard::Run_CPU(void) {
             if (use_spare)
                 SpareParts.PreProcess();
 
-            // j = JUMPSTEPS; //step counter
-            pi = 0;
-            if (PICSimLab.GetMcuPwr())       // if powered
-                for (i = 0; i < NSTEP; i++)  // repeat for number of steps in 100ms
-                {
-                    // verify if a breakpoint is reached if not run one instruction
-                    if (avr_debug_type || (!mplabxd_testbp())) {
-                        if (twostep) {
-                            twostep = 0;  // NOP
-                        } else {
-                            cycle_start = avr->cycle;
-                            avr_run(avr);
-                            if ((avr->cycle - cycle_start) > 1) {
-                                twostep = 1;
-                            }
-                        }
-                    }
-                    InstCounterInc();
-                    bsim_simavr::UpdateHardware();
-
-                    // avr->sleep_usec=0;
-                    if (use_oscope)
-                        Oscilloscope.SetSample();
-                    if (use_spare)
-                        SpareParts.Process();
-                    ioupdated = 0;
-
-                    // increment mean value counter if pin is high
-                    alm[pi] += pins[pi].value;
-                    pi++;
-                    if (pi == pinc)
-                        pi = 0;
-                    /*
-                    if (j >= JUMPSTEPS)//if number of step is bigger than steps to skip
-                     {
-                      //set analog pin 2 (AN0) with value from scroll
-                      //pic_set_apin(2,((5.0*(scroll1->GetPosition()))/
-                      //  (scroll1->GetRange()-1)));
-
-                      j = -1; //reset counter
-                     }
-                    j++; //counter increment
-                     */
-                }
+            if (PICSimLab.GetMcuPwr())  // if powered
+                RunSteps<bsim_simavr>(this, pins, pinc, NSTEP, JUMPSTEPS);
+            else
+                PinActivity.Clear();
+
             // calculate mean value
             for (pi = 0; pi < MGetPinCount(); pi++) {
-                bsim_simavr::pins[pi].oavalue = (int)((alm[pi] * RNSTEP) + 55);
+                bsim_simavr::pins[pi].oavalue = (int)((PinActivity.GetDuty(pi) * 200.0) + 55);
             }
             if (use_spare)
                 SpareParts.PostProcess();
@@ -44,6 +44,7 @@ private:
     lxFont font;
     unsigned char jmp[1];  // jumper
 public:
+    static const int reentrant = 1;  // picsim and simavr are both reentrant
     void SetScale(double scale) override;
     // Return the board name
     lxString GetName(void) override { return lxT(BOARD_Breadboard_Name); };
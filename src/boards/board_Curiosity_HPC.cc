@@ -30,6 +30,7 @@
 #include "../lib/picsimlab.h"
 #include "../lib/serial_port.h"
 #include "../lib/spareparts.h"
+#include "../lib/stepkernel.h"
 
 /* ids of inputs of input map*/
 enum {
@@ -714,73 +715,43 @@ void cboard_Curiosity_HPC::Draw(CDraw* draw) {
     }
 }
 
+void cboard_Curiosity_HPC::StepPre(const int jump) {
+    bsim_picsim::StepPre(jump);
+    if (jump) {
+        if (ic28pins) {
+            pic_set_pin(&pic, 25, p_BT[0]);  // Set pin 25 (RB4) with button state
+            pic_set_pin(&pic, 16, p_BT[1]);  // Set pin 16 (RC5) with button state
+        } else {
+            pic_set_pin(&pic, 37, p_BT[0]);  // Set pin 25 (RB4) with button state
+            pic_set_pin(&pic, 24, p_BT[1]);  // Set pin 16 (RC5) with button state
+        }
+    }
+}
+
+void cboard_Curiosity_HPC::StepPost(const int jump) {
+    if (jump) {
+        // set analog pin 2 (RA0 AN4) with value from scroll
+        pic_set_apin(&pic, 2, (pic.vcc * pot1 / 199));
+    }
+}
+
 void cboard_Curiosity_HPC::Run_CPU(void) {
-    int i;
-    int j;
     unsigned char pi;
-    const picpin* pins;
-    unsigned int alm[40];
 
     const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS();  // number of steps skipped
     const long int NSTEP = PICSimLab.GetNSTEP();     // number of steps in 100ms
-    const float RNSTEP = 200.0 * pic.PINCOUNT / NSTEP;
-
-    // reset mean value
-    memset(alm, 0, 40 * sizeof(unsigned int));
-
-    // read pic.pins to a local variable to speed up
-    pins = pic.pins;
 
     if (use_spare)
         SpareParts.PreProcess();
 
-    j = JUMPSTEPS;  // step counter
-    pi = 0;
-    if (PICSimLab.GetMcuPwr())       // if powered
-        for (i = 0; i < NSTEP; i++)  // repeat for number of steps in 100ms
-        {
-            if (j >= JUMPSTEPS)  // if number of step is bigger than steps to skip
-            {
-                pic_set_pin(&pic, pic.mclr, p_RST);
-                if (ic28pins) {
-                    pic_set_pin(&pic, 25, p_BT[0]);  // Set pin 25 (RB4) with button state
-                    pic_set_pin(&pic, 16, p_BT[1]);  // Set pin 16 (RC5) with button state
-                } else {
-                    pic_set_pin(&pic, 37, p_BT[0]);  // Set pin 25 (RB4) with button state
-                    pic_set_pin(&pic, 24, p_BT[1]);  // Set pin 16 (RC5) with button state
-                }
-            }
-
-            // verify if a breakpoint is reached if not run one instruction
-            if (!mplabxd_testbp())
-                pic_step(&pic);
-            ioupdated = pic.ioupdated;
-            InstCounterInc();
-            if (use_oscope)
-                Oscilloscope.SetSample();
-            if (use_spare)
-                SpareParts.Process();
-
-            // increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pic.PINCOUNT)
-                pi = 0;
-
-            if (j >= JUMPSTEPS)  // if number of step is bigger than steps to skip
-            {
-                // set analog pin 2 (RA0 AN4) with value from scroll
-                pic_set_apin(&pic, 2, (pic.vcc * pot1 / 199));
-                j = -1;  // reset counter
-            }
-
-            j++;  // counter increment
-            pic.ioupdated = 0;
-        }
+    if (PICSimLab.GetMcuPwr())  // if powered
+        RunSteps(this, pic.pins, pic.PINCOUNT, NSTEP, JUMPSTEPS);
+    else
+        PinActivity.Clear();
 
     // calculate mean value
     for (pi = 0; pi < pic.PINCOUNT; pi++) {
-        pic.pins[pi].oavalue = (int)((alm[pi] * RNSTEP) + 55);
+        pic.pins[pi].oavalue = (int)((PinActivity.GetDuty(pi) * 200.0) + 55);
     }
     if (use_spare)
         SpareParts.PostProcess();
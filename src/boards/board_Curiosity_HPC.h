@@ -74,6 +74,9 @@ public:
     // Called ever 100ms to draw board
     void Draw(CDraw* draw) override;
     void Run_CPU(void) override;
+    // Stepping kernel hooks called every CPU step
+    void StepPre(const int jump);
+    void StepPost(const int jump);
     // Return a list of board supported microcontrollers
     lxString GetSupportedDevices(void) override { return lxT("PIC18F47K40,"); };
     // Reset board status
@@ -28,6 +28,7 @@
 #include "../lib/oscilloscope.h"
 #include "../lib/picsimlab.h"
 #include "../lib/spareparts.h"
+#include "../lib/stepkernel.h"
 
 /* ids of inputs of input map*/
 enum {
@@ -375,22 +376,23 @@ void cboard_Franzininho_DIY::Draw(CDraw* draw) {
     }
 }
 
+void cboard_Franzininho_DIY::StepCore(void) {
+    bsim_simavr::StepCore();
+    // TinyDebug support
+    if (avr->data[TDDR]) {
+        printf("%c", avr->data[TDDR]);
+        serial_port_send(serialfd, avr->data[TDDR]);
+        avr->data[TDDR] = 0;
+    }
+}
+
 void cboard_Franzininho_DIY::Run_CPU(void) {
-    int i;
     unsigned char pi;
     const picpin* pins;
-    unsigned int alm[40];
 
+    const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS() * 4.0;  // number of steps skipped
     const int pinc = MGetPinCount();
     const long int NSTEP = 4.0 * PICSimLab.GetNSTEP();  // number of steps in 100ms
-    const float RNSTEP = 200.0 * pinc / NSTEP;
-
-    long long unsigned int cycle_start;
-    int twostep = 0;
-
-    // reset mean value
-
-    memset(alm, 0, pinc * sizeof(unsigned int));
 
     // read pic.pins to a local variable to speed up
 
@@ -399,47 +401,14 @@ void cboard_Franzininho_DIY::Run_CPU(void) {
     if (use_spare)
         SpareParts.PreProcess();
 
-    pi = 0;
-    if (PICSimLab.GetMcuPwr())       // if powered
-        for (i = 0; i < NSTEP; i++)  // repeat for number of steps in 100ms
-        {
-            // verify if a breakpoint is reached if not run one instruction
-            if (avr_debug_type || (!mplabxd_testbp())) {
-                if (twostep) {
-                    twostep = 0;  // NOP
-                } else {
-                    cycle_start = avr->cycle;
-                    avr_run(avr);
-                    if ((avr->cycle - cycle_start) > 1) {
-                        twostep = 1;
-                    }
-                    // TinyDebug support
-                    if (avr->data[TDDR]) {
-                        printf("%c", avr->data[TDDR]);
-                        serial_port_send(serialfd, avr->data[TDDR]);
-                        avr->data[TDDR] = 0;
-                    }
-                }
-            }
-            InstCounterInc();
-            UpdateHardware();
-
-            if (use_oscope)
-                Oscilloscope.SetSample();
-            if (use_spare)
-                SpareParts.Process();
-            ioupdated = 0;
-
-            // increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pinc)
-                pi = 0;
-        }
+    if (PICSimLab.GetMcuPwr())  // if powered
+        RunSteps(this, pins, pinc, NSTEP, JUMPSTEPS);
+    else
+        PinActivity.Clear();
 
     // calculate mean value
     for (pi = 0; pi < MGetPinCount(); pi++) {
-        cboard_Franzininho_DIY::pins[pi].oavalue = (int)((alm[pi] * RNSTEP) + 55);
+        cboard_Franzininho_DIY::pins[pi].oavalue = (int)((PinActivity.GetDuty(pi) * 200.0) + 55);
     }
 
     if (use_spare)
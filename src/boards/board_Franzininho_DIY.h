@@ -69,6 +69,8 @@ public:
     // Called ever 100ms to draw board
     void Draw(CDraw* draw) override;
     void Run_CPU(void) override;
+    // Stepping kernel hook called every CPU step
+    void StepCore(void);
     // Return a list of board supported microcontrollers
     lxString GetSupportedDevices(void) override { return lxT("attiny85,"); };
     // Reset board status
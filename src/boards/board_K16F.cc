@@ -27,6 +27,7 @@
 #include "../lib/oscilloscope.h"
 #include "../lib/picsimlab.h"
 #include "../lib/spareparts.h"
+#include "../lib/stepkernel.h"
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
@@ -255,164 +256,139 @@ void cboard_K16F::Draw(CDraw* draw) {
     }
 }
 
-void cboard_K16F::Run_CPU(void) {
-    int i;
-    int j;
-    unsigned char pi;
-    const picpin* pins;
-    unsigned int alm[18];  // luminosidade media
-
-    const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS();
-    const long int NSTEP = PICSimLab.GetNSTEP();
-    const float RNSTEP = 200.0 * pic.PINCOUNT / NSTEP;
+void cboard_K16F::StepPre(const int jump) {
+    bsim_picsim::StepPre(jump);
+    if (jump) {
+        pic_set_pin(&pic, 18, 0);
+        pic_set_pin(&pic, 1, 0);
+        pic_set_pin(&pic, 15, 0);
+        pic_set_pin(&pic, 16, 0);
+        pic_set_pin(&pic, 13, 0);
+        pic_set_pin(&pic, 12, 0);
+        pic_set_pin(&pic, 11, 0);
+    }
 
-    pins = pic.pins;
+    // keyboard
 
-    memset(alm, 0, 18 * sizeof(unsigned int));
+    if (p_KEY[0]) {
+        pic_set_pin(&pic, 18, pic_get_pin(&pic, 13));
+        pic_set_pin(&pic, 13, pic_get_pin(&pic, 18));
+    }
 
-    if (use_spare)
-        SpareParts.PreProcess();
+    if (p_KEY[1]) {
+        pic_set_pin(&pic, 18, pic_get_pin(&pic, 12));
+        pic_set_pin(&pic, 12, pic_get_pin(&pic, 18));
+    }
 
-    j = JUMPSTEPS;
-    pi = 0;
-    if (PICSimLab.GetMcuPwr())
-        for (i = 0; i < NSTEP; i++) {
-            if (j >= JUMPSTEPS) {
-                pic_set_pin(&pic, pic.mclr, p_RST);
-
-                pic_set_pin(&pic, 18, 0);
-                pic_set_pin(&pic, 1, 0);
-                pic_set_pin(&pic, 15, 0);
-                pic_set_pin(&pic, 16, 0);
-                pic_set_pin(&pic, 13, 0);
-                pic_set_pin(&pic, 12, 0);
-                pic_set_pin(&pic, 11, 0);
-            }
+    if (p_KEY[2]) {
+        pic_set_pin(&pic, 18, pic_get_pin(&pic, 11));
+        pic_set_pin(&pic, 11, pic_get_pin(&pic, 18));
+    }
 
-            // keyboard
+    if (p_KEY[3]) {
+        pic_set_pin(&pic, 1, pic_get_pin(&pic, 13));
+        pic_set_pin(&pic, 13, pic_get_pin(&pic, 1));
+    }
 
-            if (p_KEY[0]) {
-                pic_set_pin(&pic, 18, pic_get_pin(&pic, 13));
-                pic_set_pin(&pic, 13, pic_get_pin(&pic, 18));
-            }
+    if (p_KEY[4]) {
+        pic_set_pin(&pic, 1, pic_get_pin(&pic, 12));
+        pic_set_pin(&pic, 12, pic_get_pin(&pic, 1));
+    }
 
-            if (p_KEY[1]) {
-                pic_set_pin(&pic, 18, pic_get_pin(&pic, 12));
-                pic_set_pin(&pic, 12, pic_get_pin(&pic, 18));
-            }
+    if (p_KEY[5]) {
+        pic_set_pin(&pic, 1, pic_get_pin(&pic, 11));
+        pic_set_pin(&pic, 11, pic_get_pin(&pic, 1));
+    }
 
-            if (p_KEY[2]) {
-                pic_set_pin(&pic, 18, pic_get_pin(&pic, 11));
-                pic_set_pin(&pic, 11, pic_get_pin(&pic, 18));
-            }
+    if (p_KEY[6]) {
+        pic_set_pin(&pic, 15, pic_get_pin(&pic, 13));
+        pic_set_pin(&pic, 13, pic_get_pin(&pic, 15));
+    }
 
-            if (p_KEY[3]) {
-                pic_set_pin(&pic, 1, pic_get_pin(&pic, 13));
-                pic_set_pin(&pic, 13, pic_get_pin(&pic, 1));
-            }
+    if (p_KEY[7]) {
+        pic_set_pin(&pic, 15, pic_get_pin(&pic, 12));
+        pic_set_pin(&pic, 12, pic_get_pin(&pic, 15));
+    }
 
-            if (p_KEY[4]) {
-                pic_set_pin(&pic, 1, pic_get_pin(&pic, 12));
-                pic_set_pin(&pic, 12, pic_get_pin(&pic, 1));
-            }
+    if (p_KEY[8]) {
+        pic_set_pin(&pic, 15, pic_get_pin(&pic, 11));
+        pic_set_pin(&pic, 11, pic_get_pin(&pic, 15));
+    }
 
-            if (p_KEY[5]) {
-                pic_set_pin(&pic, 1, pic_get_pin(&pic, 11));
-                pic_set_pin(&pic, 11, pic_get_pin(&pic, 1));
-            }
+    if (p_KEY[9]) {
+        pic_set_pin(&pic, 16, pic_get_pin(&pic, 13));
+        pic_set_pin(&pic, 13, pic_get_pin(&pic, 16));
+    }
 
-            if (p_KEY[6]) {
-                pic_set_pin(&pic, 15, pic_get_pin(&pic, 13));
-                pic_set_pin(&pic, 13, pic_get_pin(&pic, 15));
-            }
+    if (p_KEY[10]) {
+        pic_set_pin(&pic, 16, pic_get_pin(&pic, 12));
+        pic_set_pin(&pic, 12, pic_get_pin(&pic, 16));
+    }
 
-            if (p_KEY[7]) {
-                pic_set_pin(&pic, 15, pic_get_pin(&pic, 12));
-                pic_set_pin(&pic, 12, pic_get_pin(&pic, 15));
-            }
+    if (p_KEY[11]) {
+        pic_set_pin(&pic, 16, pic_get_pin(&pic, 11));
+        pic_set_pin(&pic, 11, pic_get_pin(&pic, 16));
+    }
+}
 
-            if (p_KEY[8]) {
-                pic_set_pin(&pic, 15, pic_get_pin(&pic, 11));
-                pic_set_pin(&pic, 11, pic_get_pin(&pic, 15));
-            }
+void cboard_K16F::StepPost(const int jump) {
+    const picpin* pins = pic.pins;
 
-            if (p_KEY[9]) {
-                pic_set_pin(&pic, 16, pic_get_pin(&pic, 13));
-                pic_set_pin(&pic, 13, pic_get_pin(&pic, 16));
-            }
+    if (ioupdated) {
+        // serial lcd display code
+        if ((pins[9].value) && (!clko)) {
+            d = (d << 1) | pins[8].value;
+        }
 
-            if (p_KEY[10]) {
-                pic_set_pin(&pic, 16, pic_get_pin(&pic, 12));
-                pic_set_pin(&pic, 12, pic_get_pin(&pic, 16));
-            }
+        clko = pins[9].value;
 
-            if (p_KEY[11]) {
-                pic_set_pin(&pic, 16, pic_get_pin(&pic, 11));
-                pic_set_pin(&pic, 11, pic_get_pin(&pic, 16));
+        if ((!pins[16].dir) && (!pins[16].value)) {
+            if (!lcde) {
+                if ((!pins[8].dir) && (!pins[8].value)) {
+                    lcd_cmd(&lcd, d);
+                } else if ((!pins[8].dir) && (pins[8].value)) {
+                    lcd_data(&lcd, d);
+                }
+                lcde = 1;
             }
+        } else {
+            lcde = 0;
+        }
 
-            if (!mplabxd_testbp())
-                pic_step(&pic);
-            ioupdated = pic.ioupdated;
-            InstCounterInc();
-            if (use_oscope)
-                Oscilloscope.SetSample();
-            if (use_spare)
-                SpareParts.Process();
-
-            // increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pic.PINCOUNT)
-                pi = 0;
-
-            if (j >= JUMPSTEPS) {
-                j = -1;
-            }
-            j++;
+        // i2c code
+        if (pins[2].dir) {
+            sda = 1;
+        } else {
+            sda = pins[2].value;
+        }
 
-            if (ioupdated) {
-                // serial lcd display code
-                if ((pins[9].value) && (!clko)) {
-                    d = (d << 1) | pins[8].value;
-                }
+        if (pins[1].dir) {
+            sck = 1;
+            pic_set_pin(&pic, 2, 1);
+        } else {
+            sck = pins[1].value;
+        }
+        pic_set_pin(&pic, 3, mi2c_io(&mi2c, sck, sda) & rtc_pfc8563_I2C_io(&rtc, sck, sda));
+    }
+}
 
-                clko = pins[9].value;
+void cboard_K16F::Run_CPU(void) {
+    unsigned char pi;
 
-                if ((!pins[16].dir) && (!pins[16].value)) {
-                    if (!lcde) {
-                        if ((!pins[8].dir) && (!pins[8].value)) {
-                            lcd_cmd(&lcd, d);
-                        } else if ((!pins[8].dir) && (pins[8].value)) {
-                            lcd_data(&lcd, d);
-                        }
-                        lcde = 1;
-                    }
-                } else {
-                    lcde = 0;
-                }
+    const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS();
+    const long int NSTEP = PICSimLab.GetNSTEP();
 
-                // i2c code
-                if (pins[2].dir) {
-                    sda = 1;
-                } else {
-                    sda = pins[2].value;
-                }
+    if (use_spare)
+        SpareParts.PreProcess();
 
-                if (pins[1].dir) {
-                    sck = 1;
-                    pic_set_pin(&pic, 2, 1);
-                } else {
-                    sck = pins[1].value;
-                }
-                pic_set_pin(&pic, 3, mi2c_io(&mi2c, sck, sda) & rtc_pfc8563_I2C_io(&rtc, sck, sda));
-            }
-            pic.ioupdated = 0;
-        }
+    if (PICSimLab.GetMcuPwr())
+        RunSteps(this, pic.pins, pic.PINCOUNT, NSTEP, JUMPSTEPS);
+    else
+        PinActivity.Clear();
     // fim STEP
 
     for (pi = 0; pi < pic.PINCOUNT; pi++) {
-        pic.pins[pi].oavalue = (int)((alm[pi] * RNSTEP) + 55);
+        pic.pins[pi].oavalue = (int)((PinActivity.GetDuty(pi) * 200.0) + 55);
     }
 
     if (use_spare)
@@ -63,6 +63,8 @@ public:
     ~cboard_K16F(void);
     void Draw(CDraw* draw) override;
     void Run_CPU(void) override;
+    void StepPre(const int jump);
+    void StepPost(const int jump);
     lxString GetSupportedDevices(void) override { return lxT("PIC16F628A,PIC16F648A,PIC16F84A,"); };
     int MInit(const char* processor, const char* fname, float freq) override;
     void Reset(void) override;
@@ -27,6 +27,7 @@
 #include "../lib/oscilloscope.h"
 #include "../lib/picsimlab.h"
 #include "../lib/spareparts.h"
+#include "../lib/stepkernel.h"
 
 /* outputs */
 enum {
@@ -366,23 +367,86 @@ void cboard_McLab1::Draw(CDraw* draw) {
     gauge1->SetValue((pic.pins[16].oavalue - 55) / 2);
 }
 
+void cboard_McLab1::StepPre(const int jump) {
+    const picpin* pins = pic.pins;
+    int bret;
+
+    bsim_picsim::StepPre(jump);
+    if (jump) {
+        if (!bounce.do_bounce) {
+            pic_set_pin(&pic, 18, p_BT_[0]);
+            pic_set_pin(&pic, 1, p_BT_[1]);
+            pic_set_pin(&pic, 2, p_BT_[2]);
+            pic_set_pin(&pic, 3, p_BT_[3]);
+        }
+    }
+
+    if (bounce.do_bounce) {
+        bret = SWBounce_process(&bounce);
+        if (bret) {
+            if (bounce.bounce[0]) {
+                if (bret == 1) {
+                    pic_set_pin(&pic, 18, !pins[18 - 1].value);
+                } else {
+                    pic_set_pin(&pic, 18, p_BT_[0]);
+                }
+            }
+            if (bounce.bounce[1]) {
+                if (bret == 1) {
+                    pic_set_pin(&pic, 1, !pins[1 - 1].value);
+                } else {
+                    pic_set_pin(&pic, 1, p_BT_[1]);
+                }
+            }
+            if (bounce.bounce[2]) {
+                if (bret == 1) {
+                    pic_set_pin(&pic, 2, !pins[2 - 1].value);
+                } else {
+                    pic_set_pin(&pic, 2, p_BT_[2]);
+                }
+            }
+            if (bounce.bounce[3]) {
+                if (bret == 1) {
+                    pic_set_pin(&pic, 3, !pins[3 - 1].value);
+                } else {
+                    pic_set_pin(&pic, 3, p_BT_[3]);
+                }
+            }
+        }
+    }
+}
+
+void cboard_McLab1::StepPost(const int jump) {
+    unsigned char pj;
+    unsigned char pinv;
+
+    if (jump) {
+        // pull-up extern
+        /*
+        if ((pins[17].dir)&&(p_BT[0]))alm[17]++;
+        if ((pins[0].dir)&&(p_BT[1]))alm[0]++;
+        if ((pins[1].dir)&&(p_BT[2]))alm[1]++;
+         */
+        if (jmp[0]) {
+            for (pj = 5; pj < 13; pj++) {
+                pinv = pic_get_pin(&pic, pj + 1);
+                if ((pinv) && (!pic.pins[9].value))
+                    alm1[pj]++;
+                if ((pinv) && (pic.pins[9].value))
+                    alm2[pj]++;
+            }
+        }
+    }
+}
+
 void cboard_McLab1::Run_CPU(void) {
     int i;
-    int j;
-    unsigned char pi, pj;
-    unsigned char pinv;
     const picpin* pins;
-    unsigned int alm[18];   // luminosidade media
-    unsigned int alm1[18];  // luminosidade media display
-    unsigned int alm2[18];  // luminosidade media display
-    int bret;
 
     const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS();
     const long int NSTEPJ = PICSimLab.GetNSTEPJ();
     const long int NSTEP = PICSimLab.GetNSTEP();
-    const float RNSTEP = 200.0 * pic.PINCOUNT / NSTEP;
 
-    memset(alm, 0, 18 * sizeof(unsigned int));
     memset(alm1, 0, 18 * sizeof(unsigned int));
     memset(alm2, 0, 18 * sizeof(unsigned int));
 
@@ -391,7 +455,6 @@ void cboard_McLab1::Run_CPU(void) {
     if (use_spare)
         SpareParts.PreProcess();
 
-    unsigned char p_BT_[4];
     memcpy(p_BT_, p_BT, 4);
 
     SWBounce_prepare(&bounce, MGetInstClockFreq());
@@ -409,93 +472,13 @@ void cboard_McLab1::Run_CPU(void) {
         SWBounce_bounce(&bounce, 3);
     }
 
-    j = JUMPSTEPS;
-    pi = 0;
     if (PICSimLab.GetMcuPwr())
-        for (i = 0; i < NSTEP; i++) {
-            if (j >= JUMPSTEPS) {
-                pic_set_pin(&pic, pic.mclr, p_RST);
-                if (!bounce.do_bounce) {
-                    pic_set_pin(&pic, 18, p_BT_[0]);
-                    pic_set_pin(&pic, 1, p_BT_[1]);
-                    pic_set_pin(&pic, 2, p_BT_[2]);
-                    pic_set_pin(&pic, 3, p_BT_[3]);
-                }
-            }
-
-            if (bounce.do_bounce) {
-                bret = SWBounce_process(&bounce);
-                if (bret) {
-                    if (bounce.bounce[0]) {
-                        if (bret == 1) {
-                            pic_set_pin(&pic, 18, !pins[18 - 1].value);
-                        } else {
-                            pic_set_pin(&pic, 18, p_BT_[0]);
-                        }
-                    }
-                    if (bounce.bounce[1]) {
-                        if (bret == 1) {
-                            pic_set_pin(&pic, 1, !pins[1 - 1].value);
-                        } else {
-                            pic_set_pin(&pic, 1, p_BT_[1]);
-                        }
-                    }
-                    if (bounce.bounce[2]) {
-                        if (bret == 1) {
-                            pic_set_pin(&pic, 2, !pins[2 - 1].value);
-                        } else {
-                            pic_set_pin(&pic, 2, p_BT_[2]);
-                        }
-                    }
-                    if (bounce.bounce[3]) {
-                        if (bret == 1) {
-                            pic_set_pin(&pic, 3, !pins[3 - 1].value);
-                        } else {
-                            pic_set_pin(&pic, 3, p_BT_[3]);
-                        }
-                    }
-                }
-            }
-
-            if (!mplabxd_testbp())
-                pic_step(&pic);
-            ioupdated = pic.ioupdated;
-            InstCounterInc();
-            if (use_oscope)
-                Oscilloscope.SetSample();
-            if (use_spare)
-                SpareParts.Process();
-
-            // increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pic.PINCOUNT)
-                pi = 0;
-
-            if (j >= JUMPSTEPS) {
-                // pull-up extern
-                /*
-                if ((pins[17].dir)&&(p_BT[0]))alm[17]++;
-                if ((pins[0].dir)&&(p_BT[1]))alm[0]++;
-                if ((pins[1].dir)&&(p_BT[2]))alm[1]++;
-                 */
-                if (jmp[0]) {
-                    for (pj = 5; pj < 13; pj++) {
-                        pinv = pic_get_pin(&pic, pj + 1);
-                        if ((pinv) && (!pins[9].value))
-                            alm1[pj]++;
-                        if ((pinv) && (pins[9].value))
-                            alm2[pj]++;
-                    }
-                }
-                j = -1;
-            }
-            j++;
-            pic.ioupdated = 0;
-        }
+        RunSteps(this, pins, pic.PINCOUNT, NSTEP, JUMPSTEPS);
+    else
+        PinActivity.Clear();
 
     for (i = 0; i < pic.PINCOUNT; i++) {
-        pic.pins[i].oavalue = (int)((alm[i] * RNSTEP) + 55);
+        pic.pins[i].oavalue = (int)((PinActivity.GetDuty(i) * 200.0) + 55);
         lm1[i] = (int)(((600.0 * alm1[i]) / NSTEPJ) + 30);
         lm2[i] = (int)(((600.0 * alm2[i]) / NSTEPJ) + 30);
         if (lm1[i] > 255)
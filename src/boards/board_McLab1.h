@@ -35,9 +35,12 @@
 class cboard_McLab1 : public bsim_picsim {
 private:
     unsigned char p_BT[4];
+    unsigned char p_BT_[4];  // p_BT state during Run_CPU
     unsigned char jmp[1];
-    unsigned int lm1[18];  // luminosidade media display
-    unsigned int lm2[18];  // luminosidade media display
+    unsigned int lm1[18];   // luminosidade media display
+    unsigned int lm2[18];   // luminosidade media display
+    unsigned int alm1[18];  // luminosidade media display
+    unsigned int alm2[18];  // luminosidade media display
 
     CGauge* gauge1;
     CLabel* label1;
@@ -55,6 +58,9 @@ public:
     ~cboard_McLab1(void);
     void Draw(CDraw* draw) override;
     void Run_CPU(void) override;
+    void StepPre(const int jump);
+    void StepPost(const int jump);
+    int StepQuiet(void) { return !bounce.do_bounce; };
     lxString GetSupportedDevices(void) override { return lxT("PIC16F628A,PIC16F648A,PIC16F84A,"); };
     void Reset(void) override;
     void EvMouseButtonPress(uint button, uint x, uint y, uint state) override;
@@ -27,6 +27,7 @@
 #include "../lib/oscilloscope.h"
 #include "../lib/picsimlab.h"
 #include "../lib/spareparts.h"
+#include "../lib/stepkernel.h"
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
@@ -672,26 +673,150 @@ void cboard_McLab2::OnTime(void) {
     pic_set_apin(&pic, 2, (10.0 / 255.0) * (temp[0] + 15.0));
 }
 
+void cboard_McLab2::StepPre(const int jump) {
+    const picpin* pins = pic.pins;
+    int bret;
+
+    bsim_picsim::StepPre(jump);
+    if (jump) {
+        if (!bounce.do_bounce) {
+            pic_set_pin(&pic, 33, p_BT_[0]);
+            pic_set_pin(&pic, 34, p_BT_[1]);
+            pic_set_pin(&pic, 35, p_BT_[2]);
+            pic_set_pin(&pic, 36, p_BT_[3]);
+        }
+
+        rpmc++;
+        if (rpmc > rpmstp) {
+            rpmc = 0;
+            pic_set_pin(&pic, 15, !pic_get_pin(&pic, 15));
+        }
+    }
+
+    if (bounce.do_bounce) {
+        bret = SWBounce_process(&bounce);
+        if (bret) {
+            for (int pl = 0; pl < 4; pl++) {
+                if (bounce.bounce[pl]) {
+                    if (bret == 1) {
+                        pic_set_pin(&pic, 33 + pl, !pins[33 + pl - 1].value);
+                    } else {
+                        pic_set_pin(&pic, 33 + pl, p_BT_[pl]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void cboard_McLab2::StepHardware(void) {
+    if (ioupdated) {
+        if (!bounce.do_bounce) {
+            pic_set_pin(&pic, 33, p_BT_[0]);
+            pic_set_pin(&pic, 34, p_BT_[1]);
+            pic_set_pin(&pic, 35, p_BT_[2]);
+            pic_set_pin(&pic, 36, p_BT_[3]);
+        }
+    }
+}
+
+void cboard_McLab2::StepPost(const int jump) {
+    const picpin* pins = pic.pins;
+    unsigned char pj;
+    unsigned char pinv;
+
+    if (jump) {
+        for (pj = 18; pj < 30; pj++) {
+            pinv = pins[pj].value;
+            if ((pinv) && (pins[39].value))
+                alm1[pj]++;
+            if ((pinv) && (pins[38].value))
+                alm2[pj]++;
+            if ((pinv) && (pins[37].value))
+                alm3[pj]++;
+            if ((pinv) && (pins[36].value))
+                alm4[pj]++;
+        }
+    }
+
+    // potênciometro p2
+    // p2 rc circuit
+
+    if (!pins[2].dir) {
+        // decarga por RA1
+        vp2[1] = vp2[0] = 5 * pins[2].value;
+    }
+
+    vp2[1] = vp2[0];
+
+    vp2[0] = vp2in * 0.00021 + vp2[1] * 0.99979;
+
+    if (pins[2].ptype < 3)
+        pic_set_pin(&pic, 3, vp2[0] > 1.25);
+    else
+        pic_set_apin(&pic, 3, vp2[0]);
+
+    if (ioupdated) {
+        // lcd dipins[2].dirsplay code
+        if ((!pins[8].dir) && (!pins[8].value)) {
+            if (!lcde) {
+                d = 0;
+                if (pins[29].value)
+                    d |= 0x80;
+                if (pins[28].value)
+                    d |= 0x40;
+                if (pins[27].value)
+                    d |= 0x20;
+                if (pins[26].value)
+                    d |= 0x10;
+                if (pins[21].value)
+                    d |= 0x08;
+                if (pins[20].value)
+                    d |= 0x04;
+                if (pins[19].value)
+                    d |= 0x02;
+                if (pins[18].value)
+                    d |= 0x01;
+
+                if ((!pins[7].dir) && (!pins[7].value)) {
+                    lcd_cmd(&lcd, d);
+                } else if ((!pins[7].dir) && (pins[7].value)) {
+                    lcd_data(&lcd, d);
+                }
+                lcde = 1;
+            }
+
+        } else {
+            lcde = 0;
+        }
+
+        // i2c code
+        if (pins[22].dir) {
+            sda = 1;
+        } else {
+            sda = pins[22].value;
+        }
+
+        if (pins[17].dir) {
+            sck = 1;
+            pic_set_pin(&pic, 18, 1);
+        } else {
+            sck = pins[17].value;
+        }
+        pic_set_pin(&pic, 23, mi2c_io(&mi2c, sck, sda));
+    }
+}
+
 void cboard_McLab2::Run_CPU(void) {
     int i;
     int j;
-    unsigned char pi, pj;
-    unsigned char pinv;
+    unsigned char pi;
     const picpin* pins;
-    int bret;
-
-    unsigned int alm[40];   // luminosidade media
-    unsigned int alm1[40];  // luminosidade media display
-    unsigned int alm2[40];  // luminosidade media display
-    unsigned int alm3[40];  // luminosidade media display
-    unsigned int alm4[40];  // luminosidade media display
 
     const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS();
     const long int NSTEPJ = PICSimLab.GetNSTEPJ();
     const long int NSTEP = PICSimLab.GetNSTEP();
-    const float RNSTEP = 200.0 * pic.PINCOUNT / NSTEP;
 
-    memset(alm, 0, 40 * sizeof(unsigned int));
     memset(alm1, 0, 40 * sizeof(unsigned int));
     memset(alm2, 0, 40 * sizeof(unsigned int));
     memset(alm3, 0, 40 * sizeof(unsigned int));
@@ -702,7 +827,6 @@ void cboard_McLab2::Run_CPU(void) {
     if (use_spare)
         SpareParts.PreProcess();
 
-    unsigned char p_BT_[4];
     memcpy(p_BT_, p_BT, 4);
 
     SWBounce_prepare(&bounce, PICSimLab.GetBoard()->MGetInstClockFreq());
@@ -712,159 +836,17 @@ void cboard_McLab2::Run_CPU(void) {
         }
     }
 
-    j = JUMPSTEPS;
-    pi = 0;
     if (PICSimLab.GetMcuPwr())
-        for (i = 0; i < NSTEP; i++) {
-            if (j >= JUMPSTEPS) {
-                pic_set_pin(&pic, pic.mclr, p_RST);
-
-                if (!bounce.do_bounce) {
-                    pic_set_pin(&pic, 33, p_BT_[0]);
-                    pic_set_pin(&pic, 34, p_BT_[1]);
-                    pic_set_pin(&pic, 35, p_BT_[2]);
-                    pic_set_pin(&pic, 36, p_BT_[3]);
-                }
-
-                rpmc++;
-                if (rpmc > rpmstp) {
-                    rpmc = 0;
-                    pic_set_pin(&pic, 15, !pic_get_pin(&pic, 15));
-                }
-            }
-
-            if (bounce.do_bounce) {
-                bret = SWBounce_process(&bounce);
-                if (bret) {
-                    for (int pl = 0; pl < 4; pl++) {
-                        if (bounce.bounce[pl]) {
-                            if (bret == 1) {
-                                pic_set_pin(&pic, 33 + pl, !pins[33 + pl - 1].value);
-                            } else {
-                                pic_set_pin(&pic, 33 + pl, p_BT_[pl]);
-                            }
-                        }
-                    }
-                }
-            }
-
-            if (!mplabxd_testbp())
-                pic_step(&pic);
-            ioupdated = pic.ioupdated;
-            InstCounterInc();
-
-            if (ioupdated) {
-                if (!bounce.do_bounce) {
-                    pic_set_pin(&pic, 33, p_BT_[0]);
-                    pic_set_pin(&pic, 34, p_BT_[1]);
-                    pic_set_pin(&pic, 35, p_BT_[2]);
-                    pic_set_pin(&pic, 36, p_BT_[3]);
-                }
-            }
-
-            if (use_oscope)
-                Oscilloscope.SetSample();
-            if (use_spare)
-                SpareParts.Process();
-
-            // increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pic.PINCOUNT)
-                pi = 0;
-
-            if (j >= JUMPSTEPS) {
-                for (pj = 18; pj < 30; pj++) {
-                    pinv = pins[pj].value;
-                    if ((pinv) && (pins[39].value))
-                        alm1[pj]++;
-                    if ((pinv) && (pins[38].value))
-                        alm2[pj]++;
-                    if ((pinv) && (pins[37].value))
-                        alm3[pj]++;
-                    if ((pinv) && (pins[36].value))
-                        alm4[pj]++;
-                }
-
-                j = -1;
-            }
-            j++;
-
-            // potênciometro p2
-            // p2 rc circuit
-
-            if (!pins[2].dir) {
-                // decarga por RA1
-                vp2[1] = vp2[0] = 5 * pins[2].value;
-            }
-
-            vp2[1] = vp2[0];
-
-            vp2[0] = vp2in * 0.00021 + vp2[1] * 0.99979;
-
-            if (pins[2].ptype < 3)
-                pic_set_pin(&pic, 3, vp2[0] > 1.25);
-            else
-                pic_set_apin(&pic, 3, vp2[0]);
-
-            if (ioupdated) {
-                // lcd dipins[2].dirsplay code
-                if ((!pins[8].dir) && (!pins[8].value)) {
-                    if (!lcde) {
-                        d = 0;
-                        if (pins[29].value)
-                            d |= 0x80;
-                        if (pins[28].value)
-                            d |= 0x40;
-                        if (pins[27].value)
-                            d |= 0x20;
-                        if (pins[26].value)
-                            d |= 0x10;
-                        if (pins[21].value)
-                            d |= 0x08;
-                        if (pins[20].value)
-                            d |= 0x04;
-                        if (pins[19].value)
-                            d |= 0x02;
-                        if (pins[18].value)
-                            d |= 0x01;
-
-                        if ((!pins[7].dir) && (!pins[7].value)) {
-                            lcd_cmd(&lcd, d);
-                        } else if ((!pins[7].dir) && (pins[7].value)) {
-                            lcd_data(&lcd, d);
-                        }
-                        lcde = 1;
-                    }
-
-                } else {
-                    lcde = 0;
-                }
-
-                // i2c code
-                if (pins[22].dir) {
-                    sda = 1;
-                } else {
-                    sda = pins[22].value;
-                }
-
-                if (pins[17].dir) {
-                    sck = 1;
-                    pic_set_pin(&pic, 18, 1);
-                } else {
-                    sck = pins[17].value;
-                }
-                pic_set_pin(&pic, 23, mi2c_io(&mi2c, sck, sda));
-            }
-            pic.ioupdated = 0;
-        }
+        RunSteps(this, pins, pic.PINCOUNT, NSTEP, JUMPSTEPS);
+    else
+        PinActivity.Clear();
     // fim STEP
 
     for (pi = 0; pi < pic.PINCOUNT; pi++) {
         if (pic.pins[pi].port == P_VDD)
             pic.pins[pi].oavalue = 255;
         else
-            pic.pins[pi].oavalue = (int)((alm[pi] * RNSTEP) + 55);
+            pic.pins[pi].oavalue = (int)((PinActivity.GetDuty(pi) * 200.0) + 55);
 
         lm1[pi] = (int)(((600.0 * alm1[pi]) / NSTEPJ) + 30);
         lm2[pi] = (int)(((600.0 * alm2[pi]) / NSTEPJ) + 30);
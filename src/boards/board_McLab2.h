@@ -37,6 +37,7 @@
 class cboard_McLab2 : public bsim_picsim {
 private:
     unsigned char p_BT[4];
+    unsigned char p_BT_[4];  // p_BT state during Run_CPU
 
     unsigned char pot1;
     unsigned char active;
@@ -64,10 +65,14 @@ private:
     unsigned char sda, sck;
 
     unsigned char jmp[8];
-    unsigned int lm1[40];  // luminosidade media display
-    unsigned int lm2[40];  // luminosidade media display
-    unsigned int lm3[40];  // luminosidade media display
-    unsigned int lm4[40];  // luminosidade media display
+    unsigned int lm1[40];   // luminosidade media display
+    unsigned int lm2[40];   // luminosidade media display
+    unsigned int lm3[40];   // luminosidade media display
+    unsigned int lm4[40];   // luminosidade media display
+    unsigned int alm1[40];  // luminosidade media display
+    unsigned int alm2[40];  // luminosidade media display
+    unsigned int alm3[40];  // luminosidade media display
+    unsigned int alm4[40];  // luminosidade media display
 
     CGauge* gauge1;
     CGauge* gauge2;
@@ -98,6 +103,11 @@ public:
     ~cboard_McLab2(void);
     void Draw(CDraw* draw) override;
     void Run_CPU(void) override;
+    void StepPre(const int jump);
+    void StepHardware(void);
+    void StepPost(const int jump);
+    // p2 rc circuit changes RA1 every step
+    int StepQuiet(void) { return 0; };
     lxString GetSupportedDevices(void) override {
         return lxT(
             "PIC16F1789,PIC16F1939,PIC16F777,PIC16F877A,PIC16F887,PIC18F452,PIC18F4520,PIC18F4550,PIC18F45K50,"
@@ -27,6 +27,7 @@
 #include "../lib/oscilloscope.h"
 #include "../lib/picsimlab.h"
 #include "../lib/spareparts.h"
+#include "../lib/stepkernel.h"
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
@@ -949,29 +950,225 @@ void cboard_PICGenios::OnTime(void) {
         pic_set_apin(&pic, 4, temp[0] / 100.0);
 }
 
+void cboard_PICGenios::StepPre(const int jump) {
+    const picpin* pins = pic.pins;
+    int bret;
+
+    bsim_picsim::StepPre(jump);
+    if (jump) {
+        if (!bounce.do_bounce) {
+            pic_set_pin(&pic, 33, p_BT_[0]);
+            pic_set_pin(&pic, 34, p_BT_[1]);
+            pic_set_pin(&pic, 35, p_BT_[2]);
+            pic_set_pin(&pic, 36, p_BT_[3]);
+            pic_set_pin(&pic, 37, p_BT_[4]);
+            pic_set_pin(&pic, 38, p_BT_[5]);
+            pic_set_pin(&pic, 7, p_BT_[6]);
+        }
+
+        /*
+            pic_set_pin(&pic, 39, 1);
+            pic_set_pin(&pic, 40, 1);
+            pic_set_pin(&pic, 19,1);
+            pic_set_pin(&pic, 20,1);
+            pic_set_pin(&pic, 21,1);
+            pic_set_pin(&pic, 22,1);
+            pic_set_pin(&pic, 27,1);
+            pic_set_pin(&pic, 28,1);
+            pic_set_pin(&pic, 29,1);
+            pic_set_pin(&pic, 30,1);
+             */
+
+        // keyboard
+
+        if (p_KEY[0]) {
+            pic_set_pin(&pic, 22, pic_get_pin(&pic, 33));
+            pic_set_pin(&pic, 33, pic_get_pin(&pic, 22));
+        }
+
+        if (p_KEY[1]) {
+            pic_set_pin(&pic, 22, pic_get_pin(&pic, 34));
+            pic_set_pin(&pic, 34, pic_get_pin(&pic, 22));
+        }
+
+        if (p_KEY[2]) {
+            pic_set_pin(&pic, 22, pic_get_pin(&pic, 35));
+            pic_set_pin(&pic, 35, pic_get_pin(&pic, 22));
+        }
+
+        if (p_KEY[3]) {
+            pic_set_pin(&pic, 21, pic_get_pin(&pic, 33));
+            pic_set_pin(&pic, 33, pic_get_pin(&pic, 21));
+        }
+
+        if (p_KEY[4]) {
+            pic_set_pin(&pic, 21, pic_get_pin(&pic, 34));
+            pic_set_pin(&pic, 34, pic_get_pin(&pic, 21));
+        }
+
+        if (p_KEY[5]) {
+            pic_set_pin(&pic, 21, pic_get_pin(&pic, 35));
+            pic_set_pin(&pic, 35, pic_get_pin(&pic, 21));
+        }
+
+        if (p_KEY[6]) {
+            pic_set_pin(&pic, 20, pic_get_pin(&pic, 33));
+            pic_set_pin(&pic, 33, pic_get_pin(&pic, 20));
+        }
+
+        if (p_KEY[7]) {
+            pic_set_pin(&pic, 20, pic_get_pin(&pic, 34));
+            pic_set_pin(&pic, 34, pic_get_pin(&pic, 20));
+        }
+
+        if (p_KEY[8]) {
+            pic_set_pin(&pic, 20, pic_get_pin(&pic, 35));
+            pic_set_pin(&pic, 35, pic_get_pin(&pic, 20));
+        }
+
+        if (p_KEY[9]) {
+            pic_set_pin(&pic, 19, pic_get_pin(&pic, 33));
+            pic_set_pin(&pic, 33, pic_get_pin(&pic, 19));
+        }
+
+        if (p_KEY[10]) {
+            pic_set_pin(&pic, 19, pic_get_pin(&pic, 34));
+            pic_set_pin(&pic, 34, pic_get_pin(&pic, 19));
+        }
+
+        if (p_KEY[11]) {
+            pic_set_pin(&pic, 19, pic_get_pin(&pic, 35));
+            pic_set_pin(&pic, 35, pic_get_pin(&pic, 19));
+        }
+
+        if (dip[14]) {
+            if (cooler_pwr > 55) {
+                rpmc++;
+                if (rpmc > rpmstp) {
+                    rpmc = 0;
+                    pic_set_pin(&pic, 15, !pins[14].value);
+                }
+            } else
+                pic_set_pin(&pic, 15, 0);
+        }
+    }
+
+    if (bounce.do_bounce) {
+        bret = SWBounce_process(&bounce);
+        if (bret) {
+            for (int pl = 0; pl < 6; pl++) {
+                if (bounce.bounce[pl]) {
+                    if (bret == 1) {
+                        pic_set_pin(&pic, 33 + pl, !pins[33 + pl - 1].value);
+                    } else {
+                        pic_set_pin(&pic, 33 + pl, p_BT_[pl]);
+                    }
+                }
+            }
+            if (bounce.bounce[6]) {
+                if (bret == 1) {
+                    pic_set_pin(&pic, 7, !pins[7 - 1].value);
+                } else {
+                    pic_set_pin(&pic, 7, p_BT_[6]);
+                }
+            }
+        }
+    }
+}
+
+void cboard_PICGenios::StepPost(const int jump) {
+    const picpin* pins = pic.pins;
+    unsigned char pj;
+    unsigned char pinv;
+
+    if (jump) {
+        for (pj = 18; pj < 30; pj++) {
+            pinv = pins[pj].value;
+            if ((pinv) && (pins[3].value) && (dip[10]))
+                alm1[pj]++;
+            if ((pinv) && (pins[4].value) && (dip[11]))
+                alm2[pj]++;
+            if ((pinv) && (pins[5].value) && (dip[12]))
+                alm3[pj]++;
+            if ((pinv) && (pins[6].value) && (dip[13]))
+                alm4[pj]++;
+        }
+
+        // potenciometro p1 e p2
+        if (dip[18])
+            pic_set_apin(&pic, 2, vp1in);
+        if (dip[19])
+            pic_set_apin(&pic, 3, vp2in);
+    }
+
+    if (ioupdated) {
+        // lcd dipins[2].display code
+
+        if ((!pins[8].dir) && (!pins[8].value)) {
+            if (!lcde) {
+                d = 0;
+                if (pins[29].value)
+                    d |= 0x80;
+                if (pins[28].value)
+                    d |= 0x40;
+                if (pins[27].value)
+                    d |= 0x20;
+                if (pins[26].value)
+                    d |= 0x10;
+                if (pins[21].value)
+                    d |= 0x08;
+                if (pins[20].value)
+                    d |= 0x04;
+                if (pins[19].value)
+                    d |= 0x02;
+                if (pins[18].value)
+                    d |= 0x01;
+
+                if ((!pins[9].dir) && (!pins[9].value)) {
+                    lcd_cmd(&lcd, d);
+                } else if ((!pins[9].dir) && (pins[9].value)) {
+                    lcd_data(&lcd, d);
+                }
+                lcde = 1;
+            }
+        } else {
+            lcde = 0;
+        }
+        // end display code
+
+        // i2c code
+        if (pins[22].dir) {
+            sda = 1;
+        } else {
+            sda = pins[22].value;
+        }
+
+        if (pins[17].dir) {
+            sck = 1;
+            if (dip[5]) {
+                pic_set_pin(&pic, 18, 1);
+            }
+        } else {
+            sck = pins[17].value;
+        }
+        if (dip[6]) {
+            pic_set_pin(&pic, 23, mi2c_io(&mi2c, sck, sda) & rtc_ds1307_I2C_io(&rtc2, sck, sda));
+        }
+    }
+}
+
 void cboard_PICGenios::Run_CPU(void) {
     int i;
     int j;
-    unsigned char pi, pj;
-    unsigned char pinv;
     const picpin* pins;
-    int bret;
-
-    unsigned int alm[40];   // luminosidade media
-    unsigned int alm1[40];  // luminosidade media display
-    unsigned int alm2[40];  // luminosidade media display
-    unsigned int alm3[40];  // luminosidade media display
-    unsigned int alm4[40];  // luminosidade media display
 
     const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS();
     const long int NSTEPJ = PICSimLab.GetNSTEPJ();
     const long int NSTEP = PICSimLab.GetNSTEP();
-    const float RNSTEP = 200.0 * pic.PINCOUNT / NSTEP;
 
     if (use_spare)
         SpareParts.PreProcess();
 
-    memset(alm, 0, 40 * sizeof(unsigned int));
     memset(alm1, 0, 40 * sizeof(unsigned int));
     memset(alm2, 0, 40 * sizeof(unsigned int));
     memset(alm3, 0, 40 * sizeof(unsigned int));
@@ -979,7 +1176,6 @@ void cboard_PICGenios::Run_CPU(void) {
 
     pins = pic.pins;
 
-    unsigned char p_BT_[7];
     memcpy(p_BT_, p_BT, 7);
 
     SWBounce_prepare(&bounce, PICSimLab.GetBoard()->MGetInstClockFreq());
@@ -1011,229 +1207,10 @@ void cboard_PICGenios::Run_CPU(void) {
         SWBounce_bounce(&bounce, 6);
     }
 
-    j = JUMPSTEPS;
-    pi = 0;
     if (PICSimLab.GetMcuPwr())
-        for (i = 0; i < NSTEP; i++) {
-            if (j >= JUMPSTEPS) {
-                pic_set_pin(&pic, pic.mclr, p_RST);
-
-                if (!bounce.do_bounce) {
-                    pic_set_pin(&pic, 33, p_BT_[0]);
-                    pic_set_pin(&pic, 34, p_BT_[1]);
-                    pic_set_pin(&pic, 35, p_BT_[2]);
-                    pic_set_pin(&pic, 36, p_BT_[3]);
-                    pic_set_pin(&pic, 37, p_BT_[4]);
-                    pic_set_pin(&pic, 38, p_BT_[5]);
-                    pic_set_pin(&pic, 7, p_BT_[6]);
-                }
-
-                /*
-                    pic_set_pin(&pic, 39, 1);
-                    pic_set_pin(&pic, 40, 1);
-                    pic_set_pin(&pic, 19,1);
-                    pic_set_pin(&pic, 20,1);
-                    pic_set_pin(&pic, 21,1);
-                    pic_set_pin(&pic, 22,1);
-                    pic_set_pin(&pic, 27,1);
-                    pic_set_pin(&pic, 28,1);
-                    pic_set_pin(&pic, 29,1);
-                    pic_set_pin(&pic, 30,1);
-                     */
-
-                // keyboard
-
-                if (p_KEY[0]) {
-                    pic_set_pin(&pic, 22, pic_get_pin(&pic, 33));
-                    pic_set_pin(&pic, 33, pic_get_pin(&pic, 22));
-                }
-
-                if (p_KEY[1]) {
-                    pic_set_pin(&pic, 22, pic_get_pin(&pic, 34));
-                    pic_set_pin(&pic, 34, pic_get_pin(&pic, 22));
-                }
-
-                if (p_KEY[2]) {
-                    pic_set_pin(&pic, 22, pic_get_pin(&pic, 35));
-                    pic_set_pin(&pic, 35, pic_get_pin(&pic, 22));
-                }
-
-                if (p_KEY[3]) {
-                    pic_set_pin(&pic, 21, pic_get_pin(&pic, 33));
-                    pic_set_pin(&pic, 33, pic_get_pin(&pic, 21));
-                }
-
-                if (p_KEY[4]) {
-                    pic_set_pin(&pic, 21, pic_get_pin(&pic, 34));
-                    pic_set_pin(&pic, 34, pic_get_pin(&pic, 21));
-                }
-
-                if (p_KEY[5]) {
-                    pic_set_pin(&pic, 21, pic_get_pin(&pic, 35));
-                    pic_set_pin(&pic, 35, pic_get_pin(&pic, 21));
-                }
-
-                if (p_KEY[6]) {
-                    pic_set_pin(&pic, 20, pic_get_pin(&pic, 33));
-                    pic_set_pin(&pic, 33, pic_get_pin(&pic, 20));
-                }
-
-                if (p_KEY[7]) {
-                    pic_set_pin(&pic, 20, pic_get_pin(&pic, 34));
-                    pic_set_pin(&pic, 34, pic_get_pin(&pic, 20));
-                }
-
-                if (p_KEY[8]) {
-                    pic_set_pin(&pic, 20, pic_get_pin(&pic, 35));
-                    pic_set_pin(&pic, 35, pic_get_pin(&pic, 20));
-                }
-
-                if (p_KEY[9]) {
-                    pic_set_pin(&pic, 19, pic_get_pin(&pic, 33));
-                    pic_set_pin(&pic, 33, pic_get_pin(&pic, 19));
-                }
-
-                if (p_KEY[10]) {
-                    pic_set_pin(&pic, 19, pic_get_pin(&pic, 34));
-                    pic_set_pin(&pic, 34, pic_get_pin(&pic, 19));
-                }
-
-                if (p_KEY[11]) {
-                    pic_set_pin(&pic, 19, pic_get_pin(&pic, 35));
-                    pic_set_pin(&pic, 35, pic_get_pin(&pic, 19));
-                }
-
-                if (dip[14]) {
-                    if (cooler_pwr > 55) {
-                        rpmc++;
-                        if (rpmc > rpmstp) {
-                            rpmc = 0;
-                            pic_set_pin(&pic, 15, !pins[14].value);
-                        }
-                    } else
-                        pic_set_pin(&pic, 15, 0);
-                }
-            }
-
-            if (bounce.do_bounce) {
-                bret = SWBounce_process(&bounce);
-                if (bret) {
-                    for (int pl = 0; pl < 6; pl++) {
-                        if (bounce.bounce[pl]) {
-                            if (bret == 1) {
-                                pic_set_pin(&pic, 33 + pl, !pins[33 + pl - 1].value);
-                            } else {
-                                pic_set_pin(&pic, 33 + pl, p_BT_[pl]);
-                            }
-                        }
-                    }
-                    if (bounce.bounce[6]) {
-                        if (bret == 1) {
-                            pic_set_pin(&pic, 7, !pins[7 - 1].value);
-                        } else {
-                            pic_set_pin(&pic, 7, p_BT_[6]);
-                        }
-                    }
-                }
-            }
-
-            if (!mplabxd_testbp())
-                pic_step(&pic);
-            ioupdated = pic.ioupdated;
-            InstCounterInc();
-            if (use_oscope)
-                Oscilloscope.SetSample();
-            if (use_spare)
-                SpareParts.Process();
-
-            // increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pic.PINCOUNT)
-                pi = 0;
-
-            if (j >= JUMPSTEPS) {
-                for (pj = 18; pj < 30; pj++) {
-                    pinv = pins[pj].value;
-                    if ((pinv) && (pins[3].value) && (dip[10]))
-                        alm1[pj]++;
-                    if ((pinv) && (pins[4].value) && (dip[11]))
-                        alm2[pj]++;
-                    if ((pinv) && (pins[5].value) && (dip[12]))
-                        alm3[pj]++;
-                    if ((pinv) && (pins[6].value) && (dip[13]))
-                        alm4[pj]++;
-                }
-
-                if (dip[7])
-                    alm[32] = 0;
-
-                // potenciometro p1 e p2
-                if (dip[18])
-                    pic_set_apin(&pic, 2, vp1in);
-                if (dip[19])
-                    pic_set_apin(&pic, 3, vp2in);
-
-                j = -1;
-            }
-            j++;
-
-            if (ioupdated) {
-                // lcd dipins[2].display code
-
-                if ((!pins[8].dir) && (!pins[8].value)) {
-                    if (!lcde) {
-                        d = 0;
-                        if (pins[29].value)
-                            d |= 0x80;
-                        if (pins[28].value)
-                            d |= 0x40;
-                        if (pins[27].value)
-                            d |= 0x20;
-                        if (pins[26].value)
-                            d |= 0x10;
-                        if (pins[21].value)
-                            d |= 0x08;
-                        if (pins[20].value)
-                            d |= 0x04;
-                        if (pins[19].value)
-                            d |= 0x02;
-                        if (pins[18].value)
-                            d |= 0x01;
-
-                        if ((!pins[9].dir) && (!pins[9].value)) {
-                            lcd_cmd(&lcd, d);
-                        } else if ((!pins[9].dir) && (pins[9].value)) {
-                            lcd_data(&lcd, d);
-                        }
-                        lcde = 1;
-                    }
-                } else {
-                    lcde = 0;
-                }
-                // end display code
-
-                // i2c code
-                if (pins[22].dir) {
-                    sda = 1;
-                } else {
-                    sda = pins[22].value;
-                }
-
-                if (pins[17].dir) {
-                    sck = 1;
-                    if (dip[5]) {
-                        pic_set_pin(&pic, 18, 1);
-                    }
-                } else {
-                    sck = pins[17].value;
-                }
-                if (dip[6]) {
-                    pic_set_pin(&pic, 23, mi2c_io(&mi2c, sck, sda) & rtc_ds1307_I2C_io(&rtc2, sck, sda));
-                }
-            }
-            pic.ioupdated = 0;
-        }
+        RunSteps(this, pins, pic.PINCOUNT, NSTEP, JUMPSTEPS);
+    else
+        PinActivity.Clear();
 
     // fim STEP
 
@@ -1241,7 +1218,7 @@ void cboard_PICGenios::Run_CPU(void) {
         if (pic.pins[i].port == P_VDD)
             pic.pins[i].oavalue = 255;
         else
-            pic.pins[i].oavalue = (int)((alm[i] * RNSTEP) + 55);
+            pic.pins[i].oavalue = (int)((PinActivity.GetDuty(i) * 200.0) + 55);
 
         lm1[i] = (int)(((600.0 * alm1[i]) / NSTEPJ) + 30);
         lm2[i] = (int)(((600.0 * alm2[i]) / NSTEPJ) + 30);
@@ -1256,6 +1233,8 @@ void cboard_PICGenios::Run_CPU(void) {
         if (lm4[i] > 255)
             lm4[i] = 255;
     }
+    if (dip[7])
+        pic.pins[32].oavalue = 55;
 
     if (use_spare)
         SpareParts.PostProcess();
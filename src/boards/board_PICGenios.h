@@ -37,6 +37,7 @@
 class cboard_PICGenios : public bsim_picsim {
 private:
     unsigned char p_BT[7];
+    unsigned char p_BT_[7];  // p_BT state during Run_CPU
 
     unsigned char p_KEY[12];
 
@@ -75,6 +76,11 @@ private:
     unsigned int lm3[40];
     unsigned int lm4[40];
 
+    unsigned int alm1[40];  // luminosidade media display
+    unsigned int alm2[40];  // luminosidade media display
+    unsigned int alm3[40];  // luminosidade media display
+    unsigned int alm4[40];  // luminosidade media display
+
     lxBitmap* vent[2];
     lxBitmap* lcdbmp[2];
 
@@ -110,6 +116,9 @@ public:
     ~cboard_PICGenios(void);
     void Draw(CDraw* draw) override;
     void Run_CPU(void) override;
+    void StepPre(const int jump);
+    void StepPost(const int jump);
+    int StepQuiet(void) { return !bounce.do_bounce; };
     lxString GetSupportedDevices(void) override {
         return lxT(
             "PIC16F1789,PIC16F1939,PIC16F777,PIC16F877A,PIC16F887,PIC18F452,PIC18F4520,PIC18F4550,PIC18F45K50,"
@@ -26,6 +26,7 @@
 #include "../lib/oscilloscope.h"
 #include "../lib/picsimlab.h"
 #include "../lib/spareparts.h"
+#include "../lib/stepkernel.h"
 
 #include "board_PQDB.h"
 
@@ -564,199 +565,176 @@ void cboard_PQDB::Draw(CDraw* draw) {
     }
 }
 
-void cboard_PQDB::Run_CPU(void) {
-    int i;
-    int j;
-    int pi;
-    const picpin* pins;
+void cboard_PQDB::StepPre(const int jump) {
+    const picpin* pins = pic.pins;
+
+    bsim_picsim::StepPre(jump);
+    if (jump) {
+        // keyboard
+        // D3-7 do shiftReg
+        // 0-9: UDLRS sABXY
+        if (pins[KEYPAD_1_PIN].dir) {
+            if ((p_KEY[0] && (shiftReg.out & SRD3)) || (p_KEY[1] && (shiftReg.out & SRD4)) ||
+                (p_KEY[2] && (shiftReg.out & SRD5)) || (p_KEY[3] && (shiftReg.out & SRD6)) ||
+                (p_KEY[4] && (shiftReg.out & SRD7))) {
+                pic_set_pin(&pic, KEYPAD_1_PIN + 1, 1);
+            } else {
+                pic_set_pin(&pic, KEYPAD_1_PIN + 1, 0);
+            }
+        }
+        if (pins[KEYPAD_2_PIN].dir) {
+            if ((p_KEY[5] && (shiftReg.out & SRD3)) || (p_KEY[6] && (shiftReg.out & SRD4)) ||
+                (p_KEY[7] && (shiftReg.out & SRD5)) || (p_KEY[8] && (shiftReg.out & SRD6)) ||
+                (p_KEY[9] && (shiftReg.out & SRD7))) {
+                pic_set_pin(&pic, KEYPAD_2_PIN + 1, 1);
+            } else {
+                pic_set_pin(&pic, KEYPAD_2_PIN + 1, 0);
+            }
+        }
+    }
+}
+
+void cboard_PQDB::StepHardware(void) {
+    const picpin* pins = pic.pins;
+
+    if (ioupdated) {
+        // keyboard
+        // D3-7 do shiftReg
+        // 0-9: UDLRS sABXY
+        if (pins[KEYPAD_1_PIN].dir) {
+            if ((p_KEY[0] && (shiftReg.out & SRD3)) || (p_KEY[1] && (shiftReg.out & SRD4)) ||
+                (p_KEY[2] && (shiftReg.out & SRD5)) || (p_KEY[3] && (shiftReg.out & SRD6)) ||
+                (p_KEY[4] && (shiftReg.out & SRD7))) {
+                pic_set_pin(&pic, KEYPAD_1_PIN + 1, 1);
+            } else {
+                pic_set_pin(&pic, KEYPAD_1_PIN + 1, 0);
+            }
+        }
+        if (pins[KEYPAD_2_PIN].dir) {
+            if ((p_KEY[5] && (shiftReg.out & SRD3)) || (p_KEY[6] && (shiftReg.out & SRD4)) ||
+                (p_KEY[7] && (shiftReg.out & SRD5)) || (p_KEY[8] && (shiftReg.out & SRD6)) ||
+                (p_KEY[9] && (shiftReg.out & SRD7))) {
+                pic_set_pin(&pic, KEYPAD_2_PIN + 1, 1);
+            } else {
+                pic_set_pin(&pic, KEYPAD_2_PIN + 1, 0);
+            }
+        }
+    }
+}
+
+void cboard_PQDB::StepPost(const int jump) {
+    const picpin* pins = pic.pins;
+
+    if (jump) {
+        // contabilizando a média do 7 segmentos
+        for (int iDisp = DISP_1_PIN; iDisp <= DISP_4_PIN; iDisp++) {
+            if (pins[iDisp].value && !pins[iDisp].dir) {
+                for (int iSeg = 0; iSeg < 8; iSeg++) {
+                    if (shiftReg.out & (1 << iSeg)) {
+                        alm7seg[(iDisp - DISP_1_PIN) * 8 + iSeg]++;
+                    }
+                }
+            }
+        }
 
-    unsigned int alm[40];  // valor médio dos pinos de IO
+        // potenciometro
+        pic_set_apin(&pic, POT_PIN + 1, vPOT);  // pot
+        pic_set_apin(&pic, LDR_PIN + 1, vLDR);  // ldr
+        pic_set_apin(&pic, LM_PIN + 1, vLM);    // temp
+
+        // valor medio shift register
+        if (pic.pins[pic.PINCOUNT].value)
+            shiftReg_alm[0]++;
+        if (pic.pins[pic.PINCOUNT + 1].value)
+            shiftReg_alm[1]++;
+        if (pic.pins[pic.PINCOUNT + 2].value)
+            shiftReg_alm[2]++;
+        if (pic.pins[pic.PINCOUNT + 3].value)
+            shiftReg_alm[3]++;
+        if (pic.pins[pic.PINCOUNT + 4].value)
+            shiftReg_alm[4]++;
+        if (pic.pins[pic.PINCOUNT + 5].value)
+            shiftReg_alm[5]++;
+        if (pic.pins[pic.PINCOUNT + 6].value)
+            shiftReg_alm[6]++;
+        if (pic.pins[pic.PINCOUNT + 7].value)
+            shiftReg_alm[7]++;
+    }
+
+    if (ioupdated) {
+        // lcd display code
+        if ((!pins[LCD_EN_PIN].dir) && (!pins[LCD_EN_PIN].value)) {
+            if (!lcde) {
+                d = (shiftReg.out & 0x0f) << 4;
+
+                if ((!pins[LCD_RS_PIN].dir) && (!pins[LCD_RS_PIN].value)) {
+                    lcd_cmd(&lcd, d);
+                } else if ((!pins[LCD_RS_PIN].dir) && (pins[LCD_RS_PIN].value)) {
+                    lcd_data(&lcd, d);
+                }
+                lcde = 1;
+            }
+        } else {
+            lcde = 0;
+        }
+        // end display code
 
-    unsigned int alm7seg[32];  // luminosidade media display 7 seg
+        // ds1307 over i2c code
+        if (pins[SDA_PIN].dir) {
+            sda = 1;
+        } else {
+            sda = pins[SDA_PIN].value;
+        }
+        if (pins[SCL_PIN].dir) {
+            sck = 1;
+            pic_set_pin(&pic, SCL_PIN + 1, 1);
+        } else {
+            sck = pins[SCL_PIN].value;
+        }
+        pic_set_pin(&pic, SDA_PIN + 1, rtc_ds1307_I2C_io(&rtc2, sck, sda));
+
+        // 74hc595 code
+        if (pins[SO_DATA_PIN].dir == 0) {
+            srDATA = pins[SO_DATA_PIN].value;
+        }
+        if (pins[SO_CLK_PIN].dir == 0) {
+            srCLK = pins[SO_CLK_PIN].value;
+        }
+        if (pins[SO_EN_PIN].dir == 0) {
+            srLAT = pins[SO_EN_PIN].value;
+        }
+        unsigned short ret = io_74xx595_io(&shiftReg, srDATA, srCLK, srLAT, 1);
+        if (_srret != ret) {
+            pic.pins[PSRD0].value = (ret & 0x01) != 0;
+            pic.pins[PSRD1].value = (ret & 0x02) != 0;
+            pic.pins[PSRD2].value = (ret & 0x04) != 0;
+            pic.pins[PSRD3].value = (ret & 0x08) != 0;
+            pic.pins[PSRD4].value = (ret & 0x10) != 0;
+            pic.pins[PSRD5].value = (ret & 0x20) != 0;
+            pic.pins[PSRD6].value = (ret & 0x40) != 0;
+            pic.pins[PSRD7].value = (ret & 0x80) != 0;
+        }
+        _srret = ret;
+    }
+}
+
+void cboard_PQDB::Run_CPU(void) {
+    int i;
 
     const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS();
     const long int NSTEP = PICSimLab.GetNSTEP();
-    const float RNSTEP = 200.0 * pic.PINCOUNT / NSTEP;
 
     if (use_spare)
         SpareParts.PreProcess();
 
     memset(alm7seg, 0, 32 * sizeof(unsigned int));
 
-    memset(alm, 0, 40 * sizeof(unsigned int));
-
     memset(shiftReg_alm, 0, 8 * sizeof(unsigned long));
 
-    pins = pic.pins;
-
-    j = JUMPSTEPS;
-    pi = 0;
     if (PICSimLab.GetMcuPwr()) {
-        for (i = 0; i < NSTEP; i++) {
-            if (j >= JUMPSTEPS) {
-                pic_set_pin(&pic, pic.mclr, p_RST);
-
-                // keyboard
-                // D3-7 do shiftReg
-                // 0-9: UDLRS sABXY
-                if (pins[KEYPAD_1_PIN].dir) {
-                    if ((p_KEY[0] && (shiftReg.out & SRD3)) || (p_KEY[1] && (shiftReg.out & SRD4)) ||
-                        (p_KEY[2] && (shiftReg.out & SRD5)) || (p_KEY[3] && (shiftReg.out & SRD6)) ||
-                        (p_KEY[4] && (shiftReg.out & SRD7))) {
-                        pic_set_pin(&pic, KEYPAD_1_PIN + 1, 1);
-                    } else {
-                        pic_set_pin(&pic, KEYPAD_1_PIN + 1, 0);
-                    }
-                }
-                if (pins[KEYPAD_2_PIN].dir) {
-                    if ((p_KEY[5] && (shiftReg.out & SRD3)) || (p_KEY[6] && (shiftReg.out & SRD4)) ||
-                        (p_KEY[7] && (shiftReg.out & SRD5)) || (p_KEY[8] && (shiftReg.out & SRD6)) ||
-                        (p_KEY[9] && (shiftReg.out & SRD7))) {
-                        pic_set_pin(&pic, KEYPAD_2_PIN + 1, 1);
-                    } else {
-                        pic_set_pin(&pic, KEYPAD_2_PIN + 1, 0);
-                    }
-                }
-            }
-
-            if (!mplabxd_testbp())
-                pic_step(&pic);
-            ioupdated = pic.ioupdated;
-            InstCounterInc();
-
-            if (ioupdated) {
-                // keyboard
-                // D3-7 do shiftReg
-                // 0-9: UDLRS sABXY
-                if (pins[KEYPAD_1_PIN].dir) {
-                    if ((p_KEY[0] && (shiftReg.out & SRD3)) || (p_KEY[1] && (shiftReg.out & SRD4)) ||
-                        (p_KEY[2] && (shiftReg.out & SRD5)) || (p_KEY[3] && (shiftReg.out & SRD6)) ||
-                        (p_KEY[4] && (shiftReg.out & SRD7))) {
-                        pic_set_pin(&pic, KEYPAD_1_PIN + 1, 1);
-                    } else {
-                        pic_set_pin(&pic, KEYPAD_1_PIN + 1, 0);
-                    }
-                }
-                if (pins[KEYPAD_2_PIN].dir) {
-                    if ((p_KEY[5] && (shiftReg.out & SRD3)) || (p_KEY[6] && (shiftReg.out & SRD4)) ||
-                        (p_KEY[7] && (shiftReg.out & SRD5)) || (p_KEY[8] && (shiftReg.out & SRD6)) ||
-                        (p_KEY[9] && (shiftReg.out & SRD7))) {
-                        pic_set_pin(&pic, KEYPAD_2_PIN + 1, 1);
-                    } else {
-                        pic_set_pin(&pic, KEYPAD_2_PIN + 1, 0);
-                    }
-                }
-            }
-
-            if (use_oscope)
-                Oscilloscope.SetSample();
-            if (use_spare)
-                SpareParts.Process();
-
-            // increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pic.PINCOUNT)
-                pi = 0;
-
-            if (j >= JUMPSTEPS) {
-                // contabilizando a média do 7 segmentos
-                for (int iDisp = DISP_1_PIN; iDisp <= DISP_4_PIN; iDisp++) {
-                    if (pins[iDisp].value && !pins[iDisp].dir) {
-                        for (int iSeg = 0; iSeg < 8; iSeg++) {
-                            if (shiftReg.out & (1 << iSeg)) {
-                                alm7seg[(iDisp - DISP_1_PIN) * 8 + iSeg]++;
-                            }
-                        }
-                    }
-                }
-
-                alm[32] = 0;
-
-                // potenciometro
-                pic_set_apin(&pic, POT_PIN + 1, vPOT);  // pot
-                pic_set_apin(&pic, LDR_PIN + 1, vLDR);  // ldr
-                pic_set_apin(&pic, LM_PIN + 1, vLM);    // temp
-
-                // valor medio shift register
-                if (pic.pins[pic.PINCOUNT].value)
-                    shiftReg_alm[0]++;
-                if (pic.pins[pic.PINCOUNT + 1].value)
-                    shiftReg_alm[1]++;
-                if (pic.pins[pic.PINCOUNT + 2].value)
-                    shiftReg_alm[2]++;
-                if (pic.pins[pic.PINCOUNT + 3].value)
-                    shiftReg_alm[3]++;
-                if (pic.pins[pic.PINCOUNT + 4].value)
-                    shiftReg_alm[4]++;
-                if (pic.pins[pic.PINCOUNT + 5].value)
-                    shiftReg_alm[5]++;
-                if (pic.pins[pic.PINCOUNT + 6].value)
-                    shiftReg_alm[6]++;
-                if (pic.pins[pic.PINCOUNT + 7].value)
-                    shiftReg_alm[7]++;
-
-                j = -1;
-            }
-            j++;
-
-            if (ioupdated) {
-                // lcd display code
-                if ((!pins[LCD_EN_PIN].dir) && (!pins[LCD_EN_PIN].value)) {
-                    if (!lcde) {
-                        d = (shiftReg.out & 0x0f) << 4;
-
-                        if ((!pins[LCD_RS_PIN].dir) && (!pins[LCD_RS_PIN].value)) {
-                            lcd_cmd(&lcd, d);
-                        } else if ((!pins[LCD_RS_PIN].dir) && (pins[LCD_RS_PIN].value)) {
-                            lcd_data(&lcd, d);
-                        }
-                        lcde = 1;
-                    }
-                } else {
-                    lcde = 0;
-                }
-                // end display code
-
-                // ds1307 over i2c code
-                if (pins[SDA_PIN].dir) {
-                    sda = 1;
-                } else {
-                    sda = pins[SDA_PIN].value;
-                }
-                if (pins[SCL_PIN].dir) {
-                    sck = 1;
-                    pic_set_pin(&pic, SCL_PIN + 1, 1);
-                } else {
-                    sck = pins[SCL_PIN].value;
-                }
-                pic_set_pin(&pic, SDA_PIN + 1, rtc_ds1307_I2C_io(&rtc2, sck, sda));
-
-                // 74hc595 code
-                if (pins[SO_DATA_PIN].dir == 0) {
-                    srDATA = pins[SO_DATA_PIN].value;
-                }
-                if (pins[SO_CLK_PIN].dir == 0) {
-                    srCLK = pins[SO_CLK_PIN].value;
-                }
-                if (pins[SO_EN_PIN].dir == 0) {
-                    srLAT = pins[SO_EN_PIN].value;
-                }
-                unsigned short ret = io_74xx595_io(&shiftReg, srDATA, srCLK, srLAT, 1);
-                if (_srret != ret) {
-                    pic.pins[PSRD0].value = (ret & 0x01) != 0;
-                    pic.pins[PSRD1].value = (ret & 0x02) != 0;
-                    pic.pins[PSRD2].value = (ret & 0x04) != 0;
-                    pic.pins[PSRD3].value = (ret & 0x08) != 0;
-                    pic.pins[PSRD4].value = (ret & 0x10) != 0;
-                    pic.pins[PSRD5].value = (ret & 0x20) != 0;
-                    pic.pins[PSRD6].value = (ret & 0x40) != 0;
-                    pic.pins[PSRD7].value = (ret & 0x80) != 0;
-                }
-                _srret = ret;
-            }
-        }
-        pic.ioupdated = 0;
+        RunSteps(this, pic.pins, pic.PINCOUNT, NSTEP, JUMPSTEPS);
+    } else {
+        PinActivity.Clear();
     }
     // fim STEP
 
@@ -767,9 +745,10 @@ void cboard_PQDB::Run_CPU(void) {
         if (pic.pins[i].port == P_VDD) {
             pic.pins[i].oavalue = 255;
         } else {
-            pic.pins[i].oavalue = (int)((alm[i] * RNSTEP) + 55);
+            pic.pins[i].oavalue = (int)((PinActivity.GetDuty(i) * 200.0) + 55);
         }
     }
+    pic.pins[32].oavalue = 55;
 
     const long int NSTEPJ = PICSimLab.GetNSTEPJ();
 
@@ -171,6 +171,8 @@ private:
 
     int lm7seg[32];  // luminosidade media display
 
+    unsigned int alm7seg[32];  // luminosidade media display 7 seg
+
     lxaudio buzzer;
 
     void RegisterRemoteControl(void) override;
@@ -196,6 +198,9 @@ public:
     ~cboard_PQDB(void);
     void Draw(CDraw* draw) override;
     void Run_CPU(void) override;
+    void StepPre(const int jump);
+    void StepHardware(void);
+    void StepPost(const int jump);
 
     lxString GetSupportedDevices(void) override { return lxT("PIC18F4520,PIC18F4550,PIC18F4620,"); };
 
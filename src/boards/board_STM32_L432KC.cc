@@ -224,25 +224,22 @@ void cboard_STM32L432KC::Draw(CDraw* draw) {
 void cboard_STM32L432KC::Run_CPU_ns(uint64_t time) {
     static int j = 0;
     static unsigned char pi = 0;
-    static unsigned int alm[64];  // to be clearified
     static const int pinc = MGetPinCount();
 
     const int JUMPSTEPS = 4.0 * PICSimLab.GetJUMPSTEPS();  // number of steps skipped in Board update
 
     // const int inc = 1000000000L / MGetInstClockFreq();
 
-    const float RNSTEPS = 200.0 * pinc * inc_ns / TTIMEOUT;
-
     for (uint32_t c = 0; c < time; c += inc_ns) {
         if (ns_count < inc_ns) {
-            memset(alm, 0, 64 * sizeof(unsigned int));
+            // start pins activity frame
+            PinActivity.Start(pins, pinc, GetInstCounter());
 
             // Spare parts window pre process
             if (use_spare)
                 SpareParts.PreProcess();
 
             j = JUMPSTEPS;  // step counter
-            pi = 0;
         }
 
         if (PICSimLab.GetMcuPwr())  // if powered
@@ -257,11 +254,9 @@ void cboard_STM32L432KC::Run_CPU_ns(uint64_t time) {
             if (use_spare)
                 SpareParts.Process();
 
-            // inceament mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pinc)
-                pi = 0;
+            // record pins edges
+            if (ioupdated)
+                ScanPins();
 
             if (j >= JUMPSTEPS)
                 j = -1;  // reset counter
@@ -273,8 +268,12 @@ void cboard_STM32L432KC::Run_CPU_ns(uint64_t time) {
         if (ns_count >= TTIMEOUT) {
             ns_count -= TTIMEOUT;
             // calculate mean value
+            if (PICSimLab.GetMcuPwr())
+                PinActivity.End(GetInstCounter());
+            else
+                PinActivity.Clear();
             for (pi = 0; pi < MGetPinCount(); pi++) {
-                pins[pi].oavalue = (int)((alm[pi] * RNSTEPS) + 55);
+                pins[pi].oavalue = (int)((PinActivity.GetDuty(pi) * 200.0) + 55);
             }
         }
     }
@@ -28,6 +28,7 @@
 #include "../lib/oscilloscope.h"
 #include "../lib/picsimlab.h"
 #include "../lib/spareparts.h"
+#include "../lib/stepkernel.h"
 
 /* ids of inputs of input map*/
 enum {
@@ -549,68 +550,37 @@ void cboard_Xpress::Draw(CDraw* draw) {
     gauge4->SetValue((pic.pins[1].oavalue - 55) / 2);
 }
 
+void cboard_Xpress::StepPre(const int jump) {
+    bsim_picsim::StepPre(jump);
+    if (jump) {
+        pic_set_pin(&pic, 4, p_BT1);  // Set pin 4 (RA5) with button state
+    }
+}
+
+void cboard_Xpress::StepPost(const int jump) {
+    if (jump) {
+        // set analog pin 3 (RA4 ANA4) with value from scroll
+        pic_set_apin(&pic, 3, (3.3 * pot1 / 199));
+    }
+}
+
 void cboard_Xpress::Run_CPU(void) {
-    int i;
-    int j;
     unsigned char pi;
-    const picpin* pins;
-    unsigned int alm[28];
 
     const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS();  // number of steps skipped
     const long int NSTEP = PICSimLab.GetNSTEP();     // number of steps in 100ms
-    const float RNSTEP = 200.0 * pic.PINCOUNT / NSTEP;
-
-    // reset mean value
-    memset(alm, 0, 28 * sizeof(unsigned int));
-
-    // read pic.pins to a local variable to speed up
-    pins = pic.pins;
 
     if (use_spare)
         SpareParts.PreProcess();
 
-    j = JUMPSTEPS;  // step counter
-    pi = 0;
-    if (PICSimLab.GetMcuPwr())       // if powered
-        for (i = 0; i < NSTEP; i++)  // repeat for number of steps in 100ms
-        {
-            if (j >= JUMPSTEPS)  // if number of step is bigger than steps to skip
-            {
-                pic_set_pin(&pic, pic.mclr, p_RST);
-                pic_set_pin(&pic, 4, p_BT1);  // Set pin 4 (RA5) with button state
-            }
-
-            // verify if a breakpoint is reached if not run one instruction
-            if (!mplabxd_testbp())
-                pic_step(&pic);
-            ioupdated = pic.ioupdated;
-            InstCounterInc();
-            if (use_oscope)
-                Oscilloscope.SetSample();
-            if (use_spare)
-                SpareParts.Process();
-
-            // increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pic.PINCOUNT)
-                pi = 0;
-
-            if (j >= JUMPSTEPS)  // if number of step is bigger than steps to skip
-            {
-                // set analog pin 3 (RA4 ANA4) with value from scroll
-                pic_set_apin(&pic, 3, (3.3 * pot1 / 199));
-
-                j = -1;  // reset counter
-            }
-
-            j++;  // counter increment
-            pic.ioupdated = 0;
-        }
+    if (PICSimLab.GetMcuPwr())  // if powered
+        RunSteps(this, pic.pins, pic.PINCOUNT, NSTEP, JUMPSTEPS);
+    else
+        PinActivity.Clear();
 
     // calculate mean value
     for (pi = 0; pi < pic.PINCOUNT; pi++) {
-        pic.pins[pi].oavalue = (int)((alm[pi] * RNSTEP) + 55);
+        pic.pins[pi].oavalue = (int)((PinActivity.GetDuty(pi) * 200.0) + 55);
     }
 
     if (use_spare)
@@ -28,6 +28,7 @@
 #include "../lib/oscilloscope.h"
 #include "../lib/picsimlab.h"
 #include "../lib/spareparts.h"
+#include "../lib/stepkernel.h"
 
 /* ids of inputs of input map*/
 enum {
@@ -274,61 +275,25 @@ void cboard_gpboard::Draw(CDraw* draw) {
 }
 
 void cboard_gpboard::Run_CPU(void) {
-    int i;
-    // int j;
     unsigned char pi;
-    unsigned int alm[64];
     const int pinc = MGetPinCount();
 
-    // const int JUMPSTEPS = Window1.GetJUMPSTEPS (); //number of steps skipped
+    const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS();  // number of steps skipped
     const long int NSTEP = PICSimLab.GetNSTEP();  // number of steps in 100ms
-    const float RNSTEP = 200.0 * pinc / NSTEP;
-
-    // reset pins mean value
-    memset(alm, 0, 64 * sizeof(unsigned int));
 
     // Spare parts window pre process
     if (use_spare)
         SpareParts.PreProcess();
 
-    // j = JUMPSTEPS; //step counter
-    pi = 0;
-    if (PICSimLab.GetMcuPwr())                      // if powered
-        for (i = 0; i < PICSimLab.GetNSTEP(); i++)  // repeat for number of steps in 100ms
-        {
-            /*
-            if (j >= JUMPSTEPS)//if number of step is bigger than steps to skip
-             {
-             }
-             */
-            // verify if a breakpoint is reached if not run one instruction
-            MStep();
-            InstCounterInc();
-            // Oscilloscope window process
-            if (use_oscope)
-                Oscilloscope.SetSample();
-            // Spare parts window process
-            if (use_spare)
-                SpareParts.Process();
-
-            // increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pinc)
-                pi = 0;
-            /*
-             if (j >= JUMPSTEPS)//if number of step is bigger than steps to skip
-              {
-               j = -1; //reset counter
-              }
-
-             j++; //counter increment
-             */
-        }
+    // repeat for number of steps in 100ms
+    if (PICSimLab.GetMcuPwr())  // if powered
+        RunSteps(this, pins, pinc, NSTEP, JUMPSTEPS);
+    else
+        PinActivity.Clear();
 
     // calculate mean value
     for (pi = 0; pi < MGetPinCount(); pi++) {
-        pins[pi].oavalue = (int)((alm[pi] * RNSTEP) + 55);
+        pins[pi].oavalue = (int)((PinActivity.GetDuty(pi) * 200.0) + 55);
     }
 
     // Spare parts window pre post process
@@ -28,6 +28,7 @@
 #include "../lib/oscilloscope.h"
 #include "../lib/picsimlab.h"
 #include "../lib/spareparts.h"
+#include "../lib/stepkernel.h"
 
 /* ids of inputs of input map*/
 enum {
@@ -575,20 +576,53 @@ void cboard_x::Draw(CDraw* draw) {
     gauge2->SetValue((pic.pins[32].oavalue - 55) / 2);
 }
 
+void cboard_x::StepPre(const int jump) {
+    int bret;
+
+    bsim_picsim::StepPre(jump);
+    if (jump)  // if number of step is bigger than steps to skip
+    {
+        if (!bounce.do_bounce) {
+            pic_set_pin(&pic, 19, p_BT1_);  // Set pin 19 (RD0) with button state
+            pic_set_pin(&pic, 20, p_BT2_);  // Set pin 20 (RD1) with switch state
+        }
+    }
+
+    if (bounce.do_bounce) {
+        bret = SWBounce_process(&bounce);
+        if (bret) {
+            if (bounce.bounce[0]) {
+                if (bret == 1) {
+                    pic_set_pin(&pic, 19, !pic.pins[19 - 1].value);
+                } else {
+                    pic_set_pin(&pic, 19, p_BT1_);
+                }
+            }
+            if (bounce.bounce[1]) {
+                if (bret == 1) {
+                    pic_set_pin(&pic, 20, !pic.pins[20 - 1].value);
+                } else {
+                    pic_set_pin(&pic, 20, p_BT2_);
+                }
+            }
+        }
+    }
+}
+
+void cboard_x::StepPost(const int jump) {
+    if (jump)  // if number of step is bigger than steps to skip
+    {
+        // set analog pin 2 (AN0) with value from scroll
+        pic_set_apin(&pic, 2, (5.0 * pot1 / 199));
+    }
+}
+
 void cboard_x::Run_CPU(void) {
-    int i;
-    int j;
     unsigned char pi;
     const picpin* pins;
-    unsigned int alm[40];
-    int bret;
 
     const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS();  // number of steps skipped
     const long int NSTEP = PICSimLab.GetNSTEP();     // number of steps in 100ms
-    const float RNSTEP = 200.0 * pic.PINCOUNT / NSTEP;
-
-    // reset pins mean value
-    memset(alm, 0, 40 * sizeof(unsigned int));
 
     // read pic.pins to a local variable to speed up
     pins = pic.pins;
@@ -599,8 +633,8 @@ void cboard_x::Run_CPU(void) {
 
     SWBounce_prepare(&bounce, PICSimLab.GetBoard()->MGetInstClockFreq());
 
-    unsigned char p_BT1_ = p_BT1;
-    unsigned char p_BT2_ = p_BT2;
+    p_BT1_ = p_BT1;
+    p_BT2_ = p_BT2;
 
     if ((pins[19 - 1].dir == PD_IN) && (pins[19 - 1].value != p_BT1_)) {
         SWBounce_bounce(&bounce, 0);
@@ -609,72 +643,15 @@ void cboard_x::Run_CPU(void) {
         SWBounce_bounce(&bounce, 1);
     }
 
-    j = JUMPSTEPS;  // step counter
-    pi = 0;
-    if (PICSimLab.GetMcuPwr())       // if powered
-        for (i = 0; i < NSTEP; i++)  // repeat for number of steps in 100ms
-        {
-            if (j >= JUMPSTEPS)  // if number of step is bigger than steps to skip
-            {
-                pic_set_pin(&pic, pic.mclr, p_RST);
-                if (!bounce.do_bounce) {
-                    pic_set_pin(&pic, 19, p_BT1_);  // Set pin 19 (RD0) with button state
-                    pic_set_pin(&pic, 20, p_BT2_);  // Set pin 20 (RD1) with switch state
-                }
-            }
-
-            if (bounce.do_bounce) {
-                bret = SWBounce_process(&bounce);
-                if (bret) {
-                    if (bounce.bounce[0]) {
-                        if (bret == 1) {
-                            pic_set_pin(&pic, 19, !pins[19 - 1].value);
-                        } else {
-                            pic_set_pin(&pic, 19, p_BT1_);
-                        }
-                    }
-                    if (bounce.bounce[1]) {
-                        if (bret == 1) {
-                            pic_set_pin(&pic, 20, !pins[20 - 1].value);
-                        } else {
-                            pic_set_pin(&pic, 20, p_BT2_);
-                        }
-                    }
-                }
-            }
-
-            // verify if a breakpoint is reached if not run one instruction
-            if (!mplabxd_testbp())
-                pic_step(&pic);
-            ioupdated = pic.ioupdated;
-            InstCounterInc();
-            // Oscilloscope window process
-            if (use_oscope)
-                Oscilloscope.SetSample();
-            // Spare parts window process
-            if (use_spare)
-                SpareParts.Process();
-
-            // increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pic.PINCOUNT)
-                pi = 0;
-
-            if (j >= JUMPSTEPS)  // if number of step is bigger than steps to skip
-            {
-                // set analog pin 2 (AN0) with value from scroll
-                pic_set_apin(&pic, 2, (5.0 * pot1 / 199));
-
-                j = -1;  // reset counter
-            }
-            j++;  // counter increment
-            pic.ioupdated = 0;
-        }
+    // repeat for number of steps in 100ms calling StepPre and StepPost every step
+    if (PICSimLab.GetMcuPwr())  // if powered
+        RunSteps(this, pins, pic.PINCOUNT, NSTEP, JUMPSTEPS);
+    else
+        PinActivity.Clear();
 
     // calculate mean value
     for (pi = 0; pi < pic.PINCOUNT; pi++) {
-        pic.pins[pi].oavalue = (int)((alm[pi] * RNSTEP) + 55);
+        pic.pins[pi].oavalue = (int)((PinActivity.GetDuty(pi) * 200.0) + 55);
     }
 
     // Spare parts window pre post process
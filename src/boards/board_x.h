@@ -36,8 +36,10 @@
 // new board class must be derived from board class defined in board.h
 class cboard_x : public bsim_picsim {
 private:
-    unsigned char p_BT1;  // first board push button in RD0
-    unsigned char p_BT2;  // second board switch in RD1
+    unsigned char p_BT1;   // first board push button in RD0
+    unsigned char p_BT2;   // second board switch in RD1
+    unsigned char p_BT1_;  // p_BT1 state during Run_CPU
+    unsigned char p_BT2_;  // p_BT2 state during Run_CPU
 
     // value of potentiometer
     unsigned char pot1;
@@ -70,6 +72,10 @@ public:
     // Called ever 100ms to draw board
     void Draw(CDraw* draw) override;
     void Run_CPU(void) override;
+    // Stepping kernel hooks called every CPU step
+    void StepPre(const int jump);
+    void StepPost(const int jump);
+    int StepQuiet(void) { return !bounce.do_bounce; };
     // Return a list of board supported microcontrollers
     lxString GetSupportedDevices(void) override { return lxT("PIC16F877A,PIC18F4550,PIC18F4620,"); };
     // Reset board status
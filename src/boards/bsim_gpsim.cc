@@ -183,11 +183,18 @@ void bsim_gpsim::MSetSerial(const char* port) {
  }
 
  void bsim_gpsim::MStep(void) {
+     ioupdated = 0;
+
      bridge_gpsim_step();
 
-     for (int i = 0; i < MGetPinCount(); i++) {
-         pins[i].value = bridge_gpsim_get_pin_value(i + 1);
-         pins[i].dir = bridge_gpsim_get_pin_dir(i + 1);
+     for (int i = 0; i < bsim_gpsim::MGetPinCount(); i++) {
+         const unsigned char value = bridge_gpsim_get_pin_value(i + 1);
+         const unsigned char dir = bridge_gpsim_get_pin_dir(i + 1);
+         if ((pins[i].value != value) || (pins[i].dir != dir)) {
+             pins[i].value = value;
+             pins[i].dir = dir;
+             ioupdated = 1;
+         }
      }
  }
 
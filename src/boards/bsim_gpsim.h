@@ -57,6 +57,8 @@ public:
     void MStep(void) override;
     void MStepResume(void) override;
     void MReset(int flags) override;
+
+    void StepCore(void) { bsim_gpsim::MStep(); };
     int GetDefaultClock(void) override { return 8; };
 
 protected:
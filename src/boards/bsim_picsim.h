@@ -27,6 +27,7 @@
 #define BOARD_PIC_H
 
 #include "../lib/board.h"
+#include "../lib/profiler.h"
 #include "../lib/serial_port.h"
 
 #include "../devices/mplabxd.h"
@@ -34,6 +35,7 @@
 class bsim_picsim : virtual public board {
 public:
     bsim_picsim(void);
+    static const int reentrant = 1;  // all picsim state is in pic
     int DebugInit(int dtyppe) override;
     lxString GetDebugName(void) override { return "MDB"; };
     void DebugLoop(void) override;
@@ -79,6 +81,22 @@ public:
     int GetUARTRX(const int uart_num) override;
     int GetUARTTX(const int uart_num) override;
 
+    void StepPre(const int jump) {
+        if (jump)
+            pic_set_pin(&pic, pic.mclr, p_RST);
+    };
+
+    void StepCore(void) {
+        // verify if a breakpoint is reached if not run one instruction
+        const int bp = mplabxd_testbp();
+        Profiler.Lap(PS_DEBUG);
+        if (!bp)
+            pic_step(&pic);
+        ioupdated = pic.ioupdated;
+    };
+
+    void StepEnd(void) { pic.ioupdated = 0; };
+
 protected:
     _pic pic;
 };
@@ -74,6 +74,14 @@ uint32_t (*qemu_picsimlab_get_TIOCM)(void);
 static picpin* g_pins;
 static bsim_qemu* g_board = NULL;
 
+// run the board from the qemu thread, skipped while the simulation is paused
+static void RunBoard_ns(const uint64_t time) {
+    if (PICSimLab.EnterCPU()) {
+        g_board->Run_CPU_ns(time);
+        PICSimLab.LeaveCPU();
+    }
+}
+
 static int64_t GotoNow(void) {
     int64_t now = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
     int64_t delta;
@@ -96,9 +104,11 @@ static int64_t GotoNow(void) {
 static void picsimlab_write_pin(int pin, int value) {
     // printf("================> IO    <====================== %ji\n", now - g_board->timer.last);
     ioupdated = 1;
-    g_board->Run_CPU_ns(GotoNow());
+    RunBoard_ns(GotoNow());
 
     g_pins[pin - 1].value = value;
+    // Run_CPU_ns scanned the pins before the new value, and the timer callback clears ioupdated
+    g_board->ScanPins();
     // printf("pin[%i]=%i\n", pin, value);
 }
 
@@ -107,11 +117,11 @@ static void picsimlab_dir_pins(int pin, int dir) {
 
     if (pin > 0) {  // normal io
         ioupdated = 1;
-        g_board->Run_CPU_ns(GotoNow());
+        RunBoard_ns(GotoNow());
         g_pins[pin - 1].dir = !dir;
     } else if (dir == -1) {  // sync input
         ioupdated = 1;
-        g_board->Run_CPU_ns(GotoNow());
+        RunBoard_ns(GotoNow());
     } else {  // especial pin cfg
         g_board->PinsExtraConfig(-dir);
     }
@@ -119,7 +129,7 @@ static void picsimlab_dir_pins(int pin, int dir) {
 }
 
 static int picsimlab_i2c_event(const uint8_t id, const uint8_t addr, const uint16_t event) {
-    g_board->Run_CPU_ns(GotoNow());
+    RunBoard_ns(GotoNow());
 
     switch (event & 0xFF) {
         case I2C_START_RECV:
@@ -127,7 +137,7 @@ static int picsimlab_i2c_event(const uint8_t id, const uint8_t addr, const uint1
 
             bitbang_i2c_ctrl_start(&g_board->master_i2c[id]);
             g_board->timer.last += 8000;
-            g_board->Run_CPU_ns(8000);
+            RunBoard_ns(8000);
 
             if (event == I2C_START_RECV) {
                 bitbang_i2c_ctrl_write(&g_board->master_i2c[id], (addr << 1) | 0x01);
@@ -137,12 +147,12 @@ static int picsimlab_i2c_event(const uint8_t id, const uint8_t addr, const uint1
                 dprintf(">>> start send =0x%02x\n", addr);
             }
             g_board->timer.last += 72000;
-            g_board->Run_CPU_ns(72000);
+            RunBoard_ns(72000);
             break;
         case I2C_FINISH:
             bitbang_i2c_ctrl_stop(&g_board->master_i2c[id]);
             g_board->timer.last += 8000;
-            g_board->Run_CPU_ns(8000);
+            RunBoard_ns(8000);
             dprintf("<<< stop =0x%02x\n", addr);
             break;
         case I2C_NACK:
@@ -151,13 +161,13 @@ static int picsimlab_i2c_event(const uint8_t id, const uint8_t addr, const uint1
             dprintf("==> send addr=0x%02x value=0x%02x\n", addr, event >> 8);
             bitbang_i2c_ctrl_write(&g_board->master_i2c[id], event >> 8);  // TODO verify ACK
             g_board->timer.last += 72000;
-            g_board->Run_CPU_ns(72000);
+            RunBoard_ns(72000);
             return 1;
             break;
         case I2C_READ:
             bitbang_i2c_ctrl_read(&g_board->master_i2c[id]);  // TODO verify ACK
             g_board->timer.last += 72000;
-            g_board->Run_CPU_ns(72000);
+            RunBoard_ns(72000);
             dprintf("<== recv addr=0x%02x value=0x%02x\n", addr, g_board->master_i2c[id].datar);
             return g_board->master_i2c[id].datar;
             break;
@@ -166,14 +176,14 @@ static int picsimlab_i2c_event(const uint8_t id, const uint8_t addr, const uint1
 }
 
 static uint8_t picsimlab_spi_event(const uint8_t id, const uint16_t event) {
-    g_board->Run_CPU_ns(GotoNow());
+    RunBoard_ns(GotoNow());
     uint64_t cycle_ns = g_board->TimerGet_ns(g_board->master_spi[id].TimerID);
 
     switch (event & 0xFF) {
         case 0:  // tranfer
             bitbang_spi_ctrl_write(&g_board->master_spi[id], event >> 8);
             g_board->timer.last += cycle_ns * 36;
-            g_board->Run_CPU_ns(cycle_ns * 36);
+            RunBoard_ns(cycle_ns * 36);
             dprintf("SPI MASTER SEND 0x%02X  RECV 0x%02X\n", event >> 8, g_board->master_spi[id].data);
             return g_board->master_spi[id].data;
             break;
@@ -192,7 +202,7 @@ static uint8_t picsimlab_spi_event(const uint8_t id, const uint16_t event) {
                     break;
             }
             g_board->timer.last += cycle_ns * 2;
-            g_board->Run_CPU_ns(cycle_ns * 2);
+            RunBoard_ns(cycle_ns * 2);
             break;
     }
     return 0;
@@ -201,11 +211,11 @@ static uint8_t picsimlab_spi_event(const uint8_t id, const uint16_t event) {
 static void picsimlab_uart_tx_event(const uint8_t id, const uint8_t value) {
     dprintf("Uart[%i] %c \n", id, value);
 
-    g_board->Run_CPU_ns(GotoNow());
+    RunBoard_ns(GotoNow());
 
     bitbang_uart_send(&g_board->master_uart[id], value);
     g_board->timer.last += 1041667;
-    g_board->Run_CPU_ns(1041667);  // TODO fixed 10 bits at 9600 bps
+    RunBoard_ns(1041667);  // TODO fixed 10 bits at 9600 bps
 }
 
 static void picsimlab_uart_rx_event(bitbang_uart_t* bu, void* arg) {
@@ -381,9 +391,10 @@ static void user_timeout_cb(void* opaque) {
     bsim_qemu* board = (bsim_qemu*)opaque;
     int64_t now = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
     timer_mod_ns(board->timer.qtimer, now + board->timer.timeout);
-    if (PICSimLab.GetSimulationRun()) {
+    if (PICSimLab.EnterCPU()) {
         ioupdated = 0;
         board->Run_CPU_ns(GotoNow());
+        PICSimLab.LeaveCPU();
     }
     board->timer.last = now;
 }
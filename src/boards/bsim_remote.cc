@@ -879,7 +879,10 @@ int32_t bsim_remote::recv_cmd(cmd_header_t* cmd_header) {
         if (delta > (TTIMEOUT * 1.1)) {
             delta = (TTIMEOUT * 1.1);
         }
-        Run_CPU_ns(delta);
+        if (PICSimLab.EnterCPU()) {
+            Run_CPU_ns(delta);
+            PICSimLab.LeaveCPU();
+        }
     } else if (now < timerlast) {
         timerlast = now;
     }
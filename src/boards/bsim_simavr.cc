@@ -71,6 +71,7 @@ bsim_simavr::bsim_simavr(void) {
         serial_irq[i] = NULL;
     }
     avr_debug_type = 0;
+    twostep = 0;
     eeprom = NULL;
     usart_count = 0;
     pkg = PDIP;
@@ -56,6 +56,7 @@ typedef struct {
 class bsim_simavr : virtual public board {
 public:
     bsim_simavr(void);  // Called once on board creation
+    static const int reentrant = 1;  // all simavr state is in avr
     int DebugInit(int dtyppe) override;
     lxString GetDebugName(void) override;
     void DebugLoop(void) override;
@@ -100,6 +101,25 @@ public:
     int GetUARTTX(const int uart_num) override;
     virtual void UpdateHardware(void);
 
+    void StepCore(void) {
+        // verify if a breakpoint is reached if not run one instruction
+        if (avr_debug_type || (!mplabxd_testbp())) {
+            if (twostep) {
+                twostep = 0;  // NOP
+            } else {
+                const long long unsigned int cycle_start = avr->cycle;
+                avr_run(avr);
+                if ((avr->cycle - cycle_start) > 1) {
+                    twostep = 1;
+                }
+            }
+        }
+    };
+
+    void StepHardware(void) { bsim_simavr::UpdateHardware(); };
+
+    void StepEnd(void) { ioupdated = 0; };
+
     static void out_hook(struct avr_irq_t* irq, uint32_t value, void* param) {
         picpin* p = (picpin*)param;
         p->value = value;
@@ -125,6 +145,7 @@ protected:
     float serialexbaud[MAX_UART_COUNT];
     void pins_reset(void);
     int avr_debug_type;
+    int twostep;
     serialfd_t serialfd;
     bitbang_uart_t bb_uart[MAX_UART_COUNT];
     unsigned char* eeprom;
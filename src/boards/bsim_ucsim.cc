@@ -265,7 +265,7 @@ void bsim_ucsim::MSetSerial(const char* port) {
          ports[2] = p[2];
          ports[3] = p[3];
 
-         for (int i = 0; i < MGetPinCount(); i++) {
+         for (int i = 0; i < bsim_ucsim::MGetPinCount(); i++) {
              if (*pins[i].port < 4) {
                  pins[i].value = (ports[*pins[i].port] & (0x0001 << pins[i].pord)) > 0;
                  if (procid != PID_C51) {
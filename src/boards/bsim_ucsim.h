@@ -58,6 +58,8 @@ public:
     void MStepResume(void) override;
     void MReset(int flags) override;
 
+    void StepCore(void) { bsim_ucsim::MStep(); };
+
 protected:
     void pins_reset(void);
     picpin pins[256];
@@ -60,14 +60,23 @@ void lcd_ili9341_rst(lcd_ili9341_t* lcd) {
 
     lcd->mac = 0;
     lcd->pf = 0x66;
+    lcd->spans_count = 0;
 }
 
 void lcd_ili9341_init(lcd_ili9341_t* lcd) {
     lcd->hrst = 0;
+    lcd->spans = NULL;
+    lcd->spans_size = 0;
     bitbang_spi_init(&lcd->bb_spi);
     lcd_ili9341_rst(lcd);
 }
 
+void lcd_ili9341_end(lcd_ili9341_t* lcd) {
+    free(lcd->spans);
+    lcd->spans = NULL;
+    lcd->spans_size = 0;
+}
+
 void lcd_ili9341_update(lcd_ili9341_t* lcd) {
     int i, j;
     lcd->update = 1;
@@ -592,40 +601,70 @@ unsigned short lcd_ili9341_8_io(lcd_ili9341_t* lcd, const unsigned char** pins_v
     return lcd->out;
 }
 
-void lcd_ili9341_draw(lcd_ili9341_t* lcd, CCanvas* canvas, const int x1, const int y1, const int w1, const int h1,
-                      const int picpwr) {
+void lcd_ili9341_prepare(lcd_ili9341_t* lcd) {
     unsigned short x, y;
-    unsigned char r, g, b;
-
-    lcd->update = 0;
 
     if (!lcd->on)
         return;
 
+    // spans not yet drawn are kept, new changes are appended
     for (x = 0; x < 240; x++) {
+        lcd_ili9341_span_t* span = NULL;
         for (y = 0; y < 320; y++) {
             if (lcd->ram[x][y] & 0xFF000000) {
+                const unsigned int color = lcd->ram[x][y] & 0x00FFFFFF;
+
+                if (span && (span->color == color) && ((span->y + span->len) == y)) {
+                    span->len++;
+                } else {
+                    if (lcd->spans_count == lcd->spans_size) {
+                        const unsigned int size = lcd->spans_size ? lcd->spans_size * 2 : LCD_ILI9341_MIN_SPANS;
+                        lcd_ili9341_span_t* spans =
+                            (lcd_ili9341_span_t*)realloc(lcd->spans, size * sizeof(lcd_ili9341_span_t));
+                        if (!spans)
+                            return;  // remaining pixels stay marked to next prepare
+                        lcd->spans = spans;
+                        lcd->spans_size = size;
+                    }
+                    span = &lcd->spans[lcd->spans_count++];
+                    span->color = color;
+                    span->x = x;
+                    span->y = y;
+                    span->len = 1;
+                }
                 lcd->ram[x][y] &= 0x00FFFFFF;  // clear draw
+            }
+        }
+    }
+}
 
-                r = (lcd->ram[x][y] & 0xFF0000) >> 16;
-                g = (lcd->ram[x][y] & 0x00FF00) >> 8;
-                b = (lcd->ram[x][y] & 0x0000FF);
+void lcd_ili9341_draw(lcd_ili9341_t* lcd, CCanvas* canvas, const int x1, const int y1, const int w1, const int h1,
+                      const int picpwr) {
+    unsigned char r, g, b;
 
-                /*
-                r = (lcd->ram[x][y] & 0x00F800) >> 8;
-                g = (lcd->ram[x][y] & 0x0007E0) >> 3;
-                b = (lcd->ram[x][y] & 0x00001F) << 3;
-                r = ((lcd->ram[x][y] & 0x00F800) >> 11)*8.23;
-                g = ((lcd->ram[x][y] & 0x0007E0) >> 5)*4.05;
-                b = (lcd->ram[x][y] & 0x00001F)*8.23;
-                 */
+    lcd->update = 0;
 
-                canvas->SetColor(r, g, b);
+    if (!lcd->on) {
+        lcd->spans_count = 0;
+        return;
+    }
 
-                // canvas->Rectangle (1, x1 + (x * 2), y1 + (y * 8 * 2)+(z * 2), 2, 2);
+    lcd_ili9341_prepare(lcd);  // pixels changed after DrawPrepare
 
-                canvas->Point(x1 + y, y1 + (239 - x));
-            }
+    for (unsigned int i = 0; i < lcd->spans_count; i++) {
+        const lcd_ili9341_span_t* span = &lcd->spans[i];
+
+        r = (span->color & 0xFF0000) >> 16;
+        g = (span->color & 0x00FF00) >> 8;
+        b = (span->color & 0x0000FF);
+
+        canvas->SetColor(r, g, b);
+
+        if (span->len == 1) {
+            canvas->Point(x1 + span->y, y1 + (239 - span->x));
+        } else {
+            canvas->Rectangle(1, x1 + span->y, y1 + (239 - span->x), span->len, 1);
         }
     }
+    lcd->spans_count = 0;
 }
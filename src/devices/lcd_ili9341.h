@@ -40,6 +40,15 @@
   8 GND
 */
 
+typedef struct {
+    unsigned int color;
+    unsigned short x;
+    unsigned short y;
+    unsigned short len;
+} lcd_ili9341_span_t;  // horizontal run of changed pixels with same color
+
+#define LCD_ILI9341_MIN_SPANS 1024
+
 typedef struct {
     unsigned long int ram[240][320];
     unsigned char pwr;  // previous wr
@@ -67,15 +76,22 @@ typedef struct {
     unsigned short pag_end;
 
     unsigned long color;
+
+    lcd_ili9341_span_t* spans;  // changed pixels waiting draw, grows with the changed region
+    unsigned int spans_count;
+    unsigned int spans_size;
 } lcd_ili9341_t;
 
 void lcd_ili9341_rst(lcd_ili9341_t* lcd);
 void lcd_ili9341_init(lcd_ili9341_t* lcd);
+void lcd_ili9341_end(lcd_ili9341_t* lcd);
 void lcd_ili9341_update(lcd_ili9341_t* lcd);
 
 unsigned char lcd_ili9341_SPI_io(lcd_ili9341_t* lcd, const unsigned char** pins_value);
 unsigned short lcd_ili9341_8_io(lcd_ili9341_t* lcd, const unsigned char** pins_value);
 
+void lcd_ili9341_prepare(lcd_ili9341_t* lcd);
+
 void lcd_ili9341_draw(lcd_ili9341_t* lcd, CCanvas* canvas, const int x1, const int y1, const int w1, const int h1,
                       const int picpwr);
 
@@ -44,6 +44,15 @@ void ldd_max72xx_rst(ldd_max72xx_t* ldd) {
 void ldd_max72xx_init(ldd_max72xx_t* ldd) {
     bitbang_spi_init(&ldd->bb_spi, 16);
     ldd_max72xx_rst(ldd);
+    ldd_max72xx_redraw(ldd);
+}
+
+void ldd_max72xx_redraw(ldd_max72xx_t* ldd) {
+    for (int i = 0; i < 8; i++) {
+        ldd->dots[i] = 0;
+        ldd->dots_draw[i] = 0xFF;
+    }
+    ldd->update = 1;
 }
 
 void ldd_max72xx_update(ldd_max72xx_t* ldd) {
@@ -108,13 +117,12 @@ unsigned char ldd_max72xx_io(ldd_max72xx_t* ldd, unsigned char din, unsigned cha
     return ldd->bb_spi.ret;
 }
 
-void ldd_max72xx_draw(ldd_max72xx_t* ldd, CCanvas* canvas, int x1, int y1, int w1, int h1, int picpwr, int angle,
-                      int mode) {
+void ldd_max72xx_prepare(ldd_max72xx_t* ldd, int angle) {
     int x, y, a, b;
 
-    ldd->update = 0;
-
+    // dots not yet drawn are kept, new changes are added
     for (x = 0; x < 8; x++) {
+        unsigned char dots = 0;
         for (y = 0; y < 8; y++) {
             switch (angle) {
                 case 0:
@@ -140,10 +148,31 @@ void ldd_max72xx_draw(ldd_max72xx_t* ldd, CCanvas* canvas, int x1, int y1, int w
             }
 
             if (ldd->ram[a] & (1 << (b))) {
-                canvas->SetFgColor(50, 50, 50);
+                dots |= 1 << y;
+            }
+        }
+        ldd->dots_draw[x] |= dots ^ ldd->dots[x];
+        ldd->dots[x] = dots;
+    }
+}
+
+void ldd_max72xx_draw(ldd_max72xx_t* ldd, CCanvas* canvas, int x1, int y1, int w1, int h1, int picpwr, int angle,
+                      int mode) {
+    int x, y;
+
+    ldd->update = 0;
+
+    ldd_max72xx_prepare(ldd, angle);  // dots changed after DrawPrepare
+
+    canvas->SetFgColor(50, 50, 50);
+    for (x = 0; x < 8; x++) {
+        for (y = 0; y < 8; y++) {
+            if (!(ldd->dots_draw[x] & (1 << y)))
+                continue;
+
+            if (ldd->dots[x] & (1 << y)) {
                 canvas->SetBgColor(250, 0, 0);
             } else {
-                canvas->SetFgColor(50, 50, 50);
                 canvas->SetBgColor(70, 70, 70);
             }
 
@@ -156,5 +185,6 @@ void ldd_max72xx_draw(ldd_max72xx_t* ldd, CCanvas* canvas, int x1, int y1, int w
                     break;
             }
         }
+        ldd->dots_draw[x] = 0;
     }
 }
@@ -63,11 +63,15 @@ typedef struct {
     unsigned short dat;
     unsigned char update;
     unsigned short dout;
+    unsigned char dots[8];       // dots lit of each draw column (bit n is row n)
+    unsigned char dots_draw[8];  // dots changed waiting draw
 } ldd_max72xx_t;
 
 void ldd_max72xx_rst(ldd_max72xx_t* ldd);
 void ldd_max72xx_init(ldd_max72xx_t* ldd);
 void ldd_max72xx_update(ldd_max72xx_t* ldd);
+void ldd_max72xx_redraw(ldd_max72xx_t* ldd);
+void ldd_max72xx_prepare(ldd_max72xx_t* ldd, int angle);
 
 unsigned char ldd_max72xx_io(ldd_max72xx_t* ldd, unsigned char din, unsigned char clk, unsigned char ncs);
 
@@ -48,12 +48,28 @@ void led_ws2812b_init(led_ws2812b_t* led, const int rows, const int cols, const
     led->nleds = rows * cols;
     led->nbits = 24 * led->nleds;
     led->color = (rgb_color*)malloc(led->nleds * sizeof(rgb_color));
+    led->shown = (unsigned int*)malloc(led->nleds * sizeof(unsigned int));
+    led->draw_color = (unsigned int*)malloc(led->nleds * sizeof(unsigned int));
+    led->draw_list = (unsigned int*)malloc(led->nleds * sizeof(unsigned int));
 
     led_ws2812b_rst(led);
+    led_ws2812b_redraw(led);
 }
 
 void led_ws2812b_end(led_ws2812b_t* led) {
     free(led->color);
+    free(led->shown);
+    free(led->draw_color);
+    free(led->draw_list);
+}
+
+void led_ws2812b_redraw(led_ws2812b_t* led) {
+    for (unsigned int i = 0; i < led->nleds; i++) {
+        led->shown[i] = 0xFFFFFFFF;  // never a received color
+        led->draw_color[i] = 0;
+    }
+    led->draw_count = 0;
+    led->update = 1;
 }
 
 void led_ws2812b_prepare(led_ws2812b_t* led, float freq) {
@@ -108,28 +124,56 @@ unsigned char led_ws2812b_io(led_ws2812b_t* led, const unsigned char din) {
     return din;
 }
 
+void led_ws2812b_draw_prepare(led_ws2812b_t* led) {
+    unsigned int index;
+    int R, G, B;
+
+    // leds not yet drawn are kept, new changes are appended
+    for (index = 0; index < led->nleds; index++) {
+        const rgb_color color = led->color[index];
+
+        if (color.fcolor == led->shown[index])
+            continue;
+
+        if (!(led->draw_color[index] & 0x80000000)) {  // not in list
+            led->draw_list[led->draw_count++] = index;
+        }
+        led->shown[index] = color.fcolor;
+
+        R = ((color.R * 4) > 255) ? 255 : (color.R * 4);
+        G = ((color.G * 4) > 255) ? 255 : (color.G * 4);
+        B = ((color.B * 4) > 255) ? 255 : (color.B * 4);
+        led->draw_color[index] = 0x80000000 | (R << 16) | (G << 8) | B;
+    }
+}
+
 void led_ws2812b_draw(led_ws2812b_t* led, CCanvas* canvas, const int x1, const int y1, const int w1, const int h1,
                       const int picpwr) {
     unsigned int x, y, index;
-    int R, G, B;
     led->update = 0;
-    canvas->SetFgColor(0, 0, 0);
-    for (x = 0; x < led->nrows; x++) {
-        for (y = 0; y < led->ncols; y++) {
-            index = (x * led->ncols) + y;
-
-            R = ((led->color[index].R * 4) > 255) ? 255 : (led->color[index].R * 4);
-            G = ((led->color[index].G * 4) > 255) ? 255 : (led->color[index].G * 4);
-            B = ((led->color[index].B * 4) > 255) ? 255 : (led->color[index].B * 4);
 
-            canvas->SetBgColor(R, G, B);
+    led_ws2812b_draw_prepare(led);  // leds changed after DrawPrepare
 
-            if (led->diffuser) {
-                canvas->Rectangle(1, x1 + (y * 40) - 8, y1 - (x * 40) - 8, w1 + 16, h1 + 16);
-            } else {
-                canvas->SetFgColor(led->color[index].R, led->color[index].G, led->color[index].B);
-                canvas->Circle(1, x1 + (y * 40) + 12, y1 - (x * 40) + 12, 7);
-            }
+    // only changed leds, the diffuser rectangles only overlap in the black border
+    canvas->SetFgColor(0, 0, 0);
+    for (unsigned int i = 0; i < led->draw_count; i++) {
+        index = led->draw_list[i];
+        x = index / led->ncols;
+        y = index % led->ncols;
+
+        const unsigned int color = led->draw_color[index];
+        led->draw_color[index] = color & 0x00FFFFFF;
+
+        canvas->SetBgColor((color & 0xFF0000) >> 16, (color & 0x00FF00) >> 8, color & 0x0000FF);
+
+        if (led->diffuser) {
+            canvas->Rectangle(1, x1 + (y * 40) - 8, y1 - (x * 40) - 8, w1 + 16, h1 + 16);
+        } else {
+            rgb_color c;
+            c.fcolor = led->shown[index];
+            canvas->SetFgColor(c.R, c.G, c.B);
+            canvas->Circle(1, x1 + (y * 40) + 12, y1 - (x * 40) + 12, 7);
         }
     }
+    led->draw_count = 0;
 }
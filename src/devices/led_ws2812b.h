@@ -65,12 +65,18 @@ typedef struct {
     unsigned short adin;
     unsigned int dat;
     unsigned char update;
+    unsigned int* shown;       // last color prepared to draw of each led
+    unsigned int* draw_color;  // brightness scaled color of each led
+    unsigned int* draw_list;   // leds changed waiting draw
+    unsigned int draw_count;
 } led_ws2812b_t;
 
 void led_ws2812b_rst(led_ws2812b_t* led);
 void led_ws2812b_init(led_ws2812b_t* led, const int rows, const int cols, const int diffuser);
 void led_ws2812b_end(led_ws2812b_t* led);
 void led_ws2812b_prepare(led_ws2812b_t* led, const float freq);
+void led_ws2812b_draw_prepare(led_ws2812b_t* led);
+void led_ws2812b_redraw(led_ws2812b_t* led);
 
 unsigned char led_ws2812b_io(led_ws2812b_t* led, const unsigned char din);
 
@@ -0,0 +1,521 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "anrecorder.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define ANREC_NB (ANREC_BLOCKS + 1)  // queued blocks plus the block being filled
+
+CAnRecorder::CAnRecorder() {
+    file = NULL;
+    recording = 0;
+    channels = 0;
+    for (int i = 0; i < ANREC_NB; i++) {
+        blocks[i] = NULL;
+        sizes[i] = 0;
+    }
+    cur = NULL;
+    used = 0;
+    qhead = 0;
+    qcount = 0;
+    qfree = 0;
+    fname[0] = 0;
+    exportname[0] = 0;
+#ifndef _NOTHREAD
+    closing = 0;
+#endif
+}
+
+CAnRecorder::~CAnRecorder() {
+    Close();
+    Sync();
+    for (int i = 0; i < ANREC_NB; i++) {
+        delete[] blocks[i];
+    }
+}
+
+int CAnRecorder::Open(const char* fname_, const int mode, const int channels_, const char* const* names,
+                      const double step, const uint32_t period) {
+    anrec_header_t header;
+
+    Close();
+    Sync();  // previous record export
+
+    if ((channels_ < 1) || (channels_ > ANREC_MAX_CH))
+        return -1;
+
+    file = fopen(fname_, "wb");
+    if (!file) {
+        printf("PICSimLab: Error creating file %s\n", fname_);
+        return -1;
+    }
+    strncpy(fname, fname_, sizeof(fname) - 1);
+    fname[sizeof(fname) - 1] = 0;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ANREC_MAGIC, 8);
+    header.version = ANREC_VERSION;
+    header.mode = mode;
+    header.channels = channels_;
+    header.period = period ? period : 1;
+    header.step = step;
+    for (int i = 0; i < channels_; i++) {
+        if (names[i]) {
+            strncpy(header.names[i], names[i], ANREC_NAME_SIZE - 1);
+        }
+    }
+    fwrite(&header, sizeof(header), 1, file);
+
+    for (int i = 0; i < ANREC_NB; i++) {
+        if (!blocks[i]) {
+            blocks[i] = new char[ANREC_BLOCK_SIZE];
+        }
+    }
+    channels = channels_;
+    qhead = 0;
+    qcount = 0;
+    qfree = 0;
+    cur = blocks[0];
+    used = 0;
+    exportname[0] = 0;
+    recording = 1;
+#ifndef _NOTHREAD
+    closing = 0;
+    writer = std::thread(&CAnRecorder::Writer, this);
+#endif
+    return 0;
+}
+
+void CAnRecorder::Finish(void) {
+    fclose(file);
+    file = NULL;
+    if (exportname[0]) {
+        anrec_export_vcd(fname, exportname);
+    }
+}
+
+#ifndef _NOTHREAD
+
+void CAnRecorder::Submit(void) {
+    std::unique_lock<std::mutex> lock(mtx);
+    sizes[qfree] = used;
+    qcount++;
+    qfree = (qfree + 1) % ANREC_NB;
+    cv_work.notify_one();
+    // all blocks queued, wait the writer
+    cv_done.wait(lock, [&] { return qcount < ANREC_NB; });
+    cur = blocks[qfree];
+    used = 0;
+}
+
+void CAnRecorder::Close(const char* vcdname) {
+    if (!recording)
+        return;
+
+    if (used) {
+        Submit();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (vcdname) {
+            strncpy(exportname, vcdname, sizeof(exportname) - 1);
+            exportname[sizeof(exportname) - 1] = 0;
+        }
+        closing = 1;
+        recording = 0;
+    }
+    cv_work.notify_one();
+}
+
+void CAnRecorder::Sync(void) {
+    if (recording) {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv_done.wait(lock, [&] { return qcount == 0; });
+        fflush(file);
+    } else if (writer.joinable()) {
+        writer.join();
+    }
+}
+
+void CAnRecorder::Writer(void) {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (1) {
+        cv_work.wait(lock, [&] { return closing || qcount; });
+        if (qcount) {
+            const int block = qhead;
+            lock.unlock();
+            fwrite(blocks[block], sizes[block], 1, file);
+            lock.lock();
+            qhead = (qhead + 1) % ANREC_NB;
+            qcount--;
+            cv_done.notify_all();
+        } else if (closing) {
+            break;
+        }
+    }
+    lock.unlock();
+    Finish();
+}
+
+#else  // _NOTHREAD
+
+void CAnRecorder::Submit(void) {
+    fwrite(cur, used, 1, file);
+    used = 0;
+}
+
+void CAnRecorder::Close(const char* vcdname) {
+    if (!recording)
+        return;
+
+    if (used) {
+        Submit();
+    }
+    if (vcdname) {
+        strncpy(exportname, vcdname, sizeof(exportname) - 1);
+        exportname[sizeof(exportname) - 1] = 0;
+    }
+    recording = 0;
+    Finish();
+}
+
+void CAnRecorder::Sync(void) {
+    if (recording) {
+        fflush(file);
+    }
+}
+
+#endif  // _NOTHREAD
+
+// record file reader used by the exporters
+typedef struct {
+    FILE* file;
+    anrec_header_t header;
+    uint64_t time;                 // time of the current values
+    float values[ANREC_MAX_CH];    // current values
+    uint32_t changed;              // channels changed at time
+    anrec_change_t next;           // next change (ANREC_CHANGES)
+    int next_valid;
+} anrec_reader_t;
+
+static int anrec_reader_open(anrec_reader_t* rd, const char* fname) {
+    memset(rd, 0, sizeof(anrec_reader_t));
+    rd->file = fopen(fname, "rb");
+    if (!rd->file)
+        return -1;
+    if ((fread(&rd->header, sizeof(anrec_header_t), 1, rd->file) != 1) ||
+        memcmp(rd->header.magic, ANREC_MAGIC, 8) || (rd->header.channels < 1) ||
+        (rd->header.channels > ANREC_MAX_CH)) {
+        printf("PICSimLab: Invalid analog record file %s\n", fname);
+        fclose(rd->file);
+        rd->file = NULL;
+        return -1;
+    }
+    if (rd->header.mode == ANREC_CHANGES) {
+        rd->next_valid = (fread(&rd->next, sizeof(anrec_change_t), 1, rd->file) == 1);
+    }
+    return 0;
+}
+
+// advance to the next time with changes, return 0 at end of file
+static int anrec_reader_next(anrec_reader_t* rd, const uint64_t index) {
+    rd->changed = 0;
+    if (rd->header.mode == ANREC_FIXED) {
+        float values[ANREC_MAX_CH];
+        if (fread(values, sizeof(float), rd->header.channels, rd->file) != rd->header.channels)
+            return 0;
+        rd->time = index * rd->header.period;
+        for (unsigned int c = 0; c < rd->header.channels; c++) {
+            if ((values[c] != rd->values[c]) || !index) {
+                rd->values[c] = values[c];
+                rd->changed |= 1 << c;
+            }
+        }
+        return 1;
+    }
+
+    if (!rd->next_valid)
+        return 0;
+    rd->time = rd->next.time;
+    while (rd->next_valid && (rd->next.time == rd->time)) {
+        if (rd->next.channel < rd->header.channels) {
+            rd->values[rd->next.channel] = rd->next.value;
+            rd->changed |= 1 << rd->next.channel;
+        }
+        rd->next_valid = (fread(&rd->next, sizeof(anrec_change_t), 1, rd->file) == 1);
+    }
+    return 1;
+}
+
+int anrec_export_csv(const char* in, const char* out) {
+    anrec_reader_t rd;
+
+    if (anrec_reader_open(&rd, in))
+        return -1;
+
+    FILE* fout = fopen(out, "w");
+    if (!fout) {
+        fclose(rd.file);
+        return -1;
+    }
+
+    fprintf(fout, "time");
+    for (unsigned int c = 0; c < rd.header.channels; c++) {
+        if (rd.header.names[c][0])
+            fprintf(fout, ",%.*s", ANREC_NAME_SIZE, rd.header.names[c]);
+    }
+    fprintf(fout, "\n");
+
+    for (uint64_t i = 0; anrec_reader_next(&rd, i); i++) {
+        fprintf(fout, "%.9g", rd.time * rd.header.step);
+        for (unsigned int c = 0; c < rd.header.channels; c++) {
+            if (rd.header.names[c][0])
+                fprintf(fout, ",%g", rd.values[c]);
+        }
+        fprintf(fout, "\n");
+    }
+
+    fclose(fout);
+    fclose(rd.file);
+    return 0;
+}
+
+int anrec_export_vcd(const char* in, const char* out) {
+    static const char markers[] = "!$%&[()]";
+    anrec_reader_t rd;
+
+    if (anrec_reader_open(&rd, in))
+        return -1;
+
+    FILE* fout = fopen(out, "w");
+    if (!fout) {
+        fclose(rd.file);
+        return -1;
+    }
+
+    int tscale = lround(rd.header.step * 1e12);  // ps
+    if (tscale < 1)
+        tscale = 1;
+
+    fprintf(fout,
+            "$version Generated by PICSimLab $end\n"
+            "$timescale %ips $end\n"
+            "$scope module analogic $end\n",
+            tscale);
+    for (unsigned int c = 0; c < rd.header.channels; c++) {
+        if (rd.header.names[c][0])
+            fprintf(fout, "$var real 32 %c  %.*s $end\n", markers[c], ANREC_NAME_SIZE, rd.header.names[c]);
+    }
+    fprintf(fout,
+            "$upscope $end\n"
+            "$enddefinitions $end\n");
+
+    for (uint64_t i = 0; anrec_reader_next(&rd, i); i++) {
+        if (!rd.changed)
+            continue;
+        fprintf(fout, "#%llu\n", (unsigned long long)rd.time);
+        for (unsigned int c = 0; c < rd.header.channels; c++) {
+            if ((rd.changed & (1 << c)) && rd.header.names[c][0])
+                fprintf(fout, "r%f %c\n", rd.values[c], markers[c]);
+        }
+    }
+
+    fclose(fout);
+    fclose(rd.file);
+    return 0;
+}
+
+// write a change of the importers, return 0 on success
+static int anrec_write_change(FILE* fout, const uint64_t time, const int channel, const float value) {
+    anrec_change_t ch;
+
+    memset(&ch, 0, sizeof(ch));
+    ch.time = time;
+    ch.channel = channel;
+    ch.value = value;
+    return fwrite(&ch, sizeof(ch), 1, fout) != 1;
+}
+
+int anrec_import_csv(const char* in, const char* out, const double step) {
+    anrec_header_t header;
+    char line[1024];
+    float last[ANREC_MAX_CH];
+
+    memset(last, 0, sizeof(last));
+
+    if (step <= 0)
+        return -1;
+
+    FILE* fin = fopen(in, "r");
+    if (!fin)
+        return -1;
+
+    if (!fgets(line, sizeof(line), fin)) {
+        fclose(fin);
+        return -1;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ANREC_MAGIC, 8);
+    header.version = ANREC_VERSION;
+    header.mode = ANREC_CHANGES;
+    header.period = 1;
+    header.step = step;
+
+    // header line: time,name1,name2,...
+    char* tok = strtok(line, ",\r\n");
+    while ((tok = strtok(NULL, ",\r\n")) && (header.channels < ANREC_MAX_CH)) {
+        strncpy(header.names[header.channels++], tok, ANREC_NAME_SIZE - 1);
+    }
+    if (!header.channels) {
+        fclose(fin);
+        return -1;
+    }
+
+    FILE* fout = fopen(out, "wb");
+    if (!fout) {
+        fclose(fin);
+        return -1;
+    }
+    fwrite(&header, sizeof(header), 1, fout);
+
+    int first = 1;
+    while (fgets(line, sizeof(line), fin)) {
+        char* end;
+        const double t = strtod(line, &end);
+        if (end == line)
+            continue;
+        const uint64_t time = (uint64_t)llround(t / step);
+        for (unsigned int c = 0; c < header.channels; c++) {
+            if (*end != ',')
+                break;
+            char* vstart = end + 1;
+            const float v = strtof(vstart, &end);
+            if (end == vstart)
+                break;
+            if (first || (v != last[c])) {
+                last[c] = v;
+                anrec_write_change(fout, time, c, v);
+            }
+        }
+        first = 0;
+    }
+
+    fclose(fout);
+    fclose(fin);
+    return 0;
+}
+
+int anrec_import_vcd(const char* in, const char* out) {
+    anrec_header_t header;
+    char ids[ANREC_MAX_CH][16];
+    char line[1024];
+    uint64_t time = 0;
+
+    FILE* fin = fopen(in, "r");
+    if (!fin)
+        return -1;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ANREC_MAGIC, 8);
+    header.version = ANREC_VERSION;
+    header.mode = ANREC_CHANGES;
+    header.period = 1;
+    header.step = 1e-9;
+
+    // declarations
+    int defs = 1;
+    while (defs && fgets(line, sizeof(line), fin)) {
+        char type[16], id[16], name[64];
+        int size;
+        if (sscanf(line, " $var %15s %i %15s %63s", type, &size, id, name) == 4) {
+            if ((header.channels < ANREC_MAX_CH) && (!strcmp(type, "real") || (size == 1))) {
+                strcpy(ids[header.channels], id);
+                snprintf(header.names[header.channels++], ANREC_NAME_SIZE, "%.*s", ANREC_NAME_SIZE - 1, name);
+            }
+        } else if (strstr(line, "$timescale")) {
+            char* p = strstr(line, "$timescale") + 10;
+            if (!strchr(p, 's') && fgets(line, sizeof(line), fin))
+                p = line;
+            double mult = 1;
+            char unit[4] = "ns";
+            sscanf(p, " %lf %3[a-z]", &mult, unit);
+            const char* units[] = {"s", "ms", "us", "ns", "ps", "fs"};
+            for (int u = 0; u < 6; u++) {
+                if (!strcmp(unit, units[u]))
+                    header.step = mult * pow(10, -3 * u);
+            }
+        } else if (strstr(line, "$enddefinitions")) {
+            defs = 0;
+        }
+    }
+
+    if (!header.channels) {
+        fclose(fin);
+        return -1;
+    }
+
+    FILE* fout = fopen(out, "wb");
+    if (!fout) {
+        fclose(fin);
+        return -1;
+    }
+    fwrite(&header, sizeof(header), 1, fout);
+
+    // value changes
+    while (fgets(line, sizeof(line), fin)) {
+        char id[16];
+        float value;
+        const char* vid = NULL;
+
+        line[strcspn(line, "\r\n")] = 0;
+        if (line[0] == '#') {
+            time = strtoull(line + 1, NULL, 10);
+            continue;
+        } else if ((line[0] == 'r') || (line[0] == 'R')) {
+            if (sscanf(line + 1, "%f %15s", &value, id) != 2)
+                continue;
+            vid = id;
+        } else if ((line[0] == '0') || (line[0] == '1')) {
+            value = line[0] - '0';
+            vid = line + 1;
+        } else {
+            continue;
+        }
+
+        for (unsigned int c = 0; c < header.channels; c++) {
+            if (!strcmp(ids[c], vid)) {
+                anrec_write_change(fout, time, c, value);
+                break;
+            }
+        }
+    }
+
+    fclose(fout);
+    fclose(fin);
+    return 0;
+}
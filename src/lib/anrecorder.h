@@ -0,0 +1,193 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef ANRECORDER_H
+#define ANRECORDER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _NOTHREAD
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+#define ANREC_MAGIC "PSLANREC"
+#define ANREC_VERSION 1
+#define ANREC_MAX_CH 8
+#define ANREC_NAME_SIZE 32
+#define ANREC_BLOCK_SIZE 65536  // bytes per write block
+#define ANREC_BLOCKS 16         // blocks queued to the writer
+
+// recording modes
+enum { ANREC_CHANGES = 0, ANREC_FIXED };
+
+/**
+ * @brief Analog record file header
+ *
+ * The header is followed by an array of anrec_change_t (ANREC_CHANGES mode)
+ * or an array of float[channels] samples taken every period steps
+ * (ANREC_FIXED mode), so the file can be memory-mapped and indexed directly.
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t mode;      ///< ANREC_CHANGES or ANREC_FIXED
+    uint32_t channels;  ///< number of channels
+    uint32_t period;    ///< steps between samples in ANREC_FIXED mode
+    double step;        ///< time of one step in seconds
+    char names[ANREC_MAX_CH][ANREC_NAME_SIZE];  ///< channel names, empty if unused
+} anrec_header_t;
+
+/**
+ * @brief Analog record value change
+ */
+typedef struct {
+    uint64_t time;     ///< time in steps
+    uint32_t channel;  ///< channel number
+    float value;       ///< new value
+} anrec_change_t;
+
+/**
+ * @brief Streaming analog recorder
+ *
+ * Samples are appended to memory blocks in the simulation thread and a
+ * background thread writes the full blocks to disk, so recording costs a
+ * copy per sample and no file access in the simulation loop.
+ */
+class CAnRecorder {
+public:
+    CAnRecorder();
+    ~CAnRecorder();
+
+    /**
+     * @brief Create the record file, return 0 on success
+     */
+    int Open(const char* fname, const int mode, const int channels, const char* const* names, const double step,
+             const uint32_t period);
+
+    /**
+     * @brief Write pending data and close the file, if vcdname is not NULL export it to VCD in background
+     */
+    void Close(const char* vcdname = NULL);
+
+    /**
+     * @brief Wait until the queued blocks are written to disk, or the export of Close has finished
+     */
+    void Sync(void);
+
+    /**
+     * @brief Queue the partly filled block and wait it be written to disk (call with the producer stopped)
+     */
+    void Flush(void) {
+        if (recording && used)
+            Submit();
+        Sync();
+    };
+
+    /**
+     * @brief Return 1 if recording
+     */
+    int IsOpen(void) { return recording; };
+
+    /**
+     * @brief Append a channel value change (ANREC_CHANGES mode)
+     */
+    void AddChange(const uint64_t time, const int channel, const float value) {
+        if (used + sizeof(anrec_change_t) > ANREC_BLOCK_SIZE)
+            Submit();
+        anrec_change_t* ch = (anrec_change_t*)(cur + used);
+        ch->time = time;
+        ch->channel = channel;
+        ch->value = value;
+        used += sizeof(anrec_change_t);
+    };
+
+    /**
+     * @brief Append one sample of all channels (ANREC_FIXED mode)
+     */
+    void AddSample(const float* values) {
+        const unsigned int size = channels * sizeof(float);
+        if (used + size > ANREC_BLOCK_SIZE)
+            Submit();
+        memcpy(cur + used, values, size);
+        used += size;
+    };
+
+private:
+    FILE* file;
+    int recording;
+    int channels;
+    char* blocks[ANREC_BLOCKS + 1];
+    unsigned int sizes[ANREC_BLOCKS + 1];
+    char* cur;          // block being filled
+    unsigned int used;  // bytes used in cur block
+    int qhead;          // next block to write
+    int qcount;         // blocks waiting to be written
+    int qfree;          // block being filled
+    char fname[512];
+    char exportname[512];
+#ifndef _NOTHREAD
+    std::thread writer;
+    std::mutex mtx;
+    std::condition_variable cv_work;
+    std::condition_variable cv_done;
+    int closing;
+
+    void Writer(void);
+#endif
+    /**
+     * @brief Close the file and export it if requested
+     */
+    void Finish(void);
+    /**
+     * @brief Queue the current block to be written and get a new one
+     */
+    void Submit(void);
+};
+
+/**
+ * @brief Export record file to CSV (time in seconds and one column per channel), return 0 on success
+ */
+int anrec_export_csv(const char* in, const char* out);
+
+/**
+ * @brief Export record file to VCD with real variables, return 0 on success
+ */
+int anrec_export_vcd(const char* in, const char* out);
+
+/**
+ * @brief Import CSV (time in seconds and one column per channel) to record file with step resolution
+ */
+int anrec_import_csv(const char* in, const char* out, const double step);
+
+/**
+ * @brief Import real and scalar variables of VCD to record file, return 0 on success
+ */
+int anrec_import_vcd(const char* in, const char* out);
+
+#endif /* ANRECORDER_H */
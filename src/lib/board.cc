@@ -24,9 +24,10 @@
    ######################################################################## */
 
 #include "board.h"
+#include "logicrec.h"
+#include "mapfile.h"
 #include "picsimlab.h"
-
-int ioupdated = 0;
+#include "protodecoder.h"
 
 board::board(void) {
     ioupdated = 1;
@@ -37,240 +38,110 @@ board::board(void) {
     Proc = "";
     p_RST = 1;
     Scale = PICSimLab.GetScale();
-    InstCounter = 0;
-    TimersCount = 0;
-    for (int i = 0; i < MAX_TIMERS; i++) {
-        Timers[i].Arg = NULL;
-        Timers[i].Callback = NULL;
-        Timers[i].Enabled = 0;
-    }
+    input = NULL;
+    output = NULL;
+    memset(&input_none, 0, sizeof(input_t));
+    memset(&output_none, 0, sizeof(output_t));
     for (int i = 0; i < MAX_IDS; i++) {
-        input_ids[i] = &input[i];
-        output_ids[i] = &output[i];
+        input_ids[i] = &input_none;
+        output_ids[i] = &output_none;
     }
 }
 
-board::~board(void) {}
+board::~board(void) {
+    FreeMaps();
+}
 
 void board::ReadMaps(void) {
-    inputc = 0;
-    outputc = 0;
-    ReadInputMap(lxGetLocalFile(PICSimLab.GetSharePath() + lxT("boards/") + GetMapFile()));
-    ReadOutputMap(lxGetLocalFile(PICSimLab.GetSharePath() + lxT("boards/") + GetMapFile()));
+    lxString fname = lxGetLocalFile(PICSimLab.GetSharePath() + lxT("boards/") + GetMapFile());
+    const mapfile_t* map = MapFiles.Get(fname);
 
-    for (int i = 0; i < inputc; i++) {
-        input_ids[GetInputId(input[i].name)] = &input[i];
-    }
+    FreeMaps();
 
-    for (int i = 0; i < outputc; i++) {
-        output_ids[GetOutputId(output[i].name)] = &output[i];
+    if (!map) {
+        printf("PICSimLab: Error open map \"%s\"!\n", (const char*)fname.c_str());
+        PICSimLab.RegisterError("Error open map:\n" + fname);
+        return;
     }
-}
 
-void board::ReadInputMap(lxString fname) {
-    FILE* fin;
-
-    char line[256];
-
-    char* it;
-    char* shape;
-    char* coords;
-    char* name;
-    char* value;
-
-    int board_w = 0;
-    int board_h = 0;
-
-    int x1, y1, x2, y2, r;
-
-    fin = fopen(fname.c_str(), "r");
-
-    if (fin) {
-        while (fgets(line, 256, fin)) {
-            it = strtok(line, "< =\"");
-            if (!strcmp("img", it)) {
-                do {
-                    name = strtok(NULL, "< =\"");
-                    value = strtok(NULL, "<=\"");
-
-                    if (!strcmp("width", name)) {
-                        sscanf(value, "%i", &board_w);
-                        PICSimLab.SetplWidth(board_w);
-
-                        unsigned int ww = 185 + board_w * PICSimLab.GetScale();
-                        if (ww > lxGetDisplayWidth(0)) {
-                            float scalex = ((lxGetDisplayWidth(0) - 185) * 1.0) / board_w;
-                            if (PICSimLab.GetWindow()) {
-                                ((CDraw*)PICSimLab.GetWindow()->GetChildByName("draw1"))->SetWidth(board_w * scalex);
-                                PICSimLab.GetWindow()->SetWidth(lxGetDisplayWidth(0));
-                            }
-                            if (scalex < Scale) {
-                                Scale = scalex;
-                            }
-                        } else {
-                            if (PICSimLab.GetWindow()) {
-                                ((CDraw*)PICSimLab.GetWindow()->GetChildByName("draw1"))
-                                    ->SetWidth(board_w * PICSimLab.GetScale());
-                                PICSimLab.GetWindow()->SetWidth(ww);
-                            }
-                        }
-                    }
-
-                    if (!strcmp("height", name)) {
-                        sscanf(value, "%i", &board_h);
-                        PICSimLab.SetplHeight(board_h);
-
-                        unsigned int wh = 90 + board_h * PICSimLab.GetScale();
-
-                        if (wh > lxGetDisplayHeight(0)) {
-                            float scaley = ((lxGetDisplayHeight(0) - 90) * 1.0) / board_h;
-
-                            if (PICSimLab.GetWindow()) {
-                                ((CDraw*)PICSimLab.GetWindow()->GetChildByName("draw1"))->SetHeight(board_h * scaley);
-                                PICSimLab.GetWindow()->SetHeight(lxGetDisplayHeight(0));
-                                PICSimLab.GetWindow()->SetWidth(185 + board_w * scaley);
-                            }
-                            if (scaley < Scale) {
-                                Scale = scaley;
-                            }
-                        } else {
-                            if (PICSimLab.GetWindow()) {
-                                ((CDraw*)PICSimLab.GetWindow()->GetChildByName("draw1"))
-                                    ->SetHeight(board_h * PICSimLab.GetScale());
-                                PICSimLab.GetWindow()->SetHeight(wh);
-                            }
-                        }
-                    }
-
-                } while (value != NULL);
-
-                //        printf("%s %s %s\n",name,shape,coords);
-
-            } else if (!strcmp("area", it)) {
-                strtok(NULL, "< =\"");
-                shape = strtok(NULL, "< =\"");
-                strtok(NULL, "< =\"");
-                coords = strtok(NULL, "< =\"");
-                strtok(NULL, "< =\"");
-                name = strtok(NULL, "< =\"");
-
-                //        printf("%s %s %s\n",name,shape,coords);
-                if (((name[0] == 'I') || (name[0] == 'B')) && (name[1] == '_')) {
-                    if (strcmp("rect", shape) == 0) {
-                        sscanf(coords, "%i,%i,%i,%i\n", &x1, &y1, &x2, &y2);
-                        //          printf("rect=%i,%i,%i,%i\n",x1,y1,x2,y2);
-
-                        input[inputc].x1 = x1;
-                        input[inputc].y1 = y1;
-                        input[inputc].x2 = x2;
-                        input[inputc].y2 = y2;
-                    } else {
-                        sscanf(coords, "%i,%i,%i\n", &x1, &y1, &r);
-                        //          printf("circle=%i,%i,%i\n",x1,y1,r);
-                        input[inputc].x1 = x1 - r;
-                        input[inputc].y1 = y1 - r;
-                        input[inputc].x2 = x1 + r;
-                        input[inputc].y2 = y1 + r;
-                    }
-                    strcpy(input[inputc].name, name + 2);
-                    input[inputc].id = GetInputId(input[inputc].name);
-                    input[inputc].cx = ((input[inputc].x2 - input[inputc].x1) / 2.0) + input[inputc].x1;
-                    input[inputc].cy = ((input[inputc].y2 - input[inputc].y1) / 2.0) + input[inputc].y1;
-                    input[inputc].status = NULL;
-                    input[inputc].update = NULL;
-                    input[inputc].value = 0;
-                    input[inputc].value_s = 0;
-                    input[inputc].value_f = 0;
-                    inputc++;
-                    if (inputc >= MAX_IDS) {
-                        printf("PICSimLab: Error! inputc greater than MAX_IDS \n");
-                        exit(-1);
-                    }
-                }
+    const int board_w = map->width;
+    const int board_h = map->height;
+
+    if (board_w) {
+        PICSimLab.SetplWidth(board_w);
+
+        unsigned int ww = 185 + board_w * PICSimLab.GetScale();
+        if (ww > lxGetDisplayWidth(0)) {
+            float scalex = ((lxGetDisplayWidth(0) - 185) * 1.0) / board_w;
+            if (PICSimLab.GetWindow()) {
+                ((CDraw*)PICSimLab.GetWindow()->GetChildByName("draw1"))->SetWidth(board_w * scalex);
+                PICSimLab.GetWindow()->SetWidth(lxGetDisplayWidth(0));
+            }
+            if (scalex < Scale) {
+                Scale = scalex;
+            }
+        } else {
+            if (PICSimLab.GetWindow()) {
+                ((CDraw*)PICSimLab.GetWindow()->GetChildByName("draw1"))->SetWidth(board_w * PICSimLab.GetScale());
+                PICSimLab.GetWindow()->SetWidth(ww);
             }
         }
-        fclose(fin);
-    } else {
-        printf("PICSimLab: Error open input.map \"%s\"!\n", (const char*)fname.c_str());
-        PICSimLab.RegisterError("Error open input.map:\n" + fname);
     }
-}
 
-void board::ReadOutputMap(lxString fname) {
-    FILE* fin;
-
-    char line[256];
-
-    char* it;
-    char* shape;
-    char* coords;
-    char* name;
-
-    int x1, y1, x2, y2, r;
-
-    fin = fopen(fname.c_str(), "r");
-
-    if (fin) {
-        while (fgets(line, 256, fin)) {
-            it = strtok(line, "< =\"");
-            if (!strcmp("area", it)) {
-                strtok(NULL, "< =\"");
-                shape = strtok(NULL, "< =\"");
-                strtok(NULL, "< =\"");
-                coords = strtok(NULL, "< =\"");
-                strtok(NULL, "< =\"");
-                name = strtok(NULL, "< =\"");
-
-                //        printf("%s %s %s\n",name,shape,coords);
-                if (((name[0] == 'O') || (name[0] == 'B')) && (name[1] == '_')) {
-                    if (!strcmp("rect", shape)) {
-                        sscanf(coords, "%i,%i,%i,%i\n", &x1, &y1, &x2, &y2);
-                        //          printf("rect=%i,%i,%i,%i\n",x1,y1,x2,y2);
-                        output[outputc].x1 = x1;
-                        output[outputc].y1 = y1;
-                        output[outputc].x2 = x2;
-                        output[outputc].y2 = y2;
-                        output[outputc].r = 0;
-                        strcpy(output[outputc].name, name + 2);
-                        output[outputc].id = GetOutputId(output[outputc].name);
-                        output[outputc].cx = ((output[outputc].x2 - output[outputc].x1) / 2.0) + output[outputc].x1;
-                        output[outputc].cy = ((output[outputc].y2 - output[outputc].y1) / 2.0) + output[outputc].y1;
-                        output[outputc].status = NULL;
-                        output[outputc].value = 0;
-                        output[outputc].value_s = 0;
-                        output[outputc].value_f = 0;
-                        outputc++;
-                    } else {
-                        sscanf(coords, "%i,%i,%i\n", &x1, &y1, &r);
-                        //          printf("circle=%i,%i,%i\n",x1,y1,r);
-                        output[outputc].x1 = x1;
-                        output[outputc].y1 = y1;
-                        output[outputc].x2 = 0;
-                        output[outputc].y2 = 0;
-                        output[outputc].r = r;
-                        strcpy(output[outputc].name, name + 2);
-                        output[outputc].id = GetOutputId(output[outputc].name);
-                        output[outputc].cx = output[outputc].x1;
-                        output[outputc].cy = output[outputc].y1;
-                        output[outputc].status = NULL;
-                        output[outputc].value = 0;
-                        output[outputc].value_s = 0;
-                        output[outputc].value_f = 0;
-                        outputc++;
-                    }
-                    if (outputc >= MAX_IDS) {
-                        printf("PICSimLab: Error! outputc greater than MAX_IDS \n");
-                        exit(-1);
-                    }
-                }
+    if (board_h) {
+        PICSimLab.SetplHeight(board_h);
+
+        unsigned int wh = 90 + board_h * PICSimLab.GetScale();
+
+        if (wh > lxGetDisplayHeight(0)) {
+            float scaley = ((lxGetDisplayHeight(0) - 90) * 1.0) / board_h;
+
+            if (PICSimLab.GetWindow()) {
+                ((CDraw*)PICSimLab.GetWindow()->GetChildByName("draw1"))->SetHeight(board_h * scaley);
+                PICSimLab.GetWindow()->SetHeight(lxGetDisplayHeight(0));
+                PICSimLab.GetWindow()->SetWidth(185 + board_w * scaley);
+            }
+            if (scaley < Scale) {
+                Scale = scaley;
+            }
+        } else {
+            if (PICSimLab.GetWindow()) {
+                ((CDraw*)PICSimLab.GetWindow()->GetChildByName("draw1"))->SetHeight(board_h * PICSimLab.GetScale());
+                PICSimLab.GetWindow()->SetHeight(wh);
             }
         }
+    }
 
-        fclose(fin);
-    } else {
-        printf("PICSimLab: Error open output.map \"%s\"!\n", (const char*)fname.c_str());
-        PICSimLab.RegisterError("Error open output.map:\n" + fname);
+    // only the elements present in map are copied from the shared parsed map
+    inputc = map->inputc;
+    input = new input_t[inputc];
+    for (int i = 0; i < inputc; i++) {
+        input[i] = map->input[i];
+        input[i].id = GetInputId(input[i].name);
+        input_ids[input[i].id] = &input[i];
     }
+
+    outputc = map->outputc;
+    output = new output_t[outputc];
+    for (int i = 0; i < outputc; i++) {
+        output[i] = map->output[i];
+        output[i].id = GetOutputId(output[i].name);
+        output[i].update = 1;
+        output_ids[output[i].id] = &output[i];
+    }
+}
+
+void board::FreeMaps(void) {
+    for (int i = 0; i < MAX_IDS; i++) {
+        input_ids[i] = &input_none;
+        output_ids[i] = &output_none;
+    }
+    delete[] input;
+    delete[] output;
+    input = NULL;
+    output = NULL;
+    inputc = 0;
+    outputc = 0;
 }
 
 void board::RefreshStatus(void) {
@@ -377,139 +248,70 @@ void board::StartThread(void) {
 #endif
 }
 
-void board::InstCounterInc(void) {
-    InstCounter++;
-    for (int t = 0; t < TimersCount; t++) {
-        if (TimersList[t]->Enabled) {
-            TimersList[t]->Timer--;
-            if (!TimersList[t]->Timer) {
-                (*TimersList[t]->Callback)(TimersList[t]->Arg);
-                TimersList[t]->Timer = TimersList[t]->Reload;
-            }
-        }
-    }
-}
-
 int board::TimerRegister_us(const double micros, void (*Callback)(void* arg), void* arg) {
-    if (TimersCount < MAX_TIMERS) {
-        int timern = 0;
-        for (int i = 0; i < MAX_TIMERS; i++) {
-            if (Timers[i].Callback == NULL) {
-                timern = i + 1;
-                break;
-            }
-        }
-        TimerChange_us(timern, micros);
-        Timers[timern - 1].Callback = Callback;
-        Timers[timern - 1].Arg = arg;
-        Timers[timern - 1].Enabled = 1;
-        TimersList[TimersCount] = &Timers[timern - 1];
-        TimersCount++;
-        return timern;
-    }
-    return -1;
+    uint32_t reload = micros * 1e-6 * MGetInstClockFreq();
+    return TimerQueue.Register(reload, micros, Callback, arg);
 }
 
 int board::TimerRegister_ms(const double miles, void (*Callback)(void* arg), void* arg) {
-    if (TimersCount < MAX_TIMERS) {
-        int timern = 0;
-        for (int i = 0; i < MAX_TIMERS; i++) {
-            if (Timers[i].Callback == NULL) {
-                timern = i + 1;
-                break;
-            }
-        }
-        TimerChange_ms(timern, miles);
-        Timers[timern - 1].Callback = Callback;
-        Timers[timern - 1].Arg = arg;
-        Timers[timern - 1].Enabled = 1;
-        TimersList[TimersCount] = &Timers[timern - 1];
-        TimersCount++;
-        return timern;
-    }
-    return -1;
+    uint32_t reload = miles * 1e-3 * MGetInstClockFreq();
+    return TimerQueue.Register(reload, miles * 1e3, Callback, arg);
 }
 
 int board::TimerUnregister(const int timer) {
-    if (timer <= MAX_TIMERS) {
-        Timers[timer - 1].Callback = NULL;  // free timer
-
-        int tltimer = 0;
-        for (int t = 0; t < TimersCount; t++) {
-            if (TimersList[t] == &Timers[timer - 1]) {
-                tltimer = t;
-            }
-        }
-
-        for (int t = tltimer; t < (TimersCount - 1); t++) {
-            TimersList[t] = TimersList[t + 1];
-        }
-        TimersCount--;
-        TimersList[TimersCount] = NULL;
-        return 0;
-    }
-    return -1;
+    return TimerQueue.Unregister(timer);
 }
 
 int board::TimerChange_us(const int timer, const double micros) {
-    if (timer <= MAX_TIMERS) {
-        Timers[timer - 1].Reload = micros * 1e-6 * MGetInstClockFreq();
-        if (Timers[timer - 1].Reload <= 0) {
-            Timers[timer - 1].Reload = 1;
-        }
-        Timers[timer - 1].Timer = Timers[timer - 1].Reload;
-        Timers[timer - 1].Tout = micros;
-        return 0;
-    }
-    return -1;
+    uint32_t reload = micros * 1e-6 * MGetInstClockFreq();
+    return TimerQueue.Change(timer, reload, micros);
 }
 
 int board::TimerChange_ms(const int timer, const double miles) {
-    if (timer <= MAX_TIMERS) {
-        Timers[timer - 1].Reload = miles * 1e-3 * MGetInstClockFreq();
-        if (Timers[timer - 1].Reload <= 0) {
-            Timers[timer - 1].Reload = 1;
-        }
-        Timers[timer - 1].Timer = Timers[timer - 1].Reload;
-        Timers[timer - 1].Tout = miles * 1e3;
-        return 0;
-    }
-    return -1;
+    uint32_t reload = miles * 1e-3 * MGetInstClockFreq();
+    return TimerQueue.Change(timer, reload, miles * 1e3);
 }
 
 int board::TimerSetState(const int timer, const int enabled) {
-    if (timer <= MAX_TIMERS) {
-        Timers[timer - 1].Enabled = enabled;
-        if (enabled) {
-            Timers[timer - 1].Timer = Timers[timer - 1].Reload;
-        }
-        return 0;
-    }
-    return -1;
+    return TimerQueue.SetState(timer, enabled);
 }
 
 uint64_t board::TimerGet_ns(const int timer) {
-    if (timer <= MAX_TIMERS) {
-        return (Timers[timer - 1].Reload * 1e9) / MGetInstClockFreq();
+    Timers_t* t = TimerQueue.Get(timer);
+    if (t) {
+        return (t->Reload * 1e9) / MGetInstClockFreq();
     }
     return -1;
 }
 
 uint32_t board::GetInstCounter_us(const uint32_t start) {
-    return ((InstCounter - start) * 1e6) / MGetInstClockFreq();
+    return ((GetInstCounter() - start) * 1e6) / MGetInstClockFreq();
+}
+
+void board::ScanPins(void) {
+    const uint64_t now = TimerQueue.GetNow();
+    PinActivity.Scan((uint32_t)now);
+    // qemu and remote boards feed the recorder and the decoders on each pins update
+    if (LogicRecorder.Enter(now)) {
+        LogicRecorder.Scan(now);
+        LogicRecorder.Leave();
+    }
+    if (ProtoDecoder.Enter(now)) {
+        ProtoDecoder.Scan(now);
+        ProtoDecoder.Leave(now);
+    }
 }
 
 uint32_t board::GetInstCounter_ms(const uint32_t start) {
-    return ((InstCounter - start) * 1e3) / MGetInstClockFreq();
+    return ((GetInstCounter() - start) * 1e3) / MGetInstClockFreq();
 }
 
 void board::TimerUpdateFrequency(float freq) {
-    for (int t = 0; t < TimersCount; t++) {
-        TimersList[t]->Reload = TimersList[t]->Tout * 1e-6 * MGetInstClockFreq();
-        if (TimersList[t]->Reload <= 0) {
-            TimersList[t]->Reload = 1;
+    for (int timer = 1; timer <= MAX_TIMERS; timer++) {
+        Timers_t* t = TimerQueue.Get(timer);
+        if (t) {
+            TimerQueue.Change(timer, t->Tout * 1e-6 * MGetInstClockFreq(), t->Tout);
         }
-        TimersList[t]->Timer = TimersList[t]->Reload;
     }
 }
 
@@ -536,7 +338,7 @@ board* create_board(int* lab, int* lab_) {
     return pboard;
 }
 
-void board_register(const char* name, board_create_func bcreate) {
+void board_register(const char* name, board_create_func bcreate, const int reentrant) {
     int in;
 
     if (BOARDS_LAST == BOARDS_MAX) {
@@ -557,6 +359,7 @@ void board_register(const char* name, board_create_func bcreate) {
 
     // insert new
     boards_list[in].bcreate = bcreate;
+    boards_list[in].reentrant = reentrant;
     strncpy(boards_list[in].name, name, 30);
 
     for (unsigned int i = 0; i <= strlen(name); i++) {
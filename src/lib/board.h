@@ -30,6 +30,9 @@
 #include <picsim/picsim.h>
 #include <stdint.h>
 
+#include "pinactivity.h"
+#include "timerqueue.h"
+
 #define INCOMPLETE                                                      \
     printf("Incomplete: %s -> %s :%i\n", __func__, __FILE__, __LINE__); \
     exit(-1);
@@ -81,25 +84,10 @@ typedef struct {
     };
 } output_t;
 
-#define MAX_TIMERS 256
-
 #define MAX_IDS 128
 
 #define INVALID_ID (MAX_IDS - 1)
 
-/**
- * @brief internal timer struct
- *
- */
-typedef struct {
-    uint32_t Timer;
-    uint32_t Reload;
-    void* Arg;
-    void (*Callback)(void* arg);
-    int Enabled;
-    double Tout;  // in us
-} Timers_t;
-
 /**
  * @brief Board class
  *
@@ -212,6 +200,11 @@ public:
      */
     board(void);
 
+    /**
+     * @brief  The simulator backend keeps all its state in the board object (can run in worker contexts)
+     */
+    static const int reentrant = 0;
+
     /**
      * @brief  Called once on board destruction
      */
@@ -560,7 +553,12 @@ public:
     /**
      * @brief Get instruction counter
      */
-    uint32_t GetInstCounter(void) { return InstCounter; };
+    uint32_t GetInstCounter(void) { return (uint32_t)TimerQueue.GetNow(); };
+
+    /**
+     * @brief Record the pins changes of boards that don't use the stepping kernel
+     */
+    void ScanPins(void);
 
     /**
      * @brief Get elapsed time from instruction counter in us
@@ -572,6 +570,11 @@ public:
      */
     uint32_t GetInstCounter_ms(const uint32_t start);
 
+    /**
+     * @brief Get the duty cycle (0-1) of pin (0 based) integrated in the last frame
+     */
+    float GetPinDuty(const int pin) { return PinActivity.GetDuty(pin); };
+
     /**
      * @brief Register a new timer with time in us (default enabled)
      */
@@ -632,6 +635,36 @@ public:
      */
     virtual int GetUARTTX(const int uart_num) { return 0; };
 
+    /**
+     * @brief Stepping kernel hook called before each instruction, jump is set once every JUMPSTEPS
+     */
+    void StepPre(const int jump){};
+
+    /**
+     * @brief Stepping kernel hook to run one instruction and update ioupdated
+     */
+    void StepCore(void) { MStep(); };
+
+    /**
+     * @brief Stepping kernel hook called after the instruction counter increment
+     */
+    void StepHardware(void){};
+
+    /**
+     * @brief Stepping kernel hook called after oscilloscope and spare parts process
+     */
+    void StepPost(const int jump){};
+
+    /**
+     * @brief Stepping kernel hook called at end of each step
+     */
+    void StepEnd(void){};
+
+    /**
+     * @brief Stepping kernel hook, return 0 if the board needs oscilloscope and spare parts process in this step
+     */
+    int StepQuiet(void) { return 1; };
+
 protected:
     /**
      * @brief Register remote control variables
@@ -639,22 +672,34 @@ protected:
     virtual void RegisterRemoteControl(void){};
 
     /**
-     * @brief Increment the Intructions Counter
+     * @brief Increment the Intructions Counter, return 1 if any timer callback was called
      */
-    void InstCounterInc(void);
+    int InstCounterInc(void) { return TimerQueue.Step(); };
+
+    /**
+     * @brief Run nstep instructions of board B integrating pins activity in PinActivity (defined in stepkernel.h)
+     *
+     * The Step* hooks are resolved at compile time from B and the oscilloscope and spare parts flags are
+     * resolved once per call, so the loop has no virtual calls nor feature tests per instruction.
+     */
+    template <class B>
+    void RunSteps(B* b, const picpin* pins, const int pinc, const long int nstep, const int jumpsteps);
 
     lxString Proc;                  ///< Name of processor in use
     lxString DProc;                 ///< Name of default board processor
-    input_t input[MAX_IDS];         ///< input map elements
+    input_t* input;                 ///< input map elements
     input_t* input_ids[MAX_IDS];    ///< input map elements by id order
-    output_t output[MAX_IDS];       ///< output map elements
+    output_t* output;               ///< output map elements
     output_t* output_ids[MAX_IDS];  ///< output map elements by id order
+    input_t input_none;             ///< target of input ids not present in map
+    output_t output_none;           ///< target of output ids not present in map
     int inputc;                     ///< input map elements counter
     int outputc;                    ///< output map elements counter
     int use_oscope;                 ///< use oscilloscope window
     int use_spare;                  ///< use spare parts window
     unsigned char p_RST;            ///< board /RESET pin state
     double Scale;
+    CPinActivity PinActivity;       ///< pins duty cycle integrator
 
     /**
      * @brief  Read maps
@@ -667,43 +712,39 @@ protected:
     void StartThread(void);
 
 private:
-    uint32_t InstCounter;
-    int TimersCount;
-    Timers_t Timers[MAX_TIMERS];
-    Timers_t* TimersList[MAX_TIMERS];
+    CTimerQueue TimerQueue;
 
-    /**
-     * @brief Read the Input Map
-     */
-    void ReadInputMap(lxString fname);
+    template <class B, const int OSCOPE, const int SPARE>
+    void RunStepsT(B* b, const long int nstep, const int jumpsteps);
 
     /**
-     * @brief Read the Output Map
+     * @brief Free the map elements of board
      */
-    void ReadOutputMap(lxString fname);
+    void FreeMaps(void);
 };
 
-extern int ioupdated;
+// Pins updated flag of the simulation context bound to the calling thread (simcontext.h)
+extern thread_local int& ioupdated;
 
 #endif /* BOARD_H */
 
 #ifndef BOARDS_DEFS_H
 #define BOARDS_DEFS_H
 
-#define board_init(name, function)                                  \
-    static board* function##_create(void) {                         \
-        board* b = new function();                                  \
-        b->SetDefaultProcessor(b->GetProcessorName());              \
-        return b;                                                   \
-    };                                                              \
-    static void __attribute__((constructor)) function##_init(void); \
-    static void function##_init(void) {                             \
-        board_register(name, function##_create);                    \
+#define board_init(name, function)                                    \
+    static board* function##_create(void) {                           \
+        board* b = new function();                                    \
+        b->SetDefaultProcessor(b->GetProcessorName());                \
+        return b;                                                     \
+    };                                                                \
+    static void __attribute__((constructor)) function##_init(void);   \
+    static void function##_init(void) {                               \
+        board_register(name, function##_create, function::reentrant); \
     }
 
 typedef board* (*board_create_func)(void);
 
-void board_register(const char* name, board_create_func bcreate);
+void board_register(const char* name, board_create_func bcreate, const int reentrant);
 
 // boards object creation
 board* create_board(int* lab, int* lab_);
@@ -716,6 +757,7 @@ typedef struct {
     char name[30];   // name
     char name_[30];  // name without spaces
     board_create_func bcreate;
+    int reentrant;  // board can run in worker simulation contexts
 } board_desc;
 
 extern board_desc boards_list[BOARDS_MAX];
@@ -0,0 +1,161 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "drawpool.h"
+#include "part.h"
+
+// Global object
+CDrawPool DrawPool;
+
+CDrawPool::CDrawPool() {
+    jobs = NULL;
+    jobs_count = 0;
+    jobs_next = 0;
+    jobs_pending = 0;
+#ifndef _NOTHREAD
+    generation = 0;
+    quit = 0;
+#endif
+}
+
+CDrawPool::~CDrawPool() {
+    Stop();
+}
+
+int CDrawPool::GetThreadCount(void) {
+#ifndef _NOTHREAD
+    return workers.size();
+#else
+    return 0;
+#endif
+}
+
+#ifndef _NOTHREAD
+
+void CDrawPool::Start(void) {
+    int n = std::thread::hardware_concurrency();
+
+    if (n > DRAWPOOL_MAX_THREADS)
+        n = DRAWPOOL_MAX_THREADS;
+    if (n < 1)
+        n = 1;
+
+    quit = 0;
+    for (int i = 0; i < n; i++) {
+        workers.push_back(std::thread(&CDrawPool::Worker, this));
+    }
+}
+
+void CDrawPool::Stop(void) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        quit = 1;
+    }
+    cv_work.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    workers.clear();
+}
+
+void CDrawPool::Worker(void) {
+    unsigned long gen = 0;
+
+    std::unique_lock<std::mutex> lock(mtx);
+    while (1) {
+        cv_work.wait(lock, [&] { return quit || (generation != gen); });
+        if (quit)
+            break;
+        gen = generation;
+
+        lock.unlock();
+        const int done = RunJobs();
+        lock.lock();
+
+        jobs_pending -= done;
+        if (!jobs_pending)
+            cv_done.notify_one();
+    }
+}
+
+int CDrawPool::RunJobs(void) {
+    int done = 0;
+    int job;
+
+    while (1) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            job = jobs_next;
+            if (job >= jobs_count)
+                break;
+            jobs_next++;
+        }
+        jobs[job]->DrawPrepare();
+        done++;
+    }
+    return done;
+}
+
+void CDrawPool::Prepare(part** list, const int count) {
+    if (count <= 0)
+        return;
+
+    if (workers.empty()) {
+        Start();
+    }
+
+    // the UI thread only waits, all jobs run in the workers
+    std::unique_lock<std::mutex> lock(mtx);
+    jobs = list;
+    jobs_count = count;
+    jobs_next = 0;
+    jobs_pending = count;
+    generation++;
+    cv_work.notify_all();
+    cv_done.wait(lock, [&] { return !jobs_pending; });
+    jobs = NULL;
+    jobs_count = 0;
+}
+
+#else  // _NOTHREAD
+
+void CDrawPool::Stop(void) {}
+
+int CDrawPool::RunJobs(void) {
+    for (jobs_next = 0; jobs_next < jobs_count; jobs_next++) {
+        jobs[jobs_next]->DrawPrepare();
+    }
+    return jobs_count;
+}
+
+void CDrawPool::Prepare(part** list, const int count) {
+    jobs = list;
+    jobs_count = count;
+    RunJobs();
+    jobs = NULL;
+    jobs_count = 0;
+}
+
+#endif  // _NOTHREAD
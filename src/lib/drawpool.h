@@ -0,0 +1,92 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef DRAWPOOL_H
+#define DRAWPOOL_H
+
+#ifndef _NOTHREAD
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
+
+class part;
+
+#define DRAWPOOL_MAX_THREADS 8
+
+/**
+ * @brief Spare parts draw worker pool
+ *
+ * Runs part::DrawPrepare of the parts with pending draw in parallel worker
+ * threads, also when only one part is dirty. Parts render into their own
+ * memory in DrawPrepare, the canvas calls stay in part::Draw, called after
+ * on the UI thread to compose the window.
+ */
+class CDrawPool {
+public:
+    CDrawPool();
+    ~CDrawPool();
+
+    /**
+     * @brief Call DrawPrepare of all parts in list and wait all to finish
+     */
+    void Prepare(part** list, const int count);
+
+    /**
+     * @brief Stop the worker threads
+     */
+    void Stop(void);
+
+    /**
+     * @brief Return the number of worker threads (0 if not started)
+     */
+    int GetThreadCount(void);
+
+private:
+    part** jobs;
+    int jobs_count;
+    int jobs_next;
+    int jobs_pending;
+#ifndef _NOTHREAD
+    std::vector<std::thread> workers;
+    std::mutex mtx;
+    std::condition_variable cv_work;
+    std::condition_variable cv_done;
+    unsigned long generation;
+    int quit;
+
+    void Start(void);
+    void Worker(void);
+#endif
+    /**
+     * @brief Run jobs until the list is empty, return number of jobs done
+     */
+    int RunJobs(void);
+};
+
+extern CDrawPool DrawPool;
+
+#endif /* DRAWPOOL_H */
@@ -0,0 +1,201 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef EVENTRING_H
+#define EVENTRING_H
+
+#include <stdint.h>
+
+#ifndef _NOTHREAD
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+/**
+ * @brief Single producer single consumer ring of 64 bit events with a consumer thread
+ *
+ * The simulation thread stores events without locks and a consumer thread
+ * polls the ring and passes them in contiguous spans to C::Consume(const
+ * uint64_t* events, const uint32_t count). The simulation thread doesn't
+ * notify every event, it only wakes the consumer when the ring is full. In
+ * _NOTHREAD builds the events are consumed in the producer when the ring is
+ * full or by Drain. SIZE must be a power of two.
+ */
+template <class C, const uint32_t SIZE>
+class CEventRing {
+public:
+    CEventRing(C* consumer_) {
+        consumer = consumer_;
+        ring = NULL;
+        head = 0;
+        tail = 0;
+#ifndef _NOTHREAD
+        closing = 0;
+        started = 0;
+#endif
+    };
+
+    ~CEventRing() {
+        Stop();
+        delete[] ring;
+    };
+
+    /**
+     * @brief Clear the ring and start the consumer thread
+     */
+    void Start(void) {
+        Stop();
+        if (!ring) {
+            ring = new uint64_t[SIZE];
+        }
+        head = 0;
+        tail = 0;
+#ifndef _NOTHREAD
+        closing = 0;
+        started = 1;
+        worker = std::thread(&CEventRing::Worker, this);
+#endif
+    };
+
+    /**
+     * @brief Consume all pending events and stop the consumer thread
+     */
+    void Stop(void) {
+#ifndef _NOTHREAD
+        if (!started)
+            return;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            closing = 1;
+        }
+        cv_work.notify_one();
+        worker.join();
+        started = 0;
+#else
+        if (ring)
+            Drain();
+#endif
+    };
+
+    /**
+     * @brief Wait until all events added are consumed
+     */
+    void Sync(void) {
+#ifndef _NOTHREAD
+        if (!started)
+            return;
+        const uint32_t h = head.load();
+        std::unique_lock<std::mutex> lock(mtx);
+        cv_work.notify_one();
+        cv_done.wait(lock, [&] { return (int32_t)(tail.load() - h) >= 0; });
+#else
+        if (ring)
+            Drain();
+#endif
+    };
+
+    /**
+     * @brief Add an event (simulation thread)
+     */
+    void Add(const uint64_t event) {
+#ifndef _NOTHREAD
+        const uint32_t h = head.load(std::memory_order_relaxed);
+        if ((h - tail.load(std::memory_order_acquire)) >= SIZE)
+            WaitSpace();
+        ring[h & (SIZE - 1)] = event;
+        head.store(h + 1, std::memory_order_release);
+#else
+        if ((head - tail) >= SIZE)
+            Drain();
+        ring[head & (SIZE - 1)] = event;
+        head++;
+#endif
+    };
+
+    /**
+     * @brief Consume all events in ring, return the number of events
+     */
+    uint32_t Drain(void) {
+        const uint32_t h = head;
+        const uint32_t t = tail;
+        const uint32_t start = t & (SIZE - 1);
+        const uint32_t count = h - t;
+
+        if (count) {
+            if ((start + count) > SIZE) {
+                consumer->Consume(ring + start, SIZE - start);
+                consumer->Consume(ring, count - (SIZE - start));
+            } else {
+                consumer->Consume(ring + start, count);
+            }
+            tail = h;
+        }
+        return count;
+    };
+
+private:
+    C* consumer;
+    uint64_t* ring;
+#ifndef _NOTHREAD
+    std::atomic<uint32_t> head;  // written by simulation thread
+    std::atomic<uint32_t> tail;  // written by consumer thread
+    std::thread worker;
+    std::mutex mtx;
+    std::condition_variable cv_work;
+    std::condition_variable cv_done;
+    int closing;
+    int started;
+
+    void Worker(void) {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (1) {
+            // the simulation thread doesn't notify every event, poll the ring
+            cv_work.wait_for(lock, std::chrono::milliseconds(20),
+                             [&] { return closing || (head.load() != tail.load()); });
+            lock.unlock();
+            const uint32_t count = Drain();
+            lock.lock();
+            cv_done.notify_all();
+            if (closing && !count)
+                break;
+        }
+    };
+
+    void WaitSpace(void) {
+        cv_work.notify_one();
+        while ((head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire)) >= SIZE) {
+            std::this_thread::yield();
+        }
+    };
+#else
+    uint32_t head;
+    uint32_t tail;
+#endif
+};
+
+#endif /* EVENTRING_H */
@@ -0,0 +1,224 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "gzblock.h"
+
+#include <string.h>
+
+#define GZB_WMASK (GZB_WSIZE - 1)
+#define GZB_HASH_SIZE (1 << GZB_HASH_BITS)
+
+static const unsigned short len_base[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                            31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const unsigned char len_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                            2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const unsigned short dist_base[30] = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                             33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                             1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const unsigned char dist_extra[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                             6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+static uint32_t crc_table[256];
+static unsigned short sym_code[288];     // fixed Huffman codes, bit reversed
+static unsigned char sym_bits[288];      // fixed Huffman codes length
+static unsigned char len_code[GZB_MAX_MATCH + 1];  // length code of each match length
+static unsigned char dist_code[512];     // distance code, [d - 1] up to 256, [256 + ((d - 1) >> 7)] above
+static int tables_ready = 0;
+
+static unsigned int reverse(unsigned int code, int bits) {
+    unsigned int r = 0;
+    while (bits--) {
+        r = (r << 1) | (code & 1);
+        code >>= 1;
+    }
+    return r;
+}
+
+static void build_tables(void) {
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        crc_table[n] = c;
+    }
+
+    for (int s = 0; s < 288; s++) {
+        if (s < 144) {
+            sym_bits[s] = 8;
+            sym_code[s] = reverse(0x30 + s, 8);
+        } else if (s < 256) {
+            sym_bits[s] = 9;
+            sym_code[s] = reverse(0x190 + (s - 144), 9);
+        } else if (s < 280) {
+            sym_bits[s] = 7;
+            sym_code[s] = reverse(s - 256, 7);
+        } else {
+            sym_bits[s] = 8;
+            sym_code[s] = reverse(0xC0 + (s - 280), 8);
+        }
+    }
+
+    for (int c = 0; c < 29; c++) {
+        for (int l = len_base[c]; (l < len_base[c] + (1 << len_extra[c])) && (l <= GZB_MAX_MATCH); l++) {
+            len_code[l] = c;
+        }
+    }
+    len_code[GZB_MAX_MATCH] = 28;  // 258 has its own code
+
+    for (int c = 0; c < 30; c++) {
+        for (int d = dist_base[c]; d < dist_base[c] + (1 << dist_extra[c]); d++) {
+            if (d <= 256) {
+                dist_code[d - 1] = c;
+            } else {
+                dist_code[256 + ((d - 1) >> 7)] = c;
+            }
+        }
+    }
+    tables_ready = 1;
+}
+
+CGzBlock::CGzBlock() {
+    if (!tables_ready)
+        build_tables();
+    head = new int[GZB_HASH_SIZE];
+    prev = new int[GZB_WSIZE];
+    out = NULL;
+    bitbuf = 0;
+    bitcnt = 0;
+}
+
+CGzBlock::~CGzBlock() {
+    delete[] head;
+    delete[] prev;
+}
+
+uint32_t CGzBlock::Crc32(uint32_t crc, const unsigned char* buf, const unsigned int len) {
+    crc = ~crc;
+    for (unsigned int i = 0; i < len; i++) {
+        crc = crc_table[(crc ^ buf[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void CGzBlock::PutSymbol(const int sym) {
+    PutBits(sym_code[sym], sym_bits[sym]);
+}
+
+void CGzBlock::PutMatch(const int len, const int dist) {
+    const int lc = len_code[len];
+    PutSymbol(257 + lc);
+    if (len_extra[lc])
+        PutBits(len - len_base[lc], len_extra[lc]);
+
+    const int dc = (dist <= 256) ? dist_code[dist - 1] : dist_code[256 + ((dist - 1) >> 7)];
+    PutBits(reverse(dc, 5), 5);
+    if (dist_extra[dc])
+        PutBits(dist - dist_base[dc], dist_extra[dc]);
+}
+
+static inline unsigned int hash3(const unsigned char* p) {
+    return ((p[0] << 10) ^ (p[1] << 5) ^ p[2]) & (GZB_HASH_SIZE - 1);
+}
+
+unsigned int CGzBlock::Compress(const unsigned char* in, const unsigned int len, unsigned char* out_) {
+    static const unsigned char gz_header[10] = {0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF};
+
+    memcpy(out_, gz_header, sizeof(gz_header));
+    out = out_ + sizeof(gz_header);
+    bitbuf = 0;
+    bitcnt = 0;
+
+    for (int i = 0; i < GZB_HASH_SIZE; i++) {
+        head[i] = -1;
+    }
+
+    PutBits(1, 1);  // BFINAL, the member is a single block
+    PutBits(1, 2);  // BTYPE fixed Huffman
+
+    int pos = 0;
+    const int end = len;
+    while (pos < end) {
+        int best_len = 0;
+        int best_dist = 0;
+
+        if ((pos + 3) <= end) {
+            const unsigned int h = hash3(in + pos);
+            int cand = head[h];
+            const int max_len = ((end - pos) < GZB_MAX_MATCH) ? (end - pos) : GZB_MAX_MATCH;
+            int chain = GZB_CHAIN;
+
+            prev[pos & GZB_WMASK] = cand;
+            head[h] = pos;
+
+            while ((cand >= 0) && ((pos - cand) <= GZB_WSIZE) && chain--) {
+                if (in[cand + best_len] == in[pos + best_len]) {
+                    int l = 0;
+                    while ((l < max_len) && (in[cand + l] == in[pos + l]))
+                        l++;
+                    if (l > best_len) {
+                        best_len = l;
+                        best_dist = pos - cand;
+                        if (l == max_len)
+                            break;
+                    }
+                }
+                const int next = prev[cand & GZB_WMASK];
+                if (next >= cand)  // window slot reused by a newer position
+                    break;
+                cand = next;
+            }
+        }
+
+        if (best_len >= 3) {
+            PutMatch(best_len, best_dist);
+            // insert the hashes of the matched bytes
+            for (int i = 1; i < best_len; i++) {
+                const int p = pos + i;
+                if ((p + 3) <= end) {
+                    const unsigned int h = hash3(in + p);
+                    prev[p & GZB_WMASK] = head[h];
+                    head[h] = p;
+                }
+            }
+            pos += best_len;
+        } else {
+            PutSymbol(in[pos]);
+            pos++;
+        }
+    }
+    PutSymbol(256);  // end of block
+    if (bitcnt)
+        PutBits(0, 8 - bitcnt);
+
+    const uint32_t crc = Crc32(0, in, len);
+    for (int i = 0; i < 4; i++) {
+        *out++ = crc >> (i * 8);
+    }
+    for (int i = 0; i < 4; i++) {
+        *out++ = len >> (i * 8);
+    }
+    return out - out_;
+}
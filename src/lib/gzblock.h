@@ -0,0 +1,87 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef GZBLOCK_H
+#define GZBLOCK_H
+
+#include <stdint.h>
+
+#define GZB_WSIZE 32768     // LZ77 window (deflate maximum)
+#define GZB_HASH_BITS 15    // size of hash table of 3 bytes sequences
+#define GZB_CHAIN 32        // maximum candidates tested for each match
+#define GZB_MAX_MATCH 258
+
+/**
+ * @brief Gzip member compressor
+ *
+ * Compresses a memory block into one complete gzip member (RFC 1952) using a
+ * LZ77 hash chain matcher and the fixed Huffman codes of deflate (RFC 1951).
+ * Members are independent, so a file of concatenated members can be read as
+ * one stream by gzip/zlib/GTKWave or each block can be decompressed alone
+ * starting at its offset. The fixed codes trade some ratio for no tables to
+ * build or store, which is enough for the very repetitive text of waveforms.
+ */
+class CGzBlock {
+public:
+    CGzBlock();
+    ~CGzBlock();
+
+    /**
+     * @brief Return the maximum size of the member of a block of len bytes
+     */
+    static unsigned int Bound(const unsigned int len) { return len + (len >> 3) + 64; };
+
+    /**
+     * @brief Compress len bytes of in to a gzip member in out (at least Bound(len) bytes), return the member size
+     */
+    unsigned int Compress(const unsigned char* in, const unsigned int len, unsigned char* out);
+
+    /**
+     * @brief Update the CRC-32 (as gzip) of data
+     */
+    static uint32_t Crc32(uint32_t crc, const unsigned char* buf, const unsigned int len);
+
+private:
+    int* head;  // last position of each hash
+    int* prev;  // previous position with same hash (window indexed)
+    unsigned char* out;
+    uint64_t bitbuf;
+    int bitcnt;
+
+    void PutBits(const uint32_t bits, const int n) {
+        bitbuf |= ((uint64_t)bits) << bitcnt;
+        bitcnt += n;
+        while (bitcnt >= 8) {
+            *out++ = bitbuf;
+            bitbuf >>= 8;
+            bitcnt -= 8;
+        }
+    };
+
+    void PutSymbol(const int sym);
+    void PutMatch(const int len, const int dist);
+};
+
+#endif /* GZBLOCK_H */
@@ -0,0 +1,105 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "imagecache.h"
+
+// Global object
+CImageCache ImageCache;
+
+CImageCache::CImageCache() {
+    count = 0;
+    window = NULL;
+    used = 0;
+    hits = 0;
+    misses = 0;
+    for (int i = 0; i < IMAGECACHE_MAX; i++) {
+        entries[i].image = NULL;
+    }
+}
+
+CImageCache::~CImageCache() {
+    Clear();
+}
+
+void CImageCache::Clear(void) {
+    for (int i = 0; i < count; i++) {
+        if (entries[i].image) {
+            entries[i].image->Destroy();
+            delete entries[i].image;
+            entries[i].image = NULL;
+        }
+        entries[i].fname = "";
+    }
+    count = 0;
+}
+
+lxImage* CImageCache::GetImage(const lxString fname, const int orientation, const double scale, CWindow* win) {
+    // images are bound to the window used to load them
+    if (win != window) {
+        Clear();
+        window = win;
+    }
+
+    used++;
+
+    for (int i = 0; i < count; i++) {
+        if ((entries[i].scale == scale) && (entries[i].orientation == orientation) && (entries[i].fname == fname)) {
+            entries[i].used = used;
+            hits++;
+            return entries[i].image;
+        }
+    }
+
+    misses++;
+
+    lxImage* image = new lxImage(win);
+
+    if (!image->LoadFile(fname, orientation, scale, scale)) {
+        delete image;
+        return NULL;
+    }
+
+    int e = count;
+    if (count < IMAGECACHE_MAX) {
+        count++;
+    } else {
+        // evict the least recently used
+        e = 0;
+        for (int i = 1; i < count; i++) {
+            if (entries[i].used < entries[e].used)
+                e = i;
+        }
+        entries[e].image->Destroy();
+        delete entries[e].image;
+    }
+
+    entries[e].fname = fname;
+    entries[e].orientation = orientation;
+    entries[e].scale = scale;
+    entries[e].image = image;
+    entries[e].used = used;
+
+    return image;
+}
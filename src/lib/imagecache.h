@@ -0,0 +1,88 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef IMAGECACHE_H
+#define IMAGECACHE_H
+
+#include <lxrad.h>
+
+#define IMAGECACHE_MAX 64
+
+/**
+ * @brief internal image cache entry
+ *
+ */
+typedef struct {
+    lxString fname;
+    int orientation;
+    double scale;
+    lxImage* image;
+    unsigned long used;  ///< last access, used to evict the least recently used
+} ImageCacheEntry_t;
+
+/**
+ * @brief Rasterised image cache
+ *
+ * Keeps the images already loaded and rasterised, keyed by file name,
+ * orientation and scale, so parts created, rotated or zoomed again
+ * only create a new bitmap instead of parse the picture file again.
+ */
+class CImageCache {
+public:
+    CImageCache();
+    ~CImageCache();
+
+    /**
+     * @brief Return the rasterised image of file or NULL if the file can't be loaded
+     */
+    lxImage* GetImage(const lxString fname, const int orientation, const double scale, CWindow* win);
+
+    /**
+     * @brief Free all cached images
+     */
+    void Clear(void);
+
+    /**
+     * @brief Return the number of cache hits
+     */
+    unsigned long GetHits(void) { return hits; };
+
+    /**
+     * @brief Return the number of cache misses
+     */
+    unsigned long GetMisses(void) { return misses; };
+
+private:
+    ImageCacheEntry_t entries[IMAGECACHE_MAX];
+    int count;
+    CWindow* window;
+    unsigned long used;
+    unsigned long hits;
+    unsigned long misses;
+};
+
+extern CImageCache ImageCache;
+
+#endif /* IMAGECACHE_H */
@@ -0,0 +1,218 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "logicrec.h"
+
+#include <string.h>
+
+#include "board.h"
+#include "spareparts.h"
+
+static const char index_magic[8] = {'P', 'S', 'L', 'L', 'G', 'I', 'D', 'X'};
+
+CLogicRecorder::CLogicRecorder() : Stream(this) {
+    PinCount = 0;
+    memset(Mask, 0, sizeof(Mask));
+    VarCount = 0;
+    memset(VarId, 0, sizeof(VarId));
+    memset(Values, 0, sizeof(Values));
+    Period = 1;
+    Bytes = 0;
+    FileName[0] = 0;
+    file = NULL;
+    index = NULL;
+    blk = NULL;
+    blk_used = 0;
+    cblk = NULL;
+    blk_start = 0;
+    last_time = 0;
+    last_count = 0;
+}
+
+CLogicRecorder::~CLogicRecorder() {
+    Stop();
+    delete[] blk;
+    delete[] cblk;
+}
+
+int CLogicRecorder::Start(board* b, const char* fname) {
+    char name[64];
+
+    Stop();
+
+    file = fopen(fname, "wb");
+    if (!file) {
+        printf("PICSimLab: Error creating file %s\n", fname);
+        return -1;
+    }
+    snprintf(FileName, sizeof(FileName), "%s.idx", fname);
+    index = fopen(FileName, "wb");
+    if (!index) {
+        printf("PICSimLab: Error creating file %s\n", FileName);
+        fclose(file);
+        file = NULL;
+        return -1;
+    }
+    strncpy(FileName, fname, sizeof(FileName) - 1);
+    FileName[sizeof(FileName) - 1] = 0;
+
+    if (!blk) {
+        blk = new unsigned char[LREC_BLOCK_SIZE + LREC_BLOCK_SLACK];
+        cblk = new unsigned char[CGzBlock::Bound(LREC_BLOCK_SIZE + LREC_BLOCK_SLACK)];
+    }
+
+    Period = 1e12 / b->MGetInstClockFreq();
+    const int spare = b->GetUseSpareParts();
+    const int last = spare ? PP_MAX_PINS - 1 : b->MGetPinCount();
+
+    blk_used = 0;
+    Put("$version Generated by PICSimLab $end\n$timescale 1ps $end\n$scope module board $end\n");
+
+    // pins recorded and its VCD identifiers (one or two printable characters)
+    memset(Mask, 0, sizeof(Mask));
+    PinCount = 0;
+    VarCount = 0;
+    for (int pin = 1; pin <= last; pin++) {
+        if (spare && !SpareParts.GetPinUsed(pin))
+            continue;
+        const int i = pin - 1;
+        Mask[i >> 6] |= 1ull << (i & 63);
+        PinCount = pin;
+        if (VarCount < 94) {
+            VarId[i][0] = '!' + VarCount;
+            VarId[i][1] = 0;
+        } else {
+            VarId[i][0] = '!' + (VarCount % 94);
+            VarId[i][1] = '!' + (VarCount / 94) - 1;
+            VarId[i][2] = 0;
+        }
+        VarCount++;
+
+        lxString pname = spare ? SpareParts.GetPinName(pin) : b->MGetPinName(pin);
+        int n = snprintf(name, sizeof(name), "p%03i_%s", pin, (const char*)pname.c_str());
+        if (n >= (int)sizeof(name))
+            n = sizeof(name) - 1;
+        for (int c = 0; c < n; c++) {
+            if ((name[c] <= ' ') || (name[c] > '~'))
+                name[c] = '_';
+        }
+        Put("$var wire 1 ");
+        Put((const char*)VarId[i]);
+        Put(" ");
+        Put(name);
+        Put(" $end\n");
+        Values[i] = 'x';
+    }
+    Put("$upscope $end\n$enddefinitions $end\n$dumpvars\n");
+    for (int i = 0; i < PinCount; i++) {
+        if ((Mask[i >> 6] >> (i & 63)) & 1) {
+            blk[blk_used++] = 'x';
+            Put((const char*)VarId[i]);
+            blk[blk_used++] = '\n';
+        }
+    }
+    Put("$end\n");
+
+    lrec_index_header_t ih;
+    memcpy(ih.magic, index_magic, sizeof(ih.magic));
+    ih.version = 1;
+    ih.vars = VarCount;
+    fwrite(&ih, sizeof(ih), 1, index);
+
+    blk_start = UINT64_MAX;
+    last_time = 0;
+    last_count = UINT64_MAX;
+    Bytes = 0;
+    Stream.Start(b->MGetPinsValues(), Mask);
+    return 0;
+}
+
+void CLogicRecorder::Checkpoint(void) {
+    PutTime(last_time);
+    Put("$dumpall\n");
+    for (int i = 0; i < PinCount; i++) {
+        if ((Mask[i >> 6] >> (i & 63)) & 1) {
+            blk[blk_used++] = Values[i];
+            Put((const char*)VarId[i]);
+            blk[blk_used++] = '\n';
+        }
+    }
+    Put("$end\n");
+    blk_start = last_time;
+}
+
+void CLogicRecorder::Flush(void) {
+    if (!blk_used)
+        return;
+
+    lrec_index_t ie;
+    ie.offset = Bytes;
+    ie.csize = gz.Compress(blk, blk_used, cblk);
+    ie.usize = blk_used;
+    ie.tstart = (blk_start == UINT64_MAX) ? 0 : blk_start;
+    ie.tend = last_time;
+    fwrite(cblk, ie.csize, 1, file);
+    fwrite(&ie, sizeof(ie), 1, index);
+    fflush(file);
+    fflush(index);
+    Bytes += ie.csize;
+    blk_used = 0;
+}
+
+void CLogicRecorder::Consume(const uint64_t* changes, const uint32_t count) {
+    for (uint32_t n = 0; n < count; n++) {
+        const uint64_t inst = Stream.GetTime(changes[n]);
+        const int i = Stream.GetPin(changes[n]);
+
+        if (inst != last_count) {
+            // blocks are only split between times, so each one starts with a complete checkpoint
+            if (blk_used >= LREC_BLOCK_SIZE) {
+                Flush();
+                Checkpoint();
+            }
+            last_count = inst;
+            last_time = (uint64_t)(inst * Period + 0.5);
+            if (blk_start == UINT64_MAX)
+                blk_start = last_time;
+            PutTime(last_time);
+        }
+        Values[i] = '0' + Stream.GetValue(changes[n]);
+        blk[blk_used++] = Values[i];
+        Put((const char*)VarId[i]);
+        blk[blk_used++] = '\n';
+    }
+}
+
+void CLogicRecorder::Stop(void) {
+    if (!file)
+        return;
+
+    Stream.Stop();
+    Flush();
+    fclose(file);
+    fclose(index);
+    file = NULL;
+    index = NULL;
+}
@@ -0,0 +1,175 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef LOGICREC_H
+#define LOGICREC_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "gzblock.h"
+#include "pinstream.h"
+#include "vcdwriter.h"
+
+#define LREC_RING_SIZE 262144    // changes in ring (power of two)
+#define LREC_BLOCK_SIZE 1048576  // VCD text compressed in each gzip member
+#define LREC_BLOCK_SLACK 65536   // room for header and changes of one time after a block is full
+
+class board;
+
+/**
+ * @brief Logic recorder index entry (one for each gzip member)
+ */
+typedef struct {
+    uint64_t offset;  ///< file offset of the gzip member
+    uint32_t csize;   ///< compressed size
+    uint32_t usize;   ///< uncompressed size
+    uint64_t tstart;  ///< time of the block checkpoint in ps
+    uint64_t tend;    ///< time of the last change in block in ps
+} lrec_index_t;
+
+/**
+ * @brief Logic recorder index file header
+ */
+typedef struct {
+    char magic[8];  ///< "PSLLGIDX"
+    uint32_t version;
+    uint32_t vars;  ///< number of pins recorded
+} lrec_index_header_t;
+
+/**
+ * @brief Whole board logic recorder
+ *
+ * Records the digital value of all board pins and IO pins of spare parts.
+ * A CPinStream sends the changes to its ring thread, that formats them as
+ * VCD and compresses each block of about 1 MB as an independent gzip member,
+ * the file is a valid .vcd.gz for GTKWave. Each block after the first starts with a $dumpall checkpoint,
+ * and the .idx file lists the offset and time range of every member, so a
+ * viewer can start decompressing at any block.
+ */
+class CLogicRecorder {
+public:
+    CLogicRecorder();
+    ~CLogicRecorder();
+
+    /**
+     * @brief Start recording the pins of board b to file fname (.vcd.gz), return 0 on success
+     */
+    int Start(board* b, const char* fname);
+
+    /**
+     * @brief Stop recording, write pending changes and close the files
+     */
+    void Stop(void);
+
+    /**
+     * @brief Return 1 if recording
+     */
+    int IsRecording(void) { return Stream.IsRunning(); };
+
+    /**
+     * @brief Return the number of pins recorded
+     */
+    int GetVarCount(void) { return VarCount; };
+
+    /**
+     * @brief Return the number of changes recorded
+     */
+    uint64_t GetChanges(void) { return Stream.GetChanges(); };
+
+    /**
+     * @brief Return the number of compressed bytes written
+     */
+    uint64_t GetBytes(void) { return Bytes; };
+
+    /**
+     * @brief Return the file name of the recording
+     */
+    const char* GetFileName(void) { return FileName; };
+
+    /**
+     * @brief Stepping kernel entry, return 1 if the pins must be scanned until Leave is called
+     */
+    int Enter(const uint64_t now) { return Stream.Enter(now); };
+
+    /**
+     * @brief Stepping kernel exit
+     */
+    void Leave(void) { Stream.Leave(); };
+
+    /**
+     * @brief Record the pins changed since last scan at instruction count now
+     */
+    void Scan(const uint64_t now) { Stream.Scan(now); };
+
+private:
+    int PinCount;                         // highest pin recorded
+    uint64_t Mask[PP_WORDS];              // pins recorded (bit n is pin n+1)
+    int VarCount;
+    unsigned char VarId[PP_MAX_PINS][3];  // VCD identifier of each pin
+    unsigned char Values[PP_MAX_PINS];    // pins values at end of formatted text
+    double Period;                        // instruction period in ps
+    uint64_t Bytes;
+    char FileName[1024];
+    FILE* file;
+    FILE* index;
+    unsigned char* blk;  // VCD text of current block
+    unsigned int blk_used;
+    unsigned char* cblk;  // compressed block
+    uint64_t blk_start;   // time of current block checkpoint in ps
+    uint64_t last_time;   // time of last change formatted in ps
+    uint64_t last_count;  // instruction count of last change formatted
+    CGzBlock gz;
+    CPinStream<CLogicRecorder, LREC_RING_SIZE> Stream;
+
+    friend class CEventRing<CLogicRecorder, LREC_RING_SIZE>;
+
+    /**
+     * @brief Format the changes, compressing the full blocks (ring thread)
+     */
+    void Consume(const uint64_t* changes, const uint32_t count);
+
+    /**
+     * @brief Compress and write the current block and its index entry
+     */
+    void Flush(void);
+
+    /**
+     * @brief Append the $dumpall checkpoint with the current values to the block
+     */
+    void Checkpoint(void);
+
+    void Put(const char* str) {
+        while (*str)
+            blk[blk_used++] = *str++;
+    };
+
+    void PutTime(const uint64_t time) { blk_used += vcd_format_time((char*)blk + blk_used, time); };
+};
+
+// Object of the simulation context bound to the calling thread (simcontext.h)
+extern thread_local CLogicRecorder& LogicRecorder;
+
+#endif /* LOGICREC_H */
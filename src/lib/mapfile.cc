@@ -0,0 +1,208 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "mapfile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Global object
+CMapFiles MapFiles;
+
+CMapFiles::CMapFiles() {
+    mapsc = 0;
+    for (int i = 0; i < MAX_MAPFILES; i++) {
+        maps[i] = NULL;
+    }
+}
+
+CMapFiles::~CMapFiles() {
+    Clear();
+}
+
+void CMapFiles::Clear(void) {
+    for (int i = 0; i < mapsc; i++) {
+        delete[] maps[i]->input;
+        delete[] maps[i]->output;
+        delete maps[i];
+        maps[i] = NULL;
+    }
+    mapsc = 0;
+}
+
+const mapfile_t* CMapFiles::Get(const lxString fname) {
+#ifndef _NOTHREAD
+    std::lock_guard<std::mutex> lock(mtx);
+#endif
+    for (int i = 0; i < mapsc; i++) {
+        if (maps[i]->fname == fname) {
+            return maps[i];
+        }
+    }
+
+    mapfile_t* map = Parse(fname);
+
+    if (map) {
+        if (mapsc == MAX_MAPFILES) {
+            Clear();
+        }
+        maps[mapsc++] = map;
+    }
+    return map;
+}
+
+mapfile_t* CMapFiles::Parse(const lxString fname) {
+    FILE* fin;
+
+    char line[256];
+
+    char* it;
+    char* shape;
+    char* coords;
+    char* name;
+    char* value;
+
+    int x1, y1, x2, y2, r;
+
+    input_t input[MAX_IDS];
+    output_t output[MAX_IDS];
+
+    fin = fopen(fname.c_str(), "r");
+
+    if (!fin) {
+        return NULL;
+    }
+
+    mapfile_t* map = new mapfile_t;
+    map->fname = fname;
+    map->width = 0;
+    map->height = 0;
+    map->inputc = 0;
+    map->outputc = 0;
+
+    while (fgets(line, 256, fin)) {
+        it = strtok(line, "< =\"");
+        if (!it)
+            continue;
+        if (!strcmp("img", it)) {
+            do {
+                name = strtok(NULL, "< =\"");
+                value = strtok(NULL, "<=\"");
+
+                if (name && value) {
+                    if (!strcmp("width", name)) {
+                        sscanf(value, "%i", &x1);
+                        map->width = x1;
+                    }
+
+                    if (!strcmp("height", name)) {
+                        sscanf(value, "%i", &y1);
+                        map->height = y1;
+                    }
+                }
+            } while (value != NULL);
+
+        } else if (!strcmp("area", it)) {
+            strtok(NULL, "< =\"");
+            shape = strtok(NULL, "< =\"");
+            strtok(NULL, "< =\"");
+            coords = strtok(NULL, "< =\"");
+            strtok(NULL, "< =\"");
+            name = strtok(NULL, "< =\"");
+
+            if (!shape || !coords || !name) {
+                continue;
+            }
+
+            if (((name[0] == 'I') || (name[0] == 'B')) && (name[1] == '_')) {
+                input_t* in = &input[map->inputc];
+                memset(in, 0, sizeof(input_t));
+                if (strcmp("rect", shape) == 0) {
+                    sscanf(coords, "%i,%i,%i,%i\n", &x1, &y1, &x2, &y2);
+                    in->x1 = x1;
+                    in->y1 = y1;
+                    in->x2 = x2;
+                    in->y2 = y2;
+                } else {
+                    sscanf(coords, "%i,%i,%i\n", &x1, &y1, &r);
+                    in->x1 = x1 - r;
+                    in->y1 = y1 - r;
+                    in->x2 = x1 + r;
+                    in->y2 = y1 + r;
+                }
+                strncpy(in->name, name + 2, sizeof(in->name) - 1);
+                in->cx = ((in->x2 - in->x1) / 2.0) + in->x1;
+                in->cy = ((in->y2 - in->y1) / 2.0) + in->y1;
+                map->inputc++;
+                if (map->inputc >= MAX_IDS) {
+                    printf("PICSimLab: Error! inputc greater than MAX_IDS \n");
+                    exit(-1);
+                }
+            }
+
+            if (((name[0] == 'O') || (name[0] == 'B')) && (name[1] == '_')) {
+                output_t* out = &output[map->outputc];
+                memset(out, 0, sizeof(output_t));
+                if (!strcmp("rect", shape)) {
+                    sscanf(coords, "%i,%i,%i,%i\n", &x1, &y1, &x2, &y2);
+                    out->x1 = x1;
+                    out->y1 = y1;
+                    out->x2 = x2;
+                    out->y2 = y2;
+                    out->r = 0;
+                    out->cx = ((out->x2 - out->x1) / 2.0) + out->x1;
+                    out->cy = ((out->y2 - out->y1) / 2.0) + out->y1;
+                } else {
+                    sscanf(coords, "%i,%i,%i\n", &x1, &y1, &r);
+                    out->x1 = x1;
+                    out->y1 = y1;
+                    out->x2 = 0;
+                    out->y2 = 0;
+                    out->r = r;
+                    out->cx = out->x1;
+                    out->cy = out->y1;
+                }
+                strncpy(out->name, name + 2, sizeof(out->name) - 1);
+                map->outputc++;
+                if (map->outputc >= MAX_IDS) {
+                    printf("PICSimLab: Error! outputc greater than MAX_IDS \n");
+                    exit(-1);
+                }
+            }
+        }
+    }
+    fclose(fin);
+
+    input_t* min = new input_t[map->inputc];
+    memcpy(min, input, map->inputc * sizeof(input_t));
+    map->input = min;
+
+    output_t* mout = new output_t[map->outputc];
+    memcpy(mout, output, map->outputc * sizeof(output_t));
+    map->output = mout;
+
+    return map;
+}
@@ -0,0 +1,85 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef MAPFILE_H
+#define MAPFILE_H
+
+#include "board.h"
+
+#ifndef _NOTHREAD
+#include <mutex>
+#endif
+
+#define MAX_MAPFILES 256
+
+/**
+ * @brief parsed map file struct
+ *
+ */
+typedef struct {
+    lxString fname;          ///< map file name
+    unsigned int width;      ///< picture width
+    unsigned int height;     ///< picture height
+    int inputc;              ///< input map elements counter
+    int outputc;             ///< output map elements counter
+    const input_t* input;    ///< input map elements (id not resolved)
+    const output_t* output;  ///< output map elements (id not resolved)
+} mapfile_t;
+
+/**
+ * @brief Map files registry
+ *
+ * Each board or part map file is read and parsed only once, the instances
+ * copy only the elements present in the map from the registry. Get can be
+ * called from the worker threads of headless simulation contexts.
+ */
+class CMapFiles {
+public:
+    CMapFiles();
+    ~CMapFiles();
+
+    /**
+     * @brief Return the parsed map file or NULL if the file can't be read
+     */
+    const mapfile_t* Get(const lxString fname);
+
+    /**
+     * @brief Free all parsed map files
+     */
+    void Clear(void);
+
+private:
+    mapfile_t* maps[MAX_MAPFILES];
+    int mapsc;
+#ifndef _NOTHREAD
+    std::mutex mtx;
+#endif
+
+    mapfile_t* Parse(const lxString fname);
+};
+
+extern CMapFiles MapFiles;
+
+#endif /* MAPFILE_H */
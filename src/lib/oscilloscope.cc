@@ -25,24 +25,51 @@
 
 #include "oscilloscope.h"
 #include "picsimlab.h"
+#include "scopeanalysis.h"
 #include "spareparts.h"
 
 #include <picsim/picsim.h>
 
-COscilloscope Oscilloscope;
-
 COscilloscope::COscilloscope() {
     Dt = 0;
     Rt = 0;
     usetrigger = 1;
     triggerlv = 2.5;
-    chpin[0] = 0;
-    chpin[1] = 1;
+    chcount = 2;
+    for (int c = 0; c < OSC_MAX_CH; c++) {
+        chpin[c] = c;
+    }
     toffset = 250;
     run = 1;
 
     fp = 0;
-    tch = 0;
+    memset(frame, 0, sizeof(frame));
+    for (int c = 0; c < OSC_MAX_CH; c++) {
+        ch[c] = &frame[0][c][0][toffset];
+        chmin[c] = &frame[0][c][1][toffset];
+        chmax[c] = &frame[0][c][2][toffset];
+        ring[c] = NULL;
+        ringmin[c] = NULL;
+        ringmax[c] = NULL;
+        pins_[c] = 0;
+        pmin[c] = 0;
+        pmax[c] = 0;
+    }
+    memset(ch_status, 0, sizeof(ch_status));
+    rlen = 0;
+    Alloc(OSC_RECORD_DEF, chcount);
+
+    SetTriggerChannel(0);
+    tmode = OSC_TRG_RISING;
+    tpmin = 0;
+    tpmax = 0;
+    tpmask = 0;
+    tpvalue = 0;
+    tholdoff = 0;
+    tsteps = 0;
+    tlast = 0;
+    trise = 0;
+    lvl_ = 0;
     is = 0;
     t = 0;
     tr = 0;
@@ -55,70 +82,286 @@ COscilloscope::COscilloscope() {
     measures[4] = 0;
 
     vmax = 5.0;
+    noise = 1;
+    noise_seed = 0x12345678;
+    spectrum_mode = 0;
+    spectrum_bins = 0;
+    spectrum_rt = 0;
+    for (int c = 0; c < OSC_MAX_CH; c++) {
+        spectrum[c] = NULL;
+        fdom[c] = -1;
+    }
 
     tbstop = NULL;
     tbsingle = NULL;
 }
 
 void COscilloscope::SetSample(void) {
-    double pins[2];
+    double pins[OSC_MAX_CH];
+    uint32_t lvl = 0;
 
     const picpin* ppins = pboard->MGetPinsValues();
 
     if ((!run) || (tbsingle == NULL))
         return;
 
-    if ((ppins[chpin[0]].ptype == PT_ANALOG) && (ppins[chpin[0]].dir == PD_IN))
-        pins[0] = ppins[chpin[0]].avalue;
-    else
-        pins[0] = ppins[chpin[0]].value * vmax;
+    for (int c = 0; c < chcount; c++) {
+        const picpin* pin = &ppins[chpin[c]];
+
+        if ((pin->ptype == PT_ANALOG) && (pin->dir == PD_IN))
+            pins[c] = pin->avalue;
+        else
+            pins[c] = pin->value * vmax;
 
-    if ((ppins[chpin[1]].ptype == PT_ANALOG) && (ppins[chpin[1]].dir == PD_IN))
-        pins[1] = ppins[chpin[1]].avalue;
-    else
-        pins[1] = ppins[chpin[1]].value * vmax;
+        // min/max envelope between samples
+        if (pins[c] < pmin[c])
+            pmin[c] = pins[c];
+        if (pins[c] > pmax[c])
+            pmax[c] = pins[c];
+
+        // digital level of each channel, one bit per channel
+        lvl |= (uint32_t)(pins[c] >= triggerlv) << c;
+    }
+    tsteps++;
 
     // sampling
     if (t > Rt) {
         t -= Rt;
-        databuffer[fp][0][is] = -pins[0] + ((1.0 * rand() / RAND_MAX) - 0.5) * 0.1;
-        databuffer[fp][1][is] = -pins[1] + ((1.0 * rand() / RAND_MAX) - 0.5) * 0.1;
-        is++;
-        if (is >= NPOINTS)  // buffer full
-        {
-            if (tr && tbsingle->GetCheck()) {
-                tbstop->SetCheck(1);
-            }
-            is = 0;
-            tr = 0;
-            t = 0;
-            ch[0] = &databuffer[fp][0][toffset];
-            ch[1] = &databuffer[fp][1][toffset];
-            fp = !fp;    // togle fp
-            update = 1;  // Request redraw screen
-        }
+        PutSample(pins);
     }
     t += Dt;
 
     // trigger
-    if (usetrigger) {
-        if ((!tr) && (is >= NPOINTS / 2)) {
-            if ((pins_[tch] < triggerlv) && (pins[tch] >= triggerlv)) {
-                tr = 1;
-
-                is = is - (NPOINTS / 2);
-
-                for (int i = 0; i < NPOINTS / 2; i++) {
-                    databuffer[fp][0][i] = databuffer[fp][0][i + is];
-                    databuffer[fp][1][i] = databuffer[fp][1][i + is];
-                }
-                is = (NPOINTS / 2);
+    if (lvl != lvl_) {
+        if (usetrigger && (!tr) && (is >= NPOINTS / 2) && Trigger(lvl)) {
+            tr = 1;
+            tlast = tsteps;
+            // pre-trigger samples are already in ring, only the frame position changes
+            is = (NPOINTS / 2);
+        }
+        if (lvl & ~lvl_ & tsrc) {
+            trise = tsteps;  // pulse start
+        }
+        lvl_ = lvl;
+    }
+
+    memcpy(pins_, pins, chcount * sizeof(double));
+}
+
+int COscilloscope::Trigger(const uint32_t lvl) {
+    const uint32_t rise = lvl & ~lvl_;
+    const uint32_t fall = lvl_ & ~lvl;
+
+    if ((tholdoff > 0) && (((tsteps - tlast) * Dt) < tholdoff))
+        return 0;
+
+    switch (tmode) {
+        case OSC_TRG_RISING:
+            return (rise & tsrc) != 0;
+        case OSC_TRG_FALLING:
+            return (fall & tsrc) != 0;
+        case OSC_TRG_EDGE:
+            return ((rise | fall) & tsrc) != 0;
+        case OSC_TRG_PULSE:
+            if (fall & tsrc) {
+                const double width = (tsteps - trise) * Dt;
+                return (width >= tpmin) && ((tpmax <= 0) || (width <= tpmax));
             }
+            return 0;
+        case OSC_TRG_PATTERN:
+            // entering the pattern
+            return ((lvl & tpmask) == tpvalue) && ((lvl_ & tpmask) != tpvalue);
+    }
+    return 0;
+}
+
+void COscilloscope::SetTriggerPattern(const char* pattern) {
+    tpmask = 0;
+    tpvalue = 0;
+    for (int c = 0; (c < OSC_MAX_CH) && pattern[c]; c++) {
+        if (pattern[c] == '1') {
+            tpmask |= 1 << c;
+            tpvalue |= 1 << c;
+        } else if (pattern[c] == '0') {
+            tpmask |= 1 << c;
+        }
+    }
+}
+
+lxString COscilloscope::GetTriggerPattern(void) {
+    lxString pattern;
+
+    for (int c = 0; c < chcount; c++) {
+        if (tpmask & (1 << c))
+            pattern += (tpvalue & (1 << c)) ? "1" : "0";
+        else
+            pattern += "X";
+    }
+    return pattern;
+}
+
+void COscilloscope::SetChannelCount(int chn) {
+    if (chn < 1)
+        chn = 1;
+    if (chn > OSC_MAX_CH)
+        chn = OSC_MAX_CH;
+    if (chn == chcount)
+        return;
+
+    const int run = PICSimLab.PauseSimulation();
+    Alloc(rlen, chn);
+    if (tch >= chn) {
+        SetTriggerChannel(0);
+    }
+    PICSimLab.SetSimulationRun(run);
+}
+
+void COscilloscope::SetSamples(long nsteps) {
+    if ((!run) || (tbsingle == NULL) || (Dt <= 0))
+        return;
+
+    tsteps += nsteps;
+
+    // pins unchanged: the trigger can't fire, only sampling is needed
+    while (nsteps > 0) {
+        if (t > Rt) {
+            t -= Rt;
+            PutSample(pins_);
+        }
+        t += Dt;
+        nsteps--;
+        // skip the steps before the next sample
+        if ((t <= Rt) && (nsteps > 0)) {
+            long skip = (long)((Rt - t) / Dt) + 1;
+            if (skip > nsteps)
+                skip = nsteps;
+            t += skip * Dt;
+            nsteps -= skip;
+        }
+    }
+}
+
+void COscilloscope::PutSample(const double* pins) {
+    const unsigned int wp = wpos & rmask;
+
+    for (int c = 0; c < chcount; c++) {
+        const double ns = noise ? Noise() : 0;
+        ring[c][wp] = -pins[c] + ns;
+        ringmin[c][wp] = -pmax[c] + ns;
+        ringmax[c][wp] = -pmin[c] + ns;
+        pmin[c] = pins[c];
+        pmax[c] = pins[c];
+    }
+    wpos++;
+    is++;
+
+    if (is >= NPOINTS)  // frame complete
+    {
+        if (tr && tbsingle->GetCheck()) {
+            tbstop->SetCheck(1);
+        }
+        is = 0;
+        tr = 0;
+        t = 0;
+        Publish();
+        update = 1;  // Request redraw screen
+    }
+}
+
+void COscilloscope::Publish(void) {
+    const unsigned int start = (wpos - NPOINTS) & rmask;
+    // the frame can wrap around the ring end
+    const unsigned int n1 = ((start + NPOINTS) > (unsigned int)rlen) ? rlen - start : NPOINTS;
+    const unsigned int n2 = NPOINTS - n1;
+
+    for (int c = 0; c < chcount; c++) {
+        memcpy(frame[fp][c][0], ring[c] + start, n1 * sizeof(double));
+        memcpy(frame[fp][c][1], ringmin[c] + start, n1 * sizeof(double));
+        memcpy(frame[fp][c][2], ringmax[c] + start, n1 * sizeof(double));
+        if (n2) {
+            memcpy(frame[fp][c][0] + n1, ring[c], n2 * sizeof(double));
+            memcpy(frame[fp][c][1] + n1, ringmin[c], n2 * sizeof(double));
+            memcpy(frame[fp][c][2] + n1, ringmax[c], n2 * sizeof(double));
+        }
+        ch[c] = &frame[fp][c][0][toffset];
+        chmin[c] = &frame[fp][c][1][toffset];
+        chmax[c] = &frame[fp][c][2][toffset];
+    }
+    rend = wpos;
+    fp = !fp;  // togle fp
+}
+
+void COscilloscope::Alloc(int len, int chn) {
+    int nlen = OSC_RECORD_MIN;
+
+    while ((nlen < len) && (nlen < OSC_RECORD_MAX))
+        nlen <<= 1;
+
+    if ((nlen == rlen) && (chn == chcount) && ring[0])
+        return;
+
+#ifndef _NOTHREAD
+    // the CPU thread is paused by the caller, GetRecord readers are not
+    std::lock_guard<std::mutex> lock(ring_mtx);
+#endif
+
+    if (nlen != rlen) {
+        // new length, all rings restart
+        for (int c = 0; c < OSC_MAX_CH; c++) {
+            delete[] ring[c];
+            delete[] ringmin[c];
+            delete[] ringmax[c];
+            ring[c] = NULL;
+            ringmin[c] = NULL;
+            ringmax[c] = NULL;
+        }
+        rlen = nlen;
+        rmask = nlen - 1;
+        wpos = 0;
+        rend = 0;
+        is = 0;
+        tr = 0;
+    }
+
+    // same length, the running channels keep their samples
+    for (int c = 0; c < OSC_MAX_CH; c++) {
+        if ((c < chn) && (!ring[c])) {
+            ring[c] = new double[nlen];
+            ringmin[c] = new double[nlen];
+            ringmax[c] = new double[nlen];
+            memset(ring[c], 0, nlen * sizeof(double));
+            memset(ringmin[c], 0, nlen * sizeof(double));
+            memset(ringmax[c], 0, nlen * sizeof(double));
+            pins_[c] = 0;
+        } else if ((c >= chn) && ring[c]) {
+            delete[] ring[c];
+            delete[] ringmin[c];
+            delete[] ringmax[c];
+            ring[c] = NULL;
+            ringmin[c] = NULL;
+            ringmax[c] = NULL;
         }
     }
+    chcount = chn;
+}
+
+int COscilloscope::GetRecord(int cn, double* buff, int n) {
+#ifndef _NOTHREAD
+    std::lock_guard<std::mutex> lock(ring_mtx);
+#endif
+    const unsigned int age = wpos - rend;  // samples written after the frame end
+
+    if ((cn >= chcount) || (age >= (unsigned int)rlen))
+        return 0;
 
-    pins_[0] = pins[0];
-    pins_[1] = pins[1];
+    if (n > (int)(rlen - age))
+        n = rlen - age;
+
+    const unsigned int start = rend - n;
+    for (int i = 0; i < n; i++) {
+        buff[i] = ring[cn][(start + i) & rmask];
+    }
+    return n;
 }
 
 void COscilloscope::NextMeasure(int mn) {
@@ -137,82 +380,63 @@ void COscilloscope::SetMeasure(int nm, int value) {
 }
 
 void COscilloscope::CalculateStats(int channel) {
-    ch_status[channel].Vmax = -1000;
-    ch_status[channel].Vmin = 1000;
-    double sumSamples = 0;
-    double sumSquares = 0;
-    double val = -ch[channel][0];
-    int i = 1;
-    bool ltr_down = (val < ch_status[channel].Vavr);  // last transition down
-    bool firstUp = true;
-    unsigned short ltrsHigh = 0;    // last transition sample high number
-    unsigned short sumFCW = 0;      // Full cycle width sum
-    unsigned short sumPCW = 0;      // Positive semi-cycle width sum
-    unsigned short numFCycles = 0;  // Number of full cycles
-    unsigned short numPCycles = 0;  // Number of positive semi-cycles
-
-    for (i = 1; i < (NPOINTS / 2) - 1; i++) {
-        val = -ch[channel][i];
-
-        if (ch_status[channel].Vmax < val)
-            ch_status[channel].Vmax = val;
-        if (ch_status[channel].Vmin > val)
-            ch_status[channel].Vmin = val;
-        sumSamples += val;
-        sumSquares += (val * val);
-
-        // find out frequency (using previous Vavr)
-        if (ltr_down && (val > ch_status[channel].Vavr))  // transition UP
-        {
-            if (!firstUp) {
-                sumFCW += (i - 1 - ltrsHigh);
-                numFCycles++;
-            } else {
-                firstUp = false;
+    scope_stats(ch[channel], NPOINTS / 2, Rt, &ch_status[channel]);
+}
+
+void COscilloscope::StartAnalysis(int chmask, int fftmask) {
+    scope_job_t* job = ScopeAnalysis.GetJob();
+    int nfft = SCOPE_FFT_MAX;
+
+    if (nfft > rlen)
+        nfft = rlen;
+
+    job->chmask = chmask & ((1 << chcount) - 1);
+    job->fftmask = 0;
+    job->npoints = NPOINTS / 2;
+    job->rt = Rt;
+
+    for (int c = 0; c < chcount; c++) {
+        if (job->chmask & (1 << c)) {
+            memcpy(job->data[c], ch[c], (NPOINTS / 2) * sizeof(double));
+        }
+        if (fftmask & (1 << c)) {
+            int n = GetRecord(c, job->rec[c], nfft);
+            if (n < nfft) {
+                // record partially overwritten, use the largest power of two available
+                while (nfft > n)
+                    nfft >>= 1;
+                n = GetRecord(c, job->rec[c], nfft);
             }
-            ltr_down = false;
-            ltrsHigh = i - 1;
-        } else if (!ltr_down && (val < ch_status[channel].Vavr))  // transition Down
-        {
-            if (!firstUp) {
-                sumPCW += (i - 1 - ltrsHigh);
-                numPCycles++;
+            if ((nfft >= SCOPE_FFT_MIN) && (n == nfft)) {
+                job->fftmask |= 1 << c;
             }
-            ltr_down = true;
         }
     }
+    job->nfft = nfft;
 
-    ch_status[channel].Vavr = sumSamples / (NPOINTS / 2);  // Voltage average
-    ch_status[channel].Vrms = sqrt(sumSquares / (NPOINTS / 2));
-
-    double avgFCycleWidth = sumFCW * Rt / numFCycles;
-    double avgPCycleWidth = sumPCW * Rt / numPCycles;
-
-    int pulseValid = (numFCycles > 0) && (avgFCycleWidth != 0) && (avgPCycleWidth != 0) &&
-                     ((ch_status[channel].Vmax - ch_status[channel].Vmin) > 0.2);
-
-    if (pulseValid) {
-        ch_status[channel].PCycle_ms = avgPCycleWidth * 1000;
-        ch_status[channel].FCycle_ms = avgFCycleWidth * 1000;
-        ch_status[channel].Freq = 1.0 / avgFCycleWidth;
-        ch_status[channel].Duty = avgPCycleWidth * 100 / avgFCycleWidth;
-    } else {
-        ch_status[channel].PCycle_ms = -1;
-        ch_status[channel].FCycle_ms = -1;
-        ch_status[channel].Freq = -1;
-        ch_status[channel].Duty = -1;
-    }
-    /*
-    printf ("================\n");
-    printf ("avgPW %lf ms\n", ch_status[channel].PCycle_ms);
-    printf ("duty %lf %%\n", ch_status[channel].Duty);
-    printf ("freq %lf Hz\n", ch_status[channel].Freq);
-    printf ("cycle %lf ms\n", ch_status[channel].FCycle_ms);
-    printf ("Vrms %lf V\n", ch_status[channel].Vrms);
-    printf ("Vavr %lf V\n", ch_status[channel].Vavr);
-    printf ("Vmax %lf V\n", ch_status[channel].Vmax);
-    printf ("Vmin %lf V\n", ch_status[channel].Vmax);
-     */
+    ScopeAnalysis.Post();
+}
+
+int COscilloscope::FetchAnalysis(void) {
+    const scope_job_t* job = ScopeAnalysis.Fetch();
+
+    if (!job)
+        return 0;
+
+    for (int c = 0; c < chcount; c++) {
+        if (job->chmask & (1 << c)) {
+            ch_status[c] = job->status[c];
+        }
+        if (job->fftmask & (1 << c)) {
+            spectrum[c] = job->spectrum[c];
+            fdom[c] = job->fdom[c];
+        } else {
+            spectrum[c] = NULL;
+        }
+    }
+    spectrum_bins = job->fftmask ? job->nfft / 2 : 0;
+    spectrum_rt = job->rt;
+    return 1;
 }
 
 void COscilloscope::ClearStats(int channel) {
@@ -261,9 +485,64 @@ void COscilloscope::WritePreferences(void) {
     PICSimLab.SavePrefs(lxT("osc_measures"), itoa(GetMeasures(0)) + lxT(",") + itoa(GetMeasures(1)) + lxT(",") +
                                                  itoa(GetMeasures(2)) + lxT(",") + itoa(GetMeasures(3)) + lxT(",") +
                                                  itoa(GetMeasures(4)));
+    PICSimLab.SavePrefs(lxT("osc_record"), itoa(GetRecordLength()));
+    PICSimLab.SavePrefs(lxT("osc_noise"), itoa(GetNoise()));
+    PICSimLab.SavePrefs(lxT("osc_spectrum"), itoa(GetSpectrumMode()));
+    PICSimLab.SavePrefs(lxT("osc_channels"), itoa(GetChannelCount()));
+    for (int c = 2; c < GetChannelCount(); c++) {
+        PICSimLab.SavePrefs(lxT("osc_pin") + itoa(c + 1), itoa(GetChannelPin(c) + 1));
+    }
+    PICSimLab.SavePrefs(lxT("osc_tmode"), itoa(GetTriggerMode()));
+    PICSimLab.SavePrefs(lxT("osc_tpulse"), ftoa(tpmin * 1e3) + lxT(",") + ftoa(tpmax * 1e3));
+    PICSimLab.SavePrefs(lxT("osc_tpattern"), GetTriggerPattern());
+    PICSimLab.SavePrefs(lxT("osc_tholdoff"), ftoa(GetTriggerHoldoff() * 1e3));
 }
 
 void COscilloscope::ReadPreferences(char* name, char* value) {
+    if (!strcmp(name, "osc_record")) {
+        SetRecordLength(atoi(value));
+    }
+
+    if (!strcmp(name, "osc_noise")) {
+        SetNoise(atoi(value));
+    }
+
+    if (!strcmp(name, "osc_spectrum")) {
+        SetSpectrumMode(atoi(value));
+    }
+
+    if (!strcmp(name, "osc_channels")) {
+        SetChannelCount(atoi(value));
+    }
+
+    if (!strncmp(name, "osc_pin", 7)) {
+        int chn = atoi(name + 7) - 1;
+        if ((chn >= 2) && (chn < OSC_MAX_CH)) {
+            SetChannelPin(chn, atoi(value) - 1);
+        }
+    }
+
+    if (!strcmp(name, "osc_tmode")) {
+        int tm = atoi(value);
+        if ((tm >= 0) && (tm < OSC_TRG_LAST)) {
+            SetTriggerMode(tm);
+        }
+    }
+
+    if (!strcmp(name, "osc_tpulse")) {
+        double min = 0, max = 0;
+        sscanf(value, "%lf,%lf", &min, &max);
+        SetTriggerPulse(min * 1e-3, max * 1e-3);
+    }
+
+    if (!strcmp(name, "osc_tpattern")) {
+        SetTriggerPattern(value);
+    }
+
+    if (!strcmp(name, "osc_tholdoff")) {
+        SetTriggerHoldoff(atof(value) * 1e-3);
+    }
+
     if (!Window) {
         return;
     }
@@ -333,6 +612,10 @@ void COscilloscope::ReadPreferences(char* name, char* value) {
 
     if (!strcmp(name, "osc_tch")) {
         ((CCombo*)Window->GetChildByName("combo1"))->SetText(value);
+        int tc = atoi(value) - 1;
+        if ((tc >= 0) && (tc < GetChannelCount())) {
+            SetTriggerChannel(tc);
+        }
     }
 
     if (!strcmp(name, "osc_tlevel")) {
@@ -376,7 +659,21 @@ lxStringList COscilloscope::WritePreferencesList(void) {
     line += ftoa(((CSpind*)Window->GetChildByName("spind7"))->GetValue()) + ",";
     // osc_measures
     line += itoa(GetMeasures(0)) + "," + itoa(GetMeasures(1)) + +"," + itoa(GetMeasures(2)) + +"," +
-            itoa(GetMeasures(3)) + +"," + itoa(GetMeasures(4));
+            itoa(GetMeasures(3)) + +"," + itoa(GetMeasures(4)) + ",";
+    // osc_channels
+    line += itoa(GetChannelCount()) + ",";
+    // osc_tmode
+    line += itoa(GetTriggerMode()) + ",";
+    // osc_tpulse
+    line += ftoa(tpmin * 1e3) + "," + ftoa(tpmax * 1e3) + ",";
+    // osc_tpattern
+    line += GetTriggerPattern() + ",";
+    // osc_tholdoff
+    line += ftoa(GetTriggerHoldoff() * 1e3);
+    // osc_pin3 to osc_pin8
+    for (int c = 2; c < OSC_MAX_CH; c++) {
+        line += "," + itoa(GetChannelPin(c) + 1);
+    }
     list.AddLine(line);
 
     line = "osc_ch1,0,0,0:";
@@ -414,15 +711,16 @@ lxStringList COscilloscope::WritePreferencesList(void) {
 
 void COscilloscope::ReadPreferencesList(lxStringList pl) {
     char line[1024];
-    char* tokens[15];
+    char* tokens[26];
 
     if (!Window) {
         return;
     }
 
+    memset(tokens, 0, sizeof(tokens));
     strncpy(line, (const char*)pl.GetLine(0).c_str(), 1023);
     tokens[0] = strtok(line, ",:\n");
-    for (int i = 1; i < 15; i++) {
+    for (int i = 1; i < 26; i++) {
         tokens[i] = strtok(NULL, ",:\n");
         if (tokens[i] == NULL) {
             break;
@@ -454,6 +752,36 @@ void COscilloscope::ReadPreferencesList(lxStringList pl) {
         SetMeasure(i, atoi(tokens[9 + i]));
     }
 
+    // workspaces saved by older versions end here
+    if (tokens[25]) {
+        // osc_pin3 to osc_pin8
+        for (int c = 2; c < OSC_MAX_CH; c++) {
+            SetChannelPin(c, atoi(tokens[18 + c]) - 1);
+        }
+
+        // osc_channels
+        SetChannelCount(atoi(tokens[14]));
+
+        // osc_tmode
+        int tm = atoi(tokens[15]);
+        if ((tm >= 0) && (tm < OSC_TRG_LAST)) {
+            SetTriggerMode(tm);
+        }
+
+        // osc_tpulse
+        SetTriggerPulse(atof(tokens[16]) * 1e-3, atof(tokens[17]) * 1e-3);
+
+        // osc_tpattern
+        SetTriggerPattern(tokens[18]);
+
+        // osc_tholdoff
+        SetTriggerHoldoff(atof(tokens[19]) * 1e-3);
+    }
+    int tc = atoi(((CCombo*)Window->GetChildByName("combo1"))->GetText()) - 1;
+    if ((tc >= 0) && (tc < GetChannelCount())) {
+        SetTriggerChannel(tc);
+    }
+
     strncpy(line, (const char*)pl.GetLine(1).c_str(), 1023);
     tokens[0] = strtok(line, ",:\n");
     for (int i = 1; i < 15; i++) {
@@ -28,12 +28,25 @@
 
 #include "board.h"
 
+#ifndef _NOTHREAD
+#include <mutex>
+#endif
+
 #define WMAX 350
 #define HMAX 250
 
 #define NPOINTS (2 * WMAX)
 
-#define MAX_MEASURES 10
+#define OSC_RECORD_MIN 1024      // smallest record length (must hold a full frame)
+#define OSC_RECORD_MAX 1048576   // largest record length
+#define OSC_RECORD_DEF 4096      // default record length
+
+#define MAX_MEASURES 11
+
+#define OSC_MAX_CH 8  // max number of capture channels (one bit each in trigger level masks)
+
+// trigger modes
+enum { OSC_TRG_RISING = 0, OSC_TRG_FALLING, OSC_TRG_EDGE, OSC_TRG_PULSE, OSC_TRG_PATTERN, OSC_TRG_LAST };
 
 typedef struct {
     double Vrms;
@@ -57,6 +70,11 @@ public:
      */
     void SetSample(void);
 
+    /**
+     * @brief  Catch up the data aquisition of N steps where input pins don't change (uses last sampled values)
+     */
+    void SetSamples(long nsteps);
+
     void SetBoard(board* b) { pboard = b; };
 
     void NextMeasure(int mn);
@@ -69,19 +87,114 @@ public:
     void SetUseTrigger(int utg) { usetrigger = utg; };
 
     int GetTriggerChannel(void) { return tch; };
-    void SetTriggerChannel(int tc) { tch = tc; };
+    void SetTriggerChannel(int tc) {
+        tch = tc;
+        tsrc = 1 << tc;
+    };
+
+    int GetTriggerMode(void) { return tmode; };
+    void SetTriggerMode(int tm) { tmode = tm; };
+
+    /**
+     * @brief  Set the pulse width range (in seconds, 0 is no limit) of OSC_TRG_PULSE mode
+     */
+    void SetTriggerPulse(double min, double max) {
+        tpmin = min;
+        tpmax = max;
+    };
+    double GetTriggerPulseMin(void) { return tpmin; };
+    double GetTriggerPulseMax(void) { return tpmax; };
+
+    /**
+     * @brief  Set the pattern of OSC_TRG_PATTERN mode, one char per channel: '1' high, '0' low, other don't care
+     */
+    void SetTriggerPattern(const char* pattern);
+    lxString GetTriggerPattern(void);
+
+    /**
+     * @brief  Set the minimum time (in seconds) between two triggers
+     */
+    void SetTriggerHoldoff(double ho) { tholdoff = ho; };
+    double GetTriggerHoldoff(void) { return tholdoff; };
+
+    /**
+     * @brief  Set the number of capture channels (1 to OSC_MAX_CH), the simulation is paused while the rings change
+     */
+    void SetChannelCount(int chn);
+    int GetChannelCount(void) { return chcount; };
 
     double* GetChannel(int cn) { return ch[cn]; };
 
+    /**
+     * @brief  Return the lowest value seen between samples (same layout of GetChannel)
+     */
+    double* GetChannelMin(int cn) { return chmin[cn]; };
+
+    /**
+     * @brief  Return the highest value seen between samples (same layout of GetChannel)
+     */
+    double* GetChannelMax(int cn) { return chmax[cn]; };
+
+    /**
+     * @brief  Set the capture record length (rounded up to a power of two), call it with the simulation stopped
+     */
+    void SetRecordLength(int len) { Alloc(len, chcount); };
+    int GetRecordLength(void) { return rlen; };
+
+    /**
+     * @brief  Copy up to n samples of the record ending at the last displayed frame, return the number copied
+     *
+     * Safe to call from the UI and remote control threads while the rings are reallocated.
+     */
+    int GetRecord(int cn, double* buff, int n);
+
+    /**
+     * @brief  Enable or disable the simulated measurement noise
+     */
+    void SetNoise(int ns) { noise = ns; };
+    int GetNoise(void) { return noise; };
+
     void CalculateStats(int channel);
     void ClearStats(int channel);
 
+    /**
+     * @brief  Snapshot channels data and start the measures (chmask) and spectrum (fftmask) calculation in background
+     */
+    void StartAnalysis(int chmask, int fftmask);
+
+    /**
+     * @brief  Update channels status and spectrum with the last finished analysis, return 1 if updated
+     */
+    int FetchAnalysis(void);
+
+    /**
+     * @brief  Return the spectrum magnitudes (peak volts) of the last analysis or NULL, bins receive the size
+     */
+    const float* GetSpectrum(int cn, int* bins) {
+        *bins = spectrum_bins;
+        return spectrum[cn];
+    };
+
+    /**
+     * @brief  Return the frequency of the spectrum bin
+     */
+    double GetSpectrumFreq(int bin) { return spectrum_bins ? bin / (2.0 * spectrum_bins * spectrum_rt) : 0; };
+
+    /**
+     * @brief  Return the dominant frequency of the last spectrum or -1
+     */
+    double GetDominantFreq(int cn) { return spectrum[cn] ? fdom[cn] : -1; };
+
+    int GetSpectrumMode(void) { return spectrum_mode; };
+    void SetSpectrumMode(int sm) { spectrum_mode = sm; };
+
     ch_status_t GetChannelStatus(int cn) { return ch_status[cn]; };
 
     int GetUpdate(void) { return update; };
     void SetUpdate(int up) { update = up; };
 
     void SetChannelPin(int ch, int pin) { chpin[ch] = pin; };
+    int GetChannelPin(int ch) { return chpin[ch]; };
 
     int GetTimeOffset(void) { return toffset; };
     void SetTimeOffset(int to) { toffset = to; };
@@ -92,6 +205,7 @@ public:
     void SetTriggerLevel(double tl) { triggerlv = tl; };
 
     void SetVMax(float vm) { vmax = vm; };
+    float GetVMax(void) { return vmax; };
 
     void SetRT(double rt) { Rt = rt; };
     double GetRT(void) { return Rt; };
@@ -118,14 +232,40 @@ private:
     double Rt;  // Relative delta T
     int usetrigger;
     double triggerlv;
-    int tch;  // trigger channel
+    int tch;        // trigger channel
+    uint32_t tsrc;  // trigger channel bit
+    int tmode;      // trigger mode
+    double tpmin;   // pulse trigger min width
+    double tpmax;   // pulse trigger max width
+    uint32_t tpmask;   // pattern trigger channels mask
+    uint32_t tpvalue;  // pattern trigger channels value
+    double tholdoff;   // trigger holdoff
+    uint64_t tsteps;   // steps counter
+    uint64_t tlast;    // step of the last trigger
+    uint64_t trise;    // step of the last rising edge of trigger channel
+    uint32_t lvl_;     // last channels digital levels
     int toffset;
-    int chpin[2];
-    double databuffer[2][2][NPOINTS];  // flip buffers + 2 channels + 700 points
-    int fp;                            // actual flip buffer
-    double* ch[2];                     // actual channel data (pointer to databuffer)
-    ch_status_t ch_status[2];          // channel measurament status
-    double pins_[2];                   // last value of input pins
+    int chcount;
+    int chpin[OSC_MAX_CH];
+    double* ring[OSC_MAX_CH];          // capture ring buffers
+    double* ringmin[OSC_MAX_CH];       // lowest value between samples
+    double* ringmax[OSC_MAX_CH];       // highest value between samples
+    int rlen;                          // record length (power of two)
+    unsigned int rmask;                // ring index mask
+    unsigned int wpos;                 // ring write position
+    unsigned int rend;                 // ring position of the last displayed frame end
+#ifndef _NOTHREAD
+    std::mutex ring_mtx;  // rings reallocation against the UI and remote control readers
+#endif
+    double frame[2][OSC_MAX_CH][3][NPOINTS];  // flip buffers + channels + (value, min, max) + 700 points
+    int fp;                                   // actual flip buffer
+    double* ch[OSC_MAX_CH];                   // actual channel data (pointer to frame)
+    double* chmin[OSC_MAX_CH];                // actual channel min data (pointer to frame)
+    double* chmax[OSC_MAX_CH];                // actual channel max data (pointer to frame)
+    ch_status_t ch_status[OSC_MAX_CH];        // channel measurament status
+    double pins_[OSC_MAX_CH];                 // last value of input pins
+    double pmin[OSC_MAX_CH];                  // lowest input value since last sample
+    double pmax[OSC_MAX_CH];                  // highest input value since last sample
     int is;                            // input samples
     double t;                          // time
     int tr;                            // trigger
@@ -133,11 +273,49 @@ private:
     int update;
     int measures[5];
     float vmax;
+    int noise;
+    uint32_t noise_seed;
+    int spectrum_mode;
+    int spectrum_bins;
+    double spectrum_rt;
+    const float* spectrum[OSC_MAX_CH];  // pointer to the last fetched analysis
+    double fdom[OSC_MAX_CH];
 
     CToggleButton* tbstop;
     CToggleButton* tbsingle;
+
+    /**
+     * @brief  Allocate ring buffers of len samples (rounded up to a power of two) for chn channels
+     */
+    void Alloc(int len, int chn);
+
+    /**
+     * @brief  Evaluate the trigger condition for the channels digital levels
+     */
+    int Trigger(const uint32_t lvl);
+
+    /**
+     * @brief  Store one sample of each channel in ring and publish the frame when it is complete
+     */
+    void PutSample(const double* pins);
+
+    /**
+     * @brief  Copy the last frame from ring to the display flip buffer
+     */
+    void Publish(void);
+
+    /**
+     * @brief  Return a deterministic noise value (xorshift32)
+     */
+    double Noise(void) {
+        noise_seed ^= noise_seed << 13;
+        noise_seed ^= noise_seed >> 17;
+        noise_seed ^= noise_seed << 5;
+        return ((noise_seed >> 8) * (1.0 / 16777216.0) - 0.5) * 0.1;
+    };
 };
 
-extern COscilloscope Oscilloscope;
+// Object of the simulation context bound to the calling thread (simcontext.h)
+extern thread_local COscilloscope& Oscilloscope;
 
 #endif  // OSCILLOSCOPE
\ No newline at end of file
@@ -0,0 +1,143 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "pacer.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "picsimlab.h"
+
+#define PACE_TARGET_LOAD 0.9  // cpu thread load target
+#define PACE_MIN_RATIO 0.3    // slowest pace, period of BASETIMER/0.3 ms
+#define PACE_KP 0.2           // proportional gain
+#define PACE_KI 0.2           // integral gain
+#define PACE_MAX_QUEUE 3      // runs queued before drop ticks
+#define PACE_DROP_LAG 1000.0  // lag in ms to give up catching up
+#define PACE_GAP 1.0          // ticks interval in s that restarts pacing (simulation stopped)
+
+CPacer Pacer;
+
+static const unsigned int hist_limits[PACE_HIST] = {1, 2, 5, 10, 20, 50, 100, 0};
+
+CPacer::CPacer() {
+    Reset();
+}
+
+void CPacer::Reset(void) {
+    started = 0;
+    last_wall = 0;
+    expected = 0;
+    ratio = 1.0;
+    error = 0;
+    load = 0;
+    period = BASETIMER;
+    lag = 0;
+    jitter = 0;
+    max_jitter = 0;
+    overruns = 0;
+    catchups = 0;
+    drops = 0;
+    memset(lag_hist, 0, sizeof(lag_hist));
+    memset(jitter_hist, 0, sizeof(jitter_hist));
+}
+
+int CPacer::Tick(const double wall, const int queued, const double simtime) {
+    const double dt = wall - last_wall;
+
+    last_wall = wall;
+
+    if ((!started) || (dt > PACE_GAP) || (dt < 0)) {
+        started = 1;
+        expected = simtime + queued * BASETIMER * 1e-3;
+        return 1;
+    }
+
+    // timer tick jitter
+    const double jit = fabs((dt * 1e3) - period);
+    jitter = (jitter * 0.9) + (jit * 0.1);
+    if (jit > max_jitter) {
+        max_jitter = jit;
+    }
+    Histogram(jitter_hist, jit);
+
+    // PI control of the simulated/wall time ratio (velocity form, no windup)
+    const double e = PACE_TARGET_LOAD - (load * ratio);
+    ratio += (PACE_KP * (e - error)) + (PACE_KI * e);
+    error = e;
+    if (ratio > 1.0) {
+        ratio = 1.0;
+    } else if (ratio < PACE_MIN_RATIO) {
+        ratio = PACE_MIN_RATIO;
+    }
+    period = (unsigned int)((BASETIMER / ratio) + 0.5);
+
+    // lag of simulated time at actual pace, the run due in this tick is not late
+    expected += dt * ratio;
+    lag = ((expected - simtime) * 1e3) - BASETIMER;
+    Histogram(lag_hist, lag > 0 ? lag : 0);
+
+    if (queued) {
+        overruns++;
+    }
+
+    if (lag > PACE_DROP_LAG) {
+        drops++;
+        expected = simtime + queued * BASETIMER * 1e-3;
+        return queued < PACE_MAX_QUEUE;
+    }
+
+    if (queued >= PACE_MAX_QUEUE) {
+        return 0;  // cpu thread is behind, skip this tick
+    }
+
+    if ((lag > BASETIMER) && (!queued)) {
+        catchups++;
+        return 2;
+    }
+
+    return 1;
+}
+
+void CPacer::RunDone(const double etime) {
+    load = (load * 0.7) + (((etime * 1e3) / BASETIMER) * 0.3);
+}
+
+unsigned int CPacer::GetHistogramLimit(const int n) {
+    if ((n >= 0) && (n < PACE_HIST)) {
+        return hist_limits[n];
+    }
+    return 0;
+}
+
+void CPacer::Histogram(unsigned int* hist, const double ms) {
+    int i;
+    for (i = 0; i < PACE_HIST - 1; i++) {
+        if (ms < hist_limits[i]) {
+            break;
+        }
+    }
+    hist[i]++;
+}
@@ -0,0 +1,116 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef PACER_H
+#define PACER_H
+
+#define PACE_HIST 8  // histograms buckets
+
+/**
+ * @brief Real time pacing controller
+ *
+ * Every timer tick queues runs of BASETIMER ms of simulated time. A PI
+ * controller adjusts the simulated/wall time ratio so the cpu thread load
+ * stays below PACE_TARGET_LOAD. The lag between the expected simulated time
+ * (at the current ratio) and the simulated time is recovered queuing an extra
+ * run (catch-up) or, if it is too big, forgotten (drop).
+ */
+class CPacer {
+public:
+    CPacer();
+
+    /**
+     * @brief Restart pacing and clear statistics
+     */
+    void Reset(void);
+
+    /**
+     * @brief Called every timer tick with wall time in s, runs still queued and simulated time in s
+     *
+     * Return the number of runs to queue.
+     */
+    int Tick(const double wall, const int queued, const double simtime);
+
+    /**
+     * @brief Called by cpu thread after each run with the run wall time in s
+     */
+    void RunDone(const double etime);
+
+    /**
+     * @brief Return the timer period in ms for the actual ratio
+     */
+    unsigned int GetPeriod(void) { return period; };
+
+    /**
+     * @brief Return the simulated/wall time ratio
+     */
+    double GetRatio(void) { return ratio; };
+
+    /**
+     * @brief Return the cpu thread wall time needed for each simulated time unit
+     */
+    double GetLoad(void) { return load; };
+
+    double GetLag(void) { return lag; };        ///< lag in ms
+    double GetJitter(void) { return jitter; };  ///< mean timer tick jitter in ms
+    double GetMaxJitter(void) { return max_jitter; };
+    unsigned int GetOverruns(void) { return overruns; };
+    unsigned int GetCatchUps(void) { return catchups; };
+    unsigned int GetDrops(void) { return drops; };
+
+    /**
+     * @brief Return histograms of ticks lag and jitter with PACE_HIST buckets
+     */
+    const unsigned int* GetLagHistogram(void) { return lag_hist; };
+    const unsigned int* GetJitterHistogram(void) { return jitter_hist; };
+
+    /**
+     * @brief Return the upper limit in ms of histogram bucket n (0 for the last)
+     */
+    static unsigned int GetHistogramLimit(const int n);
+
+private:
+    int started;
+    double last_wall;
+    double expected;  ///< expected simulated time in s
+    double ratio;
+    double error;
+    double load;
+    unsigned int period;
+    double lag;
+    double jitter;
+    double max_jitter;
+    unsigned int overruns;
+    unsigned int catchups;
+    unsigned int drops;
+    unsigned int lag_hist[PACE_HIST];
+    unsigned int jitter_hist[PACE_HIST];
+
+    void Histogram(unsigned int* hist, const double ms);
+};
+
+extern CPacer Pacer;
+
+#endif /* PACER_H */
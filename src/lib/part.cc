@@ -24,12 +24,18 @@
    ######################################################################## */
 
 #include "../lib/part.h"
+#include "../lib/imagecache.h"
+#include "../lib/mapfile.h"
 #include "../lib/picsimlab.h"
 #include "../lib/spareparts.h"
 
 part::part(const unsigned x, const unsigned y, const char* name, const char* type, board* pboard_, const int fsize)
     : font(fsize, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
     always_update = 0;
+    pin_sensitive = 1;
+    sample_period = 0;
+    sample_timer = 0;
+    sample_timer_period = 0;
     inputc = 0;
     outputc = 0;
     Orientation = 0;
@@ -47,12 +53,20 @@ part::part(const unsigned x, const unsigned y, const char* name, const char* typ
     PinCount = 0;
     Pins = NULL;
 
+    input = NULL;
+    output = NULL;
+    memset(&input_none, 0, sizeof(input_t));
+    memset(&output_none, 0, sizeof(output_t));
     for (int i = 0; i < MAX_IDS; i++) {
-        input_ids[i] = &input[i];
-        output_ids[i] = &output[i];
+        input_ids[i] = &input_none;
+        output_ids[i] = &output_none;
     }
 }
 
+part::~part(void) {
+    FreeMaps();
+}
+
 void part::Init(void) {
     ReadMaps();
     LoadImage();
@@ -63,191 +77,52 @@ void part::Init(void) {
 }
 
 void part::ReadMaps(void) {
-    inputc = 0;
-    outputc = 0;
-    ReadInputMap(lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/") + Type + "/" + GetMapFile()));
-    ReadOutputMap(lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/") + Type + "/" + GetMapFile()));
+    lxString fname = lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/") + Type + "/" + GetMapFile());
+    const mapfile_t* map = MapFiles.Get(fname);
+
+    FreeMaps();
 
+    if (!map) {
+        printf("PICSimLab: (%s) Error open map \"%s\"!\n", (const char*)Name.c_str(), (const char*)fname.c_str());
+        PICSimLab.RegisterError(Name + ": Error open map:\n" + fname);
+        return;
+    }
+
+    if (map->width)
+        Width = map->width;
+    if (map->height)
+        Height = map->height;
+
+    // only the elements present in map are copied from the shared parsed map
+    inputc = map->inputc;
+    input = new input_t[inputc];
     for (int i = 0; i < inputc; i++) {
-        input_ids[GetInputId(input[i].name)] = &input[i];
+        input[i] = map->input[i];
+        input[i].id = GetInputId(input[i].name);
+        input_ids[input[i].id] = &input[i];
     }
 
+    outputc = map->outputc;
+    output = new output_t[outputc];
     for (int i = 0; i < outputc; i++) {
-        output_ids[GetOutputId(output[i].name)] = &output[i];
-    }
-}
-
-void part::ReadInputMap(lxString fname) {
-    FILE* fin;
-
-    char line[256];
-
-    char* it;
-    char* shape;
-    char* coords;
-    char* name;
-    char* value;
-
-    int x1, y1, x2, y2, r;
-
-    fin = fopen(fname.c_str(), "r");
-
-    if (fin) {
-        while (fgets(line, 256, fin)) {
-            it = strtok(line, "< =\"");
-            if (!strcmp("img", it)) {
-                do {
-                    name = strtok(NULL, "< =\"");
-                    value = strtok(NULL, "<=\"");
-
-                    if (!strcmp("width", name)) {
-                        sscanf(value, "%i", &x1);
-                        Width = x1;
-                        // Window1.SetplWidth(x1);
-                        // Window1.draw1.SetWidth(x1*Window1.GetScale());
-                        // Window1.SetWidth(185+x1*Window1.GetScale());
-                    }
-
-                    if (!strcmp("height", name)) {
-                        sscanf(value, "%i", &y1);
-                        Height = y1;
-                        // Window1.SetplHeight(y1);
-                        // Window1.draw1.SetHeight(y1*Window1.GetScale());
-                        /*
-                        #ifdef _WIN_
-                                    Window1.SetHeight(75+y1*Window1.GetScale());
-                        #else
-                                    Window1.SetHeight(90+y1*Window1.GetScale());
-                        #endif
-                         */
-                    }
-
-                } while (value != NULL);
-
-                //        printf("%s %s %s\n",name,shape,coords);
-
-            } else if (!strcmp("area", it)) {
-                strtok(NULL, "< =\"");
-                shape = strtok(NULL, "< =\"");
-                strtok(NULL, "< =\"");
-                coords = strtok(NULL, "< =\"");
-                strtok(NULL, "< =\"");
-                name = strtok(NULL, "< =\"");
-
-                //        printf("%s %s %s\n",name,shape,coords);
-
-                if (((name[0] == 'I') || (name[0] == 'B')) && (name[1] == '_')) {
-                    if (strcmp("rect", shape) == 0) {
-                        sscanf(coords, "%i,%i,%i,%i\n", &x1, &y1, &x2, &y2);
-                        //          printf("rect=%i,%i,%i,%i\n",x1,y1,x2,y2);
-
-                        input[inputc].x1 = x1;
-                        input[inputc].y1 = y1;
-                        input[inputc].x2 = x2;
-                        input[inputc].y2 = y2;
-                    } else {
-                        sscanf(coords, "%i,%i,%i\n", &x1, &y1, &r);
-                        //          printf("circle=%i,%i,%i\n",x1,y1,r);
-                        input[inputc].x1 = x1 - r;
-                        input[inputc].y1 = y1 - r;
-                        input[inputc].x2 = x1 + r;
-                        input[inputc].y2 = y1 + r;
-                    }
-                    strcpy(input[inputc].name, name + 2);
-                    input[inputc].id = GetInputId(input[inputc].name);
-                    input[inputc].cx = ((input[inputc].x2 - input[inputc].x1) / 2.0) + input[inputc].x1;
-                    input[inputc].cy = ((input[inputc].y2 - input[inputc].y1) / 2.0) + input[inputc].y1;
-                    input[inputc].status = NULL;
-                    input[inputc].update = NULL;
-                    input[inputc].value = 0;
-                    input[inputc].value_s = 0;
-                    input[inputc].value_f = 0;
-                    inputc++;
-                }
-            }
-        }
-        fclose(fin);
-    } else {
-        printf("PICSimLab: (%s) Error open input.map \"%s\"!\n", (const char*)Name.c_str(), (const char*)fname.c_str());
-        PICSimLab.RegisterError(Name + ": Error open input.map:\n" + fname);
-    }
-}
-
-void part::ReadOutputMap(lxString fname) {
-    FILE* fin;
-
-    char line[256];
-
-    char* it;
-    char* shape;
-    char* coords;
-    char* name;
-
-    int x1, y1, x2, y2, r;
-
-    fin = fopen(fname.c_str(), "r");
-
-    if (fin) {
-        while (fgets(line, 256, fin)) {
-            it = strtok(line, "< =\"");
-            if (!strcmp("area", it)) {
-                strtok(NULL, "< =\"");
-                shape = strtok(NULL, "< =\"");
-                strtok(NULL, "< =\"");
-                coords = strtok(NULL, "< =\"");
-                strtok(NULL, "< =\"");
-                name = strtok(NULL, "< =\"");
-
-                //        printf("%s %s %s\n",name,shape,coords);
-                if (((name[0] == 'O') || (name[0] == 'B')) && (name[1] == '_')) {
-                    if (!strcmp("rect", shape)) {
-                        sscanf(coords, "%i,%i,%i,%i\n", &x1, &y1, &x2, &y2);
-                        //          printf("rect=%i,%i,%i,%i\n",x1,y1,x2,y2);
-
-                        output[outputc].x1 = x1;
-                        output[outputc].y1 = y1;
-                        output[outputc].x2 = x2;
-                        output[outputc].y2 = y2;
-                        output[outputc].r = 0;
-                        //          output[outputc].lval=-1;
-                        strcpy(output[outputc].name, name + 2);
-                        output[outputc].id = GetOutputId(output[outputc].name);
-                        output[outputc].cx = ((output[outputc].x2 - output[outputc].x1) / 2.0) + output[outputc].x1;
-                        output[outputc].cy = ((output[outputc].y2 - output[outputc].y1) / 2.0) + output[outputc].y1;
-                        output[outputc].status = NULL;
-                        output[outputc].value = 0;
-                        output[outputc].value_s = 0;
-                        output[outputc].value_f = 0;
-                        outputc++;
-                    } else {
-                        sscanf(coords, "%i,%i,%i\n", &x1, &y1, &r);
-                        //          printf("circle=%i,%i,%i\n",x1,y1,r);
-                        output[outputc].x1 = x1;
-                        output[outputc].y1 = y1;
-                        output[outputc].x2 = 0;
-                        output[outputc].y2 = 0;
-                        output[outputc].r = r;
-                        //          output[outputc].lval=-1;
-                        strcpy(output[outputc].name, name + 2);
-                        output[outputc].id = GetOutputId(output[outputc].name);
-                        output[outputc].cx = output[outputc].x1;
-                        output[outputc].cy = output[outputc].y1;
-                        output[outputc].status = NULL;
-                        output[outputc].value = 0;
-                        output[outputc].value_s = 0;
-                        output[outputc].value_f = 0;
-                        outputc++;
-                    }
-                }
-            }
-        }
+        output[i] = map->output[i];
+        output[i].id = GetOutputId(output[i].name);
+        output[i].update = 1;
+        output_ids[output[i].id] = &output[i];
+    }
+}
 
-        fclose(fin);
-    } else {
-        printf("PICSimLab: (%s) Error open output.map \"%s\"!\n", (const char*)Name.c_str(),
-               (const char*)fname.c_str());
-        PICSimLab.RegisterError(Name + ": Error open output.map:\n" + fname);
+void part::FreeMaps(void) {
+    for (int i = 0; i < MAX_IDS; i++) {
+        input_ids[i] = &input_none;
+        output_ids[i] = &output_none;
     }
+    delete[] input;
+    delete[] output;
+    input = NULL;
+    output = NULL;
+    inputc = 0;
+    outputc = 0;
 }
 
 int part::PointInside(int x, int y) {
@@ -322,31 +197,42 @@ int part::PointInside(int x, int y, input_t input) {
 }
 
 void part::LoadImage(void) {
-    lxImage image(SpareParts.GetWindow());
+    CWindow* win = SpareParts.GetWindow();
     lxString iname = lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/") + Type + "/" + GetPictureFileName());
 
-    if (image.LoadFile(iname, Orientation, Scale, Scale)) {
-        if (SpareParts.GetWindow()) {
-            Bitmap = new lxBitmap(&image, SpareParts.GetWindow());
-            image.Destroy();
-            canvas.Destroy();
-            canvas.Create(SpareParts.GetWindow()->GetWWidget(), Bitmap);
-        }
-    } else if (image.LoadFile(lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/Common/notfound.svg")), Orientation,
-                              Scale, Scale)) {
-        if (SpareParts.GetWindow()) {
-            Bitmap = new lxBitmap(&image, SpareParts.GetWindow());
-
-            image.Destroy();
-            canvas.Destroy();
-            canvas.Create(SpareParts.GetWindow()->GetWWidget(), Bitmap);
+    if (!win) {
+        // no window to draw, only check the picture file
+        lxImage image(win);
+        if (!image.LoadFile(iname, Orientation, Scale, Scale)) {
+            printf("PICSimLab: (%s) Error loading image %s\n", (const char*)Name.c_str(), (const char*)iname.c_str());
+            PICSimLab.RegisterError("Error loading image:\n " + iname);
         }
+        return;
+    }
+
+    // the cached image is shared, each part draws on its own bitmap
+    Bitmap = new lxBitmap(LoadPicture(), win);
+    canvas.Destroy();
+    canvas.Create(win->GetWWidget(), Bitmap);
+}
+
+lxImage* part::LoadPicture(void) {
+    CWindow* win = SpareParts.GetWindow();
+    lxString iname = lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/") + Type + "/" + GetPictureFileName());
+
+    lxImage* image = ImageCache.GetImage(iname, Orientation, Scale, win);
+
+    if (!image) {
         printf("PICSimLab: (%s) Error loading image %s\n", (const char*)Name.c_str(), (const char*)iname.c_str());
+        image = ImageCache.GetImage(lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/Common/notfound.svg")),
+                                    Orientation, Scale, win);
+        if (!image) {
+            exit(-1);
+        }
         PICSimLab.RegisterError("Error loading image:\n " + iname);
-    } else {
-        printf("PICSimLab: (%s) Error loading image %s\n", (const char*)Name.c_str(), (const char*)iname.c_str());
-        exit(-1);
     }
+
+    return image;
 }
 
 int part::GetOrientation(void) {
@@ -533,6 +419,14 @@ void part::SetAlwaysUpdate(int sau) {
     always_update = sau;
 }
 
+int part::GetPinSensitive(void) {
+    return pin_sensitive;
+}
+
+void part::SetPinSensitive(int sps) {
+    pin_sensitive = sps;
+}
+
 void part::SetPCWProperties(const PCWProp* pcwprop) {
     PCWProperties = pcwprop;
     PCWCount = 0;
@@ -584,6 +478,14 @@ lxString part::GetName(void) {
     return Name;
 }
 
+int part::GetDrawPending(void) {
+    for (int i = 0; i < outputc; i++) {
+        if (output[i].update)
+            return 1;
+    }
+    return 0;
+}
+
 void part::Draw(void) {
     Update = 0;
 
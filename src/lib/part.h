@@ -73,6 +73,16 @@ public:
      */
     virtual void DrawOutput(const unsigned int index) = 0;
 
+    /**
+     * @brief  Called from draw worker threads before Draw, can only use part own memory (no canvas)
+     */
+    virtual void DrawPrepare(void){};
+
+    /**
+     * @brief  Return if any output need be draw
+     */
+    int GetDrawPending(void);
+
     /**
      * @brief  Called every start of CPU process
      */
@@ -251,7 +261,7 @@ public:
     /**
      * @brief  Called once on part destruction
      */
-    virtual ~part(void){};
+    virtual ~part(void);
 
     /**
      * @brief  Return the Bitmap of part
@@ -303,6 +313,11 @@ public:
      */
     virtual void LoadImage(void);
 
+    /**
+     * @brief  Return the part picture at current orientation and scale (the not found picture on error)
+     */
+    lxImage* LoadPicture(void);
+
     /**
      * @brief  Return the orientation to draw
      */
@@ -353,6 +368,39 @@ public:
      */
     void SetAlwaysUpdate(int sau);
 
+    /**
+     * @brief  Return if part Process need be called only when one of its pins changes
+     */
+    int GetPinSensitive(void);
+
+    /**
+     * @brief  Set if part Process need be called only when one of its pins changes
+     */
+    void SetPinSensitive(int sps);
+
+    /**
+     * @brief  Return the Process sample period in us (0 if Process is not sampled)
+     */
+    double GetSamplePeriod_us(void) { return sample_period; };
+
+    /**
+     * @brief  Return the board timer used to schedule Process
+     */
+    int GetSampleTimer(void) { return sample_timer; };
+
+    /**
+     * @brief  Return the period of board timer used to schedule Process
+     */
+    double GetSampleTimerPeriod_us(void) { return sample_timer_period; };
+
+    /**
+     * @brief  Set the board timer used to schedule Process, don't be called by user
+     */
+    void SetSampleTimer(const int timer, const double period) {
+        sample_timer = timer;
+        sample_timer_period = period;
+    };
+
     const int GetPCWCount(void);
     const PCWProp* GetPCWProperties(void);
 
@@ -368,10 +416,12 @@ protected:
     virtual void RegisterRemoteControl(void){};
 
     int id;                         ///< part ID
-    input_t input[MAX_IDS];         ///< input map elements
+    input_t* input;                 ///< input map elements
     input_t* input_ids[MAX_IDS];    ///< input map elements by id order
-    output_t output[MAX_IDS];       ///< output map elements
+    output_t* output;               ///< output map elements
     output_t* output_ids[MAX_IDS];  ///< output map elements by id order
+    input_t input_none;             ///< target of input ids not present in map
+    output_t output_none;           ///< target of output ids not present in map
     int inputc;                     ///< input map elements counter
     int outputc;                    ///< output map elements counter
     unsigned int Height;            ///< Height of part
@@ -385,6 +435,10 @@ protected:
     double Scale;                   ///< scale to draw part
     unsigned int Update;            ///< part need draw Update
     int always_update;              ///< part need to be update every clock cycle
+    int pin_sensitive;              ///< part Process is called only when one of its pins changes
+    double sample_period;           ///< Process sample period in us (0 = not sampled)
+    int sample_timer;               ///< board timer used to schedule Process
+    double sample_timer_period;     ///< period of board timer used to schedule Process
     lxString Type;
     lxFont font;
     int PinCount;
@@ -409,20 +463,20 @@ protected:
     void SetPCWComboWithPinNames(CPWindow* WProp, const char* combo_name, const unsigned char pin);
     unsigned char GetPWCComboSelectedPin(CPWindow* WProp, const char* combo_name);
 
+    /**
+     * @brief  Set the Process sample period in us, Process is called by the spare parts scheduler (0 to disable)
+     */
+    void SetSamplePeriod_us(const double period) { sample_period = period; };
+
 private:
     const PCWProp* PCWProperties;
     int PCWCount;
     lxString Name;
 
     /**
-     * @brief  Read the Input Map
-     */
-    void ReadInputMap(lxString fname);
-
-    /**
-     * @brief  Read the Output Map
+     * @brief  Free the map elements of part
      */
-    void ReadOutputMap(lxString fname);
+    void FreeMaps(void);
 };
 
 #endif /* PART_H */
@@ -24,7 +24,10 @@
    ######################################################################## */
 
 #include "picsimlab.h"
+#include "logicrec.h"
 #include "oscilloscope.h"
+#include "pacer.h"
+#include "protodecoder.h"
 #include "spareparts.h"
 
 #ifdef __EMSCRIPTEN__
@@ -38,8 +41,6 @@ extern char PROGDEVICE[100];
 #endif
 char SERIALDEVICE[100];
 
-CPICSimLab PICSimLab;
-
 CPICSimLab::CPICSimLab() {
     JUMPSTEPS = DEFAULTJS;
     NSTEP = NSTEPKT;
@@ -69,11 +70,15 @@ CPICSimLab::CPICSimLab() {
     scale = 1.0;
     need_resize = 0;
     tgo = 0;
+    cpu_busy = 0;
     plWidth = 10;
     plHeight = 10;
     need_clkupdate = 0;
     use_dsr_reset = 1;
     settodestroy = 0;
+    unthrottled = 0;
+    rtfactor = 1.0;
+    simruns = 0;
     sync = 0;
     SHARE = "";
     pzwtmpdir[0] = 0;
@@ -133,6 +138,8 @@ void CPICSimLab::SetJUMPSTEPS(int js) {
 
 void CPICSimLab::DeleteBoard(void) {
     if (pboard) {
+        LogicRecorder.Stop();  // the recorder and decoders read the board pins
+        ProtoDecoder.Stop();
         delete pboard;
         pboard = NULL;
     }
@@ -320,6 +327,10 @@ void CPICSimLab::EndSimulation(int saveold, const char* newpath) {
 
     SetSimulationRun(1);
 
+    // let the cpu thread go back to wait timer events
+    const int unthrottled_ = unthrottled;
+    unthrottled = 0;
+
 #ifndef __EMSCRIPTEN__
     rcontrol_end();
 #endif
@@ -454,6 +465,9 @@ void CPICSimLab::EndSimulation(int saveold, const char* newpath) {
         pboard->EndServers();
         DeleteBoard();
         strcpy(cmd, lxGetExecutablePath().c_str());
+        if (unthrottled_) {
+            strcat(cmd, " --unthrottled");
+        }
         if (newpath) {
             if (strstr(newpath, ".pzw")) {
                 strcat(cmd, " \"");
@@ -501,6 +515,8 @@ void CPICSimLab::EndSimulation(int saveold, const char* newpath) {
         SpareParts.GetWindow()->Hide();
     }
     DeleteBoard();
+
+    unthrottled = unthrottled_;
 }
 
 // legacy format support before 0.8.2
@@ -862,6 +878,34 @@ int CPICSimLab::GetSimulationRun(void) {
     return (status.st[0] & ST_DI) == 0;
 }
 
+int CPICSimLab::PauseSimulation(void) {
+    const int run = GetSimulationRun();
+
+    status.st[0] |= ST_DI;
+    // pairs with the fence in EnterCPU: a CPU thread either sees ST_DI or is counted in cpu_busy
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+#ifndef _NOTHREAD
+    while (cpu_busy) {
+        usleep(100);
+    }
+#endif
+    return run;
+}
+
+int CPICSimLab::EnterCPU(void) {
+    cpu_busy++;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (status.st[0] & ST_DI) {
+        cpu_busy--;
+        return 0;
+    }
+    return 1;
+}
+
+void CPICSimLab::LeaveCPU(void) {
+    cpu_busy--;
+}
+
 void CPICSimLab::Configure(const char* home, int use_default_board, int create, const char* lfile,
                            const int disable_debug) {
     char line[1024];
@@ -892,13 +936,18 @@ void CPICSimLab::Configure(const char* home, int use_default_board, int create,
     } else {
         snprintf(fname, 1023, "%s/picsimlab.ini", home);
     }
-    SERIALDEVICE[0] = ' ';
-    SERIALDEVICE[1] = 0;
+    // the serial devices and the pacer belong to the window context, headless contexts don't use them
+    if (Window) {
+        SERIALDEVICE[0] = ' ';
+        SERIALDEVICE[1] = 0;
 #ifdef _USE_PICSTARTP_
-    PROGDEVICE[0] = ' ';
-    PROGDEVICE[1] = 0;
+        PROGDEVICE[0] = ' ';
+        PROGDEVICE[1] = 0;
 #endif
+        Pacer.Reset();
+    }
     DeleteBoard();
+    simruns = 0;
 
     PrefsClear();
     if (lxFileExists(fname)) {
@@ -912,21 +961,23 @@ void CPICSimLab::Configure(const char* home, int use_default_board, int create,
                 value = strtok(NULL, "\"");
                 if ((name == NULL) || (value == NULL))
                     continue;
+                if (Window) {
 #ifndef _WIN_
-                if (!strcmp("picsimlab_lser", name))
-                    strcpy(SERIALDEVICE, value);
+                    if (!strcmp("picsimlab_lser", name))
+                        strcpy(SERIALDEVICE, value);
 #ifdef _USE_PICSTARTP_
-                if (!strcmp("picsimlab_lprog", name))
-                    strcpy(PROGDEVICE, value);
+                    if (!strcmp("picsimlab_lprog", name))
+                        strcpy(PROGDEVICE, value);
 #endif
 #else
-                if (!strcmp("picsimlab_wser", name))
-                    strcpy(SERIALDEVICE, value);
+                    if (!strcmp("picsimlab_wser", name))
+                        strcpy(SERIALDEVICE, value);
 #ifdef _USE_PICSTARTP_
-                if (!strcmp("picsimlab_wprog", name))
-                    strcpy(PROGDEVICE, value);
+                    if (!strcmp("picsimlab_wprog", name))
+                        strcpy(PROGDEVICE, value);
 #endif
 #endif
+                }
 
                 if (!strcmp(name, "picsimlab_lab")) {
                     if (use_default_board) {
@@ -1046,17 +1097,19 @@ void CPICSimLab::Configure(const char* home, int use_default_board, int create,
         SetJUMPSTEPS(DEFAULTJS);
         SetClock(pboard->GetDefaultClock());
 
+        if (Window) {
 #ifndef _WIN_
-        strcpy(SERIALDEVICE, "/dev/tnt2");
+            strcpy(SERIALDEVICE, "/dev/tnt2");
 #ifdef _USE_PICSTARTP_
-        strcpy(PROGDEVICE, "/dev/tnt4");
+            strcpy(PROGDEVICE, "/dev/tnt4");
 #endif
 #else
-        strcpy(SERIALDEVICE, "com6");
+            strcpy(SERIALDEVICE, "com6");
 #ifdef _USE_PICSTARTP_
-        strcpy(PROGDEVICE, "com8");
+            strcpy(PROGDEVICE, "com8");
 #endif
 #endif
+        }
     }
 
     if (Window) {
@@ -1091,7 +1144,9 @@ void CPICSimLab::Configure(const char* home, int use_default_board, int create,
             ->SetImgFileName(lxGetLocalFile(GetSharePath() + lxT("boards/") + pboard->GetPictureFileName()), GetScale(),
                              GetScale());
     }
-    pboard->MSetSerial(SERIALDEVICE);
+    if (Window) {
+        pboard->MSetSerial(SERIALDEVICE);
+    }
 
     if (lfile) {
         if (lxFileExists(lfile)) {
@@ -1232,11 +1287,14 @@ void CPICSimLab::Configure(const char* home, int use_default_board, int create,
 #endif
 
 #ifndef __EMSCRIPTEN__
-    printf("PICSimLab: Remote Control Port %i\n", GetRemotecPort());
-    rcontrol_init(GetRemotecPort() + Instance);
+    // the remote control server is only for the window context
+    if (Window) {
+        printf("PICSimLab: Remote Control Port %i\n", GetRemotecPort());
+        rcontrol_init(GetRemotecPort() + Instance);
+    }
 #endif
 
-    if (load_demo) {
+    if (load_demo && Window) {
         lxString fdemo =
             PICSimLab.GetSharePath() + "boards/" + lxString(boards_list[PICSimLab.GetLab()].name) + lxT("/demo.pzw");
 
@@ -1256,6 +1314,28 @@ void CPICSimLab::SetIdleMs(double im) {
     idle_ms = im;
 }
 
+void CPICSimLab::SetUnthrottled(int ut) {
+#ifdef _NOTHREAD
+    // timer1 events run the simulation, there is no cpu thread to run free
+    if (ut) {
+        printf("PICSimLab: Unthrottled mode needs the cpu thread, running in real time\n");
+        ut = 0;
+    }
+#endif
+    unthrottled = ut;
+    rtfactor = 1.0;
+    Pacer.Reset();
+#ifndef _NOTHREAD
+    // wake up the cpu thread
+    if (cpu_cond) {
+        tgo = 1;
+        cpu_mutex->Lock();
+        cpu_cond->Signal();
+        cpu_mutex->Unlock();
+    }
+#endif
+}
+
 void CPICSimLab::SetToDestroy(void) {
     settodestroy = 1;
 }
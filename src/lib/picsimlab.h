@@ -35,6 +35,8 @@ extern char SERIALDEVICE[100];
 
 #define MAX_MIC 140
 
+#include <atomic>
+
 #include "board.h"
 
 enum { CPU_RUNNING, CPU_STEPPING, CPU_HALTED, CPU_BREAKPOINT, CPU_ERROR, CPU_POWER_OFF };
@@ -225,6 +227,22 @@ public:
     void SetSimulationRun(int run);
     int GetSimulationRun(void);
 
+    /**
+     * @brief Stop the simulation and wait the CPU threads leave the board run, return the previous run state
+     */
+    int PauseSimulation(void);
+
+    /**
+     * @brief Called by CPU threads (main loop and qemu/remote threads) before run the board, return 0 if the
+     * simulation is paused and the run must be skipped
+     */
+    int EnterCPU(void);
+
+    /**
+     * @brief Called by CPU threads after a board run accepted by EnterCPU
+     */
+    void LeaveCPU(void);
+
     double GetScale(void) { return scale; };
     void SetScale(double s) { scale = s; };
 
@@ -241,6 +259,24 @@ public:
     double GetIdleMs(void);
     void SetIdleMs(double im);
 
+    /**
+     * @brief  Run the simulation as fast as possible (not synchronized with real time), only in threaded builds
+     */
+    void SetUnthrottled(int ut);
+    int GetUnthrottled(void) { return unthrottled; };
+
+    /**
+     * @brief  Return the achieved ratio between simulated time and real time
+     */
+    double GetRealTimeFactor(void) { return rtfactor; };
+    void SetRealTimeFactor(double rtf) { rtfactor = rtf; };
+
+    /**
+     * @brief  Return the simulated time in seconds since the board was configured
+     */
+    double GetSimTime(void) { return simruns * BASETIMER * 1e-3; };
+    void IncSimRuns(void) { simruns++; };
+
     int GetUseDSRReset(void) { return use_dsr_reset; };
     void SetUseDSRReset(int udsr) { use_dsr_reset = udsr; };
 
@@ -262,6 +298,7 @@ public:
     } status;
 
     int tgo;
+    std::atomic<int> cpu_busy;  // CPU threads inside a board run
 
     int plWidth;
     int plHeight;
@@ -312,12 +349,16 @@ private:
     lxString Workspacefn;
     double scale;
     double idle_ms;
+    int unthrottled;
+    double rtfactor;
+    unsigned long simruns;
     int settodestroy;
     unsigned char sync;
     char pzwtmpdir[1024];
 };
 
-extern CPICSimLab PICSimLab;
+// Object of the simulation context bound to the calling thread (simcontext.h)
+extern thread_local CPICSimLab& PICSimLab;
 
 #ifdef _WIN_
 #define msleep(x) Sleep(x)
@@ -0,0 +1,77 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "pinactivity.h"
+
+#include <stddef.h>
+#include <string.h>
+
+CPinActivity::CPinActivity() {
+    Pins = NULL;
+    PinCount = 0;
+    FrameStart = 0;
+    memset(Edge, 0, sizeof(Edge));
+    memset(High, 0, sizeof(High));
+    memset(Edges, 0, sizeof(Edges));
+    Clear();
+}
+
+void CPinActivity::Start(const picpin* pins, const int pinc, const uint32_t now) {
+    Pins = pins;
+    PinCount = (pinc < PA_MAX_PINS) ? pinc : PA_MAX_PINS;
+    FrameStart = now;
+    Planes.Capture(Pins, PinCount);
+    for (int i = 0; i < PinCount; i++) {
+        Edge[i] = now;
+        High[i] = 0;
+        Edges[i] = 0;
+    }
+}
+
+void CPinActivity::End(const uint32_t now) {
+    const uint32_t span = now - FrameStart;
+
+    for (int i = 0; i < PinCount; i++) {
+        const int value = Planes.GetValue(i);
+        if (value) {
+            High[i] += now - Edge[i];
+        }
+        if (span) {
+            Duty[i] = ((float)High[i]) / span;
+        } else {
+            Duty[i] = value;
+        }
+        LastEdges[i] = Edges[i];
+        Edge[i] = now;
+        High[i] = 0;
+        Edges[i] = 0;
+    }
+    FrameStart = now;
+}
+
+void CPinActivity::Clear(void) {
+    memset(Duty, 0, sizeof(Duty));
+    memset(LastEdges, 0, sizeof(LastEdges));
+}
@@ -0,0 +1,111 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef PINACTIVITY_H
+#define PINACTIVITY_H
+
+#include <picsim/picsim.h>
+#include <stdint.h>
+
+#include "pinplanes.h"
+
+#define PA_MAX_PINS PP_MAX_PINS
+
+/**
+ * @brief Pin activity integrator
+ *
+ * Records the instruction count of every rising and falling edge of the pins
+ * and integrates the time each pin stays high, giving the exact duty cycle of
+ * each frame. Edges are only looked for when the pins change (Scan), so steps
+ * without IO activity cost nothing, and only the pins flagged in the packed
+ * planes change mask are visited. Timestamps are 32 bit instruction counts,
+ * differences are computed modulo 2^32 and a frame must be shorter than that.
+ */
+class CPinActivity {
+public:
+    CPinActivity();
+
+    /**
+     * @brief Start a new integration frame at instruction count now
+     */
+    void Start(const picpin* pins, const int pinc, const uint32_t now);
+
+    /**
+     * @brief Record the edges of pins changed since the last call
+     */
+    void Scan(const uint32_t now) {
+        if (!Planes.Capture(Pins, PinCount))
+            return;
+        const uint64_t* changed = Planes.GetValueChanged();
+        for (int w = 0; w < PP_WORDS; w++) {
+            for (uint64_t m = changed[w]; m; m &= m - 1) {
+                const int i = (w << 6) + pp_ctz(m);
+                if (!Planes.GetValue(i)) {  // falling edge
+                    High[i] += now - Edge[i];
+                }
+                Edge[i] = now;
+                Edges[i]++;
+            }
+        }
+    };
+
+    /**
+     * @brief Close the frame at instruction count now and compute pins duty cycle
+     */
+    void End(const uint32_t now);
+
+    /**
+     * @brief Clear duty cycle and edges count of all pins
+     */
+    void Clear(void);
+
+    /**
+     * @brief Return the high time fraction (0.0 to 1.0) of pin (0 based) in the last frame
+     */
+    float GetDuty(const int pin) { return ((pin >= 0) && (pin < PA_MAX_PINS)) ? Duty[pin] : 0; };
+
+    /**
+     * @brief Return the number of edges of pin (0 based) in the last frame
+     */
+    unsigned int GetEdges(const int pin) { return ((pin >= 0) && (pin < PA_MAX_PINS)) ? LastEdges[pin] : 0; };
+
+    /**
+     * @brief Return the packed pins state of last scan
+     */
+    const CPinPlanes* GetPlanes(void) { return &Planes; };
+
+private:
+    const picpin* Pins;
+    int PinCount;
+    uint32_t FrameStart;
+    CPinPlanes Planes;                 ///< pins state after last scan
+    uint32_t Edge[PA_MAX_PINS];        ///< instruction count of last edge
+    uint32_t High[PA_MAX_PINS];        ///< high time accumulated in current frame
+    unsigned int Edges[PA_MAX_PINS];   ///< edges counted in current frame
+    unsigned int LastEdges[PA_MAX_PINS];
+    float Duty[PA_MAX_PINS];
+};
+
+#endif /* PINACTIVITY_H */
@@ -0,0 +1,43 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "pinplanes.h"
+
+#include <string.h>
+
+CPinPlanes::CPinPlanes() {
+    memset(Value, 0, sizeof(Value));
+    memset(Dir, 0, sizeof(Dir));
+    memset(Changed, 0, sizeof(Changed));
+    memset(ValueChanged, 0, sizeof(ValueChanged));
+}
+
+void CPinPlanes::Invalidate(void) {
+    // next capture differs from the inverted planes in all pins
+    for (int w = 0; w < PP_WORDS; w++) {
+        Value[w] = ~Value[w];
+        Dir[w] = ~Dir[w];
+    }
+}
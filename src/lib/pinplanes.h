@@ -0,0 +1,113 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef PINPLANES_H
+#define PINPLANES_H
+
+#include <picsim/picsim.h>
+#include <stdint.h>
+
+#define PP_MAX_PINS 256
+#define PP_WORDS (PP_MAX_PINS / 64)
+
+/**
+ * @brief Return the index of the lowest bit set in a non zero mask
+ */
+static inline int pp_ctz(const uint64_t mask) {
+#ifdef __GNUC__
+    return __builtin_ctzll(mask);
+#else
+    int n = 0;
+    while (!((mask >> n) & 1))
+        n++;
+    return n;
+#endif
+}
+
+/**
+ * @brief Packed pins state
+ *
+ * Keeps the value and direction of a picpin array as 64 bit planes (bit n is
+ * pin n+1). Each capture packs the pins once and compares the planes with the previous capture word by
+ * word, so finding the changed pins costs a few XORs instead of a compare per
+ * pin, and the set bits of the change masks give the pins to visit.
+ */
+class CPinPlanes {
+public:
+    CPinPlanes();
+
+    /**
+     * @brief Pack value and direction of pins, fill change masks and return 1 if any pin changed
+     */
+    int Capture(const picpin* pins, const int pinc) {
+        int changed = 0;
+        const int count = (pinc < PP_MAX_PINS) ? pinc : PP_MAX_PINS;
+
+        for (int w = 0; w < PP_WORDS; w++) {
+            uint64_t value = 0;
+            uint64_t dir = 0;
+            const int base = w << 6;
+            const int end = ((count - base) < 64) ? (count - base) : 64;
+            for (int b = 0; b < end; b++) {
+                value |= ((uint64_t)(pins[base + b].value & 1)) << b;
+                dir |= ((uint64_t)(pins[base + b].dir & 1)) << b;
+            }
+            ValueChanged[w] = value ^ Value[w];
+            Changed[w] = ValueChanged[w] | (dir ^ Dir[w]);
+            changed |= Changed[w] != 0;
+            Value[w] = value;
+            Dir[w] = dir;
+        }
+        return changed;
+    };
+
+    /**
+     * @brief Report all pins as changed in next capture (planes are invalid until there)
+     */
+    void Invalidate(void);
+
+    /**
+     * @brief Return value of pin (0 based)
+     */
+    int GetValue(const int pin) const { return (Value[pin >> 6] >> (pin & 63)) & 1; };
+
+    /**
+     * @brief Return mask of pins with value or direction changed in last capture
+     */
+    const uint64_t* GetChanged(void) const { return Changed; };
+
+    /**
+     * @brief Return mask of pins with value changed in last capture
+     */
+    const uint64_t* GetValueChanged(void) const { return ValueChanged; };
+
+private:
+    uint64_t Value[PP_WORDS];
+    uint64_t Dir[PP_WORDS];
+    uint64_t Changed[PP_WORDS];
+    uint64_t ValueChanged[PP_WORDS];
+};
+
+#endif /* PINPLANES_H */
@@ -0,0 +1,201 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef PINSTREAM_H
+#define PINSTREAM_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "eventring.h"
+#include "pinplanes.h"
+
+#define PSTREAM_MARK 0x200  // event flag of a time mark (no pin change)
+
+/**
+ * @brief Stream of pins changes from the stepping kernel to a consumer thread
+ *
+ * The stepping kernel scans the selected pins with word wide diffs of the
+ * packed pins planes and stores each change as one 64 bit event (instruction
+ * count, pin and value) in a CEventRing consumed by C::Consume. The first
+ * scan after Start sends the value of all selected pins. Stop waits the
+ * stepping kernel leave the scan before stopping the ring, so it can be
+ * called from any thread.
+ */
+template <class C, const uint32_t SIZE>
+class CPinStream {
+public:
+    CPinStream(C* consumer) : Ring(consumer) {
+        Pins = NULL;
+        PinCount = 0;
+        memset(Mask, 0, sizeof(Mask));
+        First = 0;
+        Changes = 0;
+        running = 0;
+#ifndef _NOTHREAD
+        busy = 0;
+#endif
+    };
+
+    /**
+     * @brief Start streaming the changes of the pins in mask (bit n is pin n+1)
+     */
+    void Start(const picpin* pins, const uint64_t* mask) {
+        Stop();
+        Pins = pins;
+        memcpy(Mask, mask, sizeof(Mask));
+        PinCount = 0;
+        for (int i = 0; i < PP_MAX_PINS; i++) {
+            if ((Mask[i >> 6] >> (i & 63)) & 1)
+                PinCount = i + 1;
+        }
+        First = 1;
+        Changes = 0;
+        Ring.Start();
+        running = 1;
+    };
+
+    /**
+     * @brief Stop streaming, the consumer receives all pending events before return
+     */
+    void Stop(void) {
+#ifndef _NOTHREAD
+        if (!running.load())
+            return;
+        // wait the stepping kernel leave the scan before closing the ring
+        running.store(0);
+        while (busy.load()) {
+            std::this_thread::yield();
+        }
+#else
+        if (!running)
+            return;
+        running = 0;
+#endif
+        Ring.Stop();
+    };
+
+    /**
+     * @brief Return 1 if streaming
+     */
+    int IsRunning(void) { return running; };
+
+    /**
+     * @brief Return the number of pins changes sent
+     */
+    uint64_t GetChanges(void) { return Changes; };
+
+    /**
+     * @brief Stepping kernel entry, return 1 if the pins must be scanned until Leave is called
+     */
+    int Enter(const uint64_t now) {
+#ifndef _NOTHREAD
+        busy.store(1);
+        if (!running.load()) {
+            busy.store(0);
+            return 0;
+        }
+#else
+        if (!running)
+            return 0;
+#endif
+        if (First) {
+            Dump(now);
+        }
+        return 1;
+    };
+
+    /**
+     * @brief Stepping kernel exit
+     */
+    void Leave(void) {
+#ifndef _NOTHREAD
+        busy.store(0);
+#else
+        Ring.Drain();  // no consumer thread
+#endif
+    };
+
+    /**
+     * @brief Send a time mark at instruction count now
+     */
+    void Mark(const uint64_t now) { Ring.Add((now << 10) | PSTREAM_MARK); };
+
+    /**
+     * @brief Send the pins changed since last scan at instruction count now
+     */
+    void Scan(const uint64_t now) {
+        if (!Planes.Capture(Pins, PinCount))
+            return;
+        const uint64_t* changed = Planes.GetValueChanged();
+        for (int w = 0; w < PP_WORDS; w++) {
+            for (uint64_t m = changed[w] & Mask[w]; m; m &= m - 1) {
+                const int i = (w << 6) + pp_ctz(m);
+                Add(now, i, Planes.GetValue(i));
+            }
+        }
+    };
+
+    static uint64_t GetTime(const uint64_t event) { return event >> 10; };
+    static int GetPin(const uint64_t event) { return (event >> 1) & 0xFF; };
+    static int GetValue(const uint64_t event) { return event & 1; };
+    static int IsMark(const uint64_t event) { return (event & PSTREAM_MARK) != 0; };
+
+private:
+    CEventRing<C, SIZE> Ring;
+    const picpin* Pins;
+    int PinCount;             // pins captured (highest pin selected)
+    uint64_t Mask[PP_WORDS];  // pins selected (bit n is pin n+1)
+    CPinPlanes Planes;        // pins state of last scan
+    int First;                // initial values not sent yet
+    uint64_t Changes;
+#ifndef _NOTHREAD
+    std::atomic<int> running;
+    std::atomic<int> busy;  // stepping kernel is scanning the pins
+#else
+    int running;
+#endif
+
+    void Add(const uint64_t now, const int pin, const int value) {
+        Ring.Add((now << 10) | (pin << 1) | value);
+        Changes++;
+    };
+
+    /**
+     * @brief Capture the pins and send the value of all pins selected
+     */
+    void Dump(const uint64_t now) {
+        Planes.Capture(Pins, PinCount);
+        for (int w = 0; w < PP_WORDS; w++) {
+            for (uint64_t m = Mask[w]; m; m &= m - 1) {
+                const int i = (w << 6) + pp_ctz(m);
+                Add(now, i, Planes.GetValue(i));
+            }
+        }
+        First = 0;
+    };
+};
+
+#endif /* PINSTREAM_H */
@@ -0,0 +1,136 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "profiler.h"
+
+#include <string.h>
+
+#ifdef _WIN_
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+static const char* stage_names[PS_LAST] = {"step", "debug", "timers", "hardware", "pins", "oscope", "spare", "board"};
+
+CProfiler::CProfiler() {
+    enabled = 0;
+    Sample = 0;
+    PartCount = 0;
+    PartTime = NULL;
+    Reset();
+}
+
+CProfiler::~CProfiler() {
+    delete[] PartTime;
+}
+
+void CProfiler::SetEnabled(const int en) {
+    if (en && !enabled) {
+        Reset();
+    }
+    enabled = en;
+}
+
+void CProfiler::Reset(void) {
+    Last = 0;
+    Start = Now();
+    Steps = 0;
+    Samples = 0;
+    RunTime = 0;
+    memset(StageTime, 0, sizeof(StageTime));
+    if (PartTime) {
+        memset(PartTime, 0, PartCount * sizeof(PartTime[0]));
+    }
+}
+
+void CProfiler::SetPartCount(const int count) {
+    if (count == PartCount)
+        return;
+
+    uint64_t(*PartTime_)[PP_LAST] = new uint64_t[count][PP_LAST];
+    memset(PartTime_, 0, count * sizeof(PartTime_[0]));
+    if (PartTime) {
+        memcpy(PartTime_, PartTime, ((count < PartCount) ? count : PartCount) * sizeof(PartTime[0]));
+    }
+    delete[] PartTime;
+    PartTime = PartTime_;
+    PartCount = count;
+}
+
+uint64_t CProfiler::Now(void) {
+#ifdef _WIN_
+    static LARGE_INTEGER freq = {0};
+    LARGE_INTEGER count;
+    if (!freq.QuadPart) {
+        QueryPerformanceFrequency(&freq);
+    }
+    QueryPerformanceCounter(&count);
+    return (uint64_t)((count.QuadPart * 1e9) / freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+void CProfiler::AddRun(const long int nstep, const uint64_t ns) {
+    if (nstep > 0) {
+        Steps += nstep;
+        Samples += ((nstep - 1) / (PROFILER_SAMPLE_MASK + 1)) + 1;
+    }
+    RunTime += ns;
+}
+
+const char* CProfiler::GetStageName(const int stage) {
+    if ((stage >= 0) && (stage < PS_LAST)) {
+        return stage_names[stage];
+    }
+    return "";
+}
+
+double CProfiler::GetStageTime(const int stage) {
+    if (!Samples) {
+        return 0;
+    }
+    return ((double)StageTime[stage] * Steps) / Samples;
+}
+
+double CProfiler::GetPartTime(const int id, const int call) {
+    if ((id < 0) || (id >= PartCount)) {
+        return 0;
+    }
+    if (call == PP_PROCESS) {
+        if (!Samples) {
+            return 0;
+        }
+        return ((double)PartTime[id][call] * Steps) / Samples;
+    }
+    return PartTime[id][call];
+}
+
+uint64_t CProfiler::GetElapsed(void) {
+    return Now() - Start;
+}
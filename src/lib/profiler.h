@@ -0,0 +1,152 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+
+#include "part.h"
+
+#define PROFILER_SAMPLE_MASK 0x3FF  // profile one of each 1024 steps
+
+// sampled stages of the stepping kernel
+enum { PS_STEP, PS_DEBUG, PS_TIMERS, PS_HARDWARE, PS_PINS, PS_OSCOPE, PS_SPARE, PS_BOARD, PS_LAST };
+
+// spare parts process calls
+enum { PP_PREPROCESS, PP_PROCESS, PP_POSTPROCESS, PP_LAST };
+
+/**
+ * @brief Hot loop profiler
+ *
+ * When enabled the stepping kernel times each stage of one of each
+ * PROFILER_SAMPLE_MASK+1 steps and scales the result by the number of steps,
+ * so the overhead stays low. Spare parts PreProcess and PostProcess are
+ * timed on every call, Process only on sampled steps.
+ */
+class CProfiler {
+public:
+    CProfiler();
+    ~CProfiler();
+
+    /**
+     * @brief Enable or disable the profiler, enabling clears the previous results
+     */
+    void SetEnabled(const int en);
+    int GetEnabled(void) { return enabled; };
+
+    /**
+     * @brief Clear all results
+     */
+    void Reset(void);
+
+    /**
+     * @brief Return a monotonic time stamp in ns
+     */
+    static uint64_t Now(void);
+
+    /**
+     * @brief Start timing a step if sample is set
+     */
+    void Mark(const int sample) {
+        Sample = sample;
+        if (sample)
+            Last = Now();
+    };
+
+    /**
+     * @brief Return if the current step is being timed
+     */
+    int GetSample(void) { return Sample; };
+
+    /**
+     * @brief Add the time since the last mark or lap to stage if the current step is being timed
+     */
+    void Lap(const int stage) {
+        if (Sample) {
+            const uint64_t t = Now();
+            StageTime[stage] += t - Last;
+            Last = t;
+        }
+    };
+
+    /**
+     * @brief Add time of one spare part process call
+     */
+    void AddPart(const int id, const int call, const uint64_t ns) {
+        if ((id >= 0) && (id < PartCount))
+            PartTime[id][call] += ns;
+    };
+
+    /**
+     * @brief Resize the spare parts table to hold count parts (call with the simulation stopped)
+     */
+    void SetPartCount(const int count);
+
+    /**
+     * @brief Account one stepping kernel run of nstep steps that took ns
+     */
+    void AddRun(const long int nstep, const uint64_t ns);
+
+    /**
+     * @brief Return the name of stage
+     */
+    static const char* GetStageName(const int stage);
+
+    /**
+     * @brief Return the estimated time in ns spent in stage
+     */
+    double GetStageTime(const int stage);
+
+    /**
+     * @brief Return the estimated time in ns spent in spare part id call
+     */
+    double GetPartTime(const int id, const int call);
+
+    uint64_t GetSteps(void) { return Steps; };
+    uint64_t GetRunTime(void) { return RunTime; };
+
+    /**
+     * @brief Return the wall time in ns since the profiler was enabled
+     */
+    uint64_t GetElapsed(void);
+
+private:
+    int enabled;
+    int Sample;
+    uint64_t Last;
+    uint64_t Start;
+    uint64_t Steps;
+    uint64_t Samples;
+    uint64_t RunTime;
+    uint64_t StageTime[PS_LAST];
+    int PartCount;                  // size of PartTime
+    uint64_t (*PartTime)[PP_LAST];  // spare parts calls time indexed by part id
+};
+
+// Object of the simulation context bound to the calling thread (simcontext.h)
+extern thread_local CProfiler& Profiler;
+
+#endif /* PROFILER_H */
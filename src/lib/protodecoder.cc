@@ -0,0 +1,399 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "protodecoder.h"
+
+#include <stdarg.h>
+#include <string.h>
+
+#include "board.h"
+
+static const char* const pdec_names[] = {"i2c", "spi", "uart", "1w"};
+
+CProtoDecoder::CProtoDecoder() : Stream(this) {
+    memset(dec, 0, sizeof(dec));
+    count = 0;
+    Period = 1;
+    file = NULL;
+    log = NULL;
+    log_head = 0;
+    log_tail = 0;
+    lost = 0;
+}
+
+CProtoDecoder::~CProtoDecoder() {
+    Stop();
+    delete[] log;
+}
+
+int CProtoDecoder::AddDecoder(const int type, const unsigned char* pins, const unsigned int speed) {
+    if (Stream.IsRunning() || (count >= PDEC_MAX))
+        return -1;
+
+    pdec_t* d = &dec[count];
+    memset(d, 0, sizeof(pdec_t));
+    d->type = type;
+    memcpy(d->pins, pins, sizeof(d->pins));
+    d->speed = speed;
+    return count++;
+}
+
+int CProtoDecoder::AddI2C(const unsigned char scl, const unsigned char sda) {
+    const unsigned char pins[4] = {scl, sda, 0, 0};
+    if (!scl || !sda)
+        return -1;
+    return AddDecoder(PDEC_I2C, pins, 0);
+}
+
+int CProtoDecoder::AddSPI(const unsigned char sck, const unsigned char copi, const unsigned char cipo,
+                          const unsigned char cs) {
+    const unsigned char pins[4] = {sck, copi, cipo, cs};
+    if (!sck || !copi)
+        return -1;
+    return AddDecoder(PDEC_SPI, pins, 0);
+}
+
+int CProtoDecoder::AddUART(const unsigned char rx, const unsigned int speed) {
+    const unsigned char pins[4] = {rx, 0, 0, 0};
+    if (!rx || !speed)
+        return -1;
+    return AddDecoder(PDEC_UART, pins, speed);
+}
+
+int CProtoDecoder::AddOneWire(const unsigned char dq) {
+    const unsigned char pins[4] = {dq, 0, 0, 0};
+    if (!dq)
+        return -1;
+    return AddDecoder(PDEC_1WIRE, pins, 0);
+}
+
+void CProtoDecoder::Clear(void) {
+    if (!Stream.IsRunning())
+        count = 0;
+}
+
+const char* CProtoDecoder::GetDescription(const int n, char* buff, const int size) {
+    const pdec_t* d = &dec[n];
+
+    switch (d->type) {
+        case PDEC_I2C:
+            snprintf(buff, size, "i2c%i scl=%i sda=%i", n, d->pins[0], d->pins[1]);
+            break;
+        case PDEC_SPI:
+            snprintf(buff, size, "spi%i sck=%i copi=%i cipo=%i cs=%i", n, d->pins[0], d->pins[1], d->pins[2],
+                     d->pins[3]);
+            break;
+        case PDEC_UART:
+            snprintf(buff, size, "uart%i rx=%i speed=%u", n, d->pins[0], d->speed);
+            break;
+        default:
+            snprintf(buff, size, "1w%i dq=%i", n, d->pins[0]);
+            break;
+    }
+    return buff;
+}
+
+int CProtoDecoder::Start(board* b, const char* fname) {
+    char desc[100];
+    uint64_t mask[PP_WORDS];  // pins decoded (bit n is pin n+1)
+
+    Stop();
+
+    if (!count)
+        return -1;
+
+    if (fname && fname[0]) {
+        file = fopen(fname, "w");
+        if (!file) {
+            printf("PICSimLab: Error creating file %s\n", fname);
+            return -1;
+        }
+    }
+
+    if (!log) {
+        log = new char[PDEC_LOG_SIZE];
+    }
+
+    const picpin* pins = b->MGetPinsValues();
+    const double freq = b->MGetInstClockFreq();
+    Period = 1e6 / freq;
+
+    memset(mask, 0, sizeof(mask));
+    for (int n = 0; n < count; n++) {
+        pdec_t* d = &dec[n];
+        for (int k = 0; k < 4; k++) {
+            const int pin = d->pins[k];
+            if (pin) {
+                mask[(pin - 1) >> 6] |= 1ull << ((pin - 1) & 63);
+                d->level[k] = pins[pin - 1].value & 1;
+            } else {
+                d->level[k] = 0;
+            }
+        }
+        switch (d->type) {
+            case PDEC_I2C:
+                bitbang_i2c_init(&d->i2c, 0, 0);  // sniffer, all addresses match
+                d->i2c.sclo = d->level[0];
+                d->i2c.sdao = d->level[1];
+                break;
+            case PDEC_SPI:
+                bitbang_spi_init(&d->spi[0]);
+                bitbang_spi_init(&d->spi[1]);
+                d->spi[0].aclk = d->level[0];
+                d->spi[1].aclk = d->level[0];
+                break;
+            case PDEC_UART:
+                d->bit = -1;
+                d->bit_time = freq / d->speed;
+                break;
+            case PDEC_1WIRE:
+                d->bit = 0;
+                d->sr = 0;
+                d->reset = 0;
+                d->fall = 0;
+                break;
+        }
+        if (file) {
+            fprintf(file, "# %s\n", GetDescription(n, desc, sizeof(desc)));
+        }
+    }
+
+    log_head = 0;
+    log_tail = 0;
+    lost = 0;
+    Stream.Start(pins, mask);
+    return 0;
+}
+
+void CProtoDecoder::Emit(const int n, const uint64_t now, const char* fmt, ...) {
+    char line[256];
+    va_list args;
+
+    int len = snprintf(line, sizeof(line), "%14.3f us %s%i ", now * Period, pdec_names[dec[n].type], n);
+    va_start(args, fmt);
+    len += vsnprintf(line + len, sizeof(line) - len, fmt, args);
+    va_end(args);
+    if (len > (int)sizeof(line) - 3) {
+        len = sizeof(line) - 3;
+    }
+
+    if (file) {
+        fprintf(file, "%s\n", line);
+    }
+
+    line[len++] = '\r';
+    line[len++] = '\n';
+#ifndef _NOTHREAD
+    std::lock_guard<std::mutex> lock(log_mtx);
+#endif
+    if ((PDEC_LOG_SIZE - (log_head - log_tail)) >= (unsigned int)len) {
+        for (int i = 0; i < len; i++) {
+            log[(log_head + i) & (PDEC_LOG_SIZE - 1)] = line[i];
+        }
+        log_head += len;
+    } else {
+        lost++;
+    }
+}
+
+int CProtoDecoder::GetLog(char* buff, const int size) {
+    int n = 0;
+
+    if (log) {
+#ifndef _NOTHREAD
+        std::lock_guard<std::mutex> lock(log_mtx);
+#endif
+        unsigned int avail = log_head - log_tail;
+        if (avail > (unsigned int)(size - 1)) {
+            avail = size - 1;
+        }
+        // only whole lines
+        int last = 0;
+        for (unsigned int i = 0; i < avail; i++) {
+            buff[i] = log[(log_tail + i) & (PDEC_LOG_SIZE - 1)];
+            if (buff[i] == '\n')
+                last = i + 1;
+        }
+        n = last;
+        log_tail += n;
+    }
+    buff[n] = 0;
+    return n;
+}
+
+void CProtoDecoder::Advance(pdec_t* d, const int n, const uint64_t now) {
+    if (d->type != PDEC_UART)
+        return;
+
+    // sample the UART bits in the middle, the level is constant until now
+    while ((d->bit >= 0) && (d->next <= now)) {
+        const int lv = d->level[0];
+        if (d->bit == 0) {
+            if (lv) {
+                d->bit = -1;  // glitch, not a start bit
+                break;
+            }
+        } else if (d->bit <= 8) {
+            d->sr |= lv << (d->bit - 1);
+        } else {
+            const unsigned char c = d->sr;
+            if (lv) {
+                Emit(n, d->next, "0x%02X '%c'", c, ((c >= 32) && (c < 127)) ? c : '.');
+            } else {
+                Emit(n, d->next, "0x%02X FRAMING ERROR", c);
+            }
+            d->bit = -1;
+            break;
+        }
+        d->bit++;
+        d->next += d->bit_time;
+    }
+}
+
+void CProtoDecoder::Change(const uint64_t now, const int pin, const int value) {
+    for (int n = 0; n < count; n++) {
+        pdec_t* d = &dec[n];
+        for (int k = 0; k < 4; k++) {
+            if (d->pins[k] != (pin + 1))
+                continue;
+
+            Advance(d, n, now);
+            if (d->level[k] == value)
+                continue;
+            d->level[k] = value;
+
+            switch (d->type) {
+                case PDEC_I2C:
+                    bitbang_i2c_io(&d->i2c, d->level[0], d->level[1]);
+                    // the ACK bit is the SDA level in the ninth clock
+                    switch (bitbang_i2c_get_status(&d->i2c)) {
+                        case I2C_START:
+                            Emit(n, now, "START");
+                            break;
+                        case I2C_STOP:
+                            Emit(n, now, "STOP");
+                            break;
+                        case I2C_ADDR:
+                            Emit(n, now, "ADDR 0x%02X W %s", d->i2c.datar >> 1, d->level[1] ? "NACK" : "ACK");
+                            break;
+                        case I2C_DATAW:
+                            Emit(n, now, "WRITE 0x%02X %s", d->i2c.datar, d->level[1] ? "NACK" : "ACK");
+                            break;
+                        case I2C_DATAR:
+                            if (d->i2c.byte == 1) {
+                                Emit(n, now, "ADDR 0x%02X R %s", d->i2c.datar >> 1, d->level[1] ? "NACK" : "ACK");
+                            } else {
+                                Emit(n, now, "READ 0x%02X %s", d->i2c.datar, d->level[1] ? "NACK" : "ACK");
+                            }
+                            break;
+                    }
+                    break;
+                case PDEC_SPI: {
+                    if (k == 3) {
+                        Emit(n, now, value ? "CS HIGH" : "CS LOW");
+                        d->spi[0].aclk = d->level[0];  // clock can be moved while not selected
+                        d->spi[1].aclk = d->level[0];
+                    }
+                    const int cs = d->pins[3] ? d->level[3] : 0;
+                    bitbang_spi_io(&d->spi[0], d->level[0], d->level[1], cs);
+                    bitbang_spi_io(&d->spi[1], d->level[0], d->level[2], cs);
+                    bitbang_spi_get_status(&d->spi[1]);
+                    if (bitbang_spi_get_status(&d->spi[0]) == SPI_DATA) {
+                        if (d->pins[2]) {
+                            Emit(n, now, "COPI 0x%02X CIPO 0x%02X", d->spi[0].data, d->spi[1].data);
+                        } else {
+                            Emit(n, now, "COPI 0x%02X", d->spi[0].data);
+                        }
+                    }
+                } break;
+                case PDEC_UART:
+                    if (!value && (d->bit < 0)) {  // start bit
+                        d->bit = 0;
+                        d->sr = 0;
+                        d->next = now + (d->bit_time / 2);
+                    }
+                    break;
+                case PDEC_1WIRE:
+                    if (!value) {
+                        d->fall = now;
+                    } else if (d->fall) {
+                        // slots are identified by the low pulse width, as sampled by the devices
+                        const double width = (now - d->fall) * Period;
+                        if (width > 450) {
+                            Emit(n, d->fall, "RESET");
+                            d->reset = 1;
+                            d->bit = 0;
+                            d->sr = 0;
+                        } else if (d->reset && (width >= 60)) {
+                            Emit(n, d->fall, "PRESENCE");
+                            d->reset = 0;
+                        } else {
+                            if (d->reset) {
+                                Emit(n, d->fall, "NO PRESENCE");
+                                d->reset = 0;
+                            }
+                            if (width < 30) {
+                                d->sr |= 1 << d->bit;
+                            }
+                            if (++d->bit == 8) {
+                                Emit(n, now, "0x%02X", d->sr);
+                                d->bit = 0;
+                                d->sr = 0;
+                            }
+                        }
+                    }
+                    break;
+            }
+        }
+    }
+}
+
+void CProtoDecoder::Consume(const uint64_t* changes, const uint32_t num) {
+    for (uint32_t i = 0; i < num; i++) {
+        const uint64_t now = Stream.GetTime(changes[i]);
+        if (Stream.IsMark(changes[i])) {
+            for (int n = 0; n < count; n++) {
+                Advance(&dec[n], n, now);
+            }
+        } else {
+            Change(now, Stream.GetPin(changes[i]), Stream.GetValue(changes[i]));
+        }
+    }
+
+    if (file) {
+        fflush(file);
+    }
+}
+
+void CProtoDecoder::Stop(void) {
+    if (!Stream.IsRunning())
+        return;
+
+    Stream.Stop();
+    if (file) {
+        fclose(file);
+        file = NULL;
+    }
+}
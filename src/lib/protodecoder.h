@@ -0,0 +1,206 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef PROTODECODER_H
+#define PROTODECODER_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifndef _NOTHREAD
+#include <mutex>
+#endif
+
+#include "../devices/bitbang_i2c.h"
+#include "../devices/bitbang_spi.h"
+#include "pinstream.h"
+
+#define PDEC_MAX 8              // decoders
+#define PDEC_RING_SIZE 65536    // pin changes in ring (power of two)
+#define PDEC_LOG_SIZE 65536     // bytes of transactions log kept to remote control
+
+class board;
+
+// decoder types
+enum { PDEC_I2C = 0, PDEC_SPI, PDEC_UART, PDEC_1WIRE };
+
+/**
+ * @brief Protocol decoder state
+ *
+ * I2C and SPI reuse the peripheral state machines of the bitbang devices,
+ * that only depend on the pins levels. UART and 1-Wire models are driven by
+ * board timers, so these decoders measure the bits and pulses from the
+ * change timestamps instead.
+ */
+typedef struct {
+    int type;
+    unsigned char pins[4];   ///< I2C: scl,sda  SPI: sck,copi,cipo,cs  UART: rx  1-Wire: dq (0 is not connected)
+    unsigned char level[4];  ///< current level of each pin
+    unsigned int speed;      ///< UART baud rate
+    bitbang_i2c_t i2c;       ///< I2C sniffer (address mask 0 accepts all addresses)
+    bitbang_spi_t spi[2];    ///< SPI COPI and CIPO shift registers
+    int bit;                 ///< UART bit being sampled (-1 idle), 1-Wire bit counter
+    unsigned int sr;         ///< UART/1-Wire shift register
+    double next;             ///< UART next sample instruction count
+    double bit_time;         ///< UART bit time in instructions
+    uint64_t fall;           ///< 1-Wire instruction count of last falling edge (0 if none)
+    int reset;               ///< 1-Wire waiting presence pulse after reset
+} pdec_t;
+
+/**
+ * @brief Background protocol decoders
+ *
+ * A CPinStream sends the changes of the pins of the configured decoders and
+ * a time mark at each stepping kernel exit to its ring thread, that runs the
+ * decoders over the change stream and writes a timestamped transaction log (addresses, bytes,
+ * ACK/NACK, framing errors) to a file and to a memory buffer read by the
+ * remote control, so decoding adds no work to the simulation thread.
+ */
+class CProtoDecoder {
+public:
+    CProtoDecoder();
+    ~CProtoDecoder();
+
+    /**
+     * @brief Add an I2C decoder, return the decoder number or -1 on error
+     */
+    int AddI2C(const unsigned char scl, const unsigned char sda);
+
+    /**
+     * @brief Add a SPI (mode 0) decoder, cipo and cs can be 0, return the decoder number or -1 on error
+     */
+    int AddSPI(const unsigned char sck, const unsigned char copi, const unsigned char cipo, const unsigned char cs);
+
+    /**
+     * @brief Add an UART (8N1) decoder, return the decoder number or -1 on error
+     */
+    int AddUART(const unsigned char rx, const unsigned int speed);
+
+    /**
+     * @brief Add a 1-Wire decoder, return the decoder number or -1 on error
+     */
+    int AddOneWire(const unsigned char dq);
+
+    /**
+     * @brief Remove all decoders (only when stopped)
+     */
+    void Clear(void);
+
+    /**
+     * @brief Return the number of decoders
+     */
+    int GetCount(void) { return count; };
+
+    /**
+     * @brief Return the description of decoder n
+     */
+    const char* GetDescription(const int n, char* buff, const int size);
+
+    /**
+     * @brief Start decoding the pins of board b, the log is also written to fname if not NULL, return 0 on success
+     */
+    int Start(board* b, const char* fname);
+
+    /**
+     * @brief Stop decoding, decode pending changes and close the log file
+     */
+    void Stop(void);
+
+    /**
+     * @brief Return 1 if decoding
+     */
+    int IsRunning(void) { return Stream.IsRunning(); };
+
+    /**
+     * @brief Move up to size-1 bytes of whole log lines to buff, return the number of bytes
+     */
+    int GetLog(char* buff, const int size);
+
+    /**
+     * @brief Return the number of log lines lost because the remote control buffer was full
+     */
+    unsigned int GetLost(void) { return lost; };
+
+    /**
+     * @brief Stepping kernel entry, return 1 if the pins must be scanned until Leave is called
+     */
+    int Enter(const uint64_t now) { return Stream.Enter(now); };
+
+    /**
+     * @brief Stepping kernel exit, the decoders time advances to now
+     */
+    void Leave(const uint64_t now) {
+        Stream.Mark(now);
+        Stream.Leave();
+    };
+
+    /**
+     * @brief Send the decoders pins changed since last scan at instruction count now
+     */
+    void Scan(const uint64_t now) { Stream.Scan(now); };
+
+private:
+    pdec_t dec[PDEC_MAX];
+    int count;
+    double Period;  // instruction period in us
+    FILE* file;
+    char* log;  // remote control log ring
+    unsigned int log_head;
+    unsigned int log_tail;
+    unsigned int lost;
+#ifndef _NOTHREAD
+    std::mutex log_mtx;
+#endif
+    CPinStream<CProtoDecoder, PDEC_RING_SIZE> Stream;
+
+    friend class CEventRing<CProtoDecoder, PDEC_RING_SIZE>;
+
+    /**
+     * @brief Run the decoders over the changes of the ring thread
+     */
+    void Consume(const uint64_t* changes, const uint32_t num);
+
+    /**
+     * @brief Decode the level change of pin (0 based) at instruction count now
+     */
+    void Change(const uint64_t now, const int pin, const int value);
+
+    /**
+     * @brief Advance the time based decoders to instruction count now
+     */
+    void Advance(pdec_t* d, const int n, const uint64_t now);
+
+    /**
+     * @brief Write a transaction of decoder n at instruction count now to the log
+     */
+    void Emit(const int n, const uint64_t now, const char* fmt, ...);
+
+    int AddDecoder(const int type, const unsigned char* pins, const unsigned int speed);
+};
+
+// Object of the simulation context bound to the calling thread (simcontext.h)
+extern thread_local CProtoDecoder& ProtoDecoder;
+
+#endif /* PROTODECODER_H */
@@ -57,7 +57,12 @@
 
 #include "../devices/lcd_hd44780.h"
 #include "../devices/vterm.h"
+#include "logicrec.h"
+#include "oscilloscope.h"
+#include "pacer.h"
 #include "picsimlab.h"
+#include "profiler.h"
+#include "protodecoder.h"
 #include "rcontrol.h"
 #include "spareparts.h"
 
@@ -69,6 +74,12 @@ static int server_started = 0;
 static char buffer[BSIZE];
 static int bp = 0;
 
+static int binmode = 0;  // binary framed protocol enabled
+static unsigned char bin_in[RC_BIN_FRAME_MAX + 4];
+static unsigned int bin_inp = 0;
+static unsigned char bin_out[4 * RC_BIN_FRAME_MAX + 5];
+static unsigned int bin_outp = 0;
+
 void setnblock(int sock_descriptor) {
 #ifndef _WIN_
     int flags;
@@ -196,6 +207,9 @@ void rcontrol_stop(void) {
         close(sockfd);
     }
     sockfd = -1;
+    binmode = 0;
+    bin_inp = 0;
+    bin_outp = 0;
 }
 
 void rcontrol_end(void) {
@@ -408,6 +422,367 @@ static char pintypetoletter(unsigned char type) {
     return '?';
 }
 
+// binary framed protocol ======================================================
+
+static unsigned int get32(const unsigned char* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static void put32(unsigned char* p, const unsigned int v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+static float getf32(const unsigned char* p) {
+    unsigned int v = get32(p);
+    float f;
+    memcpy(&f, &v, 4);
+    return f;
+}
+
+static void putf32(unsigned char* p, const float f) {
+    unsigned int v;
+    memcpy(&v, &f, 4);
+    put32(p, v);
+}
+
+static int sendbinary(const unsigned char* data, const unsigned int size) {
+    unsigned int sent = 0;
+
+    setblock(sockfd);  // large replies don't fit in the socket buffer
+    while (sent < size) {
+        int n = send(sockfd, (const char*)data + sent, size - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            printf("rcontrol: send error : %s \n", strerror(errno));
+            setnblock(sockfd);
+            return 1;
+        }
+        sent += n;
+    }
+    setnblock(sockfd);
+
+    return 0;
+}
+
+static int bin_flush(void) {
+    int ret = 0;
+    if (bin_outp) {
+        ret = sendbinary(bin_out, bin_outp);
+        bin_outp = 0;
+    }
+    return ret;
+}
+
+static const picpin* bin_pins(int* count) {
+    board* Board = PICSimLab.GetBoard();
+    if (Board->GetUseSpareParts()) {
+        *count = 255;  // board and spare parts virtual pins
+        return SpareParts.GetPinsValues();
+    }
+    *count = Board->MGetPinCount();
+    return Board->MGetPinsValues();
+}
+
+static input_t* bin_input(const unsigned char pn, const unsigned char in) {
+    board* Board = PICSimLab.GetBoard();
+    input_t* Input = NULL;
+
+    if (pn == RC_BIN_BOARD) {
+        if (in < Board->GetInputCount())
+            Input = Board->GetInput(in);
+    } else if (Board->GetUseSpareParts() && (pn < SpareParts.GetCount())) {
+        part* Part = SpareParts.GetPart(pn);
+        if (in < Part->GetInputCount())
+            Input = Part->GetInput(in);
+    }
+    if (Input && (Input->status == NULL))
+        return NULL;
+    return Input;
+}
+
+static output_t* bin_output(const unsigned char pn, const unsigned char out) {
+    board* Board = PICSimLab.GetBoard();
+    output_t* Output = NULL;
+
+    if (pn == RC_BIN_BOARD) {
+        if (out < Board->GetOutputCount())
+            Output = Board->GetOutput(out);
+    } else if (Board->GetUseSpareParts() && (pn < SpareParts.GetCount())) {
+        part* Part = SpareParts.GetPart(pn);
+        if (out < Part->GetOutputCount())
+            Output = Part->GetOutput(out);
+    }
+    if (Output && (Output->status == NULL))
+        return NULL;
+    return Output;
+}
+
+// return the reply payload size or -1 on error
+static int bin_request(const unsigned char op, const unsigned char* req, const unsigned int size,
+                       unsigned char* reply) {
+    board* Board = PICSimLab.GetBoard();
+    const picpin* pins;
+    int count;
+
+    switch (op) {
+        case RC_OP_NOP:
+            return 0;
+        case RC_OP_GET_PINS:
+            pins = bin_pins(&count);
+            for (unsigned int i = 0; i < size; i++) {
+                if (!req[i] || (req[i] > count))
+                    return -1;
+                reply[i] = pins[req[i] - 1].value;
+            }
+            return size;
+        case RC_OP_GET_APINS:
+            pins = bin_pins(&count);
+            for (unsigned int i = 0; i < size; i++) {
+                if (!req[i] || (req[i] > count))
+                    return -1;
+                putf32(reply + 4 * i, pins[req[i] - 1].avalue);
+            }
+            return 4 * size;
+        case RC_OP_SET_PINS:
+        case RC_OP_SET_APINS: {
+            const unsigned int esize = (op == RC_OP_SET_PINS) ? 2 : 5;
+            if (size % esize)
+                return -1;
+            bin_pins(&count);
+            for (unsigned int i = 0; i < size; i += esize) {
+                if (!req[i] || (req[i] > count))
+                    return -1;
+            }
+            // all pins of the request change in the same step
+            Board->IoLockAccess();
+            for (unsigned int i = 0; i < size; i += esize) {
+                if (op == RC_OP_SET_PINS) {
+                    if (Board->GetUseSpareParts()) {
+                        SpareParts.SetPin(req[i], req[i + 1]);
+                    } else {
+                        Board->MSetPin(req[i], req[i + 1]);
+                    }
+                } else {
+                    if (Board->GetUseSpareParts()) {
+                        SpareParts.SetAPin(req[i], getf32(req + i + 1));
+                    } else {
+                        Board->MSetAPin(req[i], getf32(req + i + 1));
+                    }
+                }
+            }
+            Board->IoUnlockAccess();
+            return 0;
+        }
+        case RC_OP_GET_INPUTS:
+            if (size & 1)
+                return -1;
+            for (unsigned int i = 0; i < size; i += 2) {
+                input_t* Input = bin_input(req[i], req[i + 1]);
+                unsigned char* status;
+                short value;
+                if (!Input)
+                    return -1;
+                status = (unsigned char*)Input->status;
+                if (type_is_equal(Input->name, "VS")) {
+                    value = (status[0] << 8) | status[1];
+                } else if (type_is_equal(Input->name, "PB") || type_is_equal(Input->name, "KB") ||
+                           type_is_equal(Input->name, "PO") || type_is_equal(Input->name, "JP")) {
+                    value = status[0];
+                } else if (type_is_equal(Input->name, "VT")) {
+                    value = ((vterm_t*)Input->status)->count_in;
+                } else {
+                    return -1;
+                }
+                reply[i] = value;
+                reply[i + 1] = value >> 8;
+            }
+            return size;
+        case RC_OP_SET_INPUTS:
+            if (size & 3)
+                return -1;
+            for (unsigned int i = 0; i < size; i += 4) {
+                input_t* Input = bin_input(req[i], req[i + 1]);
+                if (!Input || !(type_is_equal(Input->name, "VS") || type_is_equal(Input->name, "PB") ||
+                                type_is_equal(Input->name, "KB") || type_is_equal(Input->name, "PO") ||
+                                type_is_equal(Input->name, "JP")))
+                    return -1;
+            }
+            for (unsigned int i = 0; i < size; i += 4) {
+                input_t* Input = bin_input(req[i], req[i + 1]);
+                unsigned char* status = (unsigned char*)Input->status;
+                if (type_is_equal(Input->name, "VS")) {
+                    status[0] = req[i + 3];
+                    status[1] = req[i + 2];
+                } else {
+                    status[0] = req[i + 2];
+                }
+                if (Input->update) {
+                    *Input->update = 1;
+                }
+            }
+            return 0;
+        case RC_OP_GET_OUTPUTS:
+            if (size & 1)
+                return -1;
+            for (unsigned int i = 0; i < size; i += 2) {
+                output_t* Output = bin_output(req[i], req[i + 1]);
+                float value;
+                if (!Output)
+                    return -1;
+                if (type_is_equal(Output->name, "LD")) {
+                    value = *((float*)Output->status) - 55;
+                } else if (type_is_equal(Output->name, "DG")) {
+                    value = *((float*)Output->status) * 180.0 / M_PI;
+                } else if (type_is_equal(Output->name, "MT")) {
+                    value = *((unsigned char**)Output->status)[2];  // position
+                } else if (type_is_equal(Output->name, "SS")) {
+                    value = *((int*)Output->status);
+                } else {
+                    return -1;
+                }
+                putf32(reply + 2 * i, value);
+            }
+            return 2 * size;
+    }
+    return -1;
+}
+
+static int bin_reply(const unsigned char status, const unsigned char* data, const unsigned int size) {
+    int ret = 0;
+
+    if ((bin_outp + size + 5) > sizeof(bin_out)) {
+        ret += bin_flush();
+    }
+    put32(bin_out + bin_outp, size + 1);
+    bin_out[bin_outp + 4] = status;
+    bin_outp += 5;
+    if (size > (sizeof(bin_out) - bin_outp)) {
+        // memory dumps are sent directly from the board memory
+        ret += bin_flush();
+        ret += sendbinary(data, size);
+    } else if (size) {
+        memcpy(bin_out + bin_outp, data, size);
+        bin_outp += size;
+    }
+    return ret;
+}
+
+static int bin_read_mem(const unsigned char* req, const unsigned int size) {
+    board* Board = PICSimLab.GetBoard();
+    unsigned char* mem;
+    unsigned int msize;
+
+    if (size != 9) {
+        return bin_reply(RC_ST_ERROR, NULL, 0);
+    }
+    switch (req[0]) {
+        case 0:
+            mem = Board->DBGGetRAM_p();
+            msize = Board->DBGGetRAMSize();
+            break;
+        case 1:
+            mem = Board->DBGGetEEPROM_p();
+            msize = Board->DBGGetEEPROM_Size();
+            break;
+        case 2:
+            mem = Board->DBGGetROM_p();
+            msize = Board->DBGGetROMSize();
+            break;
+        default:
+            mem = NULL;
+            msize = 0;
+            break;
+    }
+
+    unsigned int addr = get32(req + 1);
+    unsigned int len = get32(req + 5);
+
+    if (!mem || (addr >= msize)) {
+        return bin_reply(RC_ST_ERROR, NULL, 0);
+    }
+    if (len > (msize - addr)) {
+        len = msize - addr;
+    }
+    return bin_reply(RC_ST_OK, mem + addr, len);
+}
+
+static int rcontrol_binary(void) {
+    int ret = 0;
+    int n = recv(sockfd, (char*)&bin_in[bin_inp], sizeof(bin_in) - bin_inp, 0);
+
+    if (n > 0) {
+        bin_inp += n;
+    } else if (n == 0) {
+        return 1;  // socket close by client
+    } else {
+#ifndef _WIN_
+        if (errno != EAGAIN)
+#else
+        if (WSAGetLastError() != WSAEWOULDBLOCK)
+#endif
+        {
+            return 1;  // recv ERROR
+        }
+    }
+
+    unsigned int pos = 0;
+    while (binmode && ((bin_inp - pos) >= 5)) {
+        const unsigned int len = get32(bin_in + pos);
+
+        if ((len == 0) || (len > RC_BIN_FRAME_MAX)) {
+            printf("rcontrol: invalid binary frame length %u\n", len);
+            return 1;
+        }
+        if ((bin_inp - pos) < (len + 4)) {
+            break;  // wait the rest of frame
+        }
+
+        const unsigned char op = bin_in[pos + 4];
+        const unsigned char* req = bin_in + pos + 5;
+        const unsigned int size = len - 1;
+        pos += len + 4;
+
+        if (op == RC_OP_READ_MEM) {
+            ret += bin_read_mem(req, size);
+        } else if (op == RC_OP_TEXT) {
+            ret += bin_reply(RC_ST_OK, NULL, 0);
+            binmode = 0;
+        } else {
+            // the worst case reply is four times the request size
+            if ((bin_outp + 4 * size + 5) > sizeof(bin_out)) {
+                ret += bin_flush();
+            }
+            unsigned char* reply = bin_out + bin_outp + 5;
+            int rsize = bin_request(op, req, size, reply);
+            if (rsize < 0) {
+                ret += bin_reply(RC_ST_ERROR, NULL, 0);
+            } else {
+                put32(bin_out + bin_outp, rsize + 1);
+                bin_out[bin_outp + 4] = RC_ST_OK;
+                bin_outp += rsize + 5;
+            }
+        }
+    }
+
+    memmove(bin_in, bin_in + pos, bin_inp - pos);
+    bin_inp -= pos;
+
+    ret += bin_flush();
+
+    if (!binmode) {
+        // back to text protocol, keep the remaining commands
+        bp = (bin_inp < (BSIZE - 1)) ? bin_inp : (BSIZE - 1);
+        memset(buffer, 0, BSIZE);
+        memcpy(buffer, bin_in, bp);
+        bin_inp = 0;
+        ret += sendtext(">");
+    }
+
+    return ret;
+}
+
 int rcontrol_loop(void) {
     int i, j;
     int n;
@@ -425,6 +800,13 @@ int rcontrol_loop(void) {
         return rcontrol_start();
     }
 
+    if (binmode) {
+        ret = rcontrol_binary();
+        if (ret)
+            rcontrol_stop();
+        return ret;
+    }
+
     n = recv(sockfd, (char*)&buffer[bp], 1024 - bp, 0);
 
     if (n > 0) {
@@ -461,6 +843,27 @@ int rcontrol_loop(void) {
             dprint("cmd[%s]\n", cmd);
 
             switch (cmd[0]) {
+                case 'b':
+                    if (!strncmp(cmd, "binary", 6)) {
+                        // Command binary
+                        // ========================================================
+                        int version = RC_BIN_VERSION;
+                        sscanf(cmd + 6, "%i", &version);
+                        if (version == RC_BIN_VERSION) {
+                            ret = sendtext("Ok\r\n");
+                            // frames already received after the command
+                            memcpy(bin_in, buffer, bp);
+                            bin_inp = bp;
+                            memset(buffer, 0, BSIZE);
+                            bp = 0;
+                            binmode = 1;
+                        } else {
+                            ret = sendtext("ERROR\r\n>");
+                        }
+                    } else {
+                        ret = sendtext("ERROR\r\n>");
+                    }
+                    break;
                 case 'c':
                     if (!strncmp(cmd, "clk", 3)) {
                         // Command clk =====================================================
@@ -480,7 +883,53 @@ int rcontrol_loop(void) {
                     }
                     break;
                 case 'd':
-                    if (strstr(cmd, "dumpr")) {
+                    if (!strncmp(cmd, "decode", 6)) {
+                        // Command decode
+                        // ========================================================
+                        unsigned int p[4] = {0, 0, 0, 0};
+                        char fname[BSIZE];
+                        int ok = 0;
+                        if (sscanf(cmd + 6, " i2c %u %u", &p[0], &p[1]) == 2) {
+                            ok = ProtoDecoder.AddI2C(p[0], p[1]) >= 0;
+                        } else if (sscanf(cmd + 6, " spi %u %u %u %u", &p[0], &p[1], &p[2], &p[3]) >= 2) {
+                            ok = ProtoDecoder.AddSPI(p[0], p[1], p[2], p[3]) >= 0;
+                        } else if (sscanf(cmd + 6, " uart %u %u", &p[0], &p[1]) == 2) {
+                            ok = ProtoDecoder.AddUART(p[0], p[1]) >= 0;
+                        } else if (sscanf(cmd + 6, " 1w %u", &p[0]) == 1) {
+                            ok = ProtoDecoder.AddOneWire(p[0]) >= 0;
+                        } else if (!strncmp(cmd + 6, " start", 6)) {
+                            fname[0] = 0;
+                            sscanf(cmd + 12, " %s", fname);
+                            ok = !ProtoDecoder.Start(PICSimLab.GetBoard(), fname);
+                        } else if (!strncmp(cmd + 6, " stop", 5)) {
+                            ProtoDecoder.Stop();
+                            ok = 1;
+                        } else if (!strncmp(cmd + 6, " clear", 6)) {
+                            ProtoDecoder.Clear();
+                            ok = !ProtoDecoder.GetCount();
+                        } else if (!strncmp(cmd + 6, " log", 4)) {
+                            while (ProtoDecoder.GetLog(fname, BSIZE)) {
+                                ret += sendtext(fname);
+                            }
+                            ok = 1;
+                        } else if (!cmd[6]) {
+                            snprintf(lstemp, 200, "Decode %s: %i decoders, %u lines lost\r\n",
+                                     ProtoDecoder.IsRunning() ? "on" : "off", ProtoDecoder.GetCount(),
+                                     ProtoDecoder.GetLost());
+                            ret += sendtext(lstemp);
+                            for (i = 0; i < ProtoDecoder.GetCount(); i++) {
+                                ret += sendtext("  ");
+                                ret += sendtext(ProtoDecoder.GetDescription(i, lstemp, 200));
+                                ret += sendtext("\r\n");
+                            }
+                            ok = 1;
+                        }
+                        if (ok) {
+                            ret += sendtext("Ok\r\n>");
+                        } else {
+                            ret += sendtext("ERROR\r\n>");
+                        }
+                    } else if (strstr(cmd, "dumpr")) {
                         // Command dumpr
                         // ========================================================
                         Board = PICSimLab.GetBoard();
@@ -785,7 +1234,11 @@ int rcontrol_loop(void) {
                         // Command help
                         // ========================================================
                         ret += sendtext("List of supported commands:\r\n");
+                        ret += sendtext("  binary [ver] - switch to binary framed protocol (see rcontrol.h)\r\n");
                         ret += sendtext("  clk [val MHz]- show or set simulation clock\r\n");
+                        ret += sendtext(
+                            "  decode [cmd] - show protocol decoders or execute i2c scl sda/spi sck copi [cipo] [cs]/"
+                            "uart rx baud/1w dq/start [file]/stop/clear/log\r\n");
                         ret += sendtext("  dumpe [a] [s]- dump internal EEPROM memory\r\n");
                         ret += sendtext("  dumpf [a] [s]- dump Flash memory\r\n");
                         ret += sendtext("  dumpr [a] [s]- dump RAM memory\r\n");
@@ -794,14 +1247,21 @@ int rcontrol_loop(void) {
                         ret += sendtext("  help         - show this message\r\n");
                         ret += sendtext("  info         - show actual setup info and objects\r\n");
                         ret += sendtext("  loadhex file - load hex file (use full path)\r\n");
+                        ret += sendtext("  logic [cmd]  - show logic recorder status or execute start file.vcd.gz/stop\r\n");
+                        ret += sendtext("  pace [reset] - show real time pacing statistics or clear them\r\n");
                         ret += sendtext("  pins         - show pins directions and values\r\n");
                         ret += sendtext("  pinsl        - show pins formated info\r\n");
+                        ret += sendtext("  prof [on/off]- show profiler times or enable/disable it\r\n");
                         ret += sendtext("  quit         - exit remote control interface\r\n");
                         ret += sendtext("  reset        - reset the board\r\n");
+                        ret += sendtext(
+                            "  scope [cmd]  - show oscilloscope setup or execute channels n/pin ch pin/"
+                            "trigger rising|falling|edge|pulse|pattern/pulse min max/pattern p/holdoff ms/"
+                            "data ch [n]\r\n");
                         ret += sendtext("  set ob vl    - set object with value\r\n");
                         ret += sendtext(
                             "  sim [cmd]    - show simulation status or execute "
-                            "cmd start/stop\r\n");
+                            "cmd start/stop/fast/realtime\r\n");
                         ret += sendtext("  sync         - wait to syncronize with timer event\r\n");
                         ret += sendtext("  version      - show PICSimLab version\r\n");
 
@@ -883,6 +1343,26 @@ int rcontrol_loop(void) {
                         } else {
                             ret += sendtext("Ok\r\n>");
                         }
+                    } else if (!strncmp(cmd, "logic", 5)) {
+                        // Command logic
+                        // ========================================================
+                        if (!strncmp(cmd + 5, " start ", 7)) {
+                            if (LogicRecorder.Start(PICSimLab.GetBoard(), cmd + 12)) {
+                                ret = sendtext("ERROR\r\n>");
+                            } else {
+                                ret = sendtext("Ok\r\n>");
+                            }
+                        } else if (strstr(cmd + 5, "stop")) {
+                            LogicRecorder.Stop();
+                            ret = sendtext("Ok\r\n>");
+                        } else {
+                            snprintf(lstemp, 200, "Logic %s: %i pins, %llu changes, %llu bytes\r\n",
+                                     LogicRecorder.IsRecording() ? "on" : "off", LogicRecorder.GetVarCount(),
+                                     (unsigned long long)LogicRecorder.GetChanges(),
+                                     (unsigned long long)LogicRecorder.GetBytes());
+                            ret += sendtext(lstemp);
+                            ret += sendtext("Ok\r\n>");
+                        }
                     } else {
                         ret = sendtext("ERROR\r\n>");
                     }
@@ -921,6 +1401,71 @@ int rcontrol_loop(void) {
                             ret += sendtext(lstemp);
                         }
                         ret += sendtext("Ok\r\n>");
+                    } else if (!strncmp(cmd, "pace", 4)) {
+                        // Command pace ====================================================
+                        if (strstr(cmd + 4, "reset")) {
+                            Pacer.Reset();
+                            ret = sendtext("Ok\r\n>");
+                        } else {
+                            snprintf(lstemp, 200, "Pace: %5.3fx load %5.3f period %u ms\r\n", Pacer.GetRatio(),
+                                     Pacer.GetLoad(), Pacer.GetPeriod());
+                            ret += sendtext(lstemp);
+                            snprintf(lstemp, 200, "Lag: %.1f ms  Jitter: %.1f ms (max %.1f ms)\r\n", Pacer.GetLag(),
+                                     Pacer.GetJitter(), Pacer.GetMaxJitter());
+                            ret += sendtext(lstemp);
+                            snprintf(lstemp, 200, "Overruns: %u  Catch-ups: %u  Drops: %u\r\n", Pacer.GetOverruns(),
+                                     Pacer.GetCatchUps(), Pacer.GetDrops());
+                            ret += sendtext(lstemp);
+                            const unsigned int* lagh = Pacer.GetLagHistogram();
+                            const unsigned int* jith = Pacer.GetJitterHistogram();
+                            ret += sendtext("  ms        lag     jitter\r\n");
+                            for (i = 0; i < PACE_HIST; i++) {
+                                if (CPacer::GetHistogramLimit(i)) {
+                                    snprintf(lstemp, 200, "  <%-4u %10u %10u\r\n", CPacer::GetHistogramLimit(i), lagh[i],
+                                             jith[i]);
+                                } else {
+                                    snprintf(lstemp, 200, "  >=%-3u %10u %10u\r\n", CPacer::GetHistogramLimit(i - 1),
+                                             lagh[i], jith[i]);
+                                }
+                                ret += sendtext(lstemp);
+                            }
+                            ret += sendtext("Ok\r\n>");
+                        }
+                    } else if (!strncmp(cmd, "prof", 4)) {
+                        // Command prof ====================================================
+                        if (strstr(cmd + 4, "on")) {
+                            Profiler.SetEnabled(1);
+                            ret = sendtext("Ok\r\n>");
+                        } else if (strstr(cmd + 4, "off")) {
+                            Profiler.SetEnabled(0);
+                            ret = sendtext("Ok\r\n>");
+                        } else {
+                            const double elapsed = Profiler.GetElapsed() * 1e-9;
+                            const double runtime = Profiler.GetRunTime() * 1e-6;
+                            snprintf(lstemp, 200, "Profiler %s: %llu steps in %.3f s, %.3f Minst/s\r\n",
+                                     Profiler.GetEnabled() ? "on" : "off", (unsigned long long)Profiler.GetSteps(),
+                                     elapsed, elapsed > 0 ? (Profiler.GetSteps() * 1e-6) / elapsed : 0);
+                            ret += sendtext(lstemp);
+                            snprintf(lstemp, 200, "  %-10s %12.3f ms\r\n", "run", runtime);
+                            ret += sendtext(lstemp);
+                            for (i = 0; i < PS_LAST; i++) {
+                                const double stime = Profiler.GetStageTime(i) * 1e-6;
+                                snprintf(lstemp, 200, "  %-10s %12.3f ms %5.1f%%\r\n", CProfiler::GetStageName(i),
+                                         stime, runtime > 0 ? (100.0 * stime) / runtime : 0);
+                                ret += sendtext(lstemp);
+                            }
+                            for (i = 0; i < SpareParts.GetCount(); i++) {
+                                Part = SpareParts.GetPart(i);
+                                snprintf(lstemp, 200,
+                                         "  part[%02i] pre %10.3f ms proc %10.3f ms post %10.3f ms \"%s\"\r\n", i,
+                                         Profiler.GetPartTime(Part->GetId(), PP_PREPROCESS) * 1e-6,
+                                         Profiler.GetPartTime(Part->GetId(), PP_PROCESS) * 1e-6,
+                                         Profiler.GetPartTime(Part->GetId(), PP_POSTPROCESS) * 1e-6,
+                                         (const char*)Part->GetName().c_str());
+                                ret += sendtext(lstemp);
+                            }
+                            ret += sendtext("Ok\r\n>");
+                        }
                     } else {
                         ret = sendtext("ERROR\r\n>");
                     }
@@ -946,7 +1491,79 @@ int rcontrol_loop(void) {
                     }
                     break;
                 case 's':
-                    if (!strncmp(cmd, "set ", 4)) {
+                    if (!strncmp(cmd, "scope", 5)) {
+                        // Command scope
+                        // ========================================================
+                        static const char* tmodes[OSC_TRG_LAST] = {"rising", "falling", "edge", "pulse", "pattern"};
+                        int p[2] = {0, 0};
+                        double t[2] = {0, 0};
+                        char str[20];
+                        int ok = 0;
+                        if (sscanf(cmd + 5, " channels %i", &p[0]) == 1) {
+                            if ((p[0] >= 1) && (p[0] <= OSC_MAX_CH)) {
+                                Oscilloscope.SetChannelCount(p[0]);
+                                ok = 1;
+                            }
+                        } else if (sscanf(cmd + 5, " pin %i %i", &p[0], &p[1]) == 2) {
+                            Board = PICSimLab.GetBoard();
+                            if ((p[0] >= 1) && (p[0] <= OSC_MAX_CH) && (p[1] >= 1) &&
+                                (p[1] <= Board->MGetPinCount())) {
+                                Oscilloscope.SetChannelPin(p[0] - 1, p[1] - 1);
+                                ok = 1;
+                            }
+                        } else if (sscanf(cmd + 5, " trigger %19s", str) == 1) {
+                            for (i = 0; i < OSC_TRG_LAST; i++) {
+                                if (!strcmp(str, tmodes[i])) {
+                                    Oscilloscope.SetTriggerMode(i);
+                                    ok = 1;
+                                }
+                            }
+                        } else if (sscanf(cmd + 5, " pulse %lf %lf", &t[0], &t[1]) == 2) {
+                            Oscilloscope.SetTriggerPulse(t[0] * 1e-3, t[1] * 1e-3);
+                            ok = 1;
+                        } else if (sscanf(cmd + 5, " pattern %19s", str) == 1) {
+                            Oscilloscope.SetTriggerPattern(str);
+                            ok = 1;
+                        } else if (sscanf(cmd + 5, " holdoff %lf", &t[0]) == 1) {
+                            Oscilloscope.SetTriggerHoldoff(t[0] * 1e-3);
+                            ok = 1;
+                        } else if (sscanf(cmd + 5, " data %i %i", &p[0], &p[1]) >= 1) {
+                            // last captured samples of one channel, in volts
+                            if (p[1] <= 0) {
+                                p[1] = WMAX;
+                            }
+                            if ((p[0] >= 1) && (p[0] <= Oscilloscope.GetChannelCount()) && (p[1] <= OSC_RECORD_MAX)) {
+                                double* rec = new double[p[1]];
+                                const int n = Oscilloscope.GetRecord(p[0] - 1, rec, p[1]);
+                                for (i = 0; i < n; i++) {
+                                    snprintf(lstemp, 200, "%.3f\r\n", -rec[i]);
+                                    ret += sendtext(lstemp);
+                                }
+                                delete[] rec;
+                                ok = 1;
+                            }
+                        } else if (!cmd[5]) {
+                            snprintf(lstemp, 200, "Scope: %i channels, trigger %s on ch%i, pattern %s\r\n",
+                                     Oscilloscope.GetChannelCount(), tmodes[Oscilloscope.GetTriggerMode()],
+                                     Oscilloscope.GetTriggerChannel() + 1,
+                                     (const char*)Oscilloscope.GetTriggerPattern().c_str());
+                            ret += sendtext(lstemp);
+                            snprintf(lstemp, 200, "  pulse %.3f %.3f ms, holdoff %.3f ms\r\n",
+                                     Oscilloscope.GetTriggerPulseMin() * 1e3, Oscilloscope.GetTriggerPulseMax() * 1e3,
+                                     Oscilloscope.GetTriggerHoldoff() * 1e3);
+                            ret += sendtext(lstemp);
+                            for (i = 0; i < Oscilloscope.GetChannelCount(); i++) {
+                                snprintf(lstemp, 200, "  ch%i pin %i\r\n", i + 1, Oscilloscope.GetChannelPin(i) + 1);
+                                ret += sendtext(lstemp);
+                            }
+                            ok = 1;
+                        }
+                        if (ok) {
+                            ret += sendtext("Ok\r\n>");
+                        } else {
+                            ret += sendtext("ERROR\r\n>");
+                        }
+                    } else if (!strncmp(cmd, "set ", 4)) {
                         // Command set
                         // =========================================================
                         char* ptr;
@@ -1069,8 +1686,17 @@ int rcontrol_loop(void) {
                         } else if (strstr(cmd + 3, "start")) {
                             PICSimLab.SetSimulationRun(1);
                             ret = sendtext("Ok\r\n>");
+                        } else if (strstr(cmd + 3, "fast")) {
+                            PICSimLab.SetUnthrottled(1);
+                            ret = sendtext(PICSimLab.GetUnthrottled() ? "Ok\r\n>" : "ERROR\r\n>");
+                        } else if (strstr(cmd + 3, "realtime")) {
+                            PICSimLab.SetUnthrottled(0);
+                            ret = sendtext("Ok\r\n>");
                         } else {
-                            if (PICSimLab.GetSimulationRun()) {
+                            if (PICSimLab.GetSimulationRun() && PICSimLab.GetUnthrottled()) {
+                                ret = sendtext(lxString().Format("Simulation running %5.2fx (unthrottled)\r\nOk\r\n>",
+                                                                 PICSimLab.GetRealTimeFactor()));
+                            } else if (PICSimLab.GetSimulationRun()) {
                                 ret = sendtext(lxString().Format(
                                     "Simulation running %5.2fx\r\nOk\r\n>",
                                     100.0 / ((CTimer*)PICSimLab.GetWindow()->GetChildByName("timer1"))->GetTime()));
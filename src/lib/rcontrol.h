@@ -40,6 +40,44 @@
  PB - push button
  */
 
+/* Binary framed protocol (enabled by the text command "binary 1")
+ All integers are little endian and floats are IEEE 754 single precision.
+ Request: u32 length (opcode + payload) | u8 opcode | payload
+ Reply:   u32 length (status + payload) | u8 status | payload
+ Several requests can be sent without waiting, the replies come in order.
+ A part number of 0xFF addresses the board inputs and outputs.
+
+ opcode         request payload             reply payload
+ NOP            -                           -
+ GET_PINS       n x (u8 pin)                n x (u8 value)
+ SET_PINS       n x (u8 pin, u8 value)      -
+ GET_APINS      n x (u8 pin)                n x (f32 value)
+ SET_APINS      n x (u8 pin, f32 value)     -
+ GET_INPUTS     n x (u8 part, u8 in)        n x (i16 value)
+ SET_INPUTS     n x (u8 part, u8 in, i16)   -
+ GET_OUTPUTS    n x (u8 part, u8 out)       n x (f32 value)
+ READ_MEM       u8 mem, u32 addr, u32 size  raw bytes (mem 0=RAM 1=EEPROM 2=Flash)
+ TEXT           -                           - (back to the text protocol)
+ */
+
+#define RC_BIN_VERSION 1
+#define RC_BIN_FRAME_MAX 65536  // max request length
+#define RC_BIN_BOARD 0xFF
+
+#define RC_OP_NOP 0x00
+#define RC_OP_GET_PINS 0x01
+#define RC_OP_SET_PINS 0x02
+#define RC_OP_GET_APINS 0x03
+#define RC_OP_SET_APINS 0x04
+#define RC_OP_GET_INPUTS 0x05
+#define RC_OP_SET_INPUTS 0x06
+#define RC_OP_GET_OUTPUTS 0x07
+#define RC_OP_READ_MEM 0x08
+#define RC_OP_TEXT 0x7F
+
+#define RC_ST_OK 0x00
+#define RC_ST_ERROR 0x01
+
 // PICSimLab remote control
 int rcontrol_init(const unsigned short tcpport, const int reporterror = 0);
 int rcontrol_loop(void);
@@ -0,0 +1,341 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "scopeanalysis.h"
+
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Global object
+CScopeAnalysis ScopeAnalysis;
+
+#define LANES 4  // independent accumulators, lets the compiler vectorize the reductions
+
+void scope_stats(const double* data, const int n, const double rt, ch_status_t* status) {
+    double lmax[LANES];
+    double lmin[LANES];
+    double lsum[LANES];
+    double lsq[LANES];
+    int i;
+
+    if (n < LANES) {
+        memset(status, 0, sizeof(ch_status_t));
+        return;
+    }
+
+    // pass 1: amplitude, branch free
+    for (int l = 0; l < LANES; l++) {
+        lmax[l] = -data[l];
+        lmin[l] = -data[l];
+        lsum[l] = 0;
+        lsq[l] = 0;
+    }
+
+    for (i = 0; i <= n - LANES; i += LANES) {
+        for (int l = 0; l < LANES; l++) {
+            const double val = -data[i + l];
+            lmax[l] = (val > lmax[l]) ? val : lmax[l];
+            lmin[l] = (val < lmin[l]) ? val : lmin[l];
+            lsum[l] += val;
+            lsq[l] += val * val;
+        }
+    }
+    for (; i < n; i++) {
+        const double val = -data[i];
+        lmax[0] = (val > lmax[0]) ? val : lmax[0];
+        lmin[0] = (val < lmin[0]) ? val : lmin[0];
+        lsum[0] += val;
+        lsq[0] += val * val;
+    }
+
+    for (int l = 1; l < LANES; l++) {
+        lmax[0] = (lmax[l] > lmax[0]) ? lmax[l] : lmax[0];
+        lmin[0] = (lmin[l] < lmin[0]) ? lmin[l] : lmin[0];
+        lsum[0] += lsum[l];
+        lsq[0] += lsq[l];
+    }
+
+    status->Vmax = lmax[0];
+    status->Vmin = lmin[0];
+    status->Vavr = lsum[0] / n;  // Voltage average
+    status->Vrms = sqrt(lsq[0] / n);
+
+    // pass 2: crossings of the average, transitions are rare so the branch is well predicted
+    const double avr = status->Vavr;
+    int down = (-data[0] < avr);  // last transition down
+    int firstUp = -1;             // first transition up sample
+    int lastUp = -1;              // last transition up sample
+    int numUps = 0;               // Number of transitions up
+    int sumPCW = 0;               // Positive semi-cycle width sum
+    int numPCycles = 0;           // Number of positive semi-cycles
+
+    for (i = 1; i < n; i++) {
+        const double val = -data[i];
+        const int up = down & (val > avr);
+        const int dn = (!down) & (val < avr);
+
+        if (up | dn) {
+            if (up) {
+                if (firstUp < 0)
+                    firstUp = i;
+                lastUp = i;
+                numUps++;
+            } else if (firstUp >= 0) {
+                sumPCW += i - lastUp;
+                numPCycles++;
+            }
+            down = dn;
+        }
+    }
+
+    const int numFCycles = numUps - 1;  // Number of full cycles
+    const double avgFCycleWidth = (numFCycles > 0) ? (lastUp - firstUp) * rt / numFCycles : 0;
+    const double avgPCycleWidth = (numPCycles > 0) ? sumPCW * rt / numPCycles : 0;
+
+    const int pulseValid = (numFCycles > 0) && (avgFCycleWidth != 0) && (avgPCycleWidth != 0) &&
+                           ((status->Vmax - status->Vmin) > 0.2);
+
+    if (pulseValid) {
+        status->PCycle_ms = avgPCycleWidth * 1000;
+        status->FCycle_ms = avgFCycleWidth * 1000;
+        status->Freq = 1.0 / avgFCycleWidth;
+        status->Duty = avgPCycleWidth * 100 / avgFCycleWidth;
+    } else {
+        status->PCycle_ms = -1;
+        status->FCycle_ms = -1;
+        status->Freq = -1;
+        status->Duty = -1;
+    }
+}
+
+// in place radix-2 complex FFT, n power of two
+static void scope_fft(double* re, double* im, const int n) {
+    // bit reversal permutation
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            double tmp = re[i];
+            re[i] = re[j];
+            re[j] = tmp;
+            tmp = im[i];
+            im[i] = im[j];
+            im[j] = tmp;
+        }
+    }
+
+    for (int len = 2; len <= n; len <<= 1) {
+        const double ang = -2.0 * M_PI / len;
+        const double wre = cos(ang);
+        const double wim = sin(ang);
+        for (int i = 0; i < n; i += len) {
+            double cre = 1.0;
+            double cim = 0.0;
+            for (int k = 0; k < len / 2; k++) {
+                const int a = i + k;
+                const int b = a + len / 2;
+                const double tre = re[b] * cre - im[b] * cim;
+                const double tim = re[b] * cim + im[b] * cre;
+                re[b] = re[a] - tre;
+                im[b] = im[a] - tim;
+                re[a] += tre;
+                im[a] += tim;
+                const double nre = cre * wre - cim * wim;
+                cim = cre * wim + cim * wre;
+                cre = nre;
+            }
+        }
+    }
+}
+
+double scope_spectrum(const double* data, const int n, const double rt, float* mag) {
+    double re[SCOPE_FFT_MAX / 2];
+    double im[SCOPE_FFT_MAX / 2];
+    const int h = n / 2;
+
+    if ((n < SCOPE_FFT_MIN) || (n > SCOPE_FFT_MAX) || (n & (n - 1)))
+        return -1;
+
+    // Hann window, even samples as real and odd samples as imaginary part of a n/2 complex FFT
+    const double wk = 2.0 * M_PI / n;
+    for (int m = 0; m < h; m++) {
+        re[m] = -data[2 * m] * (0.5 - 0.5 * cos(wk * (2 * m)));
+        im[m] = -data[2 * m + 1] * (0.5 - 0.5 * cos(wk * (2 * m + 1)));
+    }
+
+    scope_fft(re, im, h);
+
+    // split the packed result, scaled to peak volts (Hann coherent gain is 0.5)
+    const double scale = 4.0 / n;
+    for (int k = 0; k < h; k++) {
+        const int kc = (h - k) & (h - 1);
+        const double ere = (re[k] + re[kc]) * 0.5;
+        const double eim = (im[k] - im[kc]) * 0.5;
+        const double ore = (im[k] + im[kc]) * 0.5;
+        const double oim = -(re[k] - re[kc]) * 0.5;
+        const double ang = -wk * k;
+        const double tre = ore * cos(ang) - oim * sin(ang);
+        const double tim = ore * sin(ang) + oim * cos(ang);
+        const double xre = ere + tre;
+        const double xim = eim + tim;
+        mag[k] = sqrt(xre * xre + xim * xim) * scale;
+    }
+    mag[0] *= 0.5;  // DC has no negative frequency image
+
+    // dominant frequency, skip DC and its window leakage
+    int kmax = 2;
+    for (int k = 3; k < h - 1; k++) {
+        if (mag[k] > mag[kmax])
+            kmax = k;
+    }
+
+    // parabolic interpolation between bins
+    const double a = mag[kmax - 1];
+    const double b = mag[kmax];
+    const double c = mag[kmax + 1];
+    const double den = a - 2 * b + c;
+    const double delta = (den != 0) ? 0.5 * (a - c) / den : 0;
+
+    return (kmax + delta) / (n * rt);
+}
+
+CScopeAnalysis::CScopeAnalysis() {
+    jfill = &jobs[0];
+    jnext = &jobs[1];
+    jwork = &jobs[2];
+    jdone = &jobs[3];
+    jview = &jobs[4];
+    next_ready = 0;
+    done_ready = 0;
+#ifndef _NOTHREAD
+    quit = 0;
+#endif
+}
+
+CScopeAnalysis::~CScopeAnalysis() {
+    Stop();
+}
+
+void CScopeAnalysis::Run(scope_job_t* job) {
+    for (int c = 0; c < OSC_MAX_CH; c++) {
+        if (job->chmask & (1 << c)) {
+            scope_stats(job->data[c], job->npoints, job->rt, &job->status[c]);
+        }
+        if (job->fftmask & (1 << c)) {
+            job->fdom[c] = scope_spectrum(job->rec[c], job->nfft, job->rt, job->spectrum[c]);
+        }
+    }
+}
+
+#ifndef _NOTHREAD
+
+void CScopeAnalysis::Post(void) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        scope_job_t* tmp = jnext;  // a job not started yet is dropped
+        jnext = jfill;
+        jfill = tmp;
+        next_ready = 1;
+        if (!worker.joinable()) {
+            quit = 0;
+            worker = std::thread(&CScopeAnalysis::Worker, this);
+        }
+    }
+    cv_work.notify_one();
+}
+
+scope_job_t* CScopeAnalysis::Fetch(void) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!done_ready)
+        return NULL;
+    scope_job_t* tmp = jview;
+    jview = jdone;
+    jdone = tmp;
+    done_ready = 0;
+    return jview;
+}
+
+void CScopeAnalysis::Stop(void) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        quit = 1;
+    }
+    cv_work.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void CScopeAnalysis::Worker(void) {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (1) {
+        cv_work.wait(lock, [&] { return quit || next_ready; });
+        if (quit)
+            break;
+        scope_job_t* tmp = jwork;
+        jwork = jnext;
+        jnext = tmp;
+        next_ready = 0;
+
+        lock.unlock();
+        Run(jwork);
+        lock.lock();
+
+        tmp = jdone;
+        jdone = jwork;
+        jwork = tmp;
+        done_ready = 1;
+    }
+}
+
+#else  // _NOTHREAD
+
+void CScopeAnalysis::Post(void) {
+    Run(jfill);
+    scope_job_t* tmp = jdone;
+    jdone = jfill;
+    jfill = tmp;
+    done_ready = 1;
+}
+
+scope_job_t* CScopeAnalysis::Fetch(void) {
+    if (!done_ready)
+        return NULL;
+    scope_job_t* tmp = jview;
+    jview = jdone;
+    jdone = tmp;
+    done_ready = 0;
+    return jview;
+}
+
+void CScopeAnalysis::Stop(void) {}
+
+#endif  // _NOTHREAD
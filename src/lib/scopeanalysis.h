@@ -0,0 +1,120 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef SCOPEANALYSIS_H
+#define SCOPEANALYSIS_H
+
+#ifndef _NOTHREAD
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+#include "oscilloscope.h"
+
+#define SCOPE_FFT_MIN 64    // smallest spectrum size
+#define SCOPE_FFT_MAX 2048  // largest spectrum size (power of two)
+
+/**
+ * @brief Oscilloscope analysis job, input snapshot and results
+ */
+typedef struct {
+    int chmask;                                // channels to measure
+    int fftmask;                               // channels to transform
+    int npoints;                               // number of points of data
+    int nfft;                                  // number of points of rec (power of two)
+    double rt;                                 // time between samples
+    double data[OSC_MAX_CH][NPOINTS / 2];      // displayed samples
+    double rec[OSC_MAX_CH][SCOPE_FFT_MAX];     // record samples
+    ch_status_t status[OSC_MAX_CH];            // measures results
+    float spectrum[OSC_MAX_CH][SCOPE_FFT_MAX / 2];  // spectrum results (peak volts per bin)
+    double fdom[OSC_MAX_CH];                   // dominant frequency results
+} scope_job_t;
+
+/**
+ * @brief Calculate channel measures of n samples (stored inverted as in oscilloscope buffers)
+ */
+void scope_stats(const double* data, const int n, const double rt, ch_status_t* status);
+
+/**
+ * @brief Hann windowed real FFT of n samples (power of two), write n/2 bins magnitudes and return dominant frequency
+ */
+double scope_spectrum(const double* data, const int n, const double rt, float* mag);
+
+/**
+ * @brief Oscilloscope measures and spectrum calculated out of the UI thread
+ *
+ * The UI fills a job snapshot and posts it, a worker thread computes it and
+ * the UI fetches the last finished job on the next timer event. Posting
+ * never waits for the worker: an unstarted job is replaced by the newer one.
+ */
+class CScopeAnalysis {
+public:
+    CScopeAnalysis();
+    ~CScopeAnalysis();
+
+    /**
+     * @brief Return a free job to fill
+     */
+    scope_job_t* GetJob(void) { return jfill; };
+
+    /**
+     * @brief Queue the job returned by GetJob
+     */
+    void Post(void);
+
+    /**
+     * @brief Return the last finished job (owned by UI until the next call) or NULL if none finished since last call
+     */
+    scope_job_t* Fetch(void);
+
+    /**
+     * @brief Stop the worker thread
+     */
+    void Stop(void);
+
+private:
+    scope_job_t jobs[5];
+    scope_job_t* jfill;  // filled by UI
+    scope_job_t* jnext;  // waiting the worker
+    scope_job_t* jwork;  // in use by the worker
+    scope_job_t* jdone;  // finished
+    scope_job_t* jview;  // fetched by UI
+    int next_ready;
+    int done_ready;
+#ifndef _NOTHREAD
+    std::thread worker;
+    std::mutex mtx;
+    std::condition_variable cv_work;
+    int quit;
+
+    void Worker(void);
+#endif
+    void Run(scope_job_t* job);
+};
+
+extern CScopeAnalysis ScopeAnalysis;
+
+#endif /* SCOPEANALYSIS_H */
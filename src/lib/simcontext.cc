@@ -0,0 +1,252 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "simcontext.h"
+
+static thread_local CSimContext* bound = NULL;  // context bound to the thread
+static thread_local int bound_used = 0;         // the thread local references are initialized
+
+static CSimContext* BoundContext(void) {
+    if (!bound) {
+        bound = CSimContext::GetDefault();
+    }
+    bound_used = 1;
+    return bound;
+}
+
+// Objects of the context bound to each thread, initialized on the first use in the thread
+thread_local CPICSimLab& PICSimLab = BoundContext()->picsimlab;
+thread_local CSpareParts& SpareParts = BoundContext()->spareparts;
+thread_local COscilloscope& Oscilloscope = BoundContext()->oscilloscope;
+thread_local CProfiler& Profiler = BoundContext()->profiler;
+thread_local CLogicRecorder& LogicRecorder = BoundContext()->logicrecorder;
+thread_local CProtoDecoder& ProtoDecoder = BoundContext()->protodecoder;
+thread_local int& ioupdated = BoundContext()->ioupdated;
+
+CSimContext::CSimContext() {
+    ioupdated = 0;
+    tmpdir[0] = 0;
+}
+
+CSimContext::~CSimContext() {
+    if (tmpdir[0]) {
+        lxRemoveDir(tmpdir);
+    }
+}
+
+CSimContext* CSimContext::GetDefault(void) {
+    static CSimContext context;
+    return &context;
+}
+
+int CSimContext::Bind(void) {
+    if (bound_used && (bound != this)) {
+        printf("PICSimLab: simulation context bound after use in the thread!\n");
+        return 0;
+    }
+    bound = this;
+    return 1;
+}
+
+int CSimContext::LoadWorkspace(lxString fname) {
+    char home[1280];
+    char line[1024];
+    char* name;
+    char* value;
+    int lab = BOARDS_LAST;
+
+    if (!lxFileExists(fname) || !fname.Contains(".pzw")) {
+        printf("PICSimLab: file %s is not a .pzw file!\n", (const char*)fname.c_str());
+        return 0;
+    }
+
+    snprintf(tmpdir, 1023, "%s/picsimlab-XXXXXX", (const char*)lxGetTempDir("PICSimLab").c_str());
+    close(mkstemp(tmpdir));
+    unlink(tmpdir);
+    lxCreateDir(tmpdir);
+
+    snprintf(home, 1279, "%s/", tmpdir);
+    lxUnzipDir(fname, home);
+    snprintf(home, 1279, "%s/picsimlab_workspace/", tmpdir);
+
+    // the board must be known before its creation, qemu, gpsim and ucsim keep process wide state
+    picsimlab.PrefsClear();
+    if (picsimlab.PrefsLoadFromFile(lxString(home) + "picsimlab.ini")) {
+        for (int lc = 0; lc < (int)picsimlab.PrefsGetLinesCount(); lc++) {
+            strncpy(line, picsimlab.PrefsGetLine(lc).c_str(), 1023);
+            line[1023] = 0;
+
+            name = strtok(line, "\t= ");
+            strtok(NULL, " ");
+            value = strtok(NULL, "\"");
+            if ((name == NULL) || (value == NULL) || strcmp(name, "picsimlab_lab"))
+                continue;
+            for (lab = 0; lab < BOARDS_LAST; lab++) {
+                if (!strcmp(boards_list[lab].name_, value)) {
+                    break;
+                }
+            }
+        }
+    }
+
+    if (lab == BOARDS_LAST) {
+        printf("PICSimLab: %s has no valid board!\n", (const char*)fname.c_str());
+        return 0;
+    }
+
+    if (!boards_list[lab].reentrant) {
+        printf("PICSimLab: %s board %s can't run in a worker context!\n", (const char*)fname.c_str(),
+               boards_list[lab].name);
+        return 0;
+    }
+
+    CSimContext* def = GetDefault();
+    picsimlab.SetSharePath(def->picsimlab.GetSharePath());
+    picsimlab.SetLibPath(def->picsimlab.GetLibPath());
+    picsimlab.SetHomePath(home);
+    picsimlab.SetPath(home);
+
+    picsimlab.Configure(home, 0, 0, NULL, 1);
+
+    if (!picsimlab.GetBoard()) {
+        return 0;
+    }
+    // no window to show the oscilloscope
+    picsimlab.GetBoard()->SetUseOscilloscope(0);
+    return 1;
+}
+
+void CSimContext::Run(const double seconds) {
+    board* pboard = picsimlab.GetBoard();
+
+    while ((picsimlab.GetSimTime() < seconds) && picsimlab.EnterCPU()) {
+        pboard->Run_CPU();
+        picsimlab.LeaveCPU();
+        picsimlab.IncSimRuns();
+    }
+}
+
+void CSimContext::End(void) {
+    if (picsimlab.GetBoard()) {
+        spareparts.DeleteParts();
+        picsimlab.GetBoard()->MEnd();
+        picsimlab.DeleteBoard();
+    }
+    if (tmpdir[0]) {
+        lxRemoveDir(tmpdir);
+        tmpdir[0] = 0;
+    }
+}
+
+CSimBatch::CSimBatch() {
+    Seconds = 0;
+#ifndef _NOTHREAD
+    next = 0;
+    running = 0;
+    errors = 0;
+#endif
+}
+
+CSimBatch::~CSimBatch() {
+#ifndef _NOTHREAD
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+#endif
+}
+
+int CSimBatch::Start(lxStringList list, const double seconds, const int jobs) {
+#ifndef _NOTHREAD
+    int n = jobs;
+
+    if (n > (int)list.GetLinesCount())
+        n = list.GetLinesCount();
+    if (n > SIMBATCH_MAX_JOBS)
+        n = SIMBATCH_MAX_JOBS;
+    if (n < 1)
+        return 0;
+
+    List = list;
+    Seconds = seconds;
+    next = 0;
+    errors = 0;
+    running = n;
+    for (int i = 0; i < n; i++) {
+        workers.push_back(std::thread(&CSimBatch::Worker, this));
+    }
+    return 1;
+#else
+    printf("PICSimLab: parallel batch needs a build with threads!\n");
+    return 0;
+#endif
+}
+
+int CSimBatch::GetDone(void) {
+#ifndef _NOTHREAD
+    if (running) {
+        return 0;
+    }
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    workers.clear();
+#endif
+    return 1;
+}
+
+int CSimBatch::GetErrors(void) {
+#ifndef _NOTHREAD
+    return errors;
+#else
+    return 0;
+#endif
+}
+
+#ifndef _NOTHREAD
+
+void CSimBatch::Worker(void) {
+    // the thread local references are bound once, the context is reused for each workspace
+    CSimContext context;
+    int i;
+
+    if (context.Bind()) {
+        while ((i = next++) < (int)List.GetLinesCount()) {
+            if (context.LoadWorkspace(List.GetLine(i))) {
+                context.Run(Seconds);
+                printf("PICSimLab: Batch %i/%i %s done, %.2fs simulated\n", i + 1, (int)List.GetLinesCount(),
+                       (const char*)List.GetLine(i).c_str(), context.picsimlab.GetSimTime());
+                fflush(stdout);
+            } else {
+                errors++;
+            }
+            context.End();
+        }
+    } else {
+        errors++;
+    }
+    running--;
+}
+
+#endif
@@ -0,0 +1,142 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef SIMCONTEXT_H
+#define SIMCONTEXT_H
+
+#include "board.h"
+#include "logicrec.h"
+#include "oscilloscope.h"
+#include "picsimlab.h"
+#include "profiler.h"
+#include "protodecoder.h"
+#include "spareparts.h"
+
+#ifndef _NOTHREAD
+#include <atomic>
+#include <thread>
+#include <vector>
+#endif
+
+#define SIMBATCH_MAX_JOBS 64
+
+/**
+ * @brief Simulation context
+ *
+ * Owns the state of one simulation (board, spare parts, oscilloscope,
+ * profiler, logic recorder, protocol decoders and the ioupdated flag).
+ * The global names PICSimLab, SpareParts, Oscilloscope, Profiler,
+ * LogicRecorder, ProtoDecoder and ioupdated are thread local references to
+ * the context bound to the calling thread. Threads that don't call Bind
+ * (the window, CPU, remote control and qemu threads) use the default
+ * context. A context without window runs headless in one worker thread.
+ */
+class CSimContext {
+public:
+    CSimContext();
+    ~CSimContext();
+
+    /**
+     * @brief Bind the context to the calling thread, must be called before any use of the global names
+     */
+    int Bind(void);
+
+    /**
+     * @brief Return the default context (window context)
+     */
+    static CSimContext* GetDefault(void);
+
+    /**
+     * @brief Load a .pzw workspace in a headless context, return 1 on success
+     *
+     * Must be called from the thread bound to the context. Only boards with
+     * reentrant simulator backends (picsim and simavr) are accepted.
+     */
+    int LoadWorkspace(lxString fname);
+
+    /**
+     * @brief Run the loaded workspace until seconds of simulated time
+     */
+    void Run(const double seconds);
+
+    /**
+     * @brief Free the board and parts of the loaded workspace
+     */
+    void End(void);
+
+    CPICSimLab picsimlab;
+    CSpareParts spareparts;
+    COscilloscope oscilloscope;
+    CProfiler profiler;
+    CLogicRecorder logicrecorder;
+    CProtoDecoder protodecoder;
+    int ioupdated;
+
+private:
+    char tmpdir[1024];
+};
+
+/**
+ * @brief Run a list of workspaces in headless contexts on worker threads
+ *
+ * Each worker thread binds its own CSimContext and takes the next workspace
+ * of the list until the list ends. The window context is not used.
+ */
+class CSimBatch {
+public:
+    CSimBatch();
+    ~CSimBatch();
+
+    /**
+     * @brief Start jobs worker threads running each workspace for seconds of simulated time
+     *
+     * Return 0 if the workers can't be started (builds without threads).
+     */
+    int Start(lxStringList list, const double seconds, const int jobs);
+
+    /**
+     * @brief Return 1 if all workspaces are done (the workers are joined)
+     */
+    int GetDone(void);
+
+    /**
+     * @brief Return the number of workspaces that failed to load
+     */
+    int GetErrors(void);
+
+private:
+    lxStringList List;
+    double Seconds;
+#ifndef _NOTHREAD
+    std::vector<std::thread> workers;
+    std::atomic<int> next;
+    std::atomic<int> running;
+    std::atomic<int> errors;
+
+    void Worker(void);
+#endif
+};
+
+#endif /* SIMCONTEXT_H */
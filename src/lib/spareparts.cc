@@ -28,14 +28,25 @@
 #include "spareparts.h"
 #include "oscilloscope.h"
 #include "picsimlab.h"
-
-// Global objects;
-CSpareParts SpareParts;
+#include "profiler.h"
 
 CSpareParts::CSpareParts() {
     pboard = NULL;
     partsc = 0;
     partsc_aup = 0;
+    parts_max = 0;
+    parts = NULL;
+    parts_aup = NULL;
+    parts_draw = NULL;
+    parts_pins = NULL;
+    parts_disp = NULL;
+    index_valid = 0;
+    index_parts = NULL;
+    index_max = 0;
+    pins_scan = 0;
+    memset(pullup_mask, 0, sizeof(pullup_mask));
+    memset(pullup_low, 0, sizeof(pullup_low));
+    pullup_any = 0;
     useAlias = 0;
     alias_fname = "";
     scale = 1.0;
@@ -58,6 +69,7 @@ void CSpareParts::Init(CWindow* win) {
 }
 
 void CSpareParts::UpdateAll(const int force) {
+    index_valid = 0;
     for (int i = 0; i < partsc; i++) {
         parts[i]->SetUpdate(1);
 #if defined(_LX_SDL2) || defined(__EMSCRIPTEN__)
@@ -73,8 +85,51 @@ part* CSpareParts::GetPart(const int partn) {
     return NULL;
 }
 
+void CSpareParts::Grow(const int count) {
+    if (count <= parts_max)
+        return;
+
+    int max = parts_max ? parts_max * 2 : 32;
+    while (max < count)
+        max *= 2;
+
+    part** parts_ = new part*[max];
+    part** parts_aup_ = new part*[max];
+    part** parts_draw_ = new part*[max];
+    uint64_t(*parts_pins_)[PP_WORDS] = new uint64_t[max][PP_WORDS];
+    unsigned char* parts_disp_ = new unsigned char[max];
+
+    // the CPU thread can be processing the parts, stop it before free the old arrays
+    const int run = PICSimLab.PauseSimulation();
+
+    if (parts_max) {
+        memcpy(parts_, parts, parts_max * sizeof(part*));
+        memcpy(parts_aup_, parts_aup, parts_max * sizeof(part*));
+        memcpy(parts_pins_, parts_pins, parts_max * sizeof(parts_pins[0]));
+        memcpy(parts_disp_, parts_disp, parts_max);
+    }
+    memset(parts_disp_ + parts_max, SPD_IOUPDATE, max - parts_max);
+
+    delete[] parts;
+    delete[] parts_aup;
+    delete[] parts_draw;
+    delete[] parts_pins;
+    delete[] parts_disp;
+
+    parts = parts_;
+    parts_aup = parts_aup_;
+    parts_draw = parts_draw_;
+    parts_pins = parts_pins_;
+    parts_disp = parts_disp_;
+    parts_max = max;
+    Profiler.SetPartCount(max);
+
+    PICSimLab.SetSimulationRun(run);
+}
+
 part* CSpareParts::AddPart(const char* partname, const int x, const int y, const float scale, board* pboard_) {
     part* newpart = create_part(partname, x, y, pboard_);
+    Grow(partsc + 1);
     parts[partsc] = newpart;
     if (parts[partsc] == NULL) {
         Message_sz(lxT("Erro creating part: ") + lxString(partname), 400, 200);
@@ -82,19 +137,118 @@ part* CSpareParts::AddPart(const char* partname, const int x, const int y, const
         parts[partsc]->SetId(partsc);
         parts[partsc]->SetScale(scale);
         parts[partsc]->Reset();
+        parts_disp[partsc] = SPD_IOUPDATE;  // process every io update until next PreProcess
         partsc++;
+        index_valid = 0;
     }
 
     return newpart;
 }
 
+int CSpareParts::GetPartAt(const int x, const int y) {
+    if (!index_valid) {
+        BuildIndex();
+    }
+
+    // entries of each bucket are in parts order, first match is the first part in point
+    const int b = IndexBucket(x >> SPARE_GRID_SHIFT, y >> SPARE_GRID_SHIFT);
+    for (int i = index_bucket[b]; i < index_bucket[b + 1]; i++) {
+        const int partn = index_parts[i];
+        if ((partn < partsc) && parts[partn]->PointInside(x, y)) {
+            return partn;
+        }
+    }
+    return -1;
+}
+
+// grid cells covered by part rectangle
+static void spareparts_part_cells(part* p, int* cx1, int* cy1, int* cx2, int* cy2) {
+    int w = p->GetWidth();
+    int h = p->GetHeight();
+    if (p->GetOrientation() & 1) {
+        w = p->GetHeight();
+        h = p->GetWidth();
+    }
+    *cx1 = p->GetX() >> SPARE_GRID_SHIFT;
+    *cy1 = p->GetY() >> SPARE_GRID_SHIFT;
+    *cx2 = (p->GetX() + w) >> SPARE_GRID_SHIFT;
+    *cy2 = (p->GetY() + h) >> SPARE_GRID_SHIFT;
+}
+
+void CSpareParts::BuildIndex(void) {
+    int cx1, cy1, cx2, cy2;
+
+    // count entries of each bucket
+    memset(index_bucket, 0, sizeof(index_bucket));
+    for (int i = 0; i < partsc; i++) {
+        spareparts_part_cells(parts[i], &cx1, &cy1, &cx2, &cy2);
+        for (int cy = cy1; cy <= cy2; cy++) {
+            for (int cx = cx1; cx <= cx2; cx++) {
+                index_bucket[IndexBucket(cx, cy) + 1]++;
+            }
+        }
+    }
+
+    for (int b = 0; b < SPARE_GRID_BUCKETS; b++) {
+        index_bucket[b + 1] += index_bucket[b];
+    }
+
+    const int count = index_bucket[SPARE_GRID_BUCKETS];
+    if (count > index_max) {
+        delete[] index_parts;
+        index_max = count * 2;
+        index_parts = new int[index_max];
+    }
+
+    // fill buckets in parts order
+    int fill[SPARE_GRID_BUCKETS];
+    memcpy(fill, index_bucket, sizeof(fill));
+    for (int i = 0; i < partsc; i++) {
+        spareparts_part_cells(parts[i], &cx1, &cy1, &cx2, &cy2);
+        for (int cy = cy1; cy <= cy2; cy++) {
+            for (int cx = cx1; cx <= cx2; cx++) {
+                const int b = IndexBucket(cx, cy);
+                // a part can cover two cells of same bucket
+                if ((fill[b] == index_bucket[b]) || (index_parts[fill[b] - 1] != i)) {
+                    index_parts[fill[b]++] = i;
+                }
+            }
+        }
+    }
+
+    // close the gaps left by repeated cells
+    int n = 0;
+    for (int b = 0; b < SPARE_GRID_BUCKETS; b++) {
+        const int start = index_bucket[b];
+        index_bucket[b] = n;
+        for (int i = start; i < fill[b]; i++) {
+            index_parts[n++] = index_parts[i];
+        }
+    }
+    index_bucket[SPARE_GRID_BUCKETS] = n;
+
+    index_valid = 1;
+}
+
+part** CSpareParts::GetDrawPending(int* count) {
+    *count = 0;
+    for (int i = 0; i < partsc; i++) {
+        if (parts[i]->GetDrawPending()) {
+            parts_draw[(*count)++] = parts[i];
+        }
+    }
+    return parts_draw;
+}
+
 void CSpareParts::DeleteParts(void) {
     int partsc_ = partsc;
     partsc = 0;  // for disable process
     partsc_aup = 0;
     useAlias = 0;
+    index_valid = 0;
 
     for (int i = 0; i < partsc_; i++) {
+        Unschedule(parts[i]);
         delete parts[i];
     }
 }
@@ -107,23 +261,34 @@ void CSpareParts::ClearPinAlias(void) {
 
 void CSpareParts::ResetPullupBus(unsigned char pin) {
     if (pin < IOINIT) {
-        pullup_bus[pin]++;  // count i2c devices in bus
+        if (pin < PinsCount) {
+            pullup_mask[pin >> 6] |= 1ull << (pin & 0x3F);  // register bus
+        }
     }
 }
 
 void CSpareParts::SetPullupBus(unsigned char pin, unsigned char value) {
-    if (pin < IOINIT) {
-        pullup_bus[pin] &= value;
+    if ((pin < IOINIT) && !value) {
+        pullup_low[pin >> 6] |= 1ull << (pin & 0x3F);  // wired AND
     }
 }
 
 unsigned char CSpareParts::GetPullupBus(unsigned char pin) {
     if (pin < IOINIT)
-        return pullup_bus[pin];
+        return ((pullup_mask[pin >> 6] & ~pullup_low[pin >> 6]) >> (pin & 0x3F)) & 1;
     else
         return 0;
 }
 
+void CSpareParts::ResolvePullupBus(void) {
+    for (int w = 0; w < PP_WORDS; w++) {
+        for (uint64_t m = pullup_mask[w]; m; m &= m - 1) {
+            const int b = pp_ctz(m);
+            SetPin((w << 6) + b + 1, !((pullup_low[w] >> b) & 1));
+        }
+    }
+}
+
 lxString CSpareParts::GetPinsNames(void) {
     lxString Items = "0  NC,";
     lxString spin;
@@ -188,6 +353,7 @@ void CSpareParts::SetPin(unsigned char pin, unsigned char value) {
             } else {
                 pboard->MSetPin(pin, value);
             }
+            MarkPin(pin);
         }
     }
 }
@@ -209,6 +375,7 @@ void CSpareParts::SetPinDir(unsigned char pin, unsigned char dir) {
         if (Pins[pin - 1].dir != dir) {
             if ((pin > PinsCount)) {
                 Pins[pin - 1].dir = dir;
+                MarkPin(pin);
             }
         }
     }
@@ -217,7 +384,10 @@ void CSpareParts::SetPinDir(unsigned char pin, unsigned char dir) {
 void CSpareParts::WritePin(unsigned char pin, unsigned char value) {
     if (pin > PinsCount) {
         Pins[pin - 1].lsvalue = value;  // for open collector simulation
-        Pins[pin - 1].value = value;
+        if (Pins[pin - 1].value != value) {
+            Pins[pin - 1].value = value;
+            MarkPin(pin);
+        }
     }
 }
 
@@ -392,6 +562,9 @@ bool CSpareParts::LoadConfig(lxString fname, const int disable_debug) {
         partsc_ = 0;
         partsc_aup_ = 0;
 
+        // one grow for the whole file, each line holds at most one part
+        Grow(prefs.GetLinesCount());
+
         if (prefs.GetLine(0).Contains("version")) {
             newformat = 1;
         }
@@ -491,21 +664,23 @@ bool CSpareParts::LoadConfig(lxString fname, const int disable_debug) {
             } else if (!strcmp(name, "osc_ch2")) {
                 osc_list.AddLine(prefs.GetLine(i));
                 Oscilloscope.ReadPreferencesList(osc_list);
-            } else if ((parts[partsc_] = create_part(name, x, y, PICSimLab.GetBoard()))) {
-                printf("Spare parts: parts[%02i] (%s) created \n", partsc_, name);
-                parts[partsc_]->ReadPreferences(temp);
-                parts[partsc_]->SetId(partsc_);
-                if (newformat) {
-                    parts[partsc_]->SetOrientation(orient);
-                    parts[partsc_]->SetScale(scale);
-                    parts[partsc_]->SetUpdate(1);
-                }
-                partsc_++;
             } else {
-                printf("Spare parts: Error loading part: %s \n", name);
-                lxString temp;
-                temp.Printf("Spare parts:\nError loading part: %s \n", name);
-                PICSimLab.RegisterError(temp);
+                if ((parts[partsc_] = create_part(name, x, y, PICSimLab.GetBoard()))) {
+                    printf("Spare parts: parts[%02i] (%s) created \n", partsc_, name);
+                    parts[partsc_]->ReadPreferences(temp);
+                    parts[partsc_]->SetId(partsc_);
+                    if (newformat) {
+                        parts[partsc_]->SetOrientation(orient);
+                        parts[partsc_]->SetScale(scale);
+                        parts[partsc_]->SetUpdate(1);
+                    }
+                    partsc_++;
+                } else {
+                    printf("Spare parts: Error loading part: %s \n", name);
+                    lxString temp;
+                    temp.Printf("Spare parts:\nError loading part: %s \n", name);
+                    PICSimLab.RegisterError(temp);
+                }
             }
         }
         partsc = partsc_;
@@ -520,6 +695,7 @@ void CSpareParts::DeletePart(const int partn) {
     partsc = 0;  // disable process
     partsc_aup = 0;
 
+    Unschedule(parts[partn]);
     delete parts[partn];
 
     for (int i = partn; i < partsc_ - 1; i++) {
@@ -527,55 +703,161 @@ void CSpareParts::DeletePart(const int partn) {
     }
     partsc_--;
 
+    memset(parts_disp, SPD_IOUPDATE, parts_max);  // dispatch lists are rebuilt in next PreProcess
+    index_valid = 0;
+
     partsc = partsc_;
 }
 
 void CSpareParts::PreProcess(void) {
     int i;
 
-    memset(pullup_bus, 0, PinsCount);
+    memset(pullup_mask, 0, sizeof(pullup_mask));
+    memset(pullup_low, 0, sizeof(pullup_low));
+    pullup_any = 0;
+
+    const int prof = Profiler.GetEnabled();
 
     partsc_aup = 0;
     for (i = 0; i < partsc; i++) {
-        parts[i]->PreProcess();
-        if (parts[i]->GetAlwaysUpdate()) {
+        if (prof) {
+            const uint64_t t0 = CProfiler::Now();
+            parts[i]->PreProcess();
+            Profiler.AddPart(parts[i]->GetId(), PP_PREPROCESS, CProfiler::Now() - t0);
+        } else {
+            parts[i]->PreProcess();
+        }
+        Schedule(parts[i]);
+        if (parts[i]->GetAlwaysUpdate() && !parts[i]->GetSampleTimer()) {
             parts_aup[partsc_aup] = parts[i];
             partsc_aup++;
         }
     }
 
-    pullup_bus_count = 0;
-    for (i = 0; i < PinsCount; i++) {
-        if (pullup_bus[i] > 0)  // need register bus
-        {
-            pullup_bus_ptr[pullup_bus_count] = i;
-            pullup_bus_count++;
+    // build sensitivity lists, parts in pullup bus need be processed in every io update
+    pins_scan = 0;
+    for (i = 0; i < partsc; i++) {
+        memset(parts_pins[i], 0, sizeof(parts_pins[i]));
+        if (parts[i]->GetSampleTimer()) {
+            parts_disp[i] = SPD_SAMPLED;
+        } else if (parts[i]->GetPinSensitive() && !parts[i]->GetAlwaysUpdate() && parts[i]->GetPinCount()) {
+            parts_disp[i] = SPD_PINS;
+        } else {
+            parts_disp[i] = SPD_IOUPDATE;
+        }
+        AddPartPins(i, parts[i]->GetPins(), parts[i]->GetPinCount());
+        AddPartPins(i, parts[i]->GetPinsCtrl(), parts[i]->GetPinCtrlCount());
+    }
+    pins_planes.Invalidate();  // all parts are processed in first io update
+
+    for (i = 0; i < PP_WORDS; i++) {
+        pullup_any |= pullup_mask[i] != 0;
+    }
+}
+
+void CSpareParts::AddPartPins(const int partn, const unsigned char* pins, const int pinc) {
+    for (int i = 0; i < pinc; i++) {
+        const int pin = pins[i];
+        if (pin) {
+            parts_pins[partn][(pin - 1) >> 6] |= 1ull << ((pin - 1) & 0x3F);
+            if (pin > pins_scan) {
+                pins_scan = pin;
+            }
+            if (((pullup_mask[(pin - 1) >> 6] >> ((pin - 1) & 0x3F)) & 1) && (parts_disp[partn] == SPD_PINS)) {
+                parts_disp[partn] = SPD_IOUPDATE;
+            }
+        }
+    }
+}
+
+template <const int PROF>
+static inline void spareparts_process(part* p) {
+    if (PROF) {
+        const uint64_t t0 = CProfiler::Now();
+        p->Process();
+        Profiler.AddPart(p->GetId(), PP_PROCESS, CProfiler::Now() - t0);
+    } else {
+        p->Process();
+    }
+}
+
+static void spareparts_sample_callback(void* arg) {
+    if (Profiler.GetSample())
+        spareparts_process<1>((part*)arg);
+    else
+        spareparts_process<0>((part*)arg);
+}
+
+void CSpareParts::Schedule(part* p) {
+    const double period = p->GetSamplePeriod_us();
+    int timer = p->GetSampleTimer();
+
+    if (period <= 0) {
+        Unschedule(p);
+        return;
+    }
+
+    if (timer && (period == p->GetSampleTimerPeriod_us())) {
+        return;
+    }
+
+    if (!timer || (pboard->TimerChange_us(timer, period) < 0)) {
+        timer = pboard->TimerRegister_us(period, spareparts_sample_callback, p);
+        if (timer < 0) {
+            timer = 0;  // no free timers, part is processed every step
         }
-        pullup_bus[i] = 0;
+    }
+    p->SetSampleTimer(timer, period);
+}
+
+void CSpareParts::Unschedule(part* p) {
+    if (p->GetSampleTimer()) {
+        pboard->TimerUnregister(p->GetSampleTimer());
+        p->SetSampleTimer(0, 0);
     }
 }
 
-void CSpareParts::Process(void) {
+void CSpareParts::ScanPins(void) {
+    pins_planes.Capture(Pins, pins_scan);
+    memcpy(pins_changed, pins_planes.GetChanged(), sizeof(pins_changed));
+}
+
+template <const int PROF>
+void CSpareParts::ProcessParts(void) {
     int i;
 
     if (ioupdated) {
-        for (i = 0; i < pullup_bus_count; i++) {
-            pullup_bus[pullup_bus_ptr[i]] = 1;
+        ScanPins();
+        if (pullup_any) {
+            memset(pullup_low, 0, sizeof(pullup_low));  // buses are pulled up until a device drives low
         }
         for (i = 0; i < partsc; i++) {
-            parts[i]->Process();
+            if (PartDispatch(i))
+                spareparts_process<PROF>(parts[i]);
         }
-        for (i = 0; i < pullup_bus_count; i++) {
-            SetPin(pullup_bus_ptr[i] + 1, pullup_bus[pullup_bus_ptr[i]]);
+        if (pullup_any) {
+            ResolvePullupBus();
         }
     } else {
         for (i = 0; i < partsc_aup; i++) {
-            parts_aup[i]->Process();
+            spareparts_process<PROF>(parts_aup[i]);
         }
     }
 }
 
+template void CSpareParts::ProcessParts<0>(void);
+template void CSpareParts::ProcessParts<1>(void);
+
 void CSpareParts::PostProcess(void) {
+    if (Profiler.GetEnabled()) {
+        for (int i = 0; i < partsc; i++) {
+            const uint64_t t0 = CProfiler::Now();
+            parts[i]->PostProcess();
+            Profiler.AddPart(parts[i]->GetId(), PP_POSTPROCESS, CProfiler::Now() - t0);
+        }
+        return;
+    }
+
     for (int i = 0; i < partsc; i++) {
         parts[i]->PostProcess();
     }
@@ -27,9 +27,15 @@
 #define SPAREPARTS
 
 #include "../lib/part.h"
+#include "../lib/pinplanes.h"
 
 #define IOINIT 110
 
+#define SPARE_GRID_SHIFT 6       // spatial index cell size (64x64)
+#define SPARE_GRID_BUCKETS 1024  // spatial index hash buckets (power of 2)
+
+enum { SPD_IOUPDATE, SPD_PINS, SPD_SAMPLED };  // part Process dispatch
+
 class CSpareParts {
 public:
     CSpareParts();
@@ -38,7 +44,24 @@ public:
 
     void UpdateAll(const int force = 0);
     int GetCount(void) { return partsc; };
+    int GetAlwaysUpdateCount(void) { return partsc_aup; };
     part* GetPart(const int partn);
+
+    /**
+     * @brief  Return the number of the first part in workspace position x,y or -1 if none
+     */
+    int GetPartAt(const int x, const int y);
+
+    /**
+     * @brief  Rebuild the spatial index in next query, need be called when parts move, rotate or resize
+     */
+    void InvalidateIndex(void) { index_valid = 0; };
+
+    /**
+     * @brief  Return the list of parts with pending draw and its size in count
+     */
+    part** GetDrawPending(int* count);
+
     void DeleteParts(void);
     void ResetPullupBus(unsigned char pin);
     void SetPullupBus(unsigned char pin, unsigned char value);
@@ -47,7 +70,12 @@ public:
     /**
      * @brief  Execute the process code of spare parts N times (where N is the number of steps in 100ms)
      */
-    void Process(void);
+    void Process(void) { ProcessParts<0>(); };
+
+    /**
+     * @brief  Same as Process but timing each part in the profiler
+     */
+    void ProcessProfiled(void) { ProcessParts<1>(); };
 
     /**
      * @brief  Execute the pre process code of spare parts one time per 100ms
@@ -69,6 +97,13 @@ public:
      */
     lxString GetPinName(unsigned char pin);
 
+    /**
+     * @brief  Return 1 if pin is a board pin or an IO pin registered by a part
+     */
+    int GetPinUsed(unsigned char pin) {
+        return pin && (PinNames[pin].length() > 0) && PinNames[pin].Cmp(lxT("error"));
+    };
+
     const picpin* GetPinsValues(void);
     void SetPin(unsigned char pin, unsigned char value);
     void SetAPin(unsigned char pin, float value);
@@ -133,16 +168,89 @@ private:
     unsigned char PinsCount;
     unsigned char useAlias;
     int partsc;
-    part* parts[MAX_PARTS];
-    int partsc_aup;              // always update list
-    part* parts_aup[MAX_PARTS];  // always update list
-    unsigned char pullup_bus[IOINIT];
-    int pullup_bus_count;
-    unsigned char pullup_bus_ptr[IOINIT];
+    int parts_max;  // size of parts arrays
+    part** parts;
+    int partsc_aup;     // always update list
+    part** parts_aup;   // always update list
+    part** parts_draw;  // pending draw list
+    uint64_t pullup_mask[PP_WORDS];            // pins with pull-up bus (bit n is pin n+1)
+    uint64_t pullup_low[PP_WORDS];             // pull-up bus pins driven low in current io update
+    int pullup_any;                            // some pull-up bus is registered
+    uint64_t pins_changed[PP_WORDS];           // pins changed in current step (bit n is pin n+1)
+    CPinPlanes pins_planes;                    // pins state of last scan
+    int pins_scan;                             // number of pins scanned for changes
+    uint64_t (*parts_pins)[PP_WORDS];          // pins read by each part (bit n is pin n+1)
+    unsigned char* parts_disp;                 // part Process dispatch (SPD_*)
+    int index_valid;                           // spatial index is up to date
+    int index_bucket[SPARE_GRID_BUCKETS + 1];  // first entry of each bucket in index_parts
+    int* index_parts;                          // part numbers sorted by bucket
+    int index_max;                             // size of index_parts
     int fdtype;
     lxString oldfname;
+
+    /**
+     * @brief  Process the parts that need it in current step, timing each one if PROF (defined in spareparts.cc)
+     */
+    template <const int PROF>
+    void ProcessParts(void);
+
+    /**
+     * @brief  Grow the parts arrays to hold at least count parts
+     */
+    void Grow(const int count);
+
+    /**
+     * @brief  Build the spatial index of parts rectangles
+     */
+    void BuildIndex(void);
+
+    /**
+     * @brief  Return the spatial index bucket of grid cell cx,cy
+     */
+    static int IndexBucket(const int cx, const int cy) {
+        return (((unsigned)cx * 73856093u) ^ ((unsigned)cy * 19349663u)) & (SPARE_GRID_BUCKETS - 1);
+    };
+
+    /**
+     * @brief  Write the resolved level of all pull-up buses to its pins
+     */
+    void ResolvePullupBus(void);
+
+    /**
+     * @brief  Compare pins with last scan and fill the changed pins mask
+     */
+    void ScanPins(void);
+
+    /**
+     * @brief  Add pins to sensitivity list of part
+     */
+    void AddPartPins(const int partn, const unsigned char* pins, const int pinc);
+
+    /**
+     * @brief  Register or update the board timer that samples part Process
+     */
+    void Schedule(part* p);
+
+    /**
+     * @brief  Unregister the board timer that samples part Process
+     */
+    void Unschedule(part* p);
+
+    /**
+     * @brief  Return if part need be processed in current io update step
+     */
+    int PartDispatch(const int partn) {
+        if (parts_disp[partn] != SPD_PINS)
+            return parts_disp[partn] == SPD_IOUPDATE;
+        const uint64_t* pp = parts_pins[partn];
+        return ((pp[0] & pins_changed[0]) | (pp[1] & pins_changed[1]) | (pp[2] & pins_changed[2]) |
+                (pp[3] & pins_changed[3])) != 0;
+    };
+
+    void MarkPin(const unsigned char pin) { pins_changed[(pin - 1) >> 6] |= 1ull << ((pin - 1) & 0x3F); };
 };
 
-extern CSpareParts SpareParts;
+// Object of the simulation context bound to the calling thread (simcontext.h)
+extern thread_local CSpareParts& SpareParts;
 
 #endif  // SPAREPARTS
\ No newline at end of file
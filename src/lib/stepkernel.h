@@ -0,0 +1,147 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef STEPKERNEL_H
+#define STEPKERNEL_H
+
+#include "board.h"
+#include "logicrec.h"
+#include "oscilloscope.h"
+#include "profiler.h"
+#include "protodecoder.h"
+#include "spareparts.h"
+
+template <class B>
+void board::RunSteps(B* b, const picpin* pins, const int pinc, const long int nstep, const int jumpsteps) {
+    const int prof = Profiler.GetEnabled();
+    const uint64_t start = prof ? CProfiler::Now() : 0;
+
+    PinActivity.Start(pins, pinc, GetInstCounter());
+
+    if (use_oscope) {
+        if (use_spare)
+            RunStepsT<B, 1, 1>(b, nstep, jumpsteps);
+        else
+            RunStepsT<B, 1, 0>(b, nstep, jumpsteps);
+    } else {
+        if (use_spare)
+            RunStepsT<B, 0, 1>(b, nstep, jumpsteps);
+        else
+            RunStepsT<B, 0, 0>(b, nstep, jumpsteps);
+    }
+
+    PinActivity.End(GetInstCounter());
+
+    if (prof)
+        Profiler.AddRun(nstep, CProfiler::Now() - start);
+}
+
+template <class B, const int OSCOPE, const int SPARE>
+void board::RunStepsT(B* b, const long int nstep, const int jumpsteps) {
+    // simulation context objects are thread local, resolve them once per run
+    CSpareParts& spare = SpareParts;
+    COscilloscope& oscope = Oscilloscope;
+    CProfiler& profiler = Profiler;
+    CLogicRecorder& recorder = LogicRecorder;
+    CProtoDecoder& decoder = ProtoDecoder;
+    const int& ioupd = ioupdated;
+    // fast-forward is possible only if no part need be updated every step
+    const int ffwd = !SPARE || !spare.GetAlwaysUpdateCount();
+    const int prof = profiler.GetEnabled();
+    const int lrec = recorder.Enter(TimerQueue.GetNow());
+    const int pdec = decoder.Enter(TimerQueue.GetNow());
+    long qsteps = 0;  // quiescent steps waiting for oscilloscope catch up
+    int j = jumpsteps;  // step counter
+
+    for (long int i = 0; i < nstep; i++) {
+        const int jump = (j >= jumpsteps);  // if number of step is bigger than steps to skip
+
+        if (prof)
+            profiler.Mark(!(i & PROFILER_SAMPLE_MASK));
+
+        b->B::StepPre(jump);
+        b->B::StepCore();
+        profiler.Lap(PS_STEP);
+        const int tdisp = InstCounterInc();
+        profiler.Lap(PS_TIMERS);
+        b->B::StepHardware();
+        profiler.Lap(PS_HARDWARE);
+
+        if (ffwd && !ioupd && !tdisp && !jump && b->B::StepQuiet()) {
+            qsteps++;  // quiescent step, nothing to process
+        } else {
+            if (ioupd) {
+                PinActivity.Scan(GetInstCounter());  // record pins edges
+                profiler.Lap(PS_PINS);
+            }
+            if (OSCOPE) {
+                if (qsteps) {
+                    oscope.SetSamples(qsteps);
+                    qsteps = 0;
+                }
+                oscope.SetSample();
+                profiler.Lap(PS_OSCOPE);
+            }
+            if (SPARE) {
+                if (profiler.GetSample())
+                    spare.ProcessProfiled();
+                else
+                    spare.Process();
+                profiler.Lap(PS_SPARE);
+            }
+            if (lrec | pdec) {
+                if (lrec)
+                    recorder.Scan(TimerQueue.GetNow());  // record board and parts pins changes
+                if (pdec)
+                    decoder.Scan(TimerQueue.GetNow());  // send decoders pins changes
+                profiler.Lap(PS_PINS);
+            }
+        }
+
+        b->B::StepPost(jump);
+
+        if (jump)
+            j = -1;  // reset counter
+        j++;         // counter increment
+
+        b->B::StepEnd();
+        profiler.Lap(PS_BOARD);
+    }
+
+    if (prof)
+        profiler.Mark(0);
+
+    if (OSCOPE && qsteps) {
+        oscope.SetSamples(qsteps - 1);
+        oscope.SetSample();
+    }
+
+    if (lrec)
+        recorder.Leave();
+    if (pdec)
+        decoder.Leave(TimerQueue.GetNow());
+}
+
+#endif /* STEPKERNEL_H */
@@ -0,0 +1,204 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "timerqueue.h"
+
+#include <stddef.h>
+
+#define NO_DEADLINE UINT64_MAX
+
+CTimerQueue::CTimerQueue() {
+    Clear();
+}
+
+void CTimerQueue::Clear(void) {
+    Now = 0;
+    NextDeadline = NO_DEADLINE;
+    Seq = 0;
+    TimersCount = 0;
+    HeapCount = 0;
+    for (int i = 0; i < MAX_TIMERS; i++) {
+        Timers[i].Arg = NULL;
+        Timers[i].Callback = NULL;
+        Timers[i].Enabled = 0;
+        Timers[i].Reload = 1;
+        Timers[i].Deadline = NO_DEADLINE;
+        Timers[i].Tout = 0;
+        Timers[i].Seq = 0;
+        Timers[i].HeapPos = -1;
+        Heap[i] = NULL;
+    }
+}
+
+int CTimerQueue::Register(const uint32_t reload, const double tout, void (*Callback)(void* arg), void* arg) {
+    if (TimersCount < MAX_TIMERS) {
+        int timern = 0;
+        for (int i = 0; i < MAX_TIMERS; i++) {
+            if (Timers[i].Callback == NULL) {
+                timern = i + 1;
+                break;
+            }
+        }
+        Timers_t* t = &Timers[timern - 1];
+        t->Callback = Callback;
+        t->Arg = arg;
+        t->Seq = Seq++;
+        t->Enabled = 1;
+        TimersCount++;
+        Change(timern, reload, tout);
+        return timern;
+    }
+    return -1;
+}
+
+int CTimerQueue::Unregister(const int timer) {
+    Timers_t* t = Get(timer);
+    if (t) {
+        Disarm(t);
+        t->Callback = NULL;  // free timer
+        t->Arg = NULL;
+        t->Enabled = 0;
+        TimersCount--;
+        return 0;
+    }
+    return -1;
+}
+
+int CTimerQueue::Change(const int timer, const uint32_t reload, const double tout) {
+    Timers_t* t = Get(timer);
+    if (t) {
+        t->Reload = reload ? reload : 1;
+        t->Tout = tout;
+        if (t->Enabled) {
+            Arm(t);
+        }
+        return 0;
+    }
+    return -1;
+}
+
+int CTimerQueue::SetState(const int timer, const int enabled) {
+    Timers_t* t = Get(timer);
+    if (t) {
+        t->Enabled = enabled;
+        if (enabled) {
+            Arm(t);
+        } else {
+            Disarm(t);
+        }
+        return 0;
+    }
+    return -1;
+}
+
+Timers_t* CTimerQueue::Get(const int timer) {
+    if ((timer > 0) && (timer <= MAX_TIMERS) && (Timers[timer - 1].Callback != NULL)) {
+        return &Timers[timer - 1];
+    }
+    return NULL;
+}
+
+void CTimerQueue::Dispatch(void) {
+    while (HeapCount && (Heap[0]->Deadline <= Now)) {
+        Timers_t* t = Heap[0];
+        // rearm before the callback, it can change or disable the timer
+        t->Deadline = Now + t->Reload;
+        SiftDown(0);
+        NextDeadline = Heap[0]->Deadline;
+        (*t->Callback)(t->Arg);
+    }
+    NextDeadline = HeapCount ? Heap[0]->Deadline : NO_DEADLINE;
+}
+
+void CTimerQueue::Arm(Timers_t* t) {
+    t->Deadline = Now + t->Reload;
+    if (t->HeapPos < 0) {
+        t->HeapPos = HeapCount;
+        Heap[HeapCount++] = t;
+        SiftUp(t->HeapPos);
+    } else {
+        SiftUp(t->HeapPos);
+        SiftDown(t->HeapPos);
+    }
+    NextDeadline = Heap[0]->Deadline;
+}
+
+void CTimerQueue::Disarm(Timers_t* t) {
+    int pos = t->HeapPos;
+    if (pos < 0)
+        return;
+
+    t->HeapPos = -1;
+    t->Deadline = NO_DEADLINE;
+    HeapCount--;
+    if (pos != HeapCount) {
+        Timers_t* last = Heap[HeapCount];
+        Heap[pos] = last;
+        last->HeapPos = pos;
+        SiftUp(pos);
+        SiftDown(last->HeapPos);
+    }
+    Heap[HeapCount] = NULL;
+    NextDeadline = HeapCount ? Heap[0]->Deadline : NO_DEADLINE;
+}
+
+int CTimerQueue::Before(const Timers_t* a, const Timers_t* b) {
+    if (a->Deadline != b->Deadline) {
+        return a->Deadline < b->Deadline;
+    }
+    return a->Seq < b->Seq;
+}
+
+void CTimerQueue::SiftUp(int pos) {
+    Timers_t* t = Heap[pos];
+    while (pos > 0) {
+        int parent = (pos - 1) >> 1;
+        if (!Before(t, Heap[parent]))
+            break;
+        Heap[pos] = Heap[parent];
+        Heap[pos]->HeapPos = pos;
+        pos = parent;
+    }
+    Heap[pos] = t;
+    t->HeapPos = pos;
+}
+
+void CTimerQueue::SiftDown(int pos) {
+    Timers_t* t = Heap[pos];
+    while (1) {
+        int child = (pos << 1) + 1;
+        if (child >= HeapCount)
+            break;
+        if (((child + 1) < HeapCount) && Before(Heap[child + 1], Heap[child]))
+            child++;
+        if (!Before(Heap[child], t))
+            break;
+        Heap[pos] = Heap[child];
+        Heap[pos]->HeapPos = pos;
+        pos = child;
+    }
+    Heap[pos] = t;
+    t->HeapPos = pos;
+}
@@ -0,0 +1,136 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef TIMERQUEUE_H
+#define TIMERQUEUE_H
+
+#include <stdint.h>
+
+#define MAX_TIMERS 256
+
+/**
+ * @brief internal timer struct
+ *
+ */
+typedef struct {
+    uint64_t Deadline;  ///< absolute expiry in instructions
+    uint32_t Reload;    ///< period in instructions
+    void* Arg;
+    void (*Callback)(void* arg);
+    int Enabled;
+    double Tout;   ///< period in us
+    uint32_t Seq;  ///< registration order, used to break deadline ties
+    int HeapPos;   ///< position in deadline heap (-1 if not queued)
+} Timers_t;
+
+/**
+ * @brief Deadline ordered timer queue
+ *
+ * Enabled timers are kept in a binary min-heap ordered by their absolute
+ * expiry instruction count, so each instruction costs one compare against
+ * the nearest deadline no matter how many timers are registered.
+ */
+class CTimerQueue {
+public:
+    CTimerQueue();
+
+    /**
+     * @brief Register a new timer with period in instructions (default enabled)
+     */
+    int Register(const uint32_t reload, const double tout, void (*Callback)(void* arg), void* arg);
+
+    /**
+     * @brief Unregister timer
+     */
+    int Unregister(const int timer);
+
+    /**
+     * @brief Modify timer period and restart it
+     */
+    int Change(const int timer, const uint32_t reload, const double tout);
+
+    /**
+     * @brief Enable or disable timer
+     */
+    int SetState(const int timer, const int enabled);
+
+    /**
+     * @brief Return timer struct or NULL if timer is invalid
+     */
+    Timers_t* Get(const int timer);
+
+    /**
+     * @brief Return the number of registered timers
+     */
+    int GetCount(void) { return TimersCount; };
+
+    /**
+     * @brief Increment the instruction counter and dispatch expired timers, return 1 if any timer was dispatched
+     */
+    int Step(void) {
+        if (++Now >= NextDeadline) {
+            Dispatch();
+            return 1;
+        }
+        return 0;
+    };
+
+    /**
+     * @brief Return the instruction counter
+     */
+    uint64_t GetNow(void) { return Now; };
+
+    /**
+     * @brief Return the instruction count of the nearest enabled timer expiry
+     */
+    uint64_t GetNextDeadline(void) { return NextDeadline; };
+
+    /**
+     * @brief Reset instruction counter and remove all timers
+     */
+    void Clear(void);
+
+private:
+    uint64_t Now;
+    uint64_t NextDeadline;
+    uint32_t Seq;
+    int TimersCount;
+    int HeapCount;
+    Timers_t Timers[MAX_TIMERS];
+    Timers_t* Heap[MAX_TIMERS];
+
+    /**
+     * @brief Call the callbacks of all expired timers
+     */
+    void Dispatch(void);
+
+    void Arm(Timers_t* t);
+    void Disarm(Timers_t* t);
+    int Before(const Timers_t* a, const Timers_t* b);
+    void SiftUp(int pos);
+    void SiftDown(int pos);
+};
+
+#endif /* TIMERQUEUE_H */
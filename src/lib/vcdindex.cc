@@ -0,0 +1,452 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "vcdindex.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifndef _WIN_
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
+
+#define VCDI_BUFF 4096          // events written at once while building
+#define VCDI_READ_SIZE 65536    // bytes of VCD text read at once
+
+// parser states
+enum { VP_DEFS, VP_SKIP, VP_TIMESCALE, VP_VAR, VP_DATA, VP_DATA_SKIP };
+
+CVCDIndex::CVCDIndex() {
+    header = NULL;
+    events = NULL;
+    count = 0;
+    map = NULL;
+    map_size = 0;
+    mem = NULL;
+#ifdef _WIN_
+    hfile = NULL;
+    hmap = NULL;
+#endif
+}
+
+CVCDIndex::~CVCDIndex() {
+    Close();
+}
+
+void CVCDIndex::Close(void) {
+    if (map) {
+#ifndef _WIN_
+        munmap(map, map_size);
+#else
+        UnmapViewOfFile(map);
+        CloseHandle(hmap);
+        CloseHandle(hfile);
+        hmap = NULL;
+        hfile = NULL;
+#endif
+        map = NULL;
+        map_size = 0;
+    }
+    if (mem) {
+        free(mem);
+        mem = NULL;
+    }
+    header = NULL;
+    events = NULL;
+    count = 0;
+}
+
+int CVCDIndex::Open(const char* fname) {
+    struct stat st;
+    char iname[1100];
+
+    Close();
+
+    if (stat(fname, &st)) {
+        printf("PICSimLab: Error open file %s\n", fname);
+        return -1;
+    }
+    const uint64_t size = st.st_size;
+    const uint64_t time = st.st_mtime;
+
+    snprintf(iname, sizeof(iname), "%s.psi", fname);
+    if (!Map(iname, size, time)) {
+        return 0;
+    }
+
+    FILE* out = fopen(iname, "wb");
+    if (out) {
+        int ret = Build(fname, out, size, time);
+        fclose(out);
+        if (!ret) {
+            ret = Map(iname, size, time);
+        }
+        if (ret) {
+            remove(iname);
+        }
+        return ret;
+    }
+
+    // can't write the sidecar (read only directory), keep the index in memory
+    out = tmpfile();
+    if (!out) {
+        printf("PICSimLab: Error creating file %s\n", iname);
+        return -1;
+    }
+    int ret = Build(fname, out, size, time);
+    if (!ret) {
+        rewind(out);
+        ret = Read(out, size, time);
+    }
+    fclose(out);
+    return ret;
+}
+
+int CVCDIndex::Check(const void* buff, const uint64_t len, const uint64_t size, const uint64_t time) {
+    const vcdi_header_t* h = (const vcdi_header_t*)buff;
+
+    if ((len < sizeof(vcdi_header_t)) || memcmp(h->magic, VCDI_MAGIC, 8) || (h->version != VCDI_VERSION) ||
+        (h->source_size != size) || (h->source_time != time) ||
+        ((len - sizeof(vcdi_header_t)) / sizeof(uint64_t) < h->count)) {
+        return -1;
+    }
+    header = h;
+    events = (const uint64_t*)(h + 1);
+    count = h->count;
+    return 0;
+}
+
+int CVCDIndex::Map(const char* iname, const uint64_t size, const uint64_t time) {
+#ifndef _WIN_
+    struct stat st;
+    const int fd = open(iname, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    if (fstat(fd, &st) || (st.st_size < (off_t)sizeof(vcdi_header_t))) {
+        close(fd);
+        return -1;
+    }
+    void* p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p != MAP_FAILED) {
+        map = p;
+        map_size = st.st_size;
+    }
+#else
+    LARGE_INTEGER fsize;
+    hfile = CreateFileA(iname, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hfile == INVALID_HANDLE_VALUE) {
+        hfile = NULL;
+        return -1;
+    }
+    if (!GetFileSizeEx(hfile, &fsize) || (fsize.QuadPart < (LONGLONG)sizeof(vcdi_header_t))) {
+        CloseHandle(hfile);
+        hfile = NULL;
+        return -1;
+    }
+    hmap = CreateFileMappingA(hfile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (hmap) {
+        map = MapViewOfFile(hmap, FILE_MAP_READ, 0, 0, 0);
+        if (map) {
+            map_size = fsize.QuadPart;
+        } else {
+            CloseHandle(hmap);
+            hmap = NULL;
+        }
+    }
+    if (!map) {
+        CloseHandle(hfile);
+        hfile = NULL;
+    }
+#endif
+    if (!map) {
+        // no mmap support, read the index to memory
+        FILE* f = fopen(iname, "rb");
+        if (!f)
+            return -1;
+        const int ret = Read(f, size, time);
+        fclose(f);
+        return ret;
+    }
+    if (Check(map, map_size, size, time)) {
+        Close();
+        return -1;
+    }
+    return 0;
+}
+
+int CVCDIndex::Read(FILE* f, const uint64_t size, const uint64_t time) {
+    vcdi_header_t h;
+
+    if (fread(&h, sizeof(h), 1, f) != 1)
+        return -1;
+    if (memcmp(h.magic, VCDI_MAGIC, 8) || (h.source_size != size) || (h.source_time != time))
+        return -1;
+
+    const uint64_t len = sizeof(h) + h.count * sizeof(uint64_t);
+    mem = (unsigned char*)malloc(len);
+    if (!mem) {
+        printf("PICSimLab: VCD index malloc error\n");
+        return -1;
+    }
+    memcpy(mem, &h, sizeof(h));
+    if ((h.count && (fread(mem + sizeof(h), h.count * sizeof(uint64_t), 1, f) != 1)) || Check(mem, len, size, time)) {
+        Close();
+        return -1;
+    }
+    return 0;
+}
+
+uint64_t CVCDIndex::Find(const uint64_t time) {
+    uint64_t lo = 0;
+    uint64_t hi = count;
+
+    while (lo < hi) {
+        const uint64_t mid = lo + ((hi - lo) >> 1);
+        if (GetTime(mid) <= time) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * @brief VCD text tokenizer
+ */
+typedef struct {
+    FILE* f;
+    int len;
+    int pos;
+    char buff[VCDI_READ_SIZE];
+} vcdi_reader_t;
+
+/**
+ * @brief Read the next white space separated token (truncated to size), return 0 at end of file
+ */
+static int vcdi_token(vcdi_reader_t* r, char* tok, const int size) {
+    int n = 0;
+
+    while (1) {
+        if (r->pos >= r->len) {
+            r->len = fread(r->buff, 1, VCDI_READ_SIZE, r->f);
+            r->pos = 0;
+            if (r->len <= 0) {
+                break;
+            }
+        }
+        const char c = r->buff[r->pos++];
+        if ((c == ' ') || (c == '\t') || (c == '\r') || (c == '\n')) {
+            if (n)
+                break;
+        } else if (n < (size - 1)) {
+            tok[n++] = c;
+        }
+    }
+    tok[n] = 0;
+    return n;
+}
+
+/**
+ * @brief Return the VCD time unit in seconds of a $timescale number and unit
+ */
+static double vcdi_timescale(const double number, const char* unit) {
+    static const char units[] = "smunpf";
+    double scale = number;
+
+    while (*unit == ' ')
+        unit++;
+    const char* u = strchr(units, unit[0]);
+    if (!u || !unit[0])
+        return 0;
+    for (int i = u - units; i > 0; i--) {
+        scale *= 1e-3;
+    }
+    return scale;
+}
+
+int CVCDIndex::Build(const char* fname, FILE* out, const uint64_t size, const uint64_t time) {
+    char tok[256];
+    char ids[VCDI_MAX_SIGNALS][VCDI_NAME_SIZE];
+    char var_id[VCDI_NAME_SIZE];
+    char var_size[16];
+    uint64_t* buff;
+    vcdi_header_t h;
+    int state = VP_DEFS;
+    int field = 0;
+    double ts_number = 1;
+    int skip_id = 0;         // next token is the identifier of a vector change
+    uint64_t now = 0;        // current time
+    unsigned char data = 0;  // signals state at current time
+    unsigned char last = 0;  // state of the last event written
+    int buffc = 0;
+
+    vcdi_reader_t* reader = new vcdi_reader_t;
+    reader->f = fopen(fname, "r");
+    reader->len = 0;
+    reader->pos = 0;
+    if (!reader->f) {
+        printf("PICSimLab: Error open file %s\n", fname);
+        delete reader;
+        return -1;
+    }
+
+    buff = new uint64_t[VCDI_BUFF];
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, VCDI_MAGIC, 8);
+    h.version = VCDI_VERSION;
+    h.source_size = size;
+    h.source_time = time;
+    h.timescale = 1e-12;
+    memset(ids, 0, sizeof(ids));
+
+    // the header is rewritten with the counters at end
+    fwrite(&h, sizeof(h), 1, out);
+
+    while (vcdi_token(reader, tok, sizeof(tok))) {
+        switch (state) {
+            case VP_DEFS:
+                if (!strcmp(tok, "$timescale")) {
+                    state = VP_TIMESCALE;
+                    field = 0;
+                } else if (!strcmp(tok, "$var")) {
+                    state = VP_VAR;
+                    field = 0;
+                } else if (!strcmp(tok, "$enddefinitions")) {
+                    state = VP_DATA_SKIP;
+                } else if (tok[0] == '$') {
+                    state = VP_SKIP;  // $date, $version, $comment, $scope, $upscope
+                }
+                break;
+            case VP_SKIP:
+                if (!strcmp(tok, "$end"))
+                    state = VP_DEFS;
+                break;
+            case VP_TIMESCALE:
+                if (!strcmp(tok, "$end")) {
+                    state = VP_DEFS;
+                } else if (!field) {
+                    char* unit;
+                    ts_number = strtod(tok, &unit);
+                    if (unit[0]) {
+                        h.timescale = vcdi_timescale(ts_number, unit);
+                    }
+                    field++;
+                } else {
+                    h.timescale = vcdi_timescale(ts_number, tok);
+                }
+                break;
+            case VP_VAR:
+                // $var type size id reference [range] $end
+                if (!strcmp(tok, "$end")) {
+                    state = VP_DEFS;
+                } else if (field == 1) {
+                    strncpy(var_size, tok, sizeof(var_size) - 1);
+                    var_size[sizeof(var_size) - 1] = 0;
+                } else if (field == 2) {
+                    strncpy(var_id, tok, VCDI_NAME_SIZE - 1);
+                    var_id[VCDI_NAME_SIZE - 1] = 0;
+                } else if ((field == 3) && !strcmp(var_size, "1") && (h.signals < VCDI_MAX_SIGNALS)) {
+                    unsigned int i;
+                    for (i = 0; i < h.signals; i++) {
+                        if (!strcmp(ids[i], var_id))
+                            break;  // alias of a signal already indexed
+                    }
+                    if (i == h.signals) {
+                        strcpy(ids[i], var_id);
+                        snprintf(h.names[i], VCDI_NAME_SIZE, "%.*s", VCDI_NAME_SIZE - 1, tok);
+                        h.signals++;
+                    }
+                }
+                field++;
+                break;
+            case VP_DATA_SKIP:
+                if (!strcmp(tok, "$end"))
+                    state = VP_DATA;
+                break;
+            case VP_DATA:
+                if (skip_id) {
+                    skip_id = 0;
+                } else if (tok[0] == '#') {
+                    const uint64_t t = strtoull(tok + 1, NULL, 10);
+                    if (data != last) {
+                        buff[buffc++] = (now << 8) | data;
+                        last = data;
+                        if (buffc == VCDI_BUFF) {
+                            fwrite(buff, sizeof(uint64_t), buffc, out);
+                            h.count += buffc;
+                            buffc = 0;
+                        }
+                    }
+                    if (t > now)
+                        now = t;
+                } else if (!strcmp(tok, "$comment")) {
+                    state = VP_DATA_SKIP;
+                } else if (tok[0] == '$') {
+                    // $dumpvars, $dumpall, $dumpon, $dumpoff and its $end
+                } else if (strchr("01xXzZ", tok[0])) {
+                    for (unsigned int i = 0; i < h.signals; i++) {
+                        if (!strcmp(ids[i], tok + 1)) {
+                            if (tok[0] == '1') {
+                                data |= 1 << i;
+                            } else {
+                                data &= ~(1 << i);
+                            }
+                            break;
+                        }
+                    }
+                } else if (strchr("bBrR", tok[0])) {
+                    skip_id = 1;  // vectors and reals are not indexed
+                }
+                break;
+        }
+    }
+    fclose(reader->f);
+    delete reader;
+
+    if (data != last) {
+        buff[buffc++] = (now << 8) | data;
+    }
+    fwrite(buff, sizeof(uint64_t), buffc, out);
+    h.count += buffc;
+    h.end = now;
+    delete[] buff;
+
+    if (h.timescale <= 0) {
+        printf("PICSimLab: VCD invalid timescale in %s\n", fname);
+        return -1;
+    }
+
+    fseek(out, 0, SEEK_SET);
+    fwrite(&h, sizeof(h), 1, out);
+    fflush(out);
+    return ferror(out) ? -1 : 0;
+}
@@ -0,0 +1,154 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef VCDINDEX_H
+#define VCDINDEX_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define VCDI_MAGIC "PSLVCDIX"
+#define VCDI_VERSION 1
+#define VCDI_MAX_SIGNALS 8
+#define VCDI_NAME_SIZE 32
+
+/**
+ * @brief VCD index cache file header
+ *
+ * The header is followed by count events, each one is a 64 bit word with
+ * the time in VCD units in the upper 56 bits and the state of the signals
+ * after all changes of that time in the lower 8 bits (bit n is signal n).
+ * Events are sorted by time and only written when the state changes.
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t signals;      ///< number of 1 bit signals indexed
+    uint64_t source_size;  ///< size of the VCD file indexed
+    uint64_t source_time;  ///< modification time of the VCD file indexed
+    double timescale;      ///< VCD time unit in seconds
+    uint64_t end;          ///< last time of the VCD file
+    uint64_t count;        ///< number of events
+    char names[VCDI_MAX_SIGNALS][VCDI_NAME_SIZE];  ///< signals reference names
+} vcdi_header_t;
+
+/**
+ * @brief Pre-indexed VCD file
+ *
+ * The VCD text is parsed only once into a sorted event array saved in a
+ * binary sidecar file (name.vcd.psi) next to the VCD. Later loads only check
+ * the source size and time and memory-map the sidecar, so files of hundreds
+ * of MB start playing at once and are paged in by the OS as played. If the
+ * sidecar can't be written or mapped the events are kept in memory.
+ */
+class CVCDIndex {
+public:
+    CVCDIndex();
+    ~CVCDIndex();
+
+    /**
+     * @brief Load the index of VCD file fname, building the sidecar if needed, return 0 on success
+     */
+    int Open(const char* fname);
+
+    /**
+     * @brief Release the index
+     */
+    void Close(void);
+
+    /**
+     * @brief Return the number of events
+     */
+    uint64_t GetCount(void) { return count; };
+
+    /**
+     * @brief Return the number of signals
+     */
+    int GetSignals(void) { return header ? header->signals : 0; };
+
+    /**
+     * @brief Return the name of signal n
+     */
+    const char* GetName(const int n) { return header ? header->names[n] : ""; };
+
+    /**
+     * @brief Return the VCD time unit in seconds
+     */
+    double GetTimescale(void) { return header ? header->timescale : 1e-12; };
+
+    /**
+     * @brief Return the last time of the VCD file
+     */
+    uint64_t GetEnd(void) { return header ? header->end : 0; };
+
+    /**
+     * @brief Return the time of event n
+     */
+    uint64_t GetTime(const uint64_t n) { return events[n] >> 8; };
+
+    /**
+     * @brief Return the signals state after event n
+     */
+    unsigned char GetData(const uint64_t n) { return events[n] & 0xFF; };
+
+    /**
+     * @brief Return the number of the first event after time (binary search)
+     */
+    uint64_t Find(const uint64_t time);
+
+private:
+    const vcdi_header_t* header;
+    const uint64_t* events;
+    uint64_t count;
+    void* map;  // mapped sidecar
+    uint64_t map_size;
+    unsigned char* mem;  // sidecar read to memory
+#ifdef _WIN_
+    void* hfile;
+    void* hmap;
+#endif
+
+    /**
+     * @brief Parse the VCD file fname and write the index to out, return 0 on success
+     */
+    static int Build(const char* fname, FILE* out, const uint64_t size, const uint64_t time);
+
+    /**
+     * @brief Map the sidecar file if it is valid for the source size and time, return 0 on success
+     */
+    int Map(const char* iname, const uint64_t size, const uint64_t time);
+
+    /**
+     * @brief Read the index file f to memory if it is valid for the source size and time, return 0 on success
+     */
+    int Read(FILE* f, const uint64_t size, const uint64_t time);
+
+    /**
+     * @brief Use the index in buff if it is valid for the source size and time, return 0 on success
+     */
+    int Check(const void* buff, const uint64_t len, const uint64_t size, const uint64_t time);
+};
+
+#endif /* VCDINDEX_H */
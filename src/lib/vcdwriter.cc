@@ -0,0 +1,144 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "vcdwriter.h"
+
+#include <string.h>
+
+static const char markers[] = "!$%&[()]";
+
+int vcd_format_time(char* buff, const uint64_t time) {
+    char digits[24];
+    int n = 0;
+    int len = 0;
+    uint64_t v = time;
+    do {
+        digits[n++] = '0' + (v % 10);
+        v /= 10;
+    } while (v);
+    buff[len++] = '#';
+    while (n)
+        buff[len++] = digits[--n];
+    buff[len++] = '\n';
+    return len;
+}
+
+CVCDWriter::CVCDWriter() : Ring(this) {
+    file = NULL;
+    out = NULL;
+    out_used = 0;
+    last_time = 0;
+}
+
+CVCDWriter::~CVCDWriter() {
+    Close();
+    delete[] out;
+}
+
+int CVCDWriter::Open(const char* fname, const int tscale_ps, const char* module, const char* const* names,
+                     const int count) {
+    Close();
+
+    file = fopen(fname, "w");
+    if (!file) {
+        printf("PICSimLab: Error creating file %s\n", fname);
+        return -1;
+    }
+
+    if (!out) {
+        out = new char[VCDW_OUT_SIZE];
+    }
+
+    fprintf(file,
+            "$version Generated by PICSimLab $end\n"
+            "$timescale %ips $end\n"
+            "$scope module %s $end\n",
+            tscale_ps, module);
+
+    memset(ids, 0, sizeof(ids));
+    for (int i = 0; (i < count) && (i < VCDW_MAX_VARS); i++) {
+        if (names[i] && names[i][0]) {
+            ids[i] = markers[i];
+            fprintf(file, "$var wire 1 %c  %s $end\n", ids[i], names[i]);
+        }
+    }
+
+    fprintf(file,
+            "$upscope $end\n"
+            "$enddefinitions $end\n"
+            "$dumpvars\n");
+    for (int i = 0; i < VCDW_MAX_VARS; i++) {
+        if (ids[i])
+            fprintf(file, "x%c\n", ids[i]);
+    }
+    fprintf(file, "$end\n");
+    fflush(file);
+
+    out_used = 0;
+    last_time = UINT64_MAX;
+    Ring.Start();
+    return 0;
+}
+
+void CVCDWriter::Consume(const uint64_t* changes, const uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        const uint64_t ch = changes[i];
+        const uint64_t time = ch >> 4;
+
+        // room for the longest time line and a value line
+        if ((out_used + 32) > VCDW_OUT_SIZE) {
+            fwrite(out, out_used, 1, file);
+            out_used = 0;
+        }
+
+        if (time != last_time) {
+            out_used += vcd_format_time(out + out_used, time);
+            last_time = time;
+        }
+        out[out_used++] = '0' + (ch & 1);
+        out[out_used++] = ids[(ch >> 1) & 7];
+        out[out_used++] = '\n';
+    }
+
+    if (out_used) {
+        fwrite(out, out_used, 1, file);
+        out_used = 0;
+        fflush(file);
+    }
+}
+
+void CVCDWriter::Sync(void) {
+    if (file)
+        Ring.Sync();
+}
+
+void CVCDWriter::Close(void) {
+    if (!file)
+        return;
+
+    Ring.Stop();
+    fclose(file);
+    file = NULL;
+}
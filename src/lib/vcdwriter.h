@@ -0,0 +1,97 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef VCDWRITER_H
+#define VCDWRITER_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "eventring.h"
+
+#define VCDW_MAX_VARS 8
+#define VCDW_RING_SIZE 65536  // changes in ring (power of two)
+#define VCDW_OUT_SIZE 65536   // bytes of formatted output written at once
+
+/**
+ * @brief Write the VCD time line "#time\n" to buff, return the number of characters (at most 22)
+ */
+int vcd_format_time(char* buff, const uint64_t time);
+
+/**
+ * @brief Asynchronous VCD writer of 1 bit variables
+ *
+ * The simulation thread stores each change as one 64 bit word (time and
+ * variable value) in a CEventRing. The ring thread formats the changes in
+ * large blocks and writes them to the file, so no formatting or file access
+ * happens in the simulation loop.
+ */
+class CVCDWriter {
+public:
+    CVCDWriter();
+    ~CVCDWriter();
+
+    /**
+     * @brief Create the VCD file and write its header (names NULL or empty are not declared), return 0 on success
+     */
+    int Open(const char* fname, const int tscale_ps, const char* module, const char* const* names, const int count);
+
+    /**
+     * @brief Write pending changes and close the file
+     */
+    void Close(void);
+
+    /**
+     * @brief Wait until all changes added are written to the file
+     */
+    void Sync(void);
+
+    /**
+     * @brief Return 1 if the file is open
+     */
+    int IsOpen(void) { return file != NULL; };
+
+    /**
+     * @brief Add a variable value change at time
+     */
+    void Add(const uint64_t time, const int var, const int value) { Ring.Add((time << 4) | (var << 1) | (value & 1)); };
+
+private:
+    FILE* file;
+    char ids[VCDW_MAX_VARS];
+    uint64_t last_time;
+    char* out;
+    unsigned int out_used;
+    CEventRing<CVCDWriter, VCDW_RING_SIZE> Ring;
+
+    friend class CEventRing<CVCDWriter, VCDW_RING_SIZE>;
+
+    /**
+     * @brief Format and write changes (writer thread)
+     */
+    void Consume(const uint64_t* changes, const uint32_t count);
+};
+
+#endif /* VCDWRITER_H */
@@ -58,6 +58,7 @@ cpart_dht22::cpart_dht22(const unsigned x, const unsigned y, const char* name, c
 
     PinCount = 1;
     Pins = output_pins;
+    SetPinSensitive(0);  // sensor output is driven by internal timer
 }
 
 void cpart_dht22::RegisterRemoteControl(void) {
@@ -55,6 +55,7 @@ cpart_ds18b20::cpart_ds18b20(const unsigned x, const unsigned y, const char* nam
 
     PinCount = 1;
     Pins = output_pins;
+    SetPinSensitive(0);  // sensor output is driven by internal timer
 }
 
 void cpart_ds18b20::RegisterRemoteControl(void) {
@@ -264,48 +264,48 @@ void cpart_keypad::DrawOutput(const unsigned int i) {
     }
 }
 
+void cpart_keypad::PreProcess(void) {
+    SetSamplePeriod_us(10);  // keys matrix update at 100kHz
+}
+
 void cpart_keypad::Process(void) {
-    if (refresh > 10) {
-        const picpin* ppins = SpareParts.GetPinsValues();
-        refresh = 0;
-
-        for (int i = 0; i < 8; i++)
-            SpareParts.SetPin(output_pins[i], !pull);
-
-        switch (type) {
-            case KT4x4:
-                for (int c = 0; c < 4; c++) {
-                    for (int l = 0; l < 4; l++) {
-                        if (keys[l][c]) {
-                            SpareParts.SetPin(output_pins[l], ppins[output_pins[4 + c] - 1].value);
-                            SpareParts.SetPin(output_pins[4 + c], ppins[output_pins[l] - 1].value);
-                        }
+    const picpin* ppins = SpareParts.GetPinsValues();
+
+    for (int i = 0; i < 8; i++)
+        SpareParts.SetPin(output_pins[i], !pull);
+
+    switch (type) {
+        case KT4x4:
+            for (int c = 0; c < 4; c++) {
+                for (int l = 0; l < 4; l++) {
+                    if (keys[l][c]) {
+                        SpareParts.SetPin(output_pins[l], ppins[output_pins[4 + c] - 1].value);
+                        SpareParts.SetPin(output_pins[4 + c], ppins[output_pins[l] - 1].value);
                     }
                 }
-                break;
-            case KT4x3:
-                for (int c = 0; c < 3; c++) {
-                    for (int l = 0; l < 4; l++) {
-                        if (keys[l][c]) {
-                            SpareParts.SetPin(output_pins[l], ppins[output_pins[4 + c] - 1].value);
-                            SpareParts.SetPin(output_pins[4 + c], ppins[output_pins[l] - 1].value);
-                        }
+            }
+            break;
+        case KT4x3:
+            for (int c = 0; c < 3; c++) {
+                for (int l = 0; l < 4; l++) {
+                    if (keys[l][c]) {
+                        SpareParts.SetPin(output_pins[l], ppins[output_pins[4 + c] - 1].value);
+                        SpareParts.SetPin(output_pins[4 + c], ppins[output_pins[l] - 1].value);
                     }
                 }
-                break;
-            case KT2x5:
-                for (int c = 0; c < 5; c++) {
-                    for (int l = 0; l < 2; l++) {
-                        if (keys2[l][c]) {
-                            SpareParts.SetPin(output_pins[l], ppins[output_pins[2 + c] - 1].value);
-                            SpareParts.SetPin(output_pins[2 + c], ppins[output_pins[l] - 1].value);
-                        }
+            }
+            break;
+        case KT2x5:
+            for (int c = 0; c < 5; c++) {
+                for (int l = 0; l < 2; l++) {
+                    if (keys2[l][c]) {
+                        SpareParts.SetPin(output_pins[l], ppins[output_pins[2 + c] - 1].value);
+                        SpareParts.SetPin(output_pins[2 + c], ppins[output_pins[l] - 1].value);
                     }
                 }
-                break;
-        }
+            }
+            break;
     }
-    refresh++;
 }
 
 void cpart_keypad::OnMouseButtonPress(uint inputId, uint button, uint x, uint y, uint state) {
@@ -37,6 +37,7 @@ public:
     cpart_keypad(const unsigned x, const unsigned y, const char* name, const char* type, board* pboard_);
     ~cpart_keypad(void);
     void DrawOutput(const unsigned int index) override;
+    void PreProcess(void) override;
     void Process(void) override;
     lxString GetPictureFileName(void) override;
     lxString GetMapFile(void) override;
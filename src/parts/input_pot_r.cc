@@ -342,10 +342,7 @@ void cpart_pot_r::LoadImage(void) {
             canvas.Destroy();
             canvas.Create(SpareParts.GetWindow()->GetWWidget(), Bitmap);
 
-            image.LoadFile(lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/") + Type + "/" + GetPictureFileName()),
-                           Orientation, Scale, Scale);
-            lxBitmap* BackBitmap = new lxBitmap(&image, SpareParts.GetWindow());
-            image.Destroy();
+            lxBitmap* BackBitmap = new lxBitmap(LoadPicture(), SpareParts.GetWindow());
 
             canvas.Init(Scale, Scale, Orientation);
             canvas.SetColor(0x31, 0x3d, 0x63);
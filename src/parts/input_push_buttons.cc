@@ -82,6 +82,7 @@ cpart_pbuttons::cpart_pbuttons(const unsigned x, const unsigned y, const char* n
 
     PinCount = 8;
     Pins = output_pins;
+    SetPinSensitive(0);  // bounce is processed without pin changes
 }
 
 void cpart_pbuttons::RegisterRemoteControl(void) {
@@ -486,10 +487,7 @@ void cpart_pbuttons::LoadImage(void) {
             canvas.Destroy();
             canvas.Create(SpareParts.GetWindow()->GetWWidget(), Bitmap);
 
-            image.LoadFile(lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/") + Type + "/" + GetPictureFileName()),
-                           Orientation, Scale, Scale);
-            lxBitmap* BackBitmap = new lxBitmap(&image, SpareParts.GetWindow());
-            image.Destroy();
+            lxBitmap* BackBitmap = new lxBitmap(LoadPicture(), SpareParts.GetWindow());
 
             canvas.Init(Scale, Scale, Orientation);
             canvas.SetColor(0x31, 0x3d, 0x63);
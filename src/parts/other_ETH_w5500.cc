@@ -93,6 +93,7 @@ cpart_ETH_w5500::cpart_ETH_w5500(const unsigned x, const unsigned y, const char*
 
     PinCount = 6;
     Pins = pins;
+    SetPinSensitive(0);  // network data is received without pin changes
 }
 
 cpart_ETH_w5500::~cpart_ETH_w5500(void) {
@@ -147,24 +147,24 @@ void cpart_tempsys::DrawOutput(const unsigned int i) {
     }
 }
 
+void cpart_tempsys::PreProcess(void) {
+    // fan tachometer update, rpmstp is calibrated to the old 101 instructions countdown at 5 MIPS (20 MHz PIC)
+    SetSamplePeriod_us(20.2);
+}
+
 void cpart_tempsys::Process(void) {
-    if (!refresh) {
-        refresh = PICSimLab.GetJUMPSTEPS() + 1;
-
-        const picpin* ppins = SpareParts.GetPinsValues();
-
-        if ((input_pins[1] > 0) && (input_pins[3] > 0)) {
-            if (ppins[input_pins[1] - 1].oavalue > 55) {
-                rpmc++;
-                if (rpmc > rpmstp) {
-                    rpmc = 0;
-                    SpareParts.SetPin(input_pins[3], !ppins[input_pins[3] - 1].value);
-                }
-            } else
-                SpareParts.SetPin(input_pins[3], 0);
-        }
+    const picpin* ppins = SpareParts.GetPinsValues();
+
+    if ((input_pins[1] > 0) && (input_pins[3] > 0)) {
+        if (ppins[input_pins[1] - 1].oavalue > 55) {
+            rpmc++;
+            if (rpmc > rpmstp) {
+                rpmc = 0;
+                SpareParts.SetPin(input_pins[3], !ppins[input_pins[3] - 1].value);
+            }
+        } else
+            SpareParts.SetPin(input_pins[3], 0);
     }
-    refresh--;
 }
 
 void cpart_tempsys::OnTime(void) {
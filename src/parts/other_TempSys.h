@@ -37,6 +37,7 @@ public:
     cpart_tempsys(const unsigned x, const unsigned y, const char* name, const char* type, board* pboard_);
     ~cpart_tempsys(void);
     void DrawOutput(const unsigned int index) override;
+    void PreProcess(void) override;
     void Process(void) override;
     void ConfigurePropertiesWindow(CPWindow* WProp) override;
     void ReadPropertiesWindow(CPWindow* WProp) override;
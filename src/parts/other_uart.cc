@@ -76,6 +76,7 @@ cpart_UART::cpart_UART(const unsigned x, const unsigned y, const char* name, con
 
     PinCount = 2;
     Pins = pins;
+    SetPinSensitive(0);  // serial port data is received without pin changes
 }
 
 cpart_UART::~cpart_UART(void) {
@@ -112,7 +112,8 @@ cpart_7s_display::cpart_7s_display(const unsigned x, const unsigned y, const cha
     input_pins[10] = 0;
     input_pins[11] = 0;
 
-    mcount = 0;
+    samples = 0;
+    board_pinc = 0;
 
     for (int i = 0; i < 8; i++) {
         lm1[i] = 30;
@@ -595,50 +596,55 @@ void cpart_7s_display::PreProcess(void) {
         memset(alm4, 0, 8 * sizeof(unsigned int));
     }
 
-    JUMPSTEPS_ = PICSimLab.GetJUMPSTEPS();
-    mcount = JUMPSTEPS_;
+    samples = 0;
+    SetSamplePeriod_us(10);  // segments sampled at 100kHz
+    board_pinc = pboard->MGetPinCount();
 }
 
 void cpart_7s_display::Process(void) {
     int i;
     const picpin* ppins = SpareParts.GetPinsValues();
 
-    mcount++;
-
-    if (mcount > JUMPSTEPS_) {
-        for (i = 0; i < 8; i++) {
-            if (input_pins[i]) {
-                if (ppins[input_pins[i] - 1].value == active) {
-                    if (dtype) {
+    for (i = 0; i < 8; i++) {
+        if (input_pins[i]) {
+            if (ppins[input_pins[i] - 1].value == active) {
+                if (dtype) {
+                    if (input_pins[i] > board_pinc)
+                        alm1[i]++;
+                } else {
+                    if (ppins[input_pins[8] - 1].value)
                         alm1[i]++;
-                    } else {
-                        if (ppins[input_pins[8] - 1].value)
-                            alm1[i]++;
-                        if (ppins[input_pins[9] - 1].value)
-                            alm2[i]++;
-                        if (ppins[input_pins[10] - 1].value)
-                            alm3[i]++;
-                        if (ppins[input_pins[11] - 1].value)
-                            alm4[i]++;
-                    }
+                    if (ppins[input_pins[9] - 1].value)
+                        alm2[i]++;
+                    if (ppins[input_pins[10] - 1].value)
+                        alm3[i]++;
+                    if (ppins[input_pins[11] - 1].value)
+                        alm4[i]++;
                 }
             }
         }
-        mcount = -1;
     }
+    samples++;
 }
 
 void cpart_7s_display::PostProcess(void) {
-    long int NSTEPJ = PICSimLab.GetNSTEPJ();
+    const float NSAMPLES = samples ? samples : 1;
 
     for (int i = 0; i < 8; i++) {
-        lm1[i] = (int)((lm1[i] + (((600.0 * alm1[i]) / NSTEPJ) + 30)) / 2.0);
+        if (dtype && input_pins[i] && (input_pins[i] <= board_pinc)) {
+            float duty = pboard->GetPinDuty(input_pins[i] - 1);
+            if (!active)
+                duty = 1.0 - duty;
+            lm1[i] = (int)((lm1[i] + ((600.0 * duty) + 30)) / 2.0);
+        } else {
+            lm1[i] = (int)((lm1[i] + (((600.0 * alm1[i]) / NSAMPLES) + 30)) / 2.0);
+        }
         if (lm1[i] > 255)
             lm1[i] = 255;
         if (!dtype) {
-            lm2[i] = (int)((lm2[i] + (((600.0 * alm2[i]) / NSTEPJ) + 30)) / 2.0);
-            lm3[i] = (int)((lm3[i] + (((600.0 * alm3[i]) / NSTEPJ) + 30)) / 2.0);
-            lm4[i] = (int)((lm4[i] + (((600.0 * alm4[i]) / NSTEPJ) + 30)) / 2.0);
+            lm2[i] = (int)((lm2[i] + (((600.0 * alm2[i]) / NSAMPLES) + 30)) / 2.0);
+            lm3[i] = (int)((lm3[i] + (((600.0 * alm3[i]) / NSAMPLES) + 30)) / 2.0);
+            lm4[i] = (int)((lm4[i] + (((600.0 * alm4[i]) / NSAMPLES) + 30)) / 2.0);
             if (lm2[i] > 255)
                 lm2[i] = 255;
             if (lm3[i] > 255)
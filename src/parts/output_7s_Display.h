@@ -64,8 +64,8 @@ private:
     unsigned int alm2[8];
     unsigned int alm3[8];
     unsigned int alm4[8];
-    long int mcount;
-    int JUMPSTEPS_;
+    unsigned int samples;  // samples taken since PreProcess
+    int board_pinc;  // pins up to board pin count use the board pins duty cycle
     lxFont font;
     unsigned char dtype;
 };
@@ -103,7 +103,7 @@ cpart_7s_display_dec::cpart_7s_display_dec(const unsigned x, const unsigned y, c
     latchs[2] = 0;
     latchs[3] = 0;
 
-    mcount = 0;
+    samples = 0;
 
     for (int i = 0; i < 8; i++) {
         lm1[i] = 30;
@@ -547,8 +547,8 @@ void cpart_7s_display_dec::PreProcess(void) {
     memset(alm3, 0, 8 * sizeof(unsigned int));
     memset(alm4, 0, 8 * sizeof(unsigned int));
 
-    JUMPSTEPS_ = PICSimLab.GetJUMPSTEPS();
-    mcount = JUMPSTEPS_;
+    samples = 0;
+    SetSamplePeriod_us(10);  // segments sampled at 100kHz
 }
 
 void cpart_7s_display_dec::Process(void) {
@@ -557,123 +557,118 @@ void cpart_7s_display_dec::Process(void) {
 
     const picpin* ppins = SpareParts.GetPinsValues();
 
-    mcount++;
-
-    if (mcount > JUMPSTEPS_) {
-        value = 0;
-        if (input_pins[0] && ppins[input_pins[0] - 1].value)
-            value |= 0x01;
-        if (input_pins[1] && ppins[input_pins[1] - 1].value)
-            value |= 0x02;
-        if (input_pins[2] && ppins[input_pins[2] - 1].value)
-            value |= 0x04;
-        if (input_pins[3] && ppins[input_pins[3] - 1].value)
-            value |= 0x08;
-
-        switch (value) {
-            case 0:
-                value = 0x3F;
-                break;
-            case 1:
-                value = 0x06;
-                break;
-            case 2:
-                value = 0x5B;
-                break;
-            case 3:
-                value = 0x4F;
-                break;
-            case 4:
-                value = 0x66;
-                break;
-            case 5:
-                value = 0x6D;
-                break;
-            case 6:
-                value = 0x7D;
-                break;
-            case 7:
-                value = 0x07;
-                break;
-            case 8:
-                value = 0x7F;
-                break;
-            case 9:
-                value = 0x6F;
-                break;
-                /*
-               case 10:
-                value = 0x77;
-                break;
-               case 11:
-                value = 0x7c;
-                break;
-               case 12:
-                value = 0x58;
-                break;
-               case 13:
-                value = 0x5E;
-                break;
-               case 14:
-                value = 0x79;
-                break;
-               case 15:
-                value = 0x71;
-                break;
-                 */
-            default:
-                value = 0;
-        }
+    value = 0;
+    if (input_pins[0] && ppins[input_pins[0] - 1].value)
+        value |= 0x01;
+    if (input_pins[1] && ppins[input_pins[1] - 1].value)
+        value |= 0x02;
+    if (input_pins[2] && ppins[input_pins[2] - 1].value)
+        value |= 0x04;
+    if (input_pins[3] && ppins[input_pins[3] - 1].value)
+        value |= 0x08;
+
+    switch (value) {
+        case 0:
+            value = 0x3F;
+            break;
+        case 1:
+            value = 0x06;
+            break;
+        case 2:
+            value = 0x5B;
+            break;
+        case 3:
+            value = 0x4F;
+            break;
+        case 4:
+            value = 0x66;
+            break;
+        case 5:
+            value = 0x6D;
+            break;
+        case 6:
+            value = 0x7D;
+            break;
+        case 7:
+            value = 0x07;
+            break;
+        case 8:
+            value = 0x7F;
+            break;
+        case 9:
+            value = 0x6F;
+            break;
+            /*
+           case 10:
+            value = 0x77;
+            break;
+           case 11:
+            value = 0x7c;
+            break;
+           case 12:
+            value = 0x58;
+            break;
+           case 13:
+            value = 0x5E;
+            break;
+           case 14:
+            value = 0x79;
+            break;
+           case 15:
+            value = 0x71;
+            break;
+             */
+        default:
+            value = 0;
+    }
 
-        if (!dtype) {
-            // MUX
-            for (i = 0; i < 8; i++) {
-                if (value & (0x01 << i)) {
-                    if (input_pins[4] && ppins[input_pins[4] - 1].value)
-                        alm1[i]++;
-                    if (input_pins[5] && ppins[input_pins[5] - 1].value)
-                        alm2[i]++;
-                    if (input_pins[6] && ppins[input_pins[6] - 1].value)
-                        alm3[i]++;
-                    if (input_pins[7] && ppins[input_pins[7] - 1].value)
-                        alm4[i]++;
-                }
-            }
-        } else {
-            // LATCH
-            if (input_pins[4] && !ppins[input_pins[4] - 1].value)
-                latchs[0] = value;
-            if (input_pins[5] && !ppins[input_pins[5] - 1].value)
-                latchs[1] = value;
-            if (input_pins[6] && !ppins[input_pins[6] - 1].value)
-                latchs[2] = value;
-            if (input_pins[7] && !ppins[input_pins[7] - 1].value)
-                latchs[3] = value;
-
-            for (i = 0; i < 8; i++) {
-                if (latchs[0] & (0x01 << i))
+    if (!dtype) {
+        // MUX
+        for (i = 0; i < 8; i++) {
+            if (value & (0x01 << i)) {
+                if (input_pins[4] && ppins[input_pins[4] - 1].value)
                     alm1[i]++;
-                if (latchs[1] & (0x01 << i))
+                if (input_pins[5] && ppins[input_pins[5] - 1].value)
                     alm2[i]++;
-                if (latchs[2] & (0x01 << i))
+                if (input_pins[6] && ppins[input_pins[6] - 1].value)
                     alm3[i]++;
-                if (latchs[3] & (0x01 << i))
+                if (input_pins[7] && ppins[input_pins[7] - 1].value)
                     alm4[i]++;
             }
         }
-
-        mcount = -1;
+    } else {
+        // LATCH
+        if (input_pins[4] && !ppins[input_pins[4] - 1].value)
+            latchs[0] = value;
+        if (input_pins[5] && !ppins[input_pins[5] - 1].value)
+            latchs[1] = value;
+        if (input_pins[6] && !ppins[input_pins[6] - 1].value)
+            latchs[2] = value;
+        if (input_pins[7] && !ppins[input_pins[7] - 1].value)
+            latchs[3] = value;
+
+        for (i = 0; i < 8; i++) {
+            if (latchs[0] & (0x01 << i))
+                alm1[i]++;
+            if (latchs[1] & (0x01 << i))
+                alm2[i]++;
+            if (latchs[2] & (0x01 << i))
+                alm3[i]++;
+            if (latchs[3] & (0x01 << i))
+                alm4[i]++;
+        }
     }
+    samples++;
 }
 
 void cpart_7s_display_dec::PostProcess(void) {
-    long int NSTEPJ = PICSimLab.GetNSTEPJ();
+    const float NSAMPLES = samples ? samples : 1;
 
     for (int i = 0; i < 8; i++) {
-        lm1[i] = (int)((lm1[i] + (((600.0 * alm1[i]) / NSTEPJ) + 30)) / 2.0);
-        lm2[i] = (int)((lm2[i] + (((600.0 * alm2[i]) / NSTEPJ) + 30)) / 2.0);
-        lm3[i] = (int)((lm3[i] + (((600.0 * alm3[i]) / NSTEPJ) + 30)) / 2.0);
-        lm4[i] = (int)((lm4[i] + (((600.0 * alm4[i]) / NSTEPJ) + 30)) / 2.0);
+        lm1[i] = (int)((lm1[i] + (((600.0 * alm1[i]) / NSAMPLES) + 30)) / 2.0);
+        lm2[i] = (int)((lm2[i] + (((600.0 * alm2[i]) / NSAMPLES) + 30)) / 2.0);
+        lm3[i] = (int)((lm3[i] + (((600.0 * alm3[i]) / NSAMPLES) + 30)) / 2.0);
+        lm4[i] = (int)((lm4[i] + (((600.0 * alm4[i]) / NSAMPLES) + 30)) / 2.0);
         if (lm1[i] > 255)
             lm1[i] = 255;
         if (lm2[i] > 255)
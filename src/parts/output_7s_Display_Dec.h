@@ -62,8 +62,7 @@ private:
     unsigned int alm2[8];
     unsigned int alm3[8];
     unsigned int alm4[8];
-    long int mcount;
-    int JUMPSTEPS_;
+    unsigned int samples;  // samples taken since PreProcess
     lxFont font;
     unsigned char dtype;
     unsigned char latchs[4];
@@ -52,8 +52,6 @@ cpart_Buzzer::cpart_Buzzer(const unsigned x, const unsigned y, const char* name,
 
     input_pins[0] = 0;
 
-    mcount = 0;
-
     buzzer.Init();
     btype = ACTIVE;
 
@@ -222,13 +220,14 @@ void cpart_Buzzer::ReadPropertiesWindow(CPWindow* WProp) {
 }
 
 void cpart_Buzzer::PreProcess(void) {
-    if (btype == PASSIVE) {
-        JUMPSTEPS_ = (pboard->MGetInstClockFreq() / samplerate);
-        JUMPSTEPS_ *= ((float)BASETIMER) / timer->GetTime();  // Adjust to sample at the same time to the timer
-        mcount = JUMPSTEPS_;
+    SetAlwaysUpdate(btype != ACTIVE);  // active buzzer only use PostProcess
+    if (btype == ACTIVE) {
+        SetSamplePeriod_us(0);
+    } else if (btype == PASSIVE) {
+        // Adjust to sample at the same time to the timer
+        SetSamplePeriod_us((1e6 / samplerate) * ((float)BASETIMER) / timer->GetTime());
     } else if (btype == TONE) {
-        JUMPSTEPS_ = (pboard->MGetInstClockFreq() / samplerate);
-        mcount = JUMPSTEPS_;
+        SetSamplePeriod_us(1e6 / samplerate);
         ctone = 0;
         optone = 0;
         ftone = 0;
@@ -243,46 +242,37 @@ void cpart_Buzzer::Stop(void) {
 
 void cpart_Buzzer::Process(void) {
     if (btype == PASSIVE) {
-        mcount++;
-        if (mcount > JUMPSTEPS_) {
-            if ((input_pins[0]) && (buffercount < buffersize)) {
-                const picpin* ppins = SpareParts.GetPinsValues();
-
-                /*
-                   0.7837 z-1 - 0.7837 z-2
-             y1:  ----------------------
-                  1 - 1.196 z-1 + 0.2068 z-2
-                 */
-                in[2] = in[1];
-                in[1] = in[0];
-                if (active) {
-                    in[0] = ((2.0 * ppins[input_pins[0] - 1].value) - 1.0) * maxv * 0.5;
-                } else {
-                    in[0] = ((2.0 * (ppins[input_pins[0] - 1].value == 0)) - 1.0) * maxv * 0.5;
-                }
-                out[2] = out[1];
-                out[1] = out[0];
-                out[0] = 0.7837 * in[1] - 0.7837 * in[2] + 1.196 * out[1] - 0.2068 * out[2];
-
-                buffer[buffercount++] = out[0];
+        if ((input_pins[0]) && (buffercount < buffersize)) {
+            const picpin* ppins = SpareParts.GetPinsValues();
+
+            /*
+               0.7837 z-1 - 0.7837 z-2
+         y1:  ----------------------
+              1 - 1.196 z-1 + 0.2068 z-2
+             */
+            in[2] = in[1];
+            in[1] = in[0];
+            if (active) {
+                in[0] = ((2.0 * ppins[input_pins[0] - 1].value) - 1.0) * maxv * 0.5;
+            } else {
+                in[0] = ((2.0 * (ppins[input_pins[0] - 1].value == 0)) - 1.0) * maxv * 0.5;
             }
+            out[2] = out[1];
+            out[1] = out[0];
+            out[0] = 0.7837 * in[1] - 0.7837 * in[2] + 1.196 * out[1] - 0.2068 * out[2];
 
-            mcount = 0;
+            buffer[buffercount++] = out[0];
         }
     } else if (btype == TONE) {
-        mcount++;
-        if (mcount > JUMPSTEPS_) {
-            if (input_pins[0]) {
-                const picpin* ppins = SpareParts.GetPinsValues();
-
-                if ((!optone) && (ppins[input_pins[0] - 1].value)) {
-                    ftone = (ftone + ctone) / 2.0;
-                    ctone = 0;
-                }
-                optone = ppins[input_pins[0] - 1].value;
-                ctone++;
+        if (input_pins[0]) {
+            const picpin* ppins = SpareParts.GetPinsValues();
+
+            if ((!optone) && (ppins[input_pins[0] - 1].value)) {
+                ftone = (ftone + ctone) / 2.0;
+                ctone = 0;
             }
-            mcount = 0;
+            optone = ppins[input_pins[0] - 1].value;
+            ctone++;
         }
     }
 }
@@ -54,8 +54,6 @@ private:
     unsigned char active;
     unsigned char input_pins[1];
     lxaudio buzzer;
-    long int mcount;
-    int JUMPSTEPS_;
     unsigned char btype;
     unsigned int samplerate;
     short* buffer;
@@ -105,6 +105,7 @@ cpart_LCD_ili9341::cpart_LCD_ili9341(const unsigned x, const unsigned y, const c
 
     PinCount = 13;
     Pins = input_pins;
+    SetPinSensitive(0);  // touch pins are not in pins list
 }
 
 lxString cpart_LCD_ili9341::GetPictureFileName(void) {
@@ -146,6 +147,7 @@ lxString cpart_LCD_ili9341::GetMapFile(void) {
 cpart_LCD_ili9341::~cpart_LCD_ili9341(void) {
     delete Bitmap;
     canvas.Destroy();
+    lcd_ili9341_end(&lcd);
 }
 
 void cpart_LCD_ili9341::DrawOutput(const unsigned int i) {
@@ -706,6 +708,11 @@ void cpart_LCD_ili9341::Process(void) {
     }
 }
 
+void cpart_LCD_ili9341::DrawPrepare(void) {
+    if (lcd.update && output_ids[O_LCD]->update)
+        lcd_ili9341_prepare(&lcd);
+}
+
 void cpart_LCD_ili9341::PostProcess(void) {
     if (lcd.update)
         output_ids[O_LCD]->update = 1;
@@ -39,6 +39,7 @@ public:
     cpart_LCD_ili9341(const unsigned x, const unsigned y, const char* name, const char* type, board* pboard_);
     ~cpart_LCD_ili9341(void);
     void DrawOutput(const unsigned int index) override;
+    void DrawPrepare(void) override;
     void PreProcess(void) override;
     void Process(void) override;
     void PostProcess(void) override;
@@ -71,6 +71,7 @@ cpart_led_ws2812b::~cpart_led_ws2812b(void) {
 }
 
 void cpart_led_ws2812b::LoadImage(void) {
+    led_ws2812b_redraw(&led);  // all leds over the new bitmap
     if (led.nleds > 1) {
         xoff = (led.ncols - 1) * 40;
         yoff = (led.nrows - 1) * 40;
@@ -87,10 +88,7 @@ void cpart_led_ws2812b::LoadImage(void) {
             canvas.Destroy();
             canvas.Create(SpareParts.GetWindow()->GetWWidget(), Bitmap);
 
-            image.LoadFile(lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/") + Type + "/" + GetPictureFileName()),
-                           Orientation, Scale, Scale);
-            lxBitmap* BackBitmap = new lxBitmap(&image, SpareParts.GetWindow());
-            image.Destroy();
+            lxBitmap* BackBitmap = new lxBitmap(LoadPicture(), SpareParts.GetWindow());
 
             image.LoadFile(
                 lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/") + Type + "/" + GetName() + lxT("/LED.svg")),
@@ -300,6 +298,11 @@ void cpart_led_ws2812b::Process(void) {
     }
 }
 
+void cpart_led_ws2812b::DrawPrepare(void) {
+    if (led.update && output_ids[O_LED]->update)
+        led_ws2812b_draw_prepare(&led);
+}
+
 void cpart_led_ws2812b::PostProcess(void) {
     if (led.update)
         output_ids[O_LED]->update = 1;
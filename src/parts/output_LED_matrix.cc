@@ -69,6 +69,11 @@ cpart_led_matrix::~cpart_led_matrix(void) {
     canvas.Destroy();
 }
 
+void cpart_led_matrix::LoadImage(void) {
+    part::LoadImage();
+    ldd_max72xx_redraw(&ldd);  // all dots over the new bitmap
+}
+
 void cpart_led_matrix::DrawOutput(const unsigned int i) {
     switch (output[i].id) {
         case O_P1:
@@ -160,6 +165,7 @@ void cpart_led_matrix::ReadPreferences(lxString value) {
     SpareParts.UnregisterIOpin(output_pins[0]);
     output_pins[0] = SpareParts.RegisterIOpin(lxT("DOUT"), outp);
 
+    ldd_max72xx_redraw(&ldd);
     Reset();
 }
 
@@ -187,6 +193,7 @@ void cpart_led_matrix::ReadPropertiesWindow(CPWindow* WProp) {
     input_pins[2] = GetPWCComboSelectedPin(WProp, "combo5");
     angle = atoi(((CCombo*)WProp->GetChildByName("combo7"))->GetText());
     lmode = !(((CCombo*)WProp->GetChildByName("combo8"))->GetText().Cmp("FC16") == 0);
+    ldd_max72xx_redraw(&ldd);
 }
 
 void cpart_led_matrix::Process(void) {
@@ -203,6 +210,11 @@ void cpart_led_matrix::Process(void) {
     }
 }
 
+void cpart_led_matrix::DrawPrepare(void) {
+    if (ldd.update && output_ids[O_LED]->update)
+        ldd_max72xx_prepare(&ldd, angle);
+}
+
 void cpart_led_matrix::PostProcess(void) {
     if (ldd.update)
         output_ids[O_LED]->update = 1;
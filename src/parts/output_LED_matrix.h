@@ -39,11 +39,13 @@ public:
     ~cpart_led_matrix(void);
     void DrawOutput(const unsigned int index) override;
     void Process(void) override;
+    void DrawPrepare(void) override;
     void PostProcess(void) override;
     void ConfigurePropertiesWindow(CPWindow* WProp) override;
     void ReadPropertiesWindow(CPWindow* WProp) override;
     lxString WritePreferences(void) override;
     void ReadPreferences(lxString value) override;
+    void LoadImage(void) override;
     unsigned short GetInputId(char* name) override;
     unsigned short GetOutputId(char* name) override;
 
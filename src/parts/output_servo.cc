@@ -171,21 +171,14 @@ void cpart_servo::ReadPropertiesWindow(CPWindow* WProp) {
 
 void cpart_servo::LoadImage(void) {
     if (SpareParts.GetWindow()) {
-        lxImage image(SpareParts.GetWindow());
-        image.LoadFile(lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/") + Type + "/" + GetPictureFileName()),
-                       Orientation, Scale, Scale);
+        lxImage* picture = LoadPicture();
 
-        Bitmap = new lxBitmap(&image, (SpareParts.GetWindow()));
-        image.Destroy();
-
-        image.LoadFile(lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/") + Type + "/" + GetPictureFileName()),
-                       Orientation, Scale, Scale);
+        Bitmap = new lxBitmap(picture, (SpareParts.GetWindow()));
 
         if (BackGround) {
             delete BackGround;
         }
-        BackGround = new lxBitmap(&image, (SpareParts.GetWindow()));
-        image.Destroy();
+        BackGround = new lxBitmap(picture, (SpareParts.GetWindow()));
 
         canvas.Destroy();
         canvas.Create(SpareParts.GetWindow()->GetWWidget(), Bitmap);
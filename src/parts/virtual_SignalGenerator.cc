@@ -164,8 +164,7 @@ void cpart_SignalGenerator::DrawOutput(const unsigned int i) {
 }
 
 void cpart_SignalGenerator::PreProcess(void) {
-    JUMPSTEPS_ = (pboard->MGetInstClockFreq() / 250000);
-    mcount = JUMPSTEPS_;
+    SetSamplePeriod_us(4);  // 250kHz output update
 
     freq = (maxfreq * values[1] / 200.0);
     ampl = (5.0 * values[0] / 200.0);
@@ -173,39 +172,34 @@ void cpart_SignalGenerator::PreProcess(void) {
 }
 
 void cpart_SignalGenerator::Process(void) {
-    mcount++;
-
-    if (mcount > JUMPSTEPS_) {
-        float v = 0;
-        float wt = freq * 2.0 * M_PI * ts;
-
-        switch (type) {
-            case 0:
-                v = (ampl * sin(wt)) + offs;
-                break;
-            case 1:
-                v = ((sin(wt) > 0) - 0.5) * 2 * ampl + offs;
-                break;
-            case 2:
-                v = ((acos(sin(wt)) / 1.5708) - 1) * ampl + offs;
-                break;
-        }
-        ts += 4e-6;
-
-        if (wt >= 2.0 * M_PI) {
-            ts = ts - (1.0 / freq);
-        }
-
-        SpareParts.SetAPin(input_pins[0], v);
-        SpareParts.SetAPin(input_pins[1], v);
-
-        unsigned char vald = v > offs;
-        if (vald != lastd) {
-            lastd = vald;
-            SpareParts.SetPin(input_pins[0], vald);
-            SpareParts.SetPin(input_pins[1], vald);
-        }
-        mcount = 1;
+    float v = 0;
+    float wt = freq * 2.0 * M_PI * ts;
+
+    switch (type) {
+        case 0:
+            v = (ampl * sin(wt)) + offs;
+            break;
+        case 1:
+            v = ((sin(wt) > 0) - 0.5) * 2 * ampl + offs;
+            break;
+        case 2:
+            v = ((acos(sin(wt)) / 1.5708) - 1) * ampl + offs;
+            break;
+    }
+    ts += 4e-6;
+
+    if (wt >= 2.0 * M_PI) {
+        ts = ts - (1.0 / freq);
+    }
+
+    SpareParts.SetAPin(input_pins[0], v);
+    SpareParts.SetAPin(input_pins[1], v);
+
+    unsigned char vald = v > offs;
+    if (vald != lastd) {
+        lastd = vald;
+        SpareParts.SetPin(input_pins[0], vald);
+        SpareParts.SetPin(input_pins[1], vald);
     }
 }
 
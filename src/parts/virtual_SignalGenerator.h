@@ -56,8 +56,6 @@ private:
     unsigned char active[3];
     unsigned char type;
     float ts;
-    long int mcount;
-    int JUMPSTEPS_;
     float freq;
     float ampl;
     float offs;
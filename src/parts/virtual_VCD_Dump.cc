@@ -32,8 +32,6 @@
 #include <emscripten.h>
 #endif
 
-static const char markers[] = "!$%&[()]";
-
 /* outputs */
 enum { O_P1, O_P2, O_P3, O_P4, O_P5, O_P6, O_P7, O_P8, O_L1, O_L2, O_L3, O_L4, O_L5, O_L6, O_L7, O_L8, O_NAME, O_REC };
 
@@ -72,9 +70,8 @@ cpart_VCD_Dump::cpart_VCD_Dump(const unsigned x, const unsigned y, const char* n
 
     strncat(f_vcd_name, ".vcd", 200);
 
-    f_vcd = fopen(f_vcd_name, "w");
+    FILE* f_vcd = fopen(f_vcd_name, "w");
     fclose(f_vcd);
-    f_vcd = NULL;
 
     rec = 0;
     vcd_count = 0;
@@ -94,10 +91,7 @@ cpart_VCD_Dump::~cpart_VCD_Dump(void) {
     delete Bitmap;
     canvas.Destroy();
 
-    if (f_vcd) {
-        fclose(f_vcd);
-        f_vcd = NULL;
-    }
+    vcd.Close();
     unlink(f_vcd_name);
 }
 
@@ -286,82 +280,38 @@ void cpart_VCD_Dump::ReadPropertiesWindow(CPWindow* WProp) {
 }
 
 void cpart_VCD_Dump::PreProcess(void) {
-    if (rec && (f_vcd == NULL)) {
+    if (rec && !vcd.IsOpen()) {
         float tscale = 1.0e12 / pboard->MGetInstClockFreq();  // ps step
+        lxString names[8];
+        const char* pnames[8];
 
-        f_vcd = fopen(f_vcd_name, "w");
-        vcd_count = 0;
+        for (int i = 0; i < 8; i++) {
+            if (input_pins[i])
+                names[i] = itoa(i + 1) + lxT("-") + SpareParts.GetPinName(input_pins[i]);
+            pnames[i] = names[i].c_str();
+        }
 
-        fprintf(f_vcd,
-                "$version Generated by PICSimLab $end\n"
-                "$timescale %ips $end\n"
-                "$scope module logic $end\n",
-                (int)tscale);
-
-        if (input_pins[0])
-            fprintf(f_vcd, "$var wire 1 !  1-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[0]).c_str());
-        if (input_pins[1])
-            fprintf(f_vcd, "$var wire 1 $  2-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[1]).c_str());
-        if (input_pins[2])
-            fprintf(f_vcd, "$var wire 1 %%  3-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[2]).c_str());
-        if (input_pins[3])
-            fprintf(f_vcd, "$var wire 1 &  4-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[3]).c_str());
-        if (input_pins[4])
-            fprintf(f_vcd, "$var wire 1 [  5-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[4]).c_str());
-        if (input_pins[5])
-            fprintf(f_vcd, "$var wire 1 (  6-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[5]).c_str());
-        if (input_pins[6])
-            fprintf(f_vcd, "$var wire 1 )  7-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[6]).c_str());
-        if (input_pins[7])
-            fprintf(f_vcd, "$var wire 1 ]  8-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[7]).c_str());
-
-        fprintf(f_vcd,
-                "$upscope $end\n"
-                "$enddefinitions $end\n"
-                "$dumpvars\n");
-
-        if (input_pins[0])
-            fprintf(f_vcd, "x!\n");
-        if (input_pins[1])
-            fprintf(f_vcd, "x$\n");
-        if (input_pins[2])
-            fprintf(f_vcd, "x%%\n");
-        if (input_pins[3])
-            fprintf(f_vcd, "x&\n");
-        if (input_pins[4])
-            fprintf(f_vcd, "x[\n");
-        if (input_pins[5])
-            fprintf(f_vcd, "x(\n");
-        if (input_pins[6])
-            fprintf(f_vcd, "x)\n");
-        if (input_pins[7])
-            fprintf(f_vcd, "x[\n");
-        fprintf(f_vcd, "$end\n");
-    } else if (!rec && (f_vcd != NULL)) {
-        if (f_vcd) {
-            fclose(f_vcd);
-            f_vcd = NULL;
+        vcd.Open(f_vcd_name, (int)tscale, "logic", pnames, 8);
+        vcd_count = 0;
+        for (int i = 0; i < 8; i++) {
+            old_value_pins[i] = 2;
         }
+    } else if (!rec && vcd.IsOpen()) {
+        vcd.Close();
     }
 }
 
 void cpart_VCD_Dump::Process(void) {
-    if (rec && f_vcd) {
+    if (rec && vcd.IsOpen()) {
         const picpin* ppins = SpareParts.GetPinsValues();
 
         vcd_count++;
-        int tprint = 0;
 
         for (int i = 0; i < 8; i++) {
             if (input_pins[i] != 0) {
                 if (ppins[input_pins[i] - 1].value != old_value_pins[i]) {
-                    if (!tprint) {
-                        tprint = 1;
-                        fprintf(f_vcd, "#%li\n", vcd_count);
-                    }
                     old_value_pins[i] = ppins[input_pins[i] - 1].value;
-                    fprintf(f_vcd, "%i%c\n", old_value_pins[i], markers[i]);
-                    fflush(f_vcd);
+                    vcd.Add(vcd_count, i, old_value_pins[i]);  // formatted and written by the writer thread
                 }
             }
         }
@@ -386,6 +336,7 @@ void cpart_VCD_Dump::OnMouseButtonPress(uint inputId, uint button, uint x, uint
             output_ids[O_REC]->update = 1;
             break;
         case I_VIEW:
+            vcd.Sync();
 #ifdef __EMSCRIPTEN__
             EM_ASM_(
                 {
@@ -28,6 +28,7 @@
 
 #include <lxrad.h>
 #include "../lib/part.h"
+#include "../lib/vcdwriter.h"
 
 #define PART_VCD_DUMP_Name "VCD Dump"
 
@@ -53,7 +54,7 @@ private:
     unsigned char input_pins[8];
     unsigned char old_value_pins[8];
     char f_vcd_name[200];
-    FILE* f_vcd;
+    CVCDWriter vcd;
     unsigned long vcd_count;
     unsigned char rec;
     lxFont font;
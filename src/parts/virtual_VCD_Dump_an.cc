@@ -32,8 +32,6 @@
 #include <emscripten.h>
 #endif
 
-static const char markers[] = "!$%&[()]";
-
 /* outputs */
 enum { O_P1, O_P2, O_P3, O_P4, O_P5, O_P6, O_P7, O_P8, O_L1, O_L2, O_L3, O_L4, O_L5, O_L6, O_L7, O_L8, O_NAME, O_REC };
 
@@ -70,11 +68,12 @@ cpart_VCD_Dump_an::cpart_VCD_Dump_an(const unsigned x, const unsigned y, const c
     close(mkstemp(f_vcd_name));
     unlink(f_vcd_name);
 
+    strncpy(f_rec_name, f_vcd_name, 200);
     strncat(f_vcd_name, ".vcd", 200);
+    strncat(f_rec_name, ".psa", 200);
 
-    f_vcd = fopen(f_vcd_name, "w");
+    FILE* f_vcd = fopen(f_vcd_name, "w");
     fclose(f_vcd);
-    f_vcd = NULL;
 
     rec = 0;
     vcd_count = 0;
@@ -94,10 +93,9 @@ cpart_VCD_Dump_an::~cpart_VCD_Dump_an(void) {
     delete Bitmap;
     canvas.Destroy();
 
-    if (f_vcd) {
-        fclose(f_vcd);
-        f_vcd = NULL;
-    }
+    recorder.Close();
+    recorder.Sync();
+    unlink(f_rec_name);
     unlink(f_vcd_name);
 }
 
@@ -290,75 +288,45 @@ void cpart_VCD_Dump_an::ReadPropertiesWindow(CPWindow* WProp) {
 }
 
 void cpart_VCD_Dump_an::PreProcess(void) {
-    if (rec && (f_vcd == NULL)) {
-        float tscale = 1.0e12 / pboard->MGetInstClockFreq();  // ns step
+    if (rec && !recorder.IsOpen()) {
+        lxString names[8];
+        const char* pnames[8];
 
-        f_vcd = fopen(f_vcd_name, "w");
-        vcd_count = 0;
+        for (int i = 0; i < 8; i++) {
+            if (input_pins[i])
+                names[i] = itoa(i + 1) + lxT("-") + SpareParts.GetPinName(input_pins[i]);
+            pnames[i] = names[i].c_str();
+        }
 
-        fprintf(f_vcd,
-                "$version Generated by PICSimLab $end\n"
-                "$timescale %ips $end\n"
-                "$scope module analogic $end\n",
-                (int)tscale);
-
-        if (input_pins[0])
-            fprintf(f_vcd, "$var real 32 !  1-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[0]).c_str());
-        if (input_pins[1])
-            fprintf(f_vcd, "$var real 32 $  2-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[1]).c_str());
-        if (input_pins[2])
-            fprintf(f_vcd, "$var real 32 %%  3-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[2]).c_str());
-        if (input_pins[3])
-            fprintf(f_vcd, "$var real 32 &  4-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[3]).c_str());
-        if (input_pins[4])
-            fprintf(f_vcd, "$var real 32 [  5-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[4]).c_str());
-        if (input_pins[5])
-            fprintf(f_vcd, "$var real 32 (  6-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[5]).c_str());
-        if (input_pins[6])
-            fprintf(f_vcd, "$var real 32 )  7-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[6]).c_str());
-        if (input_pins[7])
-            fprintf(f_vcd, "$var real 32 ]  8-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[7]).c_str());
-
-        fprintf(f_vcd,
-                "$upscope $end\n"
-                "$enddefinitions $end\n");
-    } else if (!rec && (f_vcd != NULL)) {
-        if (f_vcd) {
-            fclose(f_vcd);
-            f_vcd = NULL;
+        // samples are streamed to a binary record, the VCD is exported when recording stops
+        recorder.Open(f_rec_name, ANREC_CHANGES, 8, pnames, 1.0 / pboard->MGetInstClockFreq(), 1);
+        vcd_count = 0;
+        for (int i = 0; i < 8; i++) {
+            old_value_pins[i] = 2;
         }
+    } else if (!rec && recorder.IsOpen()) {
+        recorder.Close(f_vcd_name);
     }
 }
 
 void cpart_VCD_Dump_an::Process(void) {
-    if (rec && f_vcd) {
+    if (rec && recorder.IsOpen()) {
         const picpin* ppins = SpareParts.GetPinsValues();
 
         vcd_count++;
-        int tprint = 0;
 
         for (int i = 0; i < 8; i++) {
             if (input_pins[i] != 0) {
                 if (ppins[input_pins[i] - 1].dir == PD_IN) {
                     if (ppins[input_pins[i] - 1].avalue != old_value_pins[i]) {
-                        if (!tprint) {
-                            tprint = 1;
-                            fprintf(f_vcd, "#%li\n", vcd_count);
-                        }
                         old_value_pins[i] = ppins[input_pins[i] - 1].avalue;
-                        fprintf(f_vcd, "r%f %c\n", old_value_pins[i], markers[i]);
-                        fflush(f_vcd);
+                        recorder.AddChange(vcd_count, i, old_value_pins[i]);
                     }
                 } else  // out
                 {
                     if (ppins[input_pins[i] - 1].oavalue != old_value_pins[i]) {
-                        if (!tprint) {
-                            tprint = 1;
-                            fprintf(f_vcd, "#%li\n", vcd_count);
-                        }
                         old_value_pins[i] = ppins[input_pins[i] - 1].oavalue;
-                        fprintf(f_vcd, "r%f %c\n", old_value_pins[i] / 51, markers[i]);
-                        fflush(f_vcd);
+                        recorder.AddChange(vcd_count, i, old_value_pins[i] / 51);
                     }
                 }
             }
@@ -384,6 +352,15 @@ void cpart_VCD_Dump_an::OnMouseButtonPress(uint inputId, uint button, uint x, ui
             output_ids[O_REC]->update = 1;
             break;
         case I_VIEW:
+            if (recorder.IsOpen()) {
+                // export what was recorded until now, the simulation is paused to write the block being filled
+                const int run = PICSimLab.PauseSimulation();
+                recorder.Flush();
+                PICSimLab.SetSimulationRun(run);
+                anrec_export_vcd(f_rec_name, f_vcd_name);
+            } else {
+                recorder.Sync();  // wait the export of last record
+            }
 #ifdef __EMSCRIPTEN__
             EM_ASM_(
                 {
@@ -27,6 +27,7 @@
 #define PART_VCD_DUMP_AN_H
 
 #include <lxrad.h>
+#include "../lib/anrecorder.h"
 #include "../lib/part.h"
 
 #define PART_VCD_DUMP_AN_Name "VCD Dump (Analogic)"
@@ -56,7 +57,8 @@ private:
     unsigned char input_pins[8];
     float old_value_pins[8];
     char f_vcd_name[200];
-    FILE* f_vcd;
+    char f_rec_name[200];
+    CAnRecorder recorder;
     unsigned long vcd_count;
     unsigned char rec;
     lxFont font;
@@ -38,9 +38,10 @@ enum { O_P1, O_P2, O_P3, O_P4, O_P5, O_P6, O_P7, O_P8, O_L1, O_L2, O_L3, O_L4, O
 /*inputs*/
 enum { I_PLAY, I_VIEW, I_LOAD };
 
-static PCWProp pcwprop[9] = {{PCW_COMBO, "Pin 1"}, {PCW_COMBO, "Pin 2"}, {PCW_COMBO, "Pin 3"},
-                             {PCW_COMBO, "Pin 4"}, {PCW_COMBO, "Pin 5"}, {PCW_COMBO, "Pin 6"},
-                             {PCW_COMBO, "Pin 7"}, {PCW_COMBO, "Pin 8"}, {PCW_END, ""}};
+static PCWProp pcwprop[11] = {{PCW_COMBO, "Pin 1"}, {PCW_COMBO, "Pin 2"}, {PCW_COMBO, "Pin 3"},
+                              {PCW_COMBO, "Pin 4"}, {PCW_COMBO, "Pin 5"}, {PCW_COMBO, "Pin 6"},
+                              {PCW_COMBO, "Pin 7"}, {PCW_COMBO, "Pin 8"}, {PCW_COMBO, "Loop"},
+                              {PCW_SPIND, "Start(ms)"}, {PCW_END, ""}};
 
 cpart_VCD_Play::cpart_VCD_Play(const unsigned x, const unsigned y, const char* name, const char* type, board* pboard_)
     : part(x, y, name, type, pboard_), font(9, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
@@ -59,12 +60,14 @@ cpart_VCD_Play::cpart_VCD_Play(const unsigned x, const unsigned y, const char* n
     f_vcd_name[1] = 0;
 
     play = 0;
+    loop = 1;
+    start_ms = 0;
+    active = 0;
 
-    vcd_data = NULL;
-    vcd_data_count = 0;
-    vcd_count = 0;
+    vcd_now = 0;
+    vcd_next = 0;
+    vcd_inc = 0;
     vcd_ptr = 0;
-    vcd_step = 0;
 
     SetPCWProperties(pcwprop);
 
@@ -80,10 +83,6 @@ void cpart_VCD_Play::RegisterRemoteControl(void) {
 cpart_VCD_Play::~cpart_VCD_Play(void) {
     delete Bitmap;
     canvas.Destroy();
-    if (vcd_data) {
-        free(vcd_data);
-        vcd_data = NULL;
-    }
 }
 
 void cpart_VCD_Play::DrawOutput(const unsigned int i) {
@@ -237,17 +236,25 @@ unsigned short cpart_VCD_Play::GetOutputId(char* name) {
 }
 
 lxString cpart_VCD_Play::WritePreferences(void) {
-    char prefs[256];
-    sprintf(prefs, "%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%s", output_pins[0], output_pins[1], output_pins[2],
-            output_pins[3], output_pins[4], output_pins[5], output_pins[6], output_pins[7], play, f_vcd_name);
+    char prefs[300];
+    sprintf(prefs, "%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%f,%s", output_pins[0], output_pins[1],
+            output_pins[2], output_pins[3], output_pins[4], output_pins[5], output_pins[6], output_pins[7], play, loop,
+            start_ms, f_vcd_name);
 
     return prefs;
 }
 
 void cpart_VCD_Play::ReadPreferences(lxString value) {
-    sscanf(value.c_str(), "%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%s", &output_pins[0], &output_pins[1],
-           &output_pins[2], &output_pins[3], &output_pins[4], &output_pins[5], &output_pins[6], &output_pins[7], &play,
-           f_vcd_name);
+    if (sscanf(value.c_str(), "%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%f,%s", &output_pins[0],
+               &output_pins[1], &output_pins[2], &output_pins[3], &output_pins[4], &output_pins[5], &output_pins[6],
+               &output_pins[7], &play, &loop, &start_ms, f_vcd_name) != 12) {
+        // old format without loop and start
+        sscanf(value.c_str(), "%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%s", &output_pins[0], &output_pins[1],
+               &output_pins[2], &output_pins[3], &output_pins[4], &output_pins[5], &output_pins[6], &output_pins[7],
+               &play, f_vcd_name);
+        loop = 1;
+        start_ms = 0;
+    }
 
     if (f_vcd_name[0] != '*') {
         if (!strncmp(f_vcd_name, "/tmp/picsimlab_workspace/", 25)) {
@@ -280,6 +287,19 @@ void cpart_VCD_Play::ConfigurePropertiesWindow(CPWindow* WProp) {
     SetPCWComboWithPinNames(WProp, "combo6", output_pins[5]);
     SetPCWComboWithPinNames(WProp, "combo7", output_pins[6]);
     SetPCWComboWithPinNames(WProp, "combo8", output_pins[7]);
+
+    CCombo* combo = (CCombo*)WProp->GetChildByName("combo9");
+    combo->SetItems("ON,OFF,");
+    if (loop) {
+        combo->SetText("ON");
+    } else {
+        combo->SetText("OFF");
+    }
+
+    CSpind* spind = (CSpind*)WProp->GetChildByName("spind10");
+    spind->SetMin(0);
+    spind->SetMax(1e6);
+    spind->SetValue(start_ms);
 }
 
 void cpart_VCD_Play::ReadPropertiesWindow(CPWindow* WProp) {
@@ -291,50 +311,61 @@ void cpart_VCD_Play::ReadPropertiesWindow(CPWindow* WProp) {
     output_pins[5] = GetPWCComboSelectedPin(WProp, "combo6");
     output_pins[6] = GetPWCComboSelectedPin(WProp, "combo7");
     output_pins[7] = GetPWCComboSelectedPin(WProp, "combo8");
+
+    loop = (((CCombo*)WProp->GetChildByName("combo9"))->GetText().compare("ON") == 0);
+    start_ms = ((CSpind*)WProp->GetChildByName("spind10"))->GetValue();
+    active = 0;  // restart at the new position
 }
 
 void cpart_VCD_Play::PreProcess(void) {
-    vcd_inc = 1.0 / ((timescale * 1e-12) * pboard->MGetInstClockFreq());
+    vcd_inc = 1.0 / (vcd.GetTimescale() * pboard->MGetInstClockFreq());
 }
 
-void cpart_VCD_Play::Process(void) {
-    if (play) {
-        if (vcd_data[vcd_ptr].count <= vcd_count) {
-            SpareParts.SetPin(output_pins[0], (vcd_data[vcd_ptr].data & 0x01) > 0);
-            SpareParts.SetPin(output_pins[1], (vcd_data[vcd_ptr].data & 0x02) > 0);
-            SpareParts.SetPin(output_pins[2], (vcd_data[vcd_ptr].data & 0x04) > 0);
-            SpareParts.SetPin(output_pins[3], (vcd_data[vcd_ptr].data & 0x08) > 0);
-            SpareParts.SetPin(output_pins[4], (vcd_data[vcd_ptr].data & 0x10) > 0);
-            SpareParts.SetPin(output_pins[5], (vcd_data[vcd_ptr].data & 0x20) > 0);
-            SpareParts.SetPin(output_pins[6], (vcd_data[vcd_ptr].data & 0x40) > 0);
-            SpareParts.SetPin(output_pins[7], (vcd_data[vcd_ptr].data & 0x80) > 0);
-            vcd_ptr++;
-            if (vcd_ptr >= vcd_data_count) {
-                vcd_ptr = 0;
-                vcd_count = 0;
-            }
-        }
+void cpart_VCD_Play::Output(const unsigned char data) {
+    SpareParts.SetPin(output_pins[0], (data & 0x01) > 0);
+    SpareParts.SetPin(output_pins[1], (data & 0x02) > 0);
+    SpareParts.SetPin(output_pins[2], (data & 0x04) > 0);
+    SpareParts.SetPin(output_pins[3], (data & 0x08) > 0);
+    SpareParts.SetPin(output_pins[4], (data & 0x10) > 0);
+    SpareParts.SetPin(output_pins[5], (data & 0x20) > 0);
+    SpareParts.SetPin(output_pins[6], (data & 0x40) > 0);
+    SpareParts.SetPin(output_pins[7], (data & 0x80) > 0);
+}
+
+void cpart_VCD_Play::Seek(const double time) {
+    vcd_ptr = vcd.Find((uint64_t)time);
+    Output(vcd_ptr ? vcd.GetData(vcd_ptr - 1) : 0);
+    vcd_now = time;
+    vcd_next = (vcd_ptr < vcd.GetCount()) ? vcd.GetTime(vcd_ptr) : vcd.GetEnd();
+}
 
-        vcd_step += vcd_inc;
-        if (vcd_step >= 1) {
-            vcd_count += (int)(vcd_step + 0.5);
-            vcd_step = 0;
+void cpart_VCD_Play::Process(void) {
+    if (play && vcd.GetCount()) {
+        if (!active) {
+            Seek((start_ms * 1e-3) / vcd.GetTimescale());
+            active = 1;
         }
-    } else {
-        if (vcd_count) {
-            SpareParts.SetPin(output_pins[0], 0);
-            SpareParts.SetPin(output_pins[1], 0);
-            SpareParts.SetPin(output_pins[2], 0);
-            SpareParts.SetPin(output_pins[3], 0);
-            SpareParts.SetPin(output_pins[4], 0);
-            SpareParts.SetPin(output_pins[5], 0);
-            SpareParts.SetPin(output_pins[6], 0);
-            SpareParts.SetPin(output_pins[7], 0);
+        // the events are pre-indexed, only a compare is done until the next one
+        if (vcd_now >= vcd_next) {
+            const uint64_t count = vcd.GetCount();
+            if (vcd_ptr < count) {
+                unsigned char data;
+                do {
+                    data = vcd.GetData(vcd_ptr++);
+                } while ((vcd_ptr < count) && (vcd.GetTime(vcd_ptr) <= vcd_now));
+                Output(data);
+                vcd_next = (vcd_ptr < count) ? vcd.GetTime(vcd_ptr) : vcd.GetEnd();
+            } else if (loop) {
+                Seek((start_ms * 1e-3) / vcd.GetTimescale());
+            } else {
+                play = 0;
+                output_ids[O_PLAY]->update = 1;
+            }
         }
-
-        vcd_count = 0;
-        vcd_ptr = 0;
-        vcd_step = 0;
+        vcd_now += vcd_inc;
+    } else if (active) {
+        Output(0);
+        active = 0;
     }
 }
 
@@ -410,98 +441,17 @@ void cpart_VCD_Play::filedialog_EvOnClose(int retId) {
 }
 
 int cpart_VCD_Play::LoadVCD(lxString fname) {
-    FILE* fvcd;
-    fvcd = fopen(fname.c_str(), "r");
-    char buff[256];
-    int data = 0;
-    char* id;
-    char* value;
-    char signal[8] = {0, 0, 0, 0, 0, 0, 0, 0};
-    int signal_count = 0;
     unsigned char old_play = play;
 
     play = 0;
-    vcd_data_count = 0;
-
-    unsigned int vcd_count_ = -1;
-
-    if (vcd_data) {
-        free(vcd_data);
-        vcd_data = NULL;
-    }
-
-    if (fvcd) {
-        while (fgets(buff, 255, fvcd)) {
-            if (buff[0] == '#') {
-                vcd_data_count++;
-            }
-
-            if (!data)  // option read
-            {
-                id = strtok(buff, " \n\r");
-                if (!strcmp(id, "$timescale")) {
-                    int itimescale;
-                    value = strtok(NULL, " ");
-                    sscanf(value, "%ips", &itimescale);
-                    timescale = itimescale;
-                } else if (!strcmp(id, "$var")) {
-                    value = strtok(NULL, " ");  // wire
-                    value = strtok(NULL, " ");  // 1
-                    value = strtok(NULL, " ");  // const
-                    signal[signal_count++] = value[0];
-                } else if (!strcmp(id, "$end") || (id[0] == '#')) {
-                    data = 1;
-                }
-            }
-        }
-        vcd_data_count--;
-
-        vcd_data = (vcd_reg_t*)malloc((vcd_data_count + 1) * sizeof(vcd_reg_t));
-
-        if (!vcd_data) {
-            printf("vcd_play: malloc error \n");
-            fclose(fvcd);
-            return 0;
-        }
+    active = 0;
 
-        rewind(fvcd);
-
-        data = 0;
-        while (fgets(buff, 255, fvcd)) {
-            if (!data)  // option read
-            {
-                id = strtok(buff, " \n\r");
-                if (!strcmp(id, "$end") || (id[0] == '#')) {
-                    data = 1;
-                }
-            } else  // data read
-            {
-                if (buff[0] == '#') {
-                    vcd_count_++;
-                    sscanf(buff + 1, "%lu", &vcd_data[vcd_count_].count);
-                } else {
-                    for (int i = 0; i < 8; i++) {
-                        if (signal[i] == buff[1]) {
-                            if (buff[0] == '1') {
-                                vcd_data[vcd_count_].data |= (1 << i);
-                                break;
-                            } else {
-                                vcd_data[vcd_count_].data &= ~(1 << i);
-                                break;
-                            }
-                        }
-                    }
-                }
-            }
-        }
-        fclose(fvcd);
-        vcd_count = 0;
-        vcd_ptr = 0;
-        vcd_step = 0;
-        play = old_play;
-    } else {
+    if (vcd.Open(fname.c_str())) {
         printf("vcd play: Error open file %s\n", (const char*)fname.c_str());
+        return 0;
     }
+    vcd_inc = 1.0 / (vcd.GetTimescale() * pboard->MGetInstClockFreq());
+    play = old_play;
     return 0;
 }
 
@@ -28,14 +28,10 @@
 
 #include <lxrad.h>
 #include "../lib/part.h"
+#include "../lib/vcdindex.h"
 
 #define PART_VCD_Play_Name "VCD Play"
 
-typedef struct {
-    unsigned long count;
-    unsigned char data;
-} vcd_reg_t;
-
 class cpart_VCD_Play : public part {
 public:
     lxString GetAboutInfo(void) override { return lxT("L.C. Gamboa \n <lcgamboa@yahoo.com>"); };
@@ -57,16 +53,19 @@ public:
 
 private:
     void RegisterRemoteControl(void) override;
+    void Seek(const double time);
+    void Output(const unsigned char data);
     unsigned char output_pins[8];
     char f_vcd_name[200];
     unsigned char play;
-    float timescale;
-    unsigned long vcd_count;
-    float vcd_inc;
-    float vcd_step;
-    vcd_reg_t* vcd_data;
-    int vcd_data_count;
-    int vcd_ptr;
+    unsigned char loop;  // restart at end of file
+    float start_ms;      // playback start position
+    int active;          // playing since the last seek
+    CVCDIndex vcd;
+    double vcd_now;    // current time in VCD units
+    double vcd_next;   // time of next event (or end of file) in VCD units
+    double vcd_inc;    // VCD units per instruction
+    uint64_t vcd_ptr;  // next event
     lxFont font;
     lxColor color1;
     lxColor color2;
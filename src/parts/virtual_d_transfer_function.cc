@@ -52,8 +52,6 @@ cpart_dtfunc::cpart_dtfunc(const unsigned x, const unsigned y, const char* name,
     out_gain = 0.01;
     out_off = 0.27;
 
-    nsamples = sample * pboard->MGetInstClockFreq();
-
     refresh = 0;
 
     SetPCWProperties(pcwprop);
@@ -140,40 +138,35 @@ void cpart_dtfunc::DrawOutput(const unsigned int i) {
 }
 
 void cpart_dtfunc::PreProcess(void) {
-    nsamples = sample * pboard->MGetInstClockFreq();
+    SetSamplePeriod_us(sample * 1e6);
 }
 
 void cpart_dtfunc::Process(void) {
-    if (refresh > nsamples) {
-        refresh = 0;
-
-        const picpin* ppins = SpareParts.GetPinsValues();
+    const picpin* ppins = SpareParts.GetPinsValues();
 
-        float in, out, pinv;
+    float in, out, pinv;
 
-        if (pins[0] == 0)
-            return;
-        pinv = (ppins[pins[0] - 1].oavalue - 30) * 0.022502250225;
-        // pinv = (ppins[pins[0] - 1].value) *5.0;
+    if (pins[0] == 0)
+        return;
+    pinv = (ppins[pins[0] - 1].oavalue - 30) * 0.022502250225;
+    // pinv = (ppins[pins[0] - 1].value) *5.0;
 
-        in = pinv * in_gain + in_off;
+    in = pinv * in_gain + in_off;
 
-        v[3] = v[2];
-        v[2] = v[1];
-        v[1] = v[0];
-        v[0] = in - den[1] * v[1] - den[2] * v[2] - den[3] * v[3];
-        out = v[0] * num[0] + v[1] * num[1] + v[2] * num[2] + v[3] * num[3];
+    v[3] = v[2];
+    v[2] = v[1];
+    v[1] = v[0];
+    v[0] = in - den[1] * v[1] - den[2] * v[2] - den[3] * v[3];
+    out = v[0] * num[0] + v[1] * num[1] + v[2] * num[2] + v[3] * num[3];
 
-        out = out * out_gain + out_off;
+    out = out * out_gain + out_off;
 
-        if (out < 0.0)
-            out = 0.0;
-        if (out > 5.0)
-            out = 5.0;
+    if (out < 0.0)
+        out = 0.0;
+    if (out > 5.0)
+        out = 5.0;
 
-        SpareParts.SetAPin(pins[1], out);
-    }
-    refresh++;
+    SpareParts.SetAPin(pins[1], out);
 }
 
 void cpart_dtfunc::Reset(void) {
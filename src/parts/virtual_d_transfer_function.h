@@ -61,7 +61,6 @@ private:
     float in_off;
     float out_gain;
     float out_off;
-    long unsigned int nsamples;
     lxFont font;
 };
 
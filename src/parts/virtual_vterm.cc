@@ -110,6 +110,7 @@ cpart_vterm::cpart_vterm(const unsigned x, const unsigned y, const char* name, c
 
     PinCount = 2;
     Pins = pins;
+    SetPinSensitive(0);  // terminal data is sent without pin changes
 
     pins[0] = pboard->GetUARTTX(count);
     pins[1] = pboard->GetUARTRX(count);
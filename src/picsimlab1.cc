@@ -44,10 +44,15 @@ CPWindow1 Window1;
 #include "picsimlab4.h"
 #include "picsimlab5.h"
 
+#include "lib/imagecache.h"
 #include "lib/oscilloscope.h"
+#include "lib/pacer.h"
 #include "lib/spareparts.h"
 
 #include "lib/rcontrol.h"
+#include "lib/simcontext.h"
+
+#include <math.h>
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
@@ -73,25 +78,27 @@ int prog_end(void);
 static lxString cvt_fname;
 #endif
 
+static CSimBatch SimBatch;  // parallel batch workers
+
 #ifdef _WIN_
 
-double cpuTime() {
-    FILETIME a, b, c, d;
-    if (GetProcessTimes(GetCurrentProcess(), &a, &b, &c, &d) != 0) {
-        //  Returns total user time.
-        //  Can be tweaked to include kernel times as well.
-        return (double)(d.dwLowDateTime | ((unsigned long long)d.dwHighDateTime << 32)) * 0.0000001;
-    } else {
-        //  Handle error
-        return 0;
+double wallTime() {
+    static LARGE_INTEGER freq = {0};
+    LARGE_INTEGER count;
+    if (!freq.QuadPart) {
+        QueryPerformanceFrequency(&freq);
     }
+    QueryPerformanceCounter(&count);
+    return ((double)count.QuadPart) / freq.QuadPart;
 }
 #else
 #include <sys/time.h>
 #include <time.h>
 
-double cpuTime() {
-    return (double)clock() / CLOCKS_PER_SEC;
+double wallTime() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
 }
 #endif
 
@@ -107,11 +114,28 @@ void CPWindow1::timer1_EvOnTime(CControl* control) {
     PICSimLab.SetSync(1);
     PICSimLab.status.st[0] |= ST_T1;
 
+    if (PICSimLab.GetUnthrottled()) {
+        // cpu thread runs free, only refresh the board at BASETIMER rate
+        if (timer1.GetTime() != BASETIMER) {
+            timer1.SetTime(BASETIMER);
+        }
+        if (crt) {
+            label2.SetColor(SystemColor(lxCOLOR_WINDOWTEXT));
+            label2.Draw();
+        }
+        crt = 0;
+        DrawBoard();
+        PICSimLab.status.st[0] &= ~ST_T1;
+        return;
+    }
+
+    const int runs = Pacer.Tick(wallTime(), PICSimLab.tgo, PICSimLab.GetSimTime());
+
 #ifdef _NOTHREAD
     // printf ("overtimer = %i \n", timer1.GetOverTime ());
     if (timer1.GetOverTime() < BASETIMER)
 #else
-    if ((!PICSimLab.tgo) && (timer1.GetTime() == BASETIMER))
+    if (Pacer.GetRatio() >= 1.0)
 #endif
     {
         if (crt) {
@@ -127,32 +151,17 @@ void CPWindow1::timer1_EvOnTime(CControl* control) {
         crt = 1;
     }
 
-    if (!PICSimLab.tgo) {
-        zerocount++;
-
-        if (zerocount > 3) {
-            zerocount = 0;
-
-            if (timer1.GetTime() > BASETIMER) {
-                timer1.SetTime(timer1.GetTime() - 5);
-            }
-        }
-    } else {
-        zerocount = 0;
-    }
-
-    PICSimLab.tgo++;
+    if (runs) {
+        PICSimLab.tgo += runs;
 #ifndef _NOTHREAD
-    PICSimLab.cpu_mutex->Lock();
-    PICSimLab.cpu_cond->Signal();
-    PICSimLab.cpu_mutex->Unlock();
+        PICSimLab.cpu_mutex->Lock();
+        PICSimLab.cpu_cond->Signal();
+        PICSimLab.cpu_mutex->Unlock();
 #endif
+    }
 
-    if (PICSimLab.tgo > 3) {
-        if (timer1.GetTime() < 330) {
-            timer1.SetTime(timer1.GetTime() + 5);
-        }
-        PICSimLab.tgo = 1;
+    if (timer1.GetTime() != Pacer.GetPeriod()) {
+        timer1.SetTime(Pacer.GetPeriod());
     }
 
     DrawBoard();
@@ -181,7 +190,8 @@ void CPWindow1::DrawBoard(void) {
         else
             scale_temp = scaley;
 
-        if (PICSimLab.GetScale() != scale_temp) {
+        // reload the picture only if scale changes more than 1/100
+        if (lround(PICSimLab.GetScale() * 100) != lround(scale_temp * 100)) {
             PICSimLab.SetScale(scale_temp);
 
             int nw = (PICSimLab.plWidth * PICSimLab.GetScale());
@@ -228,17 +238,44 @@ void CPWindow1::DrawBoard(void) {
 void CPWindow1::thread1_EvThreadRun(CControl*) {
     double t0, t1, etime;
     do {
-        if (PICSimLab.tgo) {
-            t0 = cpuTime();
+        if (PICSimLab.GetUnthrottled() && !(PICSimLab.status.st[0] & ST_DI)) {
+            // run back to back during one BASETIMER slice, without wait timer1
+            int runs = 0;
+            t0 = wallTime();
+            t1 = t0;
+            PICSimLab.status.st[1] |= ST_TH;
+            while (((t1 - t0) < (BASETIMER * 1e-3)) && PICSimLab.GetUnthrottled() && PICSimLab.EnterCPU()) {
+                PICSimLab.GetBoard()->Run_CPU();
+                if (PICSimLab.GetDebugStatus())
+                    PICSimLab.GetBoard()->DebugLoop();
+                PICSimLab.LeaveCPU();
+                PICSimLab.IncSimRuns();
+                runs++;
+                t1 = wallTime();
+            }
+            PICSimLab.status.st[1] &= ~ST_TH;
+            PICSimLab.tgo = 0;
+            if (runs) {
+                PICSimLab.SetRealTimeFactor((runs * BASETIMER * 1e-3) / (t1 - t0));
+            }
+            PICSimLab.SetIdleMs(0);
+        } else if (PICSimLab.tgo) {
+            t0 = wallTime();
 
             PICSimLab.status.st[1] |= ST_TH;
-            PICSimLab.GetBoard()->Run_CPU();
-            if (PICSimLab.GetDebugStatus())
-                PICSimLab.GetBoard()->DebugLoop();
-            PICSimLab.tgo--;
+            if (PICSimLab.EnterCPU()) {
+                PICSimLab.GetBoard()->Run_CPU();
+                if (PICSimLab.GetDebugStatus())
+                    PICSimLab.GetBoard()->DebugLoop();
+                PICSimLab.LeaveCPU();
+                PICSimLab.IncSimRuns();
+                PICSimLab.tgo--;
+            } else {
+                PICSimLab.tgo = 0;  // paused, drop the pending runs
+            }
             PICSimLab.status.st[1] &= ~ST_TH;
 
-            t1 = cpuTime();
+            t1 = wallTime();
 
 #if defined(_NOTHREAD)
             /*
@@ -254,11 +291,11 @@ void CPWindow1::thread1_EvThreadRun(CControl*) {
             PICSimLab.tgo = 0;
 #endif
             etime = t1 - t0;
-            PICSimLab.SetIdleMs((PICSimLab.GetIdleMs() * 0.9) + ((Window1.timer1.GetTime() - etime * 1000) * 0.1));
+            Pacer.RunDone(etime);
+            PICSimLab.SetIdleMs(Pacer.GetPeriod() - etime * 1000);
 #ifdef TDEBUG
-            float ld = (etime) / (Window1.timer1.GetTime() * 1e-5);
-            printf("PTime= %lf  tgo= %2i  zeroc= %2i  Timer= %3u Perc.= %5.1lf Idle= %5.1lf\n", etime, tgo, zerocount,
-                   Window1.timer1.GetTime(), ld, PICSimLab.GetIdleMs());
+            printf("PTime= %lf  tgo= %2i  Timer= %3u Load= %5.3lf Lag= %6.1lf Idle= %5.1lf\n", etime,
+                   PICSimLab.tgo, Window1.timer1.GetTime(), Pacer.GetLoad(), Pacer.GetLag(), PICSimLab.GetIdleMs());
 #endif
             if (PICSimLab.GetIdleMs() < 0)
                 PICSimLab.SetIdleMs(0);
@@ -317,7 +354,14 @@ void CPWindow1::timer2_EvOnTime(CControl* control) {
         }
     }
 
-    label2.SetText(lxString().Format("Spd: %3.2fx", ((float)BASETIMER) / timer1.GetTime()));
+    if (PICSimLab.GetUnthrottled()) {
+        label2.SetText(lxString().Format("Spd: %3.2fx*", PICSimLab.GetRealTimeFactor()));
+        statusbar1.SetField(3, lxT(" "));
+    } else {
+        label2.SetText(lxString().Format("Spd: %3.2fx", ((float)BASETIMER) / timer1.GetTime()));
+        statusbar1.SetField(3, lxString().Format("Lag: %.0fms Jitter: %.1fms Overruns: %u", Pacer.GetLag(),
+                                                 Pacer.GetJitter(), Pacer.GetOverruns()));
+    }
 
     if (PICSimLab.GetErrorCount()) {
 #ifndef __EMSCRIPTEN__
@@ -335,6 +379,20 @@ void CPWindow1::timer2_EvOnTime(CControl* control) {
     }
 #endif
 
+    if (batch_time > 0) {
+        if (!batch_next) {
+            // parallel batch, the window context stays idle until the workers end
+            if (SimBatch.GetDone()) {
+                printf("PICSimLab: Batch done, %i workspaces failed\n", SimBatch.GetErrors());
+                fflush(stdout);
+                batch_time = 0;
+                PICSimLab.SetToDestroy();
+            }
+        } else if (PICSimLab.GetSimTime() >= batch_time) {
+            BatchNext();
+        }
+    }
+
     if (PICSimLab.GetToDestroy()) {
         WDestroy();
     }
@@ -344,6 +402,20 @@ void CPWindow1::timer2_EvOnTime(CControl* control) {
     }
 }
 
+void CPWindow1::BatchNext(void) {
+    printf("PICSimLab: Batch %i/%i %s done, %.2fs simulated\n", batch_next, (int)batch_list.GetLinesCount(),
+           (const char*)batch_list.GetLine(batch_next - 1).c_str(), PICSimLab.GetSimTime());
+    fflush(stdout);
+
+    if (batch_next < (int)batch_list.GetLinesCount()) {
+        PICSimLab.LoadWorkspace(batch_list.GetLine(batch_next++), 0);
+    } else {
+        batch_time = 0;
+        PICSimLab.SetWorkspaceFileName("");
+        PICSimLab.SetToDestroy();
+    }
+}
+
 void CPWindow1::draw1_EvMouseMove(CControl* control, uint button, uint x, uint y, uint state) {
     x = x / PICSimLab.GetScale();
     y = y / PICSimLab.GetScale();
@@ -776,6 +848,57 @@ void CPWindow1::_EvOnCreate(CControl* control) {
     }
     printf("\n");
 
+    // remove option flags from command line
+    for (int i = 1; i < Application->Aargc; i++) {
+        if (!strcmp(Application->Aargv[i], "--unthrottled")) {
+            PICSimLab.SetUnthrottled(1);
+            for (int j = i; j < Application->Aargc - 1; j++) {
+                Application->Aargv[j] = Application->Aargv[j + 1];
+            }
+            Application->Aargc--;
+            i--;
+        } else if (!strcmp(Application->Aargv[i], "--batch") && ((i + 1) < Application->Aargc)) {
+            batch_time = atof(Application->Aargv[i + 1]);
+            for (int j = i; j < Application->Aargc - 2; j++) {
+                Application->Aargv[j] = Application->Aargv[j + 2];
+            }
+            Application->Aargc -= 2;
+            i--;
+        } else if (!strcmp(Application->Aargv[i], "--jobs") && ((i + 1) < Application->Aargc)) {
+            batch_jobs = atoi(Application->Aargv[i + 1]);
+            for (int j = i; j < Application->Aargc - 2; j++) {
+                Application->Aargv[j] = Application->Aargv[j + 2];
+            }
+            Application->Aargc -= 2;
+            i--;
+        }
+    }
+
+    // batch mode: all remaining arguments are workspaces
+    // with --jobs N > 1 the workspaces run in headless simulation contexts on N worker threads, else they run
+    // one after another in the window context, the first one is loaded as a single .pzw file
+    if (batch_time > 0) {
+        for (int i = 1; i < Application->Aargc; i++) {
+            fn.Assign(Application->Aargv[i]);
+            fn.MakeAbsolute();
+            batch_list.AddLine(fn.GetFullPath());
+        }
+        if (!batch_list.GetLinesCount()) {
+            batch_time = 0;
+        } else if ((batch_jobs > 1) && SimBatch.Start(batch_list, batch_time, batch_jobs)) {
+            batch_next = 0;
+            Application->Aargc = 1;
+            printf("PICSimLab: Batch mode, %i workspaces, %.2fs each, %i jobs\n", (int)batch_list.GetLinesCount(),
+                   batch_time, batch_jobs);
+        } else {
+            batch_next = 1;
+            Application->Aargc = 2;
+            PICSimLab.SetUnthrottled(1);
+            printf("PICSimLab: Batch mode, %i workspaces, %.2fs each\n", (int)batch_list.GetLinesCount(),
+                   batch_time);
+        }
+    }
+
     fflush(stdout);
 
     if (close_error) {
@@ -805,7 +928,7 @@ void CPWindow1::_EvOnCreate(CControl* control) {
             PICSimLab.LoadWorkspace(fn.GetFullPath(), 0);
             PICSimLab.SetWorkspaceFileName("");
         } else {
-            PICSimLab.LoadWorkspace(fn.GetFullPath());
+            PICSimLab.LoadWorkspace(fn.GetFullPath(), batch_time <= 0);
         }
 
     } else if ((Application->Aargc >= 3) && (Application->Aargc <= 5)) {
@@ -889,6 +1012,7 @@ void CPWindow1::_EvOnDestroy(CControl* control) {
     PICSimLab.GetBoard()->EndServers();
     PICSimLab.SetNeedReboot(0);
     PICSimLab.EndSimulation();
+    ImageCache.Clear();
 
     if (strlen(PICSimLab.GetPzwTmpdir())) {
         lxRemoveDir(PICSimLab.GetPzwTmpdir());
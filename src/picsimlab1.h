@@ -161,7 +161,16 @@ private:
     float over;
 
     int crt;
-    int zerocount;
+
+    double batch_time;        // simulated seconds of each batch workspace (0 = no batch)
+    int batch_next;           // next batch workspace to load (0 = parallel batch)
+    int batch_jobs;           // batch worker threads (1 = sequential in the window context)
+    lxStringList batch_list;  // batch workspaces list
+
+    /**
+     * @brief  Report the finished batch workspace and load the next one or exit
+     */
+    void BatchNext(void);
 };
 
 extern CPWindow1 Window1;
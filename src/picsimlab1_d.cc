@@ -426,7 +426,7 @@ CPWindow1::CPWindow1(void) {
     statusbar1.SetClass(lxT("CStatusbar"));
     statusbar1.SetName(lxT("statusbar1"));
     statusbar1.SetTag(0);
-    statusbar1.SetFields(lxT("port,stats,serial,"));
+    statusbar1.SetFields(lxT("port,stats,serial,pace,"));
     CreateChild(&statusbar1);
     // togglebutton1
     togglebutton1.SetFOwner(this);
@@ -487,7 +487,9 @@ CPWindow1::CPWindow1(void) {
 
     over = 0;
     crt = 1;
-    zerocount = 0;
+    batch_time = 0;
+    batch_next = 0;
+    batch_jobs = 1;
 
 #ifdef NO_TOOLS
     menu1.DestroyChild(&menu1_Tools);
@@ -34,6 +34,8 @@
 
 CPWindow4 Window4;
 
+static const char* trgmodes[OSC_TRG_LAST] = {"Rising", "Falling", "Edge", "Pulse", "Pattern"};
+
 // Implementation
 
 void CPWindow4::DrawScreen(void) {
@@ -60,7 +62,7 @@ void CPWindow4::DrawScreen(void) {
     draw1.Canvas.Line(0, HMAX / 2, WMAX, HMAX / 2);
     draw1.Canvas.Line(WMAX / 2, 0, WMAX / 2, HMAX);
 
-    float gain[3], nivel[3];
+    float gain[OSC_MAX_CH], nivel[OSC_MAX_CH], mark;
     lxPoint pts[3];
 
     // draw ch 0
@@ -79,12 +81,26 @@ void CPWindow4::DrawScreen(void) {
         pts[2].y = nivel[0] + 8;
         draw1.Canvas.Polygon(1, pts, 3);
 
-        draw1.Canvas.SetLineWidth(2);
-        for (int t = 0; t < (NPOINTS / 2) - 1; t++) {
-            draw1.Canvas.Line((t * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0),
-                              gain[0] * Oscilloscope.GetChannel(0)[t] + nivel[0],
-                              ((t + 1) * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0),
-                              gain[0] * Oscilloscope.GetChannel(0)[t + 1] + nivel[0]);
+        if (Oscilloscope.GetSpectrumMode()) {
+            DrawSpectrum(0);
+        } else {
+            // min/max envelope of fast signals between samples
+            const double* chmin = Oscilloscope.GetChannelMin(0);
+            const double* chmax = Oscilloscope.GetChannelMax(0);
+            for (int t = 0; t < (NPOINTS / 2); t++) {
+                if (chmin[t] != chmax[t]) {
+                    draw1.Canvas.Line((t * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0), gain[0] * chmin[t] + nivel[0],
+                                      (t * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0), gain[0] * chmax[t] + nivel[0]);
+                }
+            }
+
+            draw1.Canvas.SetLineWidth(2);
+            for (int t = 0; t < (NPOINTS / 2) - 1; t++) {
+                draw1.Canvas.Line((t * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0),
+                                  gain[0] * Oscilloscope.GetChannel(0)[t] + nivel[0],
+                                  ((t + 1) * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0),
+                                  gain[0] * Oscilloscope.GetChannel(0)[t + 1] + nivel[0]);
+            }
         }
     }
     draw1.Canvas.SetLineWidth(1);
@@ -105,45 +121,82 @@ void CPWindow4::DrawScreen(void) {
         pts[2].y = nivel[1] + 5;
         draw1.Canvas.Polygon(1, pts, 3);
 
-        draw1.Canvas.SetLineWidth(2);
+        if (Oscilloscope.GetSpectrumMode()) {
+            DrawSpectrum(1);
+        } else {
+            // min/max envelope of fast signals between samples
+            const double* chmin = Oscilloscope.GetChannelMin(1);
+            const double* chmax = Oscilloscope.GetChannelMax(1);
+            for (int t = 0; t < (NPOINTS / 2); t++) {
+                if (chmin[t] != chmax[t]) {
+                    draw1.Canvas.Line((t * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0), gain[1] * chmin[t] + nivel[1],
+                                      (t * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0), gain[1] * chmax[t] + nivel[1]);
+                }
+            }
+
+            draw1.Canvas.SetLineWidth(2);
+            for (int t = 0; t < (NPOINTS / 2) - 1; t++) {
+                draw1.Canvas.Line((t * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0),
+                                  gain[1] * Oscilloscope.GetChannel(1)[t] + nivel[1],
+                                  ((t + 1) * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0),
+                                  gain[1] * Oscilloscope.GetChannel(1)[t + 1] + nivel[1]);
+            }
+        }
+    }
+    draw1.Canvas.SetLineWidth(1);
+
+    // draw ch 2 to 7 as fixed scale lanes at the bottom
+    const int lh = (HMAX / 2) / (OSC_MAX_CH - 2);
+    const unsigned char lcolor[OSC_MAX_CH - 2][3] = {{0, 200, 200},   {200, 0, 200},   {200, 120, 0},
+                                                     {120, 200, 120}, {120, 120, 255}, {255, 120, 120}};
+    for (int c = 2; c < Oscilloscope.GetChannelCount(); c++) {
+        gain[c] = (Oscilloscope.GetVMax() > 0) ? (lh - 4) / Oscilloscope.GetVMax() : 0;
+        nivel[c] = HMAX - ((c - 2) * lh) - 2;
+
+        if (Oscilloscope.GetSpectrumMode())
+            continue;
+
+        draw1.Canvas.SetFgColor(lcolor[c - 2][0], lcolor[c - 2][1], lcolor[c - 2][2]);
+        lxString name;
+        name.Printf("C%i", c + 1);
+        draw1.Canvas.Text(name, 10, nivel[c] - lh + 4);
+
         for (int t = 0; t < (NPOINTS / 2) - 1; t++) {
             draw1.Canvas.Line((t * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0),
-                              gain[1] * Oscilloscope.GetChannel(1)[t] + nivel[1],
+                              gain[c] * Oscilloscope.GetChannel(c)[t] + nivel[c],
                               ((t + 1) * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0),
-                              gain[1] * Oscilloscope.GetChannel(1)[t + 1] + nivel[1]);
+                              gain[c] * Oscilloscope.GetChannel(c)[t + 1] + nivel[c]);
         }
     }
-    draw1.Canvas.SetLineWidth(1);
 
     // draw trigger level
     if (Oscilloscope.GetUseTrigger()) {
-        if (combo1.GetText().compare(lxT("1")) == 0)
-            Oscilloscope.SetTriggerChannel(0);
-        else
-            Oscilloscope.SetTriggerChannel(1);
+        int tc = atoi(combo1.GetText()) - 1;
+        if ((tc < 0) || (tc >= Oscilloscope.GetChannelCount()))
+            tc = 0;
+        Oscilloscope.SetTriggerChannel(tc);
 
         draw1.Canvas.SetFgColor(255, 255, 0);
-        nivel[2] =
-            (gain[Oscilloscope.GetTriggerChannel()] * -spind7.GetValue()) + nivel[Oscilloscope.GetTriggerChannel()];
+        mark = (gain[tc] * -spind7.GetValue()) + nivel[tc];
         pts[0].x = 0;
-        pts[0].y = nivel[2] - 3;
+        pts[0].y = mark - 3;
         pts[1].x = 3;
-        pts[1].y = nivel[2];
+        pts[1].y = mark;
         pts[2].x = 0;
-        pts[2].y = nivel[2] + 3;
+        pts[2].y = mark + 3;
         draw1.Canvas.Polygon(1, pts, 3);
     }
 
     // draw toffset level
 
     draw1.Canvas.SetFgColor(255, 255, 0);
-    nivel[2] = ((WMAX - Oscilloscope.GetTimeOffset()) * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0);
+    mark = ((WMAX - Oscilloscope.GetTimeOffset()) * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0);
     pts[0].y = 1;
-    pts[0].x = nivel[2] - 3;
+    pts[0].x = mark - 3;
     pts[1].y = 1 + 3;
-    pts[1].x = nivel[2];
+    pts[1].x = mark;
     pts[2].y = 1;
-    pts[2].x = nivel[2] + 3;
+    pts[2].x = mark + 3;
     draw1.Canvas.Polygon(1, pts, 3);
 
     // draw text info
@@ -171,12 +224,20 @@ void CPWindow4::DrawScreen(void) {
     draw1.Canvas.Text(text, 10, HMAX + 14);
 
     draw1.Canvas.SetFgColor(200, 200, 200);
-    text.Printf("TM %6.3fms  %6.3fms", spind5.GetValue(), spind6.GetValue());
+    if (Oscilloscope.GetSpectrumMode()) {
+        int bins;
+        Oscilloscope.GetSpectrum(0, &bins);
+        text.Printf("FFT %8.3fkHz 10dB", Oscilloscope.GetSpectrumFreq(bins) / 1000.0);
+    } else {
+        text.Printf("TM %6.3fms  %6.3fms", spind5.GetValue(), spind6.GetValue());
+    }
     draw1.Canvas.Text(text, WMAX / 2, HMAX + 1);
 
     draw1.Canvas.SetFgColor(200, 200, 0);
     if (togglebutton5.GetCheck()) {
-        text.Printf("TRG CH%s %6.2fV ", combo1.GetText().c_str(), spind7.GetValue());
+        const char tmodes[OSC_TRG_LAST] = {'R', 'F', 'E', 'W', 'P'};
+        text.Printf("TRG CH%s %6.2fV %c", combo1.GetText().c_str(), spind7.GetValue(),
+                    tmodes[Oscilloscope.GetTriggerMode()]);
     } else {
         text.Printf("TRG Off");
     }
@@ -243,6 +304,11 @@ void CPWindow4::DrawScreen(void) {
                 text1.Printf("%7.3f ms", Oscilloscope.GetChannelStatus(0).FCycle_ms);
                 text2.Printf("%7.3f ms", Oscilloscope.GetChannelStatus(1).FCycle_ms);
                 break;
+            case 10:
+                text = "Dom. freq.";
+                text1.Printf("%7.0f Hz", Oscilloscope.GetDominantFreq(0));
+                text2.Printf("%7.0f Hz", Oscilloscope.GetDominantFreq(1));
+                break;
             default:
                 text = "";
                 text1 = "";
@@ -262,6 +328,38 @@ void CPWindow4::DrawScreen(void) {
     draw1.Canvas.End();
 }
 
+void CPWindow4::DrawSpectrum(int channel) {
+    int bins;
+    const float* mag = Oscilloscope.GetSpectrum(channel, &bins);
+    double y0 = HMAX;
+
+    if (!mag)
+        return;
+
+    // 0 Hz to Nyquist on screen width, +20 dBV to -80 dBV on screen height
+    for (int x = 0; x < WMAX; x++) {
+        int b0 = (x * bins) / WMAX;
+        int b1 = ((x + 1) * bins) / WMAX;
+        if (b1 <= b0)
+            b1 = b0 + 1;
+
+        float peak = 0;  // peak of bins in the pixel column
+        for (int b = b0; (b < b1) && (b < bins); b++) {
+            if (mag[b] > peak)
+                peak = mag[b];
+        }
+
+        double y = ((20.0 - 20.0 * log10(peak + 1e-9)) * HMAX) / 100.0;
+        if (y < 0)
+            y = 0;
+        if (y > HMAX)
+            y = HMAX;
+        if (x)
+            draw1.Canvas.Line(x - 1, y0, x, y);
+        y0 = y;
+    }
+}
+
 void CPWindow4::button1_EvMouseButtonClick(CControl* control, uint button, uint x, uint y, uint state) {
 #ifndef __WXX11__
     colordialog1.SetColor(button1.GetColor());
@@ -279,8 +377,14 @@ void CPWindow4::button2_EvMouseButtonClick(CControl* control, uint button, uint
 }
 
 void CPWindow4::draw1_EvMouseButtonClick(CControl* control, uint button, uint x, uint y, uint state) {
-    // code here:)
-    mprint(lxT("draw1_EvMouseButtonClick\n"));
+    // click on screen toggles between time and spectrum view
+    if (x < WMAX) {
+        Oscilloscope.SetSpectrumMode(!Oscilloscope.GetSpectrumMode());
+        DrawScreen();
+#ifndef _WIN_
+        Draw();
+#endif
+    }
 }
 
 void CPWindow4::spind5_EvOnChangeSpinDouble(CControl* control) {
@@ -318,17 +422,27 @@ void CPWindow4::timer1_EvOnTime(CControl* control) {
         if (count >= 5)  // Update at 2Hz
         {
             count = 0;
-            if (togglebutton1.GetCheck()) {
-                Oscilloscope.CalculateStats(0);
+            const int chmask = togglebutton1.GetCheck() | (togglebutton2.GetCheck() << 1);
+            int fftmask = 0;
+            if (Oscilloscope.GetSpectrumMode()) {
+                fftmask = chmask;
             } else {
+                for (int i = 0; i < 5; i++) {
+                    if (Oscilloscope.GetMeasures(i) == 10)  // dominant frequency
+                        fftmask = chmask;
+                }
+            }
+            // calculated in background, results are fetched in next timer events
+            Oscilloscope.StartAnalysis(chmask, fftmask);
+            if (!togglebutton1.GetCheck()) {
                 Oscilloscope.ClearStats(0);
             }
-            if (togglebutton2.GetCheck()) {
-                Oscilloscope.CalculateStats(1);
-            } else {
+            if (!togglebutton2.GetCheck()) {
                 Oscilloscope.ClearStats(1);
             }
+            UpdateControls();
         }
+        Oscilloscope.FetchAnalysis();
         DrawScreen();
 #ifndef _WIN_
         Draw();
@@ -363,6 +477,7 @@ void CPWindow4::_EvOnCreate(CControl* control) {
 
 void CPWindow4::_EvOnShow(CControl* control) {
     Oscilloscope.Reset();
+    UpdateControls();
     timer1.SetRunState(1);
 }
 
@@ -384,6 +499,7 @@ void CPWindow4::button3_EvMouseButtonClick(CControl* control, uint button, uint
     int ce = togglebutton1.GetCheck() + togglebutton2.GetCheck() * 2;
 
     togglebutton5.SetCheck(1);  // trigguer
+    Oscilloscope.SetUseTrigger(1);
     spind5.SetValue(1.0);       // time scale
     spind5_EvOnChangeSpinDouble(control);
     // spind6.SetValue(0.0);//time offset
@@ -410,8 +526,15 @@ void CPWindow4::button3_EvMouseButtonClick(CControl* control, uint button, uint
             spind4.SetValue(-6.0);      // ch2 level
             togglebutton3.SetCheck(0);  // ch1 inverse off
             togglebutton4.SetCheck(0);  // ch2 inverse off
-            // TODO select the better mode for channel trigguer
-            combo1.SetText("1");  // trigguer channel
+            // trigguer on the periodic channel with lower frequency (ch1 if none)
+            Oscilloscope.CalculateStats(0);
+            Oscilloscope.CalculateStats(1);
+            if ((Oscilloscope.GetChannelStatus(1).Freq > 0) &&
+                ((Oscilloscope.GetChannelStatus(0).Freq <= 0) ||
+                 (Oscilloscope.GetChannelStatus(1).Freq < Oscilloscope.GetChannelStatus(0).Freq)))
+                combo1.SetText("2");  // trigguer channel
+            else
+                combo1.SetText("1");  // trigguer channel
             break;
     }
 }
@@ -438,6 +561,10 @@ void CPWindow4::togglebutton6_EvOnToggleButton(CControl* control) {
     combo1.SetEnable(Oscilloscope.GetRun());
     combo2.SetEnable(Oscilloscope.GetRun());
     combo3.SetEnable(Oscilloscope.GetRun());
+    combo4.SetEnable(Oscilloscope.GetRun());
+    edit1.SetEnable(Oscilloscope.GetRun());
+    button10.SetEnable(Oscilloscope.GetRun());
+    spin1.SetEnable(Oscilloscope.GetRun());
 }
 
 // save PNG
@@ -483,3 +610,57 @@ void CPWindow4::button9_EvMouseButtonPress(CControl* control, const uint button,
                                            const uint state) {
     Oscilloscope.NextMeasure(4);
 }
+
+// trigger mode
+
+void CPWindow4::combo4_EvOnComboChange(CControl* control) {
+    for (int i = 0; i < OSC_TRG_LAST; i++) {
+        if (combo4.GetText().compare(trgmodes[i]) == 0) {
+            Oscilloscope.SetTriggerMode(i);
+        }
+    }
+}
+
+// trigger pattern
+
+void CPWindow4::button10_EvMouseButtonClick(CControl* control, uint button, uint x, uint y, uint state) {
+    Oscilloscope.SetTriggerPattern(edit1.GetText());
+    pattern = Oscilloscope.GetTriggerPattern();
+    edit1.SetText(pattern);
+}
+
+// number of channels
+
+void CPWindow4::spin1_EvOnChangeSpin(CControl* control) {
+    Oscilloscope.SetChannelCount(spin1.GetValue());
+    UpdateControls();
+}
+
+// follow settings changed by preferences, workspaces and remote control
+
+void CPWindow4::UpdateControls(void) {
+    const int chn = Oscilloscope.GetChannelCount();
+
+    if (chcount != chn) {
+        chcount = chn;
+        spin1.SetValue(chn);
+        combo1.DeleteItems();
+        for (int i = 1; i <= chn; i++) {
+            combo1.AddItem(itoa(i));
+        }
+        if (atoi(combo1.GetText()) > chn) {
+            combo1.SetText("1");
+        }
+    }
+
+    if (combo4.GetText().compare(trgmodes[Oscilloscope.GetTriggerMode()]) != 0) {
+        combo4.SetText(trgmodes[Oscilloscope.GetTriggerMode()]);
+    }
+
+    // only overwrite the pattern being typed when the oscilloscope one changes
+    const lxString tp = Oscilloscope.GetTriggerPattern();
+    if (tp.compare(pattern) != 0) {
+        pattern = tp;
+        edit1.SetText(pattern);
+    }
+}
@@ -79,6 +79,10 @@ public:
     CButton button7;
     CButton button8;
     CButton button9;
+    CCombo combo4;
+    CEdit edit1;
+    CButton button10;
+    CSpin spin1;
     /*#Events*/
     void _EvOnCreate(CControl* control);
     void _EvOnDestroy(CControl* control);
@@ -104,16 +108,23 @@ public:
     void button7_EvMouseButtonPress(CControl* control, const uint button, const uint x, const uint y, const uint state);
     void button8_EvMouseButtonPress(CControl* control, const uint button, const uint x, const uint y, const uint state);
     void button9_EvMouseButtonPress(CControl* control, const uint button, const uint x, const uint y, const uint state);
+    void combo4_EvOnComboChange(CControl* control);
+    void button10_EvMouseButtonClick(CControl* control, const uint button, const uint x, const uint y, const uint state);
+    void spin1_EvOnChangeSpin(CControl* control);
 
     /*#Others*/
     // lxrad automatic generated block end, don't edit above!
     CPWindow4(void);
     void DrawScreen(void);
+    void DrawSpectrum(int channel);
+    void UpdateControls(void);
 
 private:
     CButton* ctrl;
     lxFont* font;
     double xz;
+    lxString pattern;
+    int chcount;
 };
 
 extern CPWindow4 Window4;
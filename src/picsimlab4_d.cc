@@ -690,10 +690,79 @@ CPWindow4::CPWindow4(void) {
     button9.EvMouseButtonPress = EVMOUSEBUTTONPRESS & CPWindow4::button9_EvMouseButtonPress;
     button9.SetText(lxT(""));
     CreateChild(&button9);
+    // combo4
+    combo4.SetFOwner(this);
+    combo4.SetClass(lxT("CCombo"));
+    combo4.SetName(lxT("combo4"));
+    combo4.SetTag(0);
+    combo4.SetX(510);
+    combo4.SetY(270);
+    combo4.SetWidth(150);
+    combo4.SetHeight(32);
+    combo4.SetHint(lxT("Trigger mode"));
+    combo4.SetEnable(1);
+    combo4.SetVisible(1);
+    combo4.SetPopupMenu(NULL);
+    combo4.SetItems(lxT("Rising,Falling,Edge,Pulse,Pattern,"));
+    combo4.SetText(lxT("Rising"));
+    combo4.SetReadOnly(0);
+    combo4.EvOnComboChange = EVONCOMBOCHANGE & CPWindow4::combo4_EvOnComboChange;
+    CreateChild(&combo4);
+    // edit1
+    edit1.SetFOwner(this);
+    edit1.SetClass(lxT("CEdit"));
+    edit1.SetName(lxT("edit1"));
+    edit1.SetTag(0);
+    edit1.SetX(665);
+    edit1.SetY(270);
+    edit1.SetWidth(100);
+    edit1.SetHeight(32);
+    edit1.SetHint(lxT("Trigger pattern, one char per channel: 1 high, 0 low, X don't care"));
+    edit1.SetEnable(1);
+    edit1.SetVisible(1);
+    edit1.SetPopupMenu(NULL);
+    edit1.SetText(lxT("XX"));
+    edit1.SetReadOnly(0);
+    CreateChild(&edit1);
+    // button10
+    button10.SetFOwner(this);
+    button10.SetClass(lxT("CButton"));
+    button10.SetName(lxT("button10"));
+    button10.SetTag(0);
+    button10.SetX(770);
+    button10.SetY(270);
+    button10.SetWidth(45);
+    button10.SetHeight(32);
+    button10.SetHint(lxT("Apply the trigger pattern"));
+    button10.SetEnable(1);
+    button10.SetVisible(1);
+    button10.SetPopupMenu(NULL);
+    button10.EvMouseButtonClick = EVMOUSEBUTTONCLICK & CPWindow4::button10_EvMouseButtonClick;
+    button10.SetText(lxT("Set"));
+    CreateChild(&button10);
+    // spin1
+    spin1.SetFOwner(this);
+    spin1.SetClass(lxT("CSpin"));
+    spin1.SetName(lxT("spin1"));
+    spin1.SetTag(0);
+    spin1.SetX(683);
+    spin1.SetY(306);
+    spin1.SetWidth(134);
+    spin1.SetHeight(32);
+    spin1.SetHint(lxT("Number of channels"));
+    spin1.SetEnable(1);
+    spin1.SetVisible(1);
+    spin1.SetPopupMenu(NULL);
+    spin1.SetValue(2);
+    spin1.SetMin(1);
+    spin1.SetMax(8);
+    spin1.EvOnChangeSpin = EVONCHANGESPIN & CPWindow4::spin1_EvOnChangeSpin;
+    CreateChild(&spin1);
     /*#Others*/
     // lxrad automatic generated block end, don't edit above!
     button1.SetColor(255, 0, 0);
     button2.SetColor(0, 255, 0);
 
     font = NULL;
+    chcount = 0;
 }
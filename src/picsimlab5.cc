@@ -25,6 +25,7 @@
 
 // Spare parts
 
+#include "lib/drawpool.h"
 #include "lib/oscilloscope.h"
 #include "lib/picsimlab.h"
 #include "lib/spareparts.h"
@@ -56,11 +57,11 @@ void CPWindow5::_EvOnShow(CControl* control) {
 void CPWindow5::menu1_EvMenuActive(CControl* control) {
     PartToCreate = ((CItemMenu*)control)->GetText();
 
-    if (SpareParts.GetCount() < MAX_PARTS) {
-        part* Part = SpareParts.AddPart((char*)PartToCreate.char_str(), 50 - offsetx, 50 - offsety,
-                                        SpareParts.GetScale(), PICSimLab.GetBoard());
-        _EvOnShow(control);
-        PartToCreate = "";
+    part* Part = SpareParts.AddPart((char*)PartToCreate.char_str(), 50 - offsetx, 50 - offsety, SpareParts.GetScale(),
+                                    PICSimLab.GetBoard());
+    _EvOnShow(control);
+    PartToCreate = "";
+    if (Part) {
         PartToMove = Part->GetId();
         lxSetCursor(lxCursor(lxCURSOR_SIZENWSE));
         mdx = -10 - offsetx;
@@ -99,22 +100,21 @@ void CPWindow5::draw1_EvMouseButtonPress(CControl* control, uint button, uint x,
     x = x / SpareParts.GetScale();
     y = y / SpareParts.GetScale();
 
-    for (int i = 0; i < SpareParts.GetCount(); i++) {
-        if (SpareParts.GetPart(i)->PointInside((int)(x - offsetx), (int)(y - offsety))) {
-            SpareParts.GetPart(i)->EvMouseButtonPress(button, (x - offsetx) - SpareParts.GetPart(i)->GetX(),
-                                                      (y - offsety) - SpareParts.GetPart(i)->GetY(), state);
-            if (button == 3) {
-                PartSelected = i;
-                pmenu2.SetX(x * SpareParts.GetScale());
-                pmenu2.SetY(y * SpareParts.GetScale());
+    int i = SpareParts.GetPartAt((int)(x - offsetx), (int)(y - offsety));
+    if (i >= 0) {
+        SpareParts.GetPart(i)->EvMouseButtonPress(button, (x - offsetx) - SpareParts.GetPart(i)->GetX(),
+                                                  (y - offsety) - SpareParts.GetPart(i)->GetY(), state);
+        if (button == 3) {
+            PartSelected = i;
+            pmenu2.SetX(x * SpareParts.GetScale());
+            pmenu2.SetY(y * SpareParts.GetScale());
 #if defined(__WXGTK__) || defined(__WXMSW__)
-                SetPopupMenu(&pmenu2);
+            SetPopupMenu(&pmenu2);
 #else
-                draw1.SetPopupMenu(&pmenu2);
+            draw1.SetPopupMenu(&pmenu2);
 #endif
-            }
-            return;
         }
+        return;
     }
 
     if (button == 1) {
@@ -141,12 +141,10 @@ void CPWindow5::draw1_EvMouseButtonRelease(CControl* control, uint button, uint
     mdx = 0;
     mdy = 0;
 
-    for (int i = 0; i < SpareParts.GetCount(); i++) {
-        if (SpareParts.GetPart(i)->PointInside(x - offsetx, y - offsety)) {
-            SpareParts.GetPart(i)->EvMouseButtonRelease(button, (x - offsetx) - SpareParts.GetPart(i)->GetX(),
-                                                        (y - offsety) - SpareParts.GetPart(i)->GetY(), state);
-            return;
-        }
+    int i = SpareParts.GetPartAt(x - offsetx, y - offsety);
+    if (i >= 0) {
+        SpareParts.GetPart(i)->EvMouseButtonRelease(button, (x - offsetx) - SpareParts.GetPart(i)->GetX(),
+                                                    (y - offsety) - SpareParts.GetPart(i)->GetY(), state);
     }
 }
 
@@ -426,6 +424,7 @@ void CPWindow5::pmenu2_Properties_EvMenuActive(CControl* control) {
 void CPWindow5::PropClose(int tag) {
     if (tag) {
         SpareParts.GetPart(PartSelected)->ReadPropertiesWindow(&wprop);
+        SpareParts.InvalidateIndex();  // part can be resized
     }
     wprop.HideExclusive();
     // wprop.SetCanDestroy (true);
@@ -494,6 +493,11 @@ void CPWindow5::timer1_EvOnTime(CControl* control) {
 
     need_resize++;
 
+    // render dirty parts in parallel, canvas drawing stays in this thread
+    int dirtyc;
+    part** dirty = SpareParts.GetDrawPending(&dirtyc);
+    DrawPool.Prepare(dirty, dirtyc);
+
     for (int i = 0; i < SpareParts.GetCount(); i++) {
         SpareParts.GetPart(i)->Draw();
         if (SpareParts.GetPart(i)->GetUpdate())
@@ -574,14 +578,13 @@ void CPWindow5::draw1_EvMouseMove(CControl* control, uint button, uint x, uint y
 
         SpareParts.GetPart(PartToMove)->SetX(x + mdx);
         SpareParts.GetPart(PartToMove)->SetY(y + mdy);
+        SpareParts.InvalidateIndex();
         update_all = 1;
     } else {
-        for (int i = 0; i < SpareParts.GetCount(); i++) {
-            if (SpareParts.GetPart(i)->PointInside(x - offsetx, y - offsety)) {
-                SpareParts.GetPart(i)->EvMouseMove(button, (x - offsetx) - SpareParts.GetPart(i)->GetX(),
-                                                   (y - offsety) - SpareParts.GetPart(i)->GetY(), state);
-                return;
-            }
+        int i = SpareParts.GetPartAt(x - offsetx, y - offsety);
+        if (i >= 0) {
+            SpareParts.GetPart(i)->EvMouseMove(button, (x - offsetx) - SpareParts.GetPart(i)->GetX(),
+                                               (y - offsety) - SpareParts.GetPart(i)->GetY(), state);
         }
     }
 }
@@ -788,6 +791,7 @@ void CPWindow5::pmenu2_Rotate_EvMenuActive(CControl* control) {
         orientation = 0;
 
     SpareParts.GetPart(PartSelected)->SetOrientation(orientation);
+    SpareParts.InvalidateIndex();
 
     update_all = 1;
 }
@@ -0,0 +1,99 @@
+/* ########################################################################
+
+   PICsimLab - PIC laboratory simulator
+
+   ########################################################################
+
+   Copyright (c) : 2020-2023  Luis Claudio Gamboa Lopes
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/lib/rcontrol.h"
+#include "tests.h"
+
+static int test_rcontrol_binary(void* arg) {
+    unsigned char req[16];
+    unsigned char reply[64];
+    printf("test rcontrol binary \n");
+
+    if (!test_load("serial/serial_uno.pzw")) {
+        return 0;
+    }
+
+    if (!test_binary_start()) {
+        test_end();
+        return 0;
+    }
+
+    // spare parts virtual pin 200 is an unused input
+    for (int v = 1; v >= 0; v--) {
+        req[0] = 200;
+        req[1] = v;
+        if (test_send_brequest(RC_OP_SET_PINS, req, 2, reply, sizeof(reply)) != 0) {
+            printf("Error on SET_PINS \n");
+            test_end();
+            return 0;
+        }
+        if ((test_send_brequest(RC_OP_GET_PINS, req, 1, reply, sizeof(reply)) != 1) || (reply[0] != v)) {
+            printf("Error on GET_PINS \n");
+            test_end();
+            return 0;
+        }
+    }
+
+    // pin 0 is invalid
+    req[0] = 0;
+    if (test_send_brequest(RC_OP_GET_PINS, req, 1, reply, sizeof(reply)) >= 0) {
+        printf("Error on GET_PINS invalid pin \n");
+        test_end();
+        return 0;
+    }
+
+    // flash starts with the reset vector jmp (0x940C)
+    memset(req, 0, 9);
+    req[0] = 2;
+    req[5] = 4;
+    if ((test_send_brequest(RC_OP_READ_MEM, req, 9, reply, sizeof(reply)) != 4) || (reply[0] != 0x0C) ||
+        (reply[1] != 0x94)) {
+        printf("Error on READ_MEM flash \n");
+        test_end();
+        return 0;
+    }
+
+    // RAM
+    req[0] = 0;
+    req[5] = 32;
+    if (test_send_brequest(RC_OP_READ_MEM, req, 9, reply, sizeof(reply)) != 32) {
+        printf("Error on READ_MEM ram \n");
+        test_end();
+        return 0;
+    }
+
+    if (!test_binary_end()) {
+        printf("Error on binary end \n");
+        test_end();
+        return 0;
+    }
+
+    return test_end();
+}
+
+register_test("Uno rcontrol binary", test_rcontrol_binary, NULL);
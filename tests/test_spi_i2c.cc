@@ -66,6 +66,54 @@ static int bmp280_test(const char* tname, const char* fname, const char* resp, i
     return test_end();
 }
 
+static int bmp280_decode_test(const char* tname, const char* fname, const char* decoder, const char* line,
+                              int use_vterm) {
+    char cmd[256];
+    printf("test %s\n", tname);
+
+    if (!test_load(fname)) {
+        return 0;
+    }
+
+    if (!test_serial_vt_init(use_vterm)) {
+        printf("Error init vt \n");
+        test_end();
+        return 0;
+    }
+
+    char buff[256];
+    // read serial console
+    while (test_serial_recv_str(buff, 256, 1000)) {
+    }
+
+    // decode the sensor read requested by the serial command
+    snprintf(cmd, 256, "decode %s", decoder);
+    test_send_rcmd(cmd);
+    test_send_rcmd("decode start");
+    if (!strstr(test_get_cmd_resp(), "Ok")) {
+        printf("Error start decoder \n");
+        test_end();
+        return 0;
+    }
+
+    test_serial_send('a');
+    sleep(1);
+    test_serial_recv_str(buff, 256, 1000);
+
+    test_send_rcmd("decode stop");
+    test_send_rcmd("decode log");
+
+    // check the sensor transfer in the decoder log
+    if (!strstr(test_get_cmd_resp(), line)) {
+        printf("[%s]\n", test_get_cmd_resp());
+        printf("Failed in %s \n", tname);
+        test_end();
+        return 0;
+    }
+
+    return test_end();
+}
+
 static int test_SPI_ESP32(void* arg) {
     return bmp280_test("SPI ESP32", "spi/esp32_bmp280_spi.pzw", "T= 35.00 P= 780.00\r", 1);
 }
@@ -104,4 +152,19 @@ register_test("SPI PIC18F", test_SPI_PIC18F, NULL);
 static int test_I2C_PIC18F(void* arg) {
     return bmp280_test("I2C PIC18F", "i2c/pic18f_bmp280_i2c.pzw", "T=  35.00 P= 780.00", 1);
 }
-register_test("I2C PIC18F", test_I2C_PIC18F, NULL);
\ No newline at end of file
+register_test("I2C PIC18F", test_I2C_PIC18F, NULL);
+
+static int test_I2C_AVR_decode(void* arg) {
+    return bmp280_decode_test("I2C AVR decode", "i2c/uno_bmp280_i2c.pzw", "i2c 28 27", "ADDR 0x76 W ACK", 1);
+}
+register_test("I2C AVR decode", test_I2C_AVR_decode, NULL);
+
+static int test_SPI_AVR_decode(void* arg) {
+    return bmp280_decode_test("SPI AVR decode", "spi/uno_bmp280_spi.pzw", "spi 19 17 18 16", "CS LOW", 1);
+}
+register_test("SPI AVR decode", test_SPI_AVR_decode, NULL);
+
+static int test_I2C_STM32_decode(void* arg) {
+    return bmp280_decode_test("I2C STM32 decode", "i2c/stm32_bmp280_i2c.pzw", "i2c 42 43", "ADDR 0x76 W ACK", 1);
+}
+register_test("I2C STM32 decode", test_I2C_STM32_decode, NULL);
@@ -46,13 +46,14 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "../src/lib/rcontrol.h"
 #include "serial.h"
 #include "tests.h"
 
 // #define USE_SERIAL
 
 static int sockfd = -1;
-static char buff[2048];
+static char buff[16384];
 // static char cmd[256];
 
 // static void setblock(int sock_descriptor);
@@ -328,7 +329,11 @@ int test_send_rcmd(const char* message) {
     buff[0] = 0;
     int timeout = 0;
     do {
-        if ((n = recv(sockfd, buff + bp, 100, 0)) > 0) {
+        int room = sizeof(buff) - 1 - bp;  // long replies (decode log) are truncated
+        if (room > 100) {
+            room = 100;
+        }
+        if ((n = recv(sockfd, buff + bp, room, 0)) > 0) {
             bp += n;
             buff[bp] = 0;
             // printf ("%c", buff[bp-1]);
@@ -362,6 +367,90 @@ char* test_get_cmd_resp(void) {
     return buff;
 }
 
+// rcontrol binary framed protocol
+
+static int recv_wait(unsigned char* data, const unsigned int size) {
+    unsigned int bp = 0;
+    int timeout = 0;
+
+    while ((bp < size) && (timeout < 20000)) {
+        int n = recv(sockfd, (char*)data + bp, size - bp, 0);
+        if (n > 0) {
+            bp += n;
+        } else {
+            timeout++;
+            usleep(100);
+        }
+    }
+
+    return bp == size;
+}
+
+int test_binary_start(void) {
+    unsigned char resp[4];
+    const char* cmd = "binary 1\r\n";
+    int n = strlen(cmd);
+
+    if (send(sockfd, cmd, n, MSG_NOSIGNAL) != n) {
+        printf("send error : %s \n", strerror(errno));
+        return 0;
+    }
+    // no prompt after the Ok, the next bytes are frames
+    if (!recv_wait(resp, 4) || memcmp(resp, "Ok\r\n", 4)) {
+        printf("Error on binary start \n");
+        return 0;
+    }
+    return 1;
+}
+
+// return the reply payload size or -1 on error
+int test_send_brequest(const unsigned char op, const unsigned char* data, const unsigned int size,
+                       unsigned char* reply, const unsigned int rsize) {
+    unsigned char frame[512];
+    unsigned int len;
+
+    if (size > (sizeof(frame) - 5)) {
+        return -1;
+    }
+    len = size + 1;
+    frame[0] = len;
+    frame[1] = len >> 8;
+    frame[2] = len >> 16;
+    frame[3] = len >> 24;
+    frame[4] = op;
+    if (size) {
+        memcpy(frame + 5, data, size);
+    }
+    if (send(sockfd, (const char*)frame, size + 5, MSG_NOSIGNAL) != (int)(size + 5)) {
+        printf("send error : %s \n", strerror(errno));
+        return -1;
+    }
+
+    if (!recv_wait(frame, 5)) {
+        printf("Error on binary reply \n");
+        return -1;
+    }
+    len = frame[0] | (frame[1] << 8) | (frame[2] << 16) | ((unsigned int)frame[3] << 24);
+    if ((len == 0) || ((len - 1) > rsize) || !recv_wait(reply, len - 1)) {
+        printf("Error on binary reply size %u\n", len);
+        return -1;
+    }
+    if (frame[4] != RC_ST_OK) {
+        return -1;
+    }
+    return len - 1;
+}
+
+int test_binary_end(void) {
+    unsigned char prompt;
+
+    if (test_send_brequest(RC_OP_TEXT, NULL, 0, NULL, 0) < 0) {
+        return 0;
+    }
+    // text protocol prompt
+    return recv_wait(&prompt, 1) && (prompt == '>');
+}
+
 #ifdef _WIN32
 WORD wVersionRequested = 2;
 WSADATA wsaData;
@@ -26,7 +26,7 @@
 #ifndef TESTS_H
 #define TESTS_H
 
-#define MAX_TESTS 20
+#define MAX_TESTS 32
 
 // extern int NUM_TESTS;
 
@@ -44,6 +44,12 @@ int test_send_rcmd(const char* message);
 char* test_get_cmd_resp(void);
 int test_end();
 
+// rcontrol binary framed protocol
+int test_binary_start(void);
+int test_send_brequest(const unsigned char op, const unsigned char* data, const unsigned int size,
+                       unsigned char* reply, const unsigned int rsize);
+int test_binary_end(void);
+
 // serial
 int test_serial_send(const char data);
 int test_serial_recv(char* data);
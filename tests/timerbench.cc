@@ -0,0 +1,77 @@
+/* ########################################################################
+
+   PICsimLab - PIC laboratory simulator
+
+   ########################################################################
+
+   Copyright (c) : 2020-2023  Luis Claudio Gamboa Lopes
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+// board timer engine microbenchmark (steps per second x registered timers)
+
+#include <stdio.h>
+#include <time.h>
+
+#include "../src/lib/timerqueue.h"
+
+#define NSTEPS 50000000UL
+
+static unsigned long calls = 0;
+
+static void callback(void* arg) {
+    calls++;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double bench(const int ntimers) {
+    static CTimerQueue queue;
+
+    queue.Clear();
+    for (int i = 0; i < ntimers; i++) {
+        // periods from 10us to ~1ms at 16MHz, half of the timers disabled
+        int timer = queue.Register(160 + (i * 997) % 16000, 0, callback, NULL);
+        if (i & 1) {
+            queue.SetState(timer, 0);
+        }
+    }
+
+    calls = 0;
+    double t0 = now_s();
+    for (unsigned long s = 0; s < NSTEPS; s++) {
+        queue.Step();
+    }
+    double t1 = now_s();
+
+    return NSTEPS / (t1 - t0);
+}
+
+int main(int argc, char** argv) {
+    const int ntimers[] = {0, 16, 128};
+
+    for (int i = 0; i < 3; i++) {
+        double sps = bench(ntimers[i]);
+        printf("timers %3i  steps/s %8.2fM  callbacks %lu\n", ntimers[i], sps * 1e-6, calls);
+    }
+    return 0;
+}